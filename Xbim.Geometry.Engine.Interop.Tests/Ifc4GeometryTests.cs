@@ -404,6 +404,120 @@ namespace Xbim.Geometry.Engine.Interop.Tests
 
             }
         }
+
+        [TestMethod]
+        public void TriangulatedFaceSet_skips_triangles_with_indices_out_of_range()
+        {
+            using (var model = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                IfcTriangulatedFaceSet faceSet;
+                using (var txn = model.BeginTransaction(""))
+                {
+                    var points = model.Instances.New<IfcCartesianPointList3D>();
+                    points.CoordList.GetAt(0).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 0, 0, 0 });
+                    points.CoordList.GetAt(1).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 1, 0, 0 });
+                    points.CoordList.GetAt(2).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 0, 1, 0 });
+                    points.CoordList.GetAt(3).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 0, 0, 1 });
+                    faceSet = model.Instances.New<IfcTriangulatedFaceSet>(fs => fs.Coordinates = points);
+                    //a tetrahedron and a triangle that refers to a fifth point that does not exist
+                    var triangles = new[] { new[] { 1, 3, 2 }, new[] { 1, 2, 4 }, new[] { 2, 3, 4 }, new[] { 1, 4, 3 }, new[] { 1, 2, 5 } };
+                    for (int i = 0; i < triangles.Length; i++)
+                        faceSet.CoordIndex.GetAt(i).AddRange(triangles[i].Select(idx => new Ifc4.MeasureResource.IfcPositiveInteger(idx)));
+                    txn.Commit();
+                }
+                var warnings = new WarningRecorder();
+                var geom = geomEngine.CreateSurfaceModel(faceSet, warnings);
+                geom.Faces.Count.Should().Be(4, "the triangle out of range is skipped, the others are kept");
+                warnings.Messages.Should().Contain(m => m.Contains("Triangle index out of range"));
+            }
+        }
+
+        [TestMethod]
+        public void IndexedPolyCurve_without_points_is_ignored()
+        {
+            using (var model = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                Ifc4.GeometryResource.IfcIndexedPolyCurve curve;
+                using (var txn = model.BeginTransaction(""))
+                {
+                    var points = model.Instances.New<IfcCartesianPointList2D>();
+                    curve = model.Instances.New<Ifc4.GeometryResource.IfcIndexedPolyCurve>(c => c.Points = points);
+                    txn.Commit();
+                }
+                var warnings = new WarningRecorder();
+                var wire = geomEngine.CreateWire(curve, warnings);
+                wire.IsValid.Should().BeFalse();
+                warnings.Messages.Should().Contain(m => m.Contains("IfcIndexedPolyCurve has no points"));
+            }
+        }
+
+        [TestMethod]
+        public void TriangulatedFaceSet_skips_triangles_on_points_without_two_coordinates()
+        {
+            using (var model = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                IfcTriangulatedFaceSet faceSet;
+                using (var txn = model.BeginTransaction(""))
+                {
+                    var points = model.Instances.New<IfcCartesianPointList3D>();
+                    points.CoordList.GetAt(0).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 0, 0, 0 });
+                    points.CoordList.GetAt(1).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 1, 0, 0 });
+                    points.CoordList.GetAt(2).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 0, 1, 0 });
+                    points.CoordList.GetAt(3).AddRange(new Ifc4.MeasureResource.IfcLengthMeasure[] { 0, 0, 1 });
+                    points.CoordList.GetAt(4).Add(2);
+                    faceSet = model.Instances.New<IfcTriangulatedFaceSet>(fs => fs.Coordinates = points);
+                    //a tetrahedron and a triangle on a fifth point that has a single coordinate
+                    var triangles = new[] { new[] { 1, 3, 2 }, new[] { 1, 2, 4 }, new[] { 2, 3, 4 }, new[] { 1, 4, 3 }, new[] { 1, 2, 5 } };
+                    for (int i = 0; i < triangles.Length; i++)
+                        faceSet.CoordIndex.GetAt(i).AddRange(triangles[i].Select(idx => new Ifc4.MeasureResource.IfcPositiveInteger(idx)));
+                    txn.Commit();
+                }
+                var warnings = new WarningRecorder();
+                var geom = geomEngine.CreateSurfaceModel(faceSet, warnings);
+                geom.Faces.Count.Should().Be(4, "the point is ignored with the triangle on it, the others are kept");
+                warnings.Messages.Should().Contain(m => m.Contains("Point 5 is missing or has less than 2 coordinates"));
+                warnings.Messages.Should().Contain(m => m.Contains("Triangle refers to a point that has been ignored"));
+            }
+        }
+
+        [TestMethod]
+        public void Polyline_skips_points_without_two_coordinates()
+        {
+            using (var model = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                Ifc4.GeometryResource.IfcPolyline polyline;
+                using (var txn = model.BeginTransaction(""))
+                {
+                    polyline = model.Instances.New<Ifc4.GeometryResource.IfcPolyline>();
+                    polyline.Points.Add(model.Instances.New<Ifc4.GeometryResource.IfcCartesianPoint>(p => p.SetXY(0, 0)));
+                    polyline.Points.Add(model.Instances.New<Ifc4.GeometryResource.IfcCartesianPoint>(p => p.Coordinates.Add(5)));
+                    polyline.Points.Add(model.Instances.New<Ifc4.GeometryResource.IfcCartesianPoint>(p => p.SetXY(1, 0)));
+                    polyline.Points.Add(model.Instances.New<Ifc4.GeometryResource.IfcCartesianPoint>(p => p.SetXY(1, 1)));
+                    txn.Commit();
+                }
+                var warnings = new WarningRecorder();
+                var wire = geomEngine.CreateWire(polyline, warnings);
+                wire.IsValid.Should().BeTrue();
+                wire.Edges.Count.Should().Be(2, "the point with one coordinate is left out");
+                warnings.Messages.Should().Contain(m => m.Contains("Point 2 is missing or has less than 2 coordinates"));
+            }
+        }
+
+        //keeps the warnings the engine writes so a test can check it reported a fault
+        private class WarningRecorder : ILogger
+        {
+            public System.Collections.Generic.List<string> Messages { get; } = new System.Collections.Generic.List<string>();
+
+            public IDisposable BeginScope<TState>(TState state) => null;
+
+            public bool IsEnabled(LogLevel logLevel) => logLevel >= LogLevel.Warning;
+
+            public void Log<TState>(LogLevel logLevel, EventId eventId, TState state, Exception exception, Func<TState, Exception, string> formatter)
+            {
+                if (IsEnabled(logLevel))
+                    Messages.Add(formatter(state, exception));
+            }
+        }
         #endregion
 
         #region Grid placement
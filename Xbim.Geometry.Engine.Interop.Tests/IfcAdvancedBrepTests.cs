@@ -127,6 +127,44 @@ namespace Xbim.Geometry.Engine.Interop.Tests
 
         }
 
+        [DataTestMethod]
+        [DataRow("advanced_brep_2")]
+        [DataRow("advanced_brep_7")]
+        [DataRow("advanced_brep_8")]
+        public void Parallel_advanced_faces_match_the_serial_build(string brepFileName)
+        {
+            var engine = (XbimGeometryEngine)geomEngine;
+            var parallel = engine.ParallelAdvancedFaces;
+            try
+            {
+                using (var model = MemoryModel.OpenRead($@"TestFiles\{brepFileName}.ifc"))
+                {
+                    model.AddRevitWorkArounds();
+                    var brep = model.Instances.OfType<IIfcAdvancedBrep>().FirstOrDefault();
+                    brep.Should().NotBeNull();
+                    engine.ParallelAdvancedFaces = false;
+                    var serialSolids = geomEngine.CreateSolidSet(brep, logger);
+                    engine.ParallelAdvancedFaces = true;
+                    var parallelSolids = geomEngine.CreateSolidSet(brep, logger);
+
+                    parallelSolids.Should().HaveCount(serialSolids.Count);
+                    var serial = serialSolids.OrderBy(s => s.Volume).ToList();
+                    var parallelBuilt = parallelSolids.OrderBy(s => s.Volume).ToList();
+                    for (var i = 0; i < serial.Count; i++)
+                    {
+                        parallelBuilt[i].Faces.Count.Should().Be(serial[i].Faces.Count);
+                        parallelBuilt[i].Edges.Count.Should().Be(serial[i].Edges.Count);
+                        parallelBuilt[i].Vertices.Count.Should().Be(serial[i].Vertices.Count);
+                        parallelBuilt[i].Volume.Should().BeApproximately(serial[i].Volume, model.ModelFactors.Precision * Math.Max(1, serial[i].Volume));
+                    }
+                }
+            }
+            finally
+            {
+                engine.ParallelAdvancedFaces = parallel;
+            }
+        }
+
 
         //[DataTestMethod]
         //[DataRow("ShapeGeometry_5")]
@@ -11,6 +11,8 @@ using Xbim.Ifc4.Kernel;
 using Xbim.Ifc4.MeasureResource;
 using Xbim.Ifc4.ProductExtension;
 using Xbim.Ifc4.ProfileResource;
+using Xbim.Ifc4.RepresentationResource;
+using Xbim.Ifc4.SharedBldgElements;
 using Xbim.Ifc4.Interfaces;
 using Xbim.IO.Memory;
 
@@ -193,6 +195,28 @@ namespace Xbim.Geometry.Engine.Interop.Tests
             return sphere;
         }
 
+        public static IfcRightCircularCone MakeRightCircularCone(MemoryModel m, double r, double h)
+        {
+            var cone = m.Instances.New<IfcRightCircularCone>();
+            cone.Position = MakeAxis2Placement3D(m);
+            cone.BottomRadius = r;
+            cone.Height = h;
+            return cone;
+        }
+
+        public static IfcSweptDiskSolid MakeSweptDiskSolid(MemoryModel m, double r, double? innerRadius, params XbimPoint3D[] directrix)
+        {
+            var sweptDisk = m.Instances.New<IfcSweptDiskSolid>();
+            var polyline = m.Instances.New<IfcPolyline>();
+            foreach (var point in directrix)
+                polyline.Points.Add(m.Instances.New<IfcCartesianPoint>(c => c.SetXYZ(point.X, point.Y, point.Z)));
+            sweptDisk.Directrix = polyline;
+            sweptDisk.Radius = r;
+            if (innerRadius.HasValue)
+                sweptDisk.InnerRadius = innerRadius.Value;
+            return sweptDisk;
+        }
+
         public static IfcPlane MakePlane(MemoryModel m, XbimPoint3D loc, XbimVector3D zdir, XbimVector3D xdir)
         {
             var plane = m.Instances.New<IfcPlane>();
@@ -457,5 +481,34 @@ namespace Xbim.Geometry.Engine.Interop.Tests
             return grid;
         }
 
+        // a project with a 3D model context, for tests that run Xbim3DModelContext
+        public static IfcGeometricRepresentationContext MakeModelContext(MemoryModel m)
+        {
+            var context = m.Instances.New<IfcGeometricRepresentationContext>(c =>
+            {
+                c.ContextType = "Model";
+                c.CoordinateSpaceDimension = 3;
+                c.WorldCoordinateSystem = MakeAxis2Placement3D(m);
+            });
+            m.Instances.New<IfcProject>(p => p.RepresentationContexts.Add(context));
+            return context;
+        }
+
+        public static IfcBuildingElementProxy MakeProxy(MemoryModel m, IfcGeometricRepresentationContext context, IfcGeometricRepresentationItem item, string representationType)
+        {
+            return m.Instances.New<IfcBuildingElementProxy>(proxy =>
+            {
+                proxy.ObjectPlacement = MakeLocalPlacement(m);
+                proxy.Representation = m.Instances.New<IfcProductDefinitionShape>(s =>
+                    s.Representations.Add(m.Instances.New<IfcShapeRepresentation>(r =>
+                    {
+                        r.ContextOfItems = context;
+                        r.RepresentationIdentifier = "Body";
+                        r.RepresentationType = representationType;
+                        r.Items.Add(item);
+                    })));
+            });
+        }
+
     }
 }
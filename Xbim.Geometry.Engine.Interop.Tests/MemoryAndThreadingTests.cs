@@ -3,12 +3,16 @@ using System;
 using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.IO;
 using System.Linq;
 using System.Text;
+using System.Text.RegularExpressions;
 using System.Threading;
 using System.Threading.Tasks;
 using Xbim.Common.Geometry;
 using Xbim.Ifc4.Interfaces;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
 
 namespace Xbim.Geometry.Engine.Interop.Tests
 {
@@ -150,5 +154,545 @@ namespace Xbim.Geometry.Engine.Interop.Tests
             }
         }
 
+        [TestMethod]
+        public void cancelled_scope_stops_booleans()
+        {
+            using (var m = new MemoryModel(new Xbim.Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction("Populate"))
+                {
+                    var block1 = IfcModelBuilder.MakeBlock(m, 20, 20, 20);
+                    var block2 = IfcModelBuilder.MakeBlock(m, 5, 5, 5);
+                    block2.Position.Location.X += 10;
+                    block2.Position.Location.Y += 10;
+                    block2.Position.Location.Z += 10;
+                    var b1 = geomEngine.CreateSolid(block1);
+                    var b2 = geomEngine.CreateSolid(block2);
+                    using (var source = new CancellationTokenSource())
+                    {
+                        source.Cancel();
+                        using (XbimGeometryCancellation.Enter(source.Token, TimeSpan.Zero))
+                        {
+                            try
+                            {
+                                var cut = b1.Cut(b2, m.ModelFactors.PrecisionBoolean);
+                                Assert.Fail("The boolean should stop when the scope is cancelled, {0} solids returned", cut.Count);
+                            }
+                            catch (Exception e) when (!(e is AssertFailedException))
+                            {
+                            }
+                        }
+                    }
+                    //the scope is closed, the thread is no longer cancelled
+                    var result = b1.Cut(b2, m.ModelFactors.PrecisionBoolean);
+                    Assert.AreEqual(1, result.Count);
+                    txn.Commit();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void cancelled_token_stops_create_context()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+            {
+                using (var source = new CancellationTokenSource())
+                {
+                    source.Cancel();
+                    var context = new Xbim3DModelContext(model) { CancellationToken = source.Token };
+                    var sw = Stopwatch.StartNew();
+                    try
+                    {
+                        context.CreateContext();
+                        Assert.Fail("CreateContext should throw when its token is cancelled");
+                    }
+                    catch (OperationCanceledException)
+                    {
+                    }
+                    Assert.IsTrue(sw.ElapsedMilliseconds < 5000, "Cancellation took {0}ms", sw.ElapsedMilliseconds);
+                }
+                //a product time budget does not stop a model that converts within it
+                var budgeted = new Xbim3DModelContext(model) { ProductTimeBudget = TimeSpan.FromMinutes(1) };
+                Assert.IsTrue(budgeted.CreateContext());
+            }
+        }
+
+        [TestMethod]
+        public void geometry_session_releases_shapes_not_kept()
+        {
+            using (var m = new MemoryModel(new Xbim.Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction("Populate"))
+                {
+                    var block1 = IfcModelBuilder.MakeBlock(m, 20, 20, 20);
+                    var block2 = IfcModelBuilder.MakeBlock(m, 5, 5, 5);
+                    block2.Position.Location.X += 10;
+                    IXbimSolid b1, b2;
+                    IXbimSolidSet cut;
+                    XbimGeometrySession session;
+                    using (session = new XbimGeometrySession())
+                    {
+                        b1 = geomEngine.CreateSolid(block1);
+                        b2 = geomEngine.CreateSolid(block2);
+                        cut = session.Keep(b1.Cut(b2, m.ModelFactors.PrecisionBoolean));
+                        Assert.IsTrue(b1.IsValid);
+                    }
+                    Assert.IsFalse(b1.IsValid, "Shapes created in the session are released when it ends");
+                    Assert.IsFalse(b2.IsValid);
+                    Assert.IsTrue(cut.IsValid, "Kept shapes outlive the session");
+                    Assert.IsTrue(cut.First.IsValid);
+                    Assert.IsTrue(session.ReleasedObjects > 0);
+                    Assert.IsTrue(session.KeptObjects > 0);
+                    //shapes created outside a session are left to their owner
+                    var b3 = geomEngine.CreateSolid(block1);
+                    using (new XbimGeometrySession())
+                    {
+                    }
+                    Assert.IsTrue(b3.IsValid);
+                    txn.Commit();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void memory_pressure_follows_native_shape_size()
+        {
+            var engine = (XbimGeometryEngine)geomEngine;
+            var reportMemoryPressure = engine.ReportMemoryPressure;
+            try
+            {
+                using (var m = new MemoryModel(new Xbim.Ifc4.EntityFactoryIfc4()))
+                {
+                    using (var txn = m.BeginTransaction("Populate"))
+                    {
+                        var sphere = IfcModelBuilder.MakeSphere(m, 1000);
+                        engine.ReportMemoryPressure = true;
+                        var solid = geomEngine.CreateSolid(sphere, null);
+                        var unmeshed = engine.EstimateNativeBytes(solid);
+                        Assert.IsTrue(unmeshed > 0);
+                        Assert.AreEqual(unmeshed, engine.MemoryPressure(solid));
+                        //the shells are wrappers of the solid's own topology, they must not count it again
+                        Assert.AreEqual(0, engine.MemoryPressure(solid.Shells));
+                        geomEngine.CreateShapeGeometry(solid, m.ModelFactors.Precision, 2, 0.1, XbimGeometryType.PolyhedronBinary, null);
+                        Assert.IsTrue(engine.EstimateNativeBytes(solid) > unmeshed, "The triangulation is part of the estimate");
+                        Assert.AreEqual(engine.EstimateNativeBytes(solid), engine.MemoryPressure(solid));
+                        solid.Dispose();
+                        Assert.AreEqual(0, engine.MemoryPressure(solid));
+
+                        //meshed spheres are created in parallel and dropped without being disposed, only the GC releases them
+                        var peakWithout = PeakWorkingSetMeshingSpheres(engine, m, sphere, false);
+                        var peakWith = PeakWorkingSetMeshingSpheres(engine, m, sphere, true);
+                        Assert.IsTrue(peakWithout > 0 && peakWith > 0);
+                        //the GC collects sooner when it knows the native size, allow some noise in the sampled working set
+                        Assert.IsTrue(peakWith <= peakWithout + peakWithout / 10,
+                            string.Format("Peak working set without memory pressure {0:N0} MB, with memory pressure {1:N0} MB", peakWithout >> 20, peakWith >> 20));
+                        txn.Commit();
+                    }
+                }
+            }
+            finally
+            {
+                engine.ReportMemoryPressure = reportMemoryPressure;
+            }
+        }
+
+        private static long PeakWorkingSetMeshingSpheres(XbimGeometryEngine engine, MemoryModel m, IIfcSphere sphere, bool reportMemoryPressure)
+        {
+            GC.Collect();
+            GC.WaitForPendingFinalizers();
+            GC.Collect();
+            engine.ReportMemoryPressure = reportMemoryPressure;
+            long peak = 0;
+            using (var done = new ManualResetEventSlim())
+            {
+                var sampler = Task.Run(() =>
+                {
+                    using (var process = Process.GetCurrentProcess())
+                    {
+                        do
+                        {
+                            process.Refresh();
+                            peak = Math.Max(peak, process.WorkingSet64);
+                        } while (!done.Wait(10));
+                    }
+                });
+                Parallel.For(0, 200, i =>
+                {
+                    var solid = engine.CreateSolid(sphere, null);
+                    engine.CreateShapeGeometry(solid, m.ModelFactors.Precision, 2, 0.1, XbimGeometryType.PolyhedronBinary, null);
+                });
+                done.Set();
+                sampler.Wait();
+            }
+            return peak;
+        }
+
+        [TestMethod]
+        public void geometry_cache_spills_and_reloads_shapes()
+        {
+            var engine = (XbimGeometryEngine)geomEngine;
+            using (var m = new MemoryModel(new Xbim.Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction("Populate"))
+                {
+                    var block = engine.CreateSolid(IfcModelBuilder.MakeBlock(m, 10, 20, 30));
+                    var sphere = engine.CreateSolid(IfcModelBuilder.MakeSphere(m, 100), null);
+                    //a one byte budget spills everything but the shape last used
+                    using (var cache = new XbimGeometryCache(engine, 1))
+                    {
+                        Assert.IsTrue(cache.TryAdd(1, block));
+                        Assert.IsTrue(cache.TryAdd(2, sphere));
+                        Assert.IsFalse(cache.TryAdd(2, sphere));
+                        Assert.AreEqual(1, cache.Statistics.SpilledShapes);
+                        Assert.AreEqual(engine.EstimateNativeBytes(sphere), cache.ResidentBytes);
+                        Assert.IsTrue(cache.TryGetValue(1, out IXbimGeometryObject reloaded));
+                        Assert.AreEqual(1, cache.Statistics.ReloadedShapes);
+                        Assert.AreEqual(block.Volume, ((IXbimSolid)reloaded).Volume, 1e-6);
+                        Assert.IsTrue(cache.TryGetValue(2, out IXbimGeometryObject sphereReloaded));
+                        Assert.AreEqual(sphere.Volume, ((IXbimSolid)sphereReloaded).Volume, 1e-3);
+                        cache.Release(1);
+                        Assert.IsFalse(cache.ContainsKey(1));
+                        Assert.AreEqual(1, cache.Count);
+                    }
+                    txn.Commit();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void binary_brep_keeps_the_sewing_tolerance_of_compounds()
+        {
+            var engine = (XbimGeometryEngine)geomEngine;
+            using (var model = MemoryModel.OpenRead(@"TestFiles\Ifc4TestFiles\beam-straight-i-shape-tessellated.ifc"))
+            {
+                model.ModelFactors.Initialise(1, 1e-3, 1e-2);
+                var faceSet = model.Instances.OfType<IIfcTriangulatedFaceSet>().First();
+                var surface = engine.CreateSurfaceModel(faceSet, null);
+                var reloaded = engine.FromBinaryBrep(engine.ToBinaryBrep(surface));
+                //the compounds are engine types, their sewing is not on the interfaces
+                IEnumerable<object> Compounds(IXbimGeometryObject geometry) => geometry.GetType().GetProperty("SewingTolerance") != null
+                    ? new object[] { geometry }
+                    : ((IEnumerable<IXbimGeometryObject>)geometry).SelectMany(Compounds);
+                object Property(object compound, string name) => compound.GetType().GetProperty(name).GetValue(compound);
+                var written = Compounds(surface).ToList();
+                var read = Compounds(reloaded).ToList();
+                Assert.IsTrue(written.Count > 0);
+                Assert.AreEqual(written.Count, read.Count);
+                for (int i = 0; i < written.Count; i++)
+                {
+                    Assert.AreEqual(model.ModelFactors.Precision, (double)Property(written[i], "SewingTolerance"));
+                    Assert.AreEqual(Property(written[i], "SewingTolerance"), Property(read[i], "SewingTolerance"));
+                    Assert.AreEqual(Property(written[i], "IsSewn"), Property(read[i], "IsSewn"));
+                }
+            }
+        }
+
+        [TestMethod]
+        public void create_context_within_geometry_cache_budget()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+            {
+                var instances = new List<int>();
+                foreach (var budget in new long[] { 0, 64 * 1024, 1 })
+                {
+                    var context = new Xbim3DModelContext(model) { GeometryCacheBudget = budget };
+                    var sw = Stopwatch.StartNew();
+                    Assert.IsTrue(context.CreateContext());
+                    var statistics = context.GeometryCacheStatistics;
+                    using (var process = Process.GetCurrentProcess())
+                        Console.WriteLine("Budget {0:N0} bytes: {1}ms, peak resident {2:N0} bytes, {3} spilled, {4} reloaded, {5} released, peak working set {6:N0} MB",
+                            budget, sw.ElapsedMilliseconds, statistics.PeakResidentBytes, statistics.SpilledShapes, statistics.ReloadedShapes,
+                            statistics.ReleasedShapes, process.PeakWorkingSet64 >> 20);
+                    if (budget == 1)
+                        Assert.IsTrue(statistics.SpilledShapes > 0, "The wall and the opening do not both fit in one byte");
+                    Assert.IsTrue(statistics.ReleasedShapes > 0, "The operands are released once the product is cut");
+                    using (var reader = model.GeometryStore.BeginRead())
+                        instances.Add(reader.ShapeInstances.Count());
+                }
+                Assert.IsTrue(instances.All(i => i == instances[0]), "The budget does not change the geometry written");
+            }
+        }
+
+        [TestMethod]
+        public void shards_convert_every_product_once()
+        {
+            List<int> products;
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+            {
+                Assert.IsTrue(new Xbim3DModelContext(model).CreateContext());
+                using (var reader = model.GeometryStore.BeginRead())
+                    products = reader.ShapeInstances.Select(i => i.IfcProductLabel).Distinct()
+                        .Where(label => !(model.Instances[label] is IIfcFeatureElement)).ToList();
+            }
+            const int shardCount = 3;
+            var shardProducts = new List<int>();
+            for (var shard = 0; shard < shardCount; shard++)
+            {
+                using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+                {
+                    var context = new Xbim3DModelContext(model) { ShardIndex = shard, ShardCount = shardCount };
+                    Assert.IsTrue(context.CreateContext());
+                    using (var reader = model.GeometryStore.BeginRead())
+                        shardProducts.AddRange(reader.ShapeInstances.Select(i => i.IfcProductLabel).Distinct()
+                            .Where(label => !(model.Instances[label] is IIfcFeatureElement)));
+                }
+            }
+            // each element is converted by exactly one shard
+            CollectionAssert.AreEquivalent(products, shardProducts);
+        }
+
+        [TestMethod]
+        public void shard_file_round_trips_the_geometry_store()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+            {
+                var context = new Xbim3DModelContext(model) { ShardIndex = 0, ShardCount = 2 };
+                Assert.IsTrue(context.CreateContext());
+                var fileName = Path.Combine(Path.GetTempPath(), Guid.NewGuid().ToString("N") + ".xbsh");
+                try
+                {
+                    using (var reader = model.GeometryStore.BeginRead())
+                    {
+                        XbimShardFile.Write(fileName, reader, context.ShardClusters);
+                        var shard = XbimShardFile.Read(fileName);
+                        var geometries = reader.ShapeGeometries.ToList();
+                        Assert.IsTrue(geometries.Any());
+                        Assert.AreEqual(geometries.Count, shard.ShapeGeometries.Count);
+                        for (var i = 0; i < geometries.Count; i++)
+                        {
+                            var expected = geometries[i];
+                            var actual = shard.ShapeGeometries[i];
+                            Assert.AreEqual(expected.ShapeLabel, actual.ShapeLabel);
+                            Assert.AreEqual(expected.IfcShapeLabel, actual.IfcShapeLabel);
+                            Assert.AreEqual(expected.GeometryHash, actual.GeometryHash);
+                            Assert.AreEqual(expected.ReferenceCount, actual.ReferenceCount);
+                            Assert.AreEqual(expected.LOD, actual.LOD);
+                            Assert.AreEqual(expected.Format, actual.Format);
+                            Assert.AreEqual(expected.BoundingBox, actual.BoundingBox);
+                            Assert.AreEqual(expected.LocalShapeDisplacement, actual.LocalShapeDisplacement);
+                            CollectionAssert.AreEqual(expected.ShapeData, actual.ShapeData);
+                        }
+                        var instances = reader.ShapeInstances.ToList();
+                        Assert.AreEqual(instances.Count, shard.ShapeInstances.Count);
+                        for (var i = 0; i < instances.Count; i++)
+                        {
+                            var expected = instances[i];
+                            var actual = shard.ShapeInstances[i];
+                            Assert.AreEqual(expected.InstanceLabel, actual.InstanceLabel);
+                            Assert.AreEqual(expected.IfcTypeId, actual.IfcTypeId);
+                            Assert.AreEqual(expected.IfcProductLabel, actual.IfcProductLabel);
+                            Assert.AreEqual(expected.StyleLabel, actual.StyleLabel);
+                            Assert.AreEqual(expected.ShapeGeometryLabel, actual.ShapeGeometryLabel);
+                            Assert.AreEqual(expected.RepresentationType, actual.RepresentationType);
+                            Assert.AreEqual(expected.RepresentationContext, actual.RepresentationContext);
+                            Assert.AreEqual(expected.Transformation, actual.Transformation);
+                            Assert.AreEqual(expected.BoundingBox, actual.BoundingBox);
+                        }
+                        CollectionAssert.AreEquivalent(context.ShardClusters.Keys, shard.Clusters.Keys);
+                        foreach (var cluster in context.ShardClusters)
+                        {
+                            CollectionAssert.AreEqual(cluster.Value.Select(e => e.GeometryIds.First()).ToList(), shard.Clusters[cluster.Key].Select(e => e.GeometryIds.First()).ToList());
+                            CollectionAssert.AreEqual(cluster.Value.Select(e => e.Bound).ToList(), shard.Clusters[cluster.Key].Select(e => e.Bound).ToList());
+                        }
+                    }
+                }
+                finally
+                {
+                    File.Delete(fileName);
+                }
+            }
+        }
+
+        [TestMethod]
+        public void shard_merge_keeps_the_first_copy_of_shared_geometry()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+            {
+                var item = model.Instances.OfType<IIfcRepresentationItem>().First().EntityLabel;
+                var products = model.Instances.OfType<IIfcProduct>().Take(3).Select(p => p.EntityLabel).ToList();
+                int element1 = products[0], element2 = products[1], opening = products[2];
+                // both shards map the same representation item, and both convert the opening of elements in each of them
+                var shard0 = new XbimShardFile();
+                shard0.ShapeGeometries.Add(new XbimShapeGeometry { ShapeLabel = 1, IfcShapeLabel = item, ShapeData = new byte[] { 1 } });
+                shard0.ShapeGeometries.Add(new XbimShapeGeometry { ShapeLabel = 2, IfcShapeLabel = opening, ShapeData = new byte[] { 2 } });
+                shard0.ShapeInstances.Add(new XbimShapeInstance { IfcProductLabel = element1, ShapeGeometryLabel = 1 });
+                shard0.ShapeInstances.Add(new XbimShapeInstance { IfcProductLabel = opening, ShapeGeometryLabel = 2 });
+                var shard1 = new XbimShardFile();
+                shard1.ShapeGeometries.Add(new XbimShapeGeometry { ShapeLabel = 1, IfcShapeLabel = opening, ShapeData = new byte[] { 3 } });
+                shard1.ShapeGeometries.Add(new XbimShapeGeometry { ShapeLabel = 2, IfcShapeLabel = item, ShapeData = new byte[] { 4 } });
+                shard1.ShapeInstances.Add(new XbimShapeInstance { IfcProductLabel = opening, ShapeGeometryLabel = 1 });
+                shard1.ShapeInstances.Add(new XbimShapeInstance { IfcProductLabel = element2, ShapeGeometryLabel = 2 });
+
+                using (var txn = model.GeometryStore.BeginInit())
+                {
+                    var merger = new XbimShardMerger(model, txn);
+                    merger.Merge(shard0);
+                    merger.Merge(shard1);
+                    txn.Commit();
+                }
+                using (var reader = model.GeometryStore.BeginRead())
+                {
+                    var geometries = reader.ShapeGeometries.ToList();
+                    var instances = reader.ShapeInstances.ToList();
+                    CollectionAssert.AreEquivalent(new byte[] { 1, 2 }, geometries.Select(g => g.ShapeData[0]).ToList(), "the copies of the second shard are dropped");
+                    Assert.AreEqual(3, instances.Count);
+                    var itemShape = geometries.Single(g => g.IfcShapeLabel == item).ShapeLabel;
+                    Assert.AreEqual(itemShape, instances.Single(i => i.IfcProductLabel == element1).ShapeGeometryLabel);
+                    Assert.AreEqual(itemShape, instances.Single(i => i.IfcProductLabel == element2).ShapeGeometryLabel, "remapped to the shape of the first shard");
+                    Assert.AreEqual(geometries.Single(g => g.IfcShapeLabel == opening).ShapeLabel, instances.Single(i => i.IfcProductLabel == opening).ShapeGeometryLabel);
+                    Assert.IsTrue(geometries.All(g => instances.Any(i => i.ShapeGeometryLabel == g.ShapeLabel)), "no geometry is left without an instance");
+                }
+            }
+        }
+
+        [TestMethod]
+        public void failed_shard_is_retried()
+        {
+            const string file = @"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc";
+            List<int> products;
+            using (var model = MemoryModel.OpenRead(file))
+            {
+                Assert.IsTrue(new Xbim3DModelContext(model).CreateContext());
+                products = ShapeProducts(model);
+            }
+            foreach (var retries in new[] { 1, 0 })
+            {
+                var attempts = new ConcurrentDictionary<string, int>();
+                using (var model = MemoryModel.OpenRead(file))
+                {
+                    var context = new Xbim3DModelContext(model)
+                    {
+                        ShardWorkers = 3,
+                        ShardRetries = retries,
+                        ShardWorkerPath = typeof(MemoryAndThreadingTests).Assembly.Location,
+                        ShardSourceFile = Path.GetFullPath(file),
+                        // the workers run in this process, the first run of shard 1 fails
+                        ShardProcess = (IList<string> arguments, out string errors) =>
+                        {
+                            var shard = arguments[arguments.IndexOf("-shard") + 1];
+                            errors = "";
+                            if (attempts.AddOrUpdate(shard, 1, (s, n) => n + 1) == 1 && shard == "1")
+                            {
+                                errors = "Simulated failure";
+                                return XbimShardWorker.Failed;
+                            }
+                            return XbimShardWorker.Run(arguments.ToArray());
+                        }
+                    };
+                    Assert.IsTrue(context.CreateContext());
+                    if (retries > 0)
+                    {
+                        Assert.AreEqual(2, attempts["1"]);
+                        Assert.AreEqual(0, context.FailedShards.Count);
+                        CollectionAssert.AreEquivalent(products, ShapeProducts(model));
+                    }
+                    else
+                    {
+                        Assert.AreEqual(1, attempts["1"]);
+                        CollectionAssert.AreEqual(new[] { 1 }, context.FailedShards.ToList());
+                        CollectionAssert.AreEquivalent(products.Where(p => p % 3 != 1).ToList(), ShapeProducts(model));
+                    }
+                }
+            }
+        }
+
+        [TestMethod]
+        public void shards_are_not_run_on_an_xbim_database()
+        {
+            var database = Path.Combine(Path.GetTempPath(), Guid.NewGuid().ToString("N") + ".xbim");
+            File.WriteAllBytes(database, new byte[0]);
+            try
+            {
+                using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+                {
+                    var workers = 0;
+                    var context = new Xbim3DModelContext(model)
+                    {
+                        ShardWorkers = 2,
+                        ShardWorkerPath = typeof(MemoryAndThreadingTests).Assembly.Location,
+                        ShardSourceFile = database,
+                        ShardProcess = (IList<string> arguments, out string errors) => { Interlocked.Increment(ref workers); errors = ""; return XbimShardWorker.Failed; }
+                    };
+                    Assert.IsTrue(context.CreateContext());
+                    Assert.AreEqual(0, workers, "the context is created in this process");
+                    Assert.IsTrue(ShapeProducts(model).Any());
+                }
+            }
+            finally
+            {
+                File.Delete(database);
+            }
+        }
+
+        //the elements with geometry, openings and projections are converted by the shards of the elements they cut
+        private static List<int> ShapeProducts(MemoryModel model)
+        {
+            using (var reader = model.GeometryStore.BeginRead())
+                return reader.ShapeInstances.Select(i => i.IfcProductLabel).Distinct()
+                    .Where(label => !(model.Instances[label] is IIfcFeatureElement)).ToList();
+        }
+
+        [TestMethod]
+        public void centre_line_profiles_offset_on_parallel_threads()
+        {
+            using (var m = new MemoryModel(new Xbim.Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction("Populate"))
+                {
+                    const int count = 400;
+                    var solids = Enumerable.Range(0, count).Select(i =>
+                        IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeCenterLineProfileDef(m, IfcModelBuilder.MakeSemiCircle(m, 20 + i % 40), 1 + i % 5), 100))
+                        .ToList();
+                    var serial = new double[count];
+                    var sw = Stopwatch.StartNew();
+                    for (var i = 0; i < count; i++)
+                        serial[i] = ((IXbimSolid)geomEngine.Create(solids[i])).Volume;
+                    var serialMs = sw.ElapsedMilliseconds;
+                    var parallel = new double[count];
+                    var traceFile = Path.Combine(Path.GetTempPath(), Guid.NewGuid() + ".trace.json");
+                    try
+                    {
+                        sw.Restart();
+                        XbimGeometryTrace.Start();
+                        try
+                        {
+                            Parallel.For(0, count, i => parallel[i] = ((IXbimSolid)geomEngine.Create(solids[i])).Volume);
+                        }
+                        finally
+                        {
+                            XbimGeometryTrace.Stop();
+                        }
+                        var parallelMs = sw.ElapsedMilliseconds;
+                        Console.WriteLine("{0} centre line profiles: {1}ms on one thread, {2}ms on {3} threads", count, serialMs, parallelMs, Environment.ProcessorCount);
+                        for (var i = 0; i < count; i++)
+                        {
+                            Assert.IsTrue(serial[i] > 0, "Profile {0} has no volume", i);
+                            Assert.AreEqual(serial[i], parallel[i], serial[i] * 1e-9, "Profile {0} differs when offset in parallel", i);
+                        }
+                        Assert.IsTrue(XbimGeometryTrace.Write(traceFile));
+                        Func<Group, double> micros = g => double.Parse(g.Value, System.Globalization.CultureInfo.InvariantCulture);
+                        var offsets = Regex.Matches(File.ReadAllText(traceFile),
+                            "\"name\":\"MakeOffset\",\"ph\":\"X\",\"pid\":\\d+,\"tid\":(\\d+),\"ts\":([\\d.]+),\"dur\":([\\d.]+)")
+                            .Cast<Match>()
+                            .Select(o => new { Thread = o.Groups[1].Value, Begin = micros(o.Groups[2]), End = micros(o.Groups[2]) + micros(o.Groups[3]) })
+                            .ToList();
+                        Assert.IsTrue(offsets.Count >= count, "Every offset is traced");
+                        if (Environment.ProcessorCount < 2)
+                            Assert.Inconclusive("One processor, the offsets cannot overlap");
+                        //the offsets are not serialised, some run on two threads at the same time
+                        var overlapping = offsets.Count(a => offsets.Any(b => b.Thread != a.Thread && b.Begin < a.End && a.Begin < b.End));
+                        Console.WriteLine("{0} of {1} offsets overlap one on another thread", overlapping, count);
+                        Assert.IsTrue(overlapping > 0, "The offsets ran one at a time");
+                    }
+                    finally
+                    {
+                        XbimGeometryTrace.Clear();
+                        if (File.Exists(traceFile)) File.Delete(traceFile);
+                    }
+                    txn.Commit();
+                }
+            }
+        }
+
     }
 }
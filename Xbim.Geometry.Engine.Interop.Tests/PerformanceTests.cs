@@ -0,0 +1,1321 @@
+﻿using FluentAssertions;
+using Microsoft.Extensions.Logging;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.Interfaces;
+using Xbim.Ifc4.ProfileResource;
+using Xbim.IO.Memory;
+using Xbim.ModelGeometry.Scene;
+
+namespace Xbim.Geometry.Engine.Interop.Tests
+{
+    [TestClass]
+    public class PerformanceTests
+    {
+        static private XbimGeometryEngine geomEngine;
+        static private ILoggerFactory loggerFactory;
+        static private ILogger logger;
+
+        [ClassInitialize]
+        static public void Initialise(TestContext context)
+        {
+            loggerFactory = new LoggerFactory().AddConsole(LogLevel.Trace);
+            geomEngine = new XbimGeometryEngine();
+            logger = loggerFactory.CreateLogger<PerformanceTests>();
+        }
+        [ClassCleanup]
+        static public void Cleanup()
+        {
+            loggerFactory = null;
+            geomEngine = null;
+            logger = null;
+        }
+
+        [TestMethod]
+        [TestCategory("Performance")]
+        public void Mesh_kernel_benchmark()
+        {
+            var times = geomEngine.BenchmarkMeshKernel(100000, 20);
+            times.Should().HaveCount(3);
+            times[0].Should().BePositive("the scalar loop always runs");
+            Console.WriteLine($"Active kernel {geomEngine.MeshKernelInstructionSet}");
+            Console.WriteLine($"Scalar {times[0]:F2}ms, SSE2 {times[1]:F2}ms, AVX2 {times[2]:F2}ms");
+        }
+
+        [DataTestMethod]
+        [DataRow(false, false, DisplayName = "Open polyline")]
+        [DataRow(true, false, DisplayName = "Closed polyline")]
+        [DataRow(false, true, DisplayName = "Polyline broken by a gap")]
+        public void Wire_edges_chained_through_the_grid_match_the_linear_scan(bool closed, bool broken)
+        {
+            const double tolerance = 1e-3;
+            var points = PolylineEdges(2000, closed, broken, tolerance, new Random(42));
+            var grid = geomEngine.SortEdgesForWire(points, tolerance, false);
+            var linear = geomEngine.SortEdgesForWire(points, tolerance, true);
+            grid.Should().Equal(linear, "the grid only skips edges too far away to be chained");
+            grid[0].Should().Be(broken ? 0 : 1);
+            grid[1].Should().Be(closed ? 1 : 0);
+            grid[2].Should().BePositive().And.BeLessThan(tolerance);
+            if (broken) grid[3].Should().BeInRange(1, 1999);
+            else grid[3].Should().Be(2000);
+        }
+
+        [TestMethod]
+        [TestCategory("Performance")]
+        public void Wire_edge_chaining_benchmark()
+        {
+            const double tolerance = 1e-3;
+            foreach (var count in new[] { 10000, 30000, 100000 })
+            {
+                var points = PolylineEdges(count, true, false, tolerance, new Random(count));
+                var sw = Stopwatch.StartNew();
+                var grid = geomEngine.SortEdgesForWire(points, tolerance, false);
+                var gridMs = sw.ElapsedMilliseconds;
+                grid[3].Should().Be(count);
+                //the linear scan is quadratic, 100k edges take minutes
+                if (count > 10000)
+                {
+                    Console.WriteLine($"{count} edges: grid {gridMs}ms");
+                    continue;
+                }
+                sw.Restart();
+                var linear = geomEngine.SortEdgesForWire(points, tolerance, true);
+                Console.WriteLine($"{count} edges: grid {gridMs}ms, linear {sw.ElapsedMilliseconds}ms");
+                grid.Should().Equal(linear);
+            }
+        }
+
+        /// <summary>
+        /// The edges of a polyline around a circle with segments about 1 long, shuffled, each reversed at random and its ends moved up to an eighth of the tolerance along each axis
+        /// An open polyline covers three quarters of the circle, in a broken one the edges after the first third are moved ten times the tolerance
+        /// </summary>
+        private static double[] PolylineEdges(int count, bool closed, bool broken, double tolerance, Random random)
+        {
+            var radius = count / (2 * Math.PI);
+            var sweep = closed ? 2 * Math.PI : 1.5 * Math.PI;
+            var vertices = new double[count + 1][];
+            for (int i = 0; i <= count; i++)
+            {
+                var angle = sweep * (closed ? i % count : i) / count;
+                vertices[i] = new[] { radius * Math.Cos(angle), radius * Math.Sin(angle), 0 };
+            }
+            var edges = Enumerable.Range(0, count).OrderBy(i => random.Next()).ToArray();
+            var points = new double[6 * count];
+            for (int e = 0; e < count; e++)
+            {
+                var reversed = random.Next(2) == 1;
+                var start = vertices[reversed ? edges[e] + 1 : edges[e]];
+                var end = vertices[reversed ? edges[e] : edges[e] + 1];
+                var offset = broken && edges[e] >= count / 3 ? 10 * tolerance : 0;
+                for (int c = 0; c < 3; c++)
+                {
+                    points[6 * e + c] = start[c] + (random.NextDouble() - 0.5) * tolerance / 4;
+                    points[6 * e + 3 + c] = end[c] + (random.NextDouble() - 0.5) * tolerance / 4;
+                }
+                points[6 * e] += offset;
+                points[6 * e + 3] += offset;
+            }
+            return points;
+        }
+
+        [DataTestMethod]
+        [TestCategory("Performance")]
+        [DataRow("Rectangle", DisplayName = "All faces polygonal")]
+        [DataRow("FilletedIShape", DisplayName = "Polygonal and curved faces")]
+        [DataRow("HollowCircle", DisplayName = "All faces curved")]
+        public void Mixed_planar_and_curved_faces_are_triangulated(string profileName)
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    IfcProfileDef profile;
+                    switch (profileName)
+                    {
+                        case "FilletedIShape":
+                            profile = IfcModelBuilder.MakeIShapeProfileDef(m, 300, 150, 12, 8, 15);
+                            break;
+                        case "HollowCircle":
+                            profile = IfcModelBuilder.MakeCircleHollowProfileDef(m, 150, 10);
+                            break;
+                        default:
+                            profile = IfcModelBuilder.MakeRectangleProfileDef(m, 300, 150);
+                            break;
+                    }
+                    var extrude = IfcModelBuilder.MakeExtrudedAreaSolid(m, profile, 3000);
+                    var solid = geomEngine.CreateSolid(extrude, logger);
+                    const int runs = 50;
+                    XbimShapeGeometry shapeGeom = null;
+                    var sw = Stopwatch.StartNew();
+                    for (int i = 0; i < runs; i++)
+                        shapeGeom = geomEngine.CreateShapeGeometry(solid, m.ModelFactors.Precision, m.ModelFactors.DeflectionTolerance,
+                            m.ModelFactors.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                    sw.Stop();
+                    using (var ms = new MemoryStream(((IXbimShapeGeometryData)shapeGeom).ShapeData))
+                    using (var br = new BinaryReader(ms))
+                    {
+                        var triangulation = br.ReadShapeTriangulation();
+                        triangulation.Faces.Count().Should().Be(solid.Faces.Count, "every face is triangulated by one of the two paths");
+                        triangulation.Faces.Sum(f => f.TriangleCount).Should().BePositive();
+                        Console.WriteLine($"{profileName}: {solid.Faces.Count} faces, {triangulation.Vertices.Count()} vertices, {(double)sw.ElapsedMilliseconds / runs:F2}ms per triangulation");
+                    }
+                    txn.Commit();
+                }
+            }
+        }
+
+        [DataTestMethod]
+        [DataRow("FilletedIShape")]
+        [DataRow("FilletedLShape")]
+        [DataRow("RevolvedRectangle")]
+        public void Mixed_planar_and_curved_faces_mesh_watertight(string shapeName)
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    // planar polygons share straight edges with curved faces, the fillets of the profiles or the inside and outside of the turn
+                    IIfcSweptAreaSolid item;
+                    switch (shapeName)
+                    {
+                        case "FilletedIShape":
+                            item = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeIShapeProfileDef(m, 300, 150, 12, 8, 15), 3000);
+                            break;
+                        case "FilletedLShape":
+                            item = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeLShapeProfileDef(m, 200, 150, 15, 12, 6), 3000);
+                            break;
+                        default:
+                            var profile = IfcModelBuilder.MakeRectangleProfileDef(m, 100, 100);
+                            profile.Position.Location.SetXY(0, 500);
+                            item = m.Instances.New<Ifc4.GeometricModelResource.IfcRevolvedAreaSolid>(r =>
+                            {
+                                r.SweptArea = profile;
+                                r.Axis = IfcModelBuilder.MakeAxis1Placement(m);
+                                r.Angle = Math.PI / 2 / m.ModelFactors.AngleToRadiansConversionFactor;
+                                r.Position = IfcModelBuilder.MakeAxis2Placement3D(m);
+                            });
+                            break;
+                    }
+                    txn.Commit();
+                    var useNative = geomEngine.UseNativePolygonTriangulator;
+                    try
+                    {
+                        foreach (var native in new[] { true, false })
+                        {
+                            geomEngine.UseNativePolygonTriangulator = native;
+                            // a fine deflection puts more nodes on the edges of the curved faces
+                            foreach (var deflection in new[] { m.ModelFactors.DeflectionTolerance, m.ModelFactors.DeflectionTolerance / 20 })
+                            {
+                                var solid = item is IIfcExtrudedAreaSolid extrusion ? geomEngine.CreateSolid(extrusion, logger) : geomEngine.CreateSolid((IIfcRevolvedAreaSolid)item, logger);
+                                solid.IsValid.Should().BeTrue();
+                                var shapeGeom = geomEngine.CreateShapeGeometry(solid, m.ModelFactors.Precision, deflection, m.ModelFactors.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                                ReadMesh(shapeGeom, out int triangles, out double volume).Should().BeTrue($"every edge is shared by two triangles of opposite winding, deflection {deflection}, native {native}");
+                                volume.Should().BeApproximately(solid.Volume, solid.Volume * 0.02);
+                            }
+                        }
+                    }
+                    finally
+                    {
+                        geomEngine.UseNativePolygonTriangulator = useNative;
+                    }
+                }
+            }
+        }
+
+        [DataTestMethod]
+        [DataRow(@"TestFiles\Primitives\composite_curve.ifc")]
+        [DataRow(@"TestFiles\Primitives\faulty_closed_shell.ifc")]
+        [DataRow(@"TestFiles\Primitives\ifc_faceted_brep.ifc")]
+        [DataRow(@"TestFiles\Primitives\polygonally_bounded_half_space.ifc")]
+        [DataRow(@"TestFiles\Primitives\poor_face_planar_fidelity.ifc")]
+        [DataRow(@"TestFiles\Regression\FailingGeom.ifc")]
+        public void Native_polygon_triangulator_matches_tessellator(string fileName)
+        {
+            using (var model = MemoryModel.OpenRead(fileName))
+            {
+                var geometries = model.Instances.OfType<IIfcShapeRepresentation>()
+                    .SelectMany(r => r.Items).OfType<IIfcGeometricRepresentationItem>()
+                    .Select(item => geomEngine.Create(item, logger))
+                    .Where(g => g != null && g.IsValid)
+                    .ToList();
+                var useNative = geomEngine.UseNativePolygonTriangulator;
+                try
+                {
+                    geomEngine.UseNativePolygonTriangulator = false;
+                    var tess = Triangulate(model, geometries);
+                    geomEngine.UseNativePolygonTriangulator = true;
+                    var native = Triangulate(model, geometries);
+                    Console.WriteLine($"{fileName}: Tess {tess.Triangles} triangles in {tess.Milliseconds}ms, native {native.Triangles} triangles in {native.Milliseconds}ms");
+                    native.Area.Should().BeApproximately(tess.Area, Math.Max(1e-6, tess.Area * 1e-4), "both triangulations cover the same faces");
+                }
+                finally
+                {
+                    geomEngine.UseNativePolygonTriangulator = useNative;
+                }
+            }
+        }
+
+        private (int Triangles, double Area, long Milliseconds) Triangulate(MemoryModel model, System.Collections.Generic.List<IXbimGeometryObject> geometries)
+        {
+            int triangles = 0;
+            double area = 0;
+            var sw = Stopwatch.StartNew();
+            foreach (var geometry in geometries)
+            {
+                var shapeGeom = geomEngine.CreateShapeGeometry(geometry, model.ModelFactors.Precision, model.ModelFactors.DeflectionTolerance,
+                    model.ModelFactors.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                using (var ms = new MemoryStream(((IXbimShapeGeometryData)shapeGeom).ShapeData))
+                using (var br = new BinaryReader(ms))
+                {
+                    var triangulation = br.ReadShapeTriangulation();
+                    var vertices = triangulation.Vertices.ToList();
+                    foreach (var face in triangulation.Faces)
+                    {
+                        triangles += face.TriangleCount;
+                        for (int i = 0; i + 2 < face.Indices.Count; i += 3)
+                        {
+                            var a = vertices[face.Indices[i]];
+                            var b = vertices[face.Indices[i + 1]];
+                            var c = vertices[face.Indices[i + 2]];
+                            area += XbimVector3D.CrossProduct(b - a, c - a).Length / 2;
+                        }
+                    }
+                }
+            }
+            sw.Stop();
+            return (triangles, area, sw.ElapsedMilliseconds);
+        }
+
+        [TestMethod]
+        public void Mesh_kernel_writes_unit_normals_for_curved_faces()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\SweptDiskSolid_1.ifc"))
+            {
+                var sweptDisk = model.Instances.OfType<IIfcSweptDiskSolid>().FirstOrDefault();
+                sweptDisk.Should().NotBeNull();
+                var solid = geomEngine.CreateSolid(sweptDisk, logger);
+                var shapeGeom = geomEngine.CreateShapeGeometry(solid, model.ModelFactors.Precision, model.ModelFactors.DeflectionTolerance,
+                    model.ModelFactors.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                using (var ms = new MemoryStream(((IXbimShapeGeometryData)shapeGeom).ShapeData))
+                using (var br = new BinaryReader(ms))
+                {
+                    var triangulation = br.ReadShapeTriangulation();
+                    triangulation.Vertices.Should().NotBeEmpty();
+                    var bounds = solid.BoundingBox;
+                    var tolerance = model.ModelFactors.DeflectionTolerance;
+                    triangulation.Vertices.All(v =>
+                        v.X >= bounds.X - tolerance && v.X <= bounds.X + bounds.SizeX + tolerance &&
+                        v.Y >= bounds.Y - tolerance && v.Y <= bounds.Y + bounds.SizeY + tolerance &&
+                        v.Z >= bounds.Z - tolerance && v.Z <= bounds.Z + bounds.SizeZ + tolerance)
+                        .Should().BeTrue("the vertices are transformed into the location of the solid");
+                    foreach (var face in triangulation.Faces)
+                        foreach (var normal in face.Normals)
+                            normal.Normal.Length.Should().BeApproximately(1, 1e-2);
+                }
+            }
+        }
+
+        [DataTestMethod]
+        [DataRow("Sphere")]
+        [DataRow("Cylinder")]
+        [DataRow("Cone")]
+        [DataRow("SweptDisk")]
+        [DataRow("HollowSweptDisk")]
+        public void Primitive_tessellator_meshes_are_closed(string primitive)
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    IIfcGeometricRepresentationItem item;
+                    var bar = new[] { new XbimPoint3D(0, 0, 0), new XbimPoint3D(0, 0, 500), new XbimPoint3D(400, 0, 500), new XbimPoint3D(400, 300, 900) };
+                    switch (primitive)
+                    {
+                        case "Sphere":
+                            item = IfcModelBuilder.MakeSphere(m, 100);
+                            break;
+                        case "Cylinder":
+                            item = IfcModelBuilder.MakeRightCircularCylinder(m, 100, 500);
+                            break;
+                        case "Cone":
+                            item = IfcModelBuilder.MakeRightCircularCone(m, 100, 500);
+                            break;
+                        case "HollowSweptDisk":
+                            item = IfcModelBuilder.MakeSweptDiskSolid(m, 20, 15, bar);
+                            break;
+                        default:
+                            item = IfcModelBuilder.MakeSweptDiskSolid(m, 20, null, bar);
+                            break;
+                    }
+                    var tessellator = new XbimPrimitiveTessellator(m, XbimGeometryType.PolyhedronBinary);
+                    tessellator.CanMesh(item).Should().BeTrue();
+                    var shapeGeom = tessellator.Mesh(item, m.ModelFactors.DeflectionTolerance, m.ModelFactors.DeflectionAngle);
+                    shapeGeom.Should().NotBeNull();
+                    var mesh = ReadMesh(shapeGeom, out int triangles, out double volume);
+                    mesh.Should().BeTrue("every edge is shared by two triangles of opposite winding");
+                    var solid = geomEngine.Create(item, logger) as IXbimSolid;
+                    solid.Should().NotBeNull();
+                    // the polygonal sections lie inside the circles so the volume is a little smaller
+                    volume.Should().BeLessOrEqualTo(solid.Volume * 1.001);
+                    volume.Should().BeGreaterThan(solid.Volume * 0.85);
+                    Console.WriteLine($"{primitive}: {triangles} triangles, volume {volume:F0}, solid volume {solid.Volume:F0}");
+                    txn.Commit();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void Primitive_tessellator_skips_degenerate_primitives()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var tessellator = new XbimPrimitiveTessellator(m, XbimGeometryType.PolyhedronBinary);
+                    var degenerate = new IIfcGeometricRepresentationItem[]
+                    {
+                        IfcModelBuilder.MakeSphere(m, 0),
+                        IfcModelBuilder.MakeSphere(m, -10),
+                        IfcModelBuilder.MakeRightCircularCylinder(m, 0, 500),
+                        IfcModelBuilder.MakeRightCircularCylinder(m, 100, 0),
+                        IfcModelBuilder.MakeRightCircularCone(m, 0, 500),
+                        IfcModelBuilder.MakeSweptDiskSolid(m, 0, null, new XbimPoint3D(0, 0, 0), new XbimPoint3D(0, 0, 500)),
+                        IfcModelBuilder.MakeSweptDiskSolid(m, 20, null, new XbimPoint3D(0, 0, 0), new XbimPoint3D(0, 0, 0))
+                    };
+                    // left to the geometry engine rather than meshed into points of NaN or an empty shape
+                    foreach (var item in degenerate)
+                        tessellator.Mesh(item, m.ModelFactors.DeflectionTolerance, m.ModelFactors.DeflectionAngle).Should().BeNull(item.ToString());
+                    txn.Commit();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void Directly_meshed_shapes_have_hulls_and_telemetry()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                IIfcGeometricRepresentationItem sphere, cone;
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var context = IfcModelBuilder.MakeModelContext(m);
+                    sphere = IfcModelBuilder.MakeSphere(m, 100);
+                    cone = IfcModelBuilder.MakeRightCircularCone(m, 100, 500);
+                    IfcModelBuilder.MakeProxy(m, context, sphere, "CSG");
+                    IfcModelBuilder.MakeProxy(m, context, cone, "CSG");
+                    txn.Commit();
+                }
+                var telemetry = new XbimGeometryTelemetry();
+                var modelContext = new Xbim3DModelContext(m) { Telemetry = telemetry, CreateHullProxies = true };
+                modelContext.MeshPrimitivesDirectly.Should().BeFalse("meshing primitives directly is opt in");
+                modelContext.MeshLoftsDirectly.Should().BeFalse("meshing lofts directly is opt in");
+                modelContext.MeshPrimitivesDirectly = true;
+                modelContext.CreateContext().Should().BeTrue();
+                foreach (var item in new[] { sphere, cone })
+                {
+                    modelContext.HullProxies.Should().ContainKey(item.EntityLabel);
+                    var hull = modelContext.HullProxies[item.EntityLabel];
+                    ReadMesh(hull, out int hullTriangles, out double hullVolume).Should().BeTrue("the hull is closed");
+                    hullVolume.Should().BePositive();
+                    var record = telemetry.Records.Single(r => r.EntityLabel == item.EntityLabel);
+                    record.Triangles.Should().BePositive();
+                    record.Outcome.Should().Be(XbimGeometryOutcome.Success);
+                }
+                // the hull of the sphere holds the polygons of its mesh, so it is no larger than the sphere
+                var sphereHull = modelContext.HullProxies[sphere.EntityLabel].BoundingBox;
+                sphereHull.SizeX.Should().BeLessOrEqualTo(200.001);
+            }
+        }
+
+        [TestMethod]
+        [TestCategory("Performance")]
+        public void Primitive_tessellator_rebar_throughput()
+        {
+            const int rebarCount = 100000;
+            const int engineSample = 1000;
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    // stirrups and hooked bars along a grid, a new directrix for every bar as in exported reinforcement models
+                    var bars = new List<IIfcSweptDiskSolid>(rebarCount);
+                    for (int i = 0; i < rebarCount; i++)
+                    {
+                        var x = (i % 100) * 200.0;
+                        var y = (i / 100) * 150.0;
+                        bars.Add(i % 2 == 0
+                            ? IfcModelBuilder.MakeSweptDiskSolid(m, 6, null, new XbimPoint3D(x, y, 0), new XbimPoint3D(x + 300, y, 0),
+                                new XbimPoint3D(x + 300, y, 500), new XbimPoint3D(x, y, 500), new XbimPoint3D(x, y, 40))
+                            : IfcModelBuilder.MakeSweptDiskSolid(m, 10, null, new XbimPoint3D(x, y, 100), new XbimPoint3D(x, y, 6000),
+                                new XbimPoint3D(x + 120, y, 6000)));
+                    }
+                    var tessellator = new XbimPrimitiveTessellator(m, XbimGeometryType.PolyhedronBinary);
+                    long triangles = 0;
+                    var sw = Stopwatch.StartNew();
+                    foreach (var bar in bars)
+                    {
+                        var shapeGeom = tessellator.Mesh(bar, m.ModelFactors.DeflectionTolerance, m.ModelFactors.DeflectionAngle);
+                        triangles += BitConverter.ToInt32(((IXbimShapeGeometryData)shapeGeom).ShapeData, 5);
+                    }
+                    sw.Stop();
+                    var directMs = sw.ElapsedMilliseconds;
+
+                    sw.Restart();
+                    foreach (var bar in bars.Take(engineSample))
+                    {
+                        var solid = geomEngine.CreateSolid(bar, logger);
+                        geomEngine.CreateShapeGeometry(solid, m.ModelFactors.Precision, m.ModelFactors.DeflectionTolerance,
+                            m.ModelFactors.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                    }
+                    sw.Stop();
+                    var engineMs = sw.ElapsedMilliseconds * (double)rebarCount / engineSample;
+                    triangles.Should().BePositive();
+                    Console.WriteLine($"{rebarCount} rebars: direct {directMs}ms ({rebarCount * 1000.0 / Math.Max(1, directMs):F0} bars/s, {triangles} triangles), " +
+                        $"B-rep and BRepMesh {engineMs:F0}ms estimated from {engineSample} bars");
+                    txn.Commit();
+                }
+            }
+        }
+
+        [TestMethod]
+        public void Telemetry_records_items_and_booleans()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+            {
+                var telemetry = new XbimGeometryTelemetry();
+                var context = new Xbim3DModelContext(model) { Telemetry = telemetry };
+                context.CreateContext();
+                telemetry.Count.Should().BePositive();
+                var wall = model.Instances.OfType<IIfcRelVoidsElement>().First().RelatingBuildingElement;
+                var wallRecord = telemetry.Records.FirstOrDefault(r => r.EntityLabel == wall.EntityLabel);
+                wallRecord.Should().NotBeNull("the opening is cut from the wall");
+                wallRecord.BooleanMs.Should().BePositive();
+                wallRecord.Triangles.Should().BePositive();
+                telemetry.Records.Where(r => r.EntityLabel != wall.EntityLabel).Should().OnlyContain(r => r.CreateMs + r.MeshMs > 0);
+                telemetry.Slowest(1).Single().TotalMs.Should().Be(telemetry.Records.Max(r => r.TotalMs));
+
+                var csv = new StringWriter();
+                telemetry.WriteCsv(csv);
+                csv.ToString().Split(new[] { Environment.NewLine }, StringSplitOptions.RemoveEmptyEntries).Should().HaveCount(telemetry.Count + 1);
+                var json = new StringWriter();
+                telemetry.WriteJson(json);
+                json.ToString().Should().Contain($"\"entityLabel\":{wall.EntityLabel},");
+                Console.WriteLine(csv);
+            }
+        }
+
+        [TestMethod]
+        public void Boolean_schedulers_write_the_same_geometry()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+            {
+                var instances = new Dictionary<XbimBooleanScheduling, int>();
+                var telemetry = new XbimGeometryTelemetry();
+                foreach (var scheduling in new[] { XbimBooleanScheduling.OperandCount, XbimBooleanScheduling.CostModel })
+                {
+                    var context = new Xbim3DModelContext(model) { BooleanScheduling = scheduling, Telemetry = telemetry };
+                    context.CreateContext().Should().BeTrue();
+                    var statistics = context.BooleanScheduleStatistics;
+                    statistics.Scheduling.Should().Be(scheduling);
+                    statistics.Products.Should().BePositive();
+                    statistics.EstimatedTotalMs.Should().BePositive();
+                    statistics.MakespanMs.Should().BeGreaterOrEqualTo(statistics.LongestProductMs);
+                    Console.WriteLine("{0}: {1} products on {2} workers, makespan {3:F1}ms, ideal {4:F1}ms, estimated {5:F1}ms, {6} split",
+                        scheduling, statistics.Products, statistics.Workers, statistics.MakespanMs, statistics.IdealMakespanMs,
+                        statistics.EstimatedMakespanMs, statistics.SplitProducts);
+                    using (var reader = model.GeometryStore.BeginRead())
+                        instances[scheduling] = reader.ShapeInstances.Count();
+                }
+                instances[XbimBooleanScheduling.CostModel].Should().Be(instances[XbimBooleanScheduling.OperandCount]);
+
+                //the times recorded by a previous run replace the estimates
+                var wall = model.Instances.OfType<IIfcRelVoidsElement>().First().RelatingBuildingElement;
+                var costModel = new XbimBooleanCostModel { History = telemetry };
+                var recorded = telemetry.Records.Single(r => r.EntityLabel == wall.EntityLabel).BooleanMs;
+                costModel.Estimate(new XbimBooleanCostFactors { ProductLabel = wall.EntityLabel, ProductFaces = 1000 }).Should().Be(recorded);
+                costModel.Estimate(new XbimBooleanCostFactors { ProductFaces = 6, OverlappingTools = 1, ToolFaces = 6, ToolCurvedFaces = 1 })
+                    .Should().BeGreaterThan(costModel.Estimate(new XbimBooleanCostFactors { ProductFaces = 6, OverlappingTools = 1, ToolFaces = 7 }),
+                    "curved faces cost more than planar ones");
+            }
+        }
+
+        [TestMethod]
+        public void Trace_records_native_and_managed_spans()
+        {
+            var traceFile = Path.Combine(Path.GetTempPath(), Guid.NewGuid() + ".trace.json");
+            try
+            {
+                using (var model = MemoryModel.OpenRead(@"TestFiles\CuttingOpeningInCompositeProfileDefTest.ifc"))
+                {
+                    var context = new Xbim3DModelContext(model);
+                    XbimGeometryTrace.Start();
+                    try
+                    {
+                        context.CreateContext();
+                    }
+                    finally
+                    {
+                        XbimGeometryTrace.Stop();
+                    }
+                    XbimGeometryTrace.SpanCount.Should().BePositive();
+                    XbimGeometryTrace.Write(traceFile).Should().BeTrue();
+                }
+                var trace = File.ReadAllText(traceFile);
+                trace.Should().StartWith("{\"displayTimeUnit\"");
+                trace.Should().Contain("\"name\":\"WriteShapeGeometries\",\"ph\":\"X\"");
+                trace.Should().Contain("\"name\":\"Cut\"", "the opening is cut from the wall");
+                trace.Should().Contain("\"name\":\"BOPAlgo_BOP\"", "the native boolean is recorded on the same timeline");
+                trace.Should().Contain("\"name\":\"BRepMesh\"");
+
+                //nothing is recorded once stopped
+                var count = XbimGeometryTrace.SpanCount;
+                using (XbimGeometryTrace.Span("Stopped")) { }
+                XbimGeometryTrace.SpanCount.Should().Be(count);
+            }
+            finally
+            {
+                XbimGeometryTrace.Clear();
+                if (File.Exists(traceFile)) File.Delete(traceFile);
+            }
+        }
+
+        [TestMethod]
+        public void Dispatch_table_counts_calls_and_takes_custom_builders()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var extrude = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeRectangleProfileDef(m, 300, 150), 3000);
+                    geomEngine.ResetDispatchStatistics();
+                    geomEngine.Create(extrude, logger).Should().BeAssignableTo<IXbimSolid>();
+                    geomEngine.DispatchStatistics().Should().Contain(s => s.TypeName == extrude.GetType().Name && s.Calls == 1);
+
+                    var called = 0;
+                    geomEngine.RegisterBuilder<IIfcSweptAreaSolid>((item, log) => { called++; return geomEngine.CreateSolid(item, log); });
+                    try
+                    {
+                        geomEngine.Create(extrude, logger).Should().BeAssignableTo<IXbimSolid>();
+                        called.Should().Be(1, "the custom builder replaces the built in one");
+                    }
+                    finally
+                    {
+                        geomEngine.RemoveBuilder<IIfcSweptAreaSolid>().Should().BeTrue();
+                    }
+                    geomEngine.Create(extrude, logger);
+                    called.Should().Be(1, "the built in builder is restored");
+
+                    const int items = 1000000;
+                    var nanoseconds = geomEngine.MeasureDispatch(extrude, items);
+                    Console.WriteLine($"Dispatch {nanoseconds:F1}ns per item, {nanoseconds * items / 1e6:F1}ms for {items} items");
+                    nanoseconds.Should().BeLessThan(1000, "finding the builder is a single dictionary lookup");
+                }
+            }
+        }
+
+        [TestMethod]
+        public void Curve_cache_reuses_shared_directrices()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                IIfcSweptDiskSolid pipe, lagging;
+                using (var txn = m.BeginTransaction(""))
+                {
+                    pipe = IfcModelBuilder.MakeSweptDiskSolid(m, 50, null, new XbimPoint3D(0, 0, 0), new XbimPoint3D(0, 0, 2000), new XbimPoint3D(3000, 0, 2000));
+                    lagging = IfcModelBuilder.MakeSweptDiskSolid(m, 80, 50, new XbimPoint3D(0, 0, 0));
+                    lagging.Directrix = pipe.Directrix;
+                    txn.Commit();
+                }
+                // curves are only cached once the model is out of the transaction
+                geomEngine.ClearCurveCache(m);
+                geomEngine.ResetCurveCacheStatistics();
+                var first = (IXbimSolid)geomEngine.Create(pipe, logger);
+                var shared = (IXbimSolid)geomEngine.Create(lagging, logger);
+                var again = (IXbimSolid)geomEngine.Create(pipe, logger);
+                var statistics = geomEngine.CurveCacheStatistics();
+                Console.WriteLine(statistics);
+                statistics.Curves.Should().Be(1);
+                statistics.Hits.Should().Be(2);
+                again.Volume.Should().BeApproximately(first.Volume, first.Volume * 1e-9, "the cached directrix is the one built");
+                shared.Volume.Should().BeGreaterThan(0);
+                geomEngine.ClearCurveCache(m);
+            }
+        }
+
+        [TestMethod]
+        public void Curve_cache_outlives_the_session_of_the_item_that_built_it()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var context = IfcModelBuilder.MakeModelContext(m);
+                    var pipe = IfcModelBuilder.MakeSweptDiskSolid(m, 50, null, new XbimPoint3D(0, 0, 0), new XbimPoint3D(0, 0, 2000), new XbimPoint3D(3000, 0, 2000));
+                    var lagging = IfcModelBuilder.MakeSweptDiskSolid(m, 80, 50, new XbimPoint3D(0, 0, 0));
+                    lagging.Directrix = pipe.Directrix;
+                    // a pipe and its lagging, two products swept along the same curve
+                    foreach (var item in new[] { pipe, lagging })
+                        IfcModelBuilder.MakeProxy(m, context, item, "AdvancedSweptSolid");
+                    txn.Commit();
+                }
+                geomEngine.UseCurveCache.Should().BeTrue();
+                geomEngine.ClearCurveCache(m);
+                geomEngine.ResetCurveCacheStatistics();
+                // one thread, so the lagging is built from the cache after the session of the pipe has ended; the swept disks are
+                // built by the engine rather than meshed directly
+                var modelContext = new Xbim3DModelContext(m) { MaxThreads = 1, MeshPrimitivesDirectly = false };
+                modelContext.CreateContext().Should().BeTrue();
+                var statistics = geomEngine.CurveCacheStatistics();
+                Console.WriteLine(statistics);
+                statistics.Curves.Should().Be(1);
+                statistics.Hits.Should().Be(1);
+                using (var reader = m.GeometryStore.BeginRead())
+                {
+                    var geometries = reader.ShapeGeometries.ToList();
+                    geometries.Should().HaveCount(2);
+                    geometries.Should().OnlyContain(g => g.ShapeData.Length > 0 && !g.BoundingBox.IsEmpty);
+                    reader.ShapeInstances.Select(i => i.IfcProductLabel).Distinct().Should().HaveCount(2);
+                }
+                geomEngine.ClearCurveCache(m);
+            }
+        }
+
+        [TestMethod]
+        [TestCategory("Performance")]
+        public void Batched_extrusions_match_the_ones_built_singly()
+        {
+            const int extrusionCount = 3000;
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                var extrusions = new List<IIfcExtrudedAreaSolid>(extrusionCount);
+                using (var txn = m.BeginTransaction(""))
+                {
+                    // a few profiles shared by many members, as in a steel frame
+                    var profiles = new IfcProfileDef[]
+                    {
+                        IfcModelBuilder.MakeRectangleProfileDef(m, 200, 400),
+                        IfcModelBuilder.MakeIShapeProfileDef(m, 300, 150, 12, 8, 10),
+                        IfcModelBuilder.MakeCircleHollowProfileDef(m, 80, 6)
+                    };
+                    for (int i = 0; i < extrusionCount; i++)
+                    {
+                        var extrusion = IfcModelBuilder.MakeExtrudedAreaSolid(m, profiles[i % profiles.Length], 2000 + (i % 7) * 250);
+                        extrusion.Position.Location.SetXYZ((i % 50) * 1000, (i / 50) * 1000, 0);
+                        extrusions.Add(extrusion);
+                    }
+                    // an invalid item is reported and has an entry like the others
+                    extrusions.Add(IfcModelBuilder.MakeExtrudedAreaSolid(m, profiles[0], 0));
+                    txn.Commit();
+                }
+                var mf = m.ModelFactors;
+                var sw = Stopwatch.StartNew();
+                var batch = geomEngine.CreateSolids(extrusions, mf.DeflectionTolerance, mf.DeflectionAngle, logger);
+                sw.Stop();
+                var batchMs = sw.ElapsedMilliseconds;
+
+                sw.Restart();
+                var single = extrusions.Select(e =>
+                {
+                    var solid = geomEngine.CreateSolid(e, logger);
+                    var shapeGeom = solid.IsValid ? geomEngine.CreateShapeGeometry(solid, mf.Precision, mf.DeflectionTolerance, mf.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger) : null;
+                    return (solid, shapeGeom);
+                }).ToList();
+                sw.Stop();
+                var singleMs = sw.ElapsedMilliseconds;
+
+                batch.Should().HaveCount(extrusions.Count);
+                for (int i = 0; i < extrusions.Count; i++)
+                {
+                    batch[i].Solid.IsValid.Should().Be(single[i].solid.IsValid);
+                    if (!single[i].solid.IsValid)
+                    {
+                        batch[i].ShapeGeometry.Should().BeNull();
+                        continue;
+                    }
+                    batch[i].Solid.Volume.Should().BeApproximately(single[i].solid.Volume, single[i].solid.Volume * 1e-9);
+                    ReadMesh(batch[i].ShapeGeometry, out int batchTriangles, out double batchVolume).Should().BeTrue();
+                    ReadMesh(single[i].shapeGeom, out int singleTriangles, out double singleVolume);
+                    batchTriangles.Should().Be(singleTriangles);
+                    batchVolume.Should().BeApproximately(singleVolume, Math.Abs(singleVolume) * 1e-6);
+                }
+                batch.Last().Solid.IsValid.Should().BeFalse("the last extrusion has no depth");
+                Console.WriteLine($"{extrusions.Count} extrusions: batched {batchMs}ms, one at a time {singleMs}ms");
+            }
+        }
+
+        [TestMethod]
+        public void Batched_extrusions_survive_an_item_that_throws()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                var extrusions = new List<IIfcExtrudedAreaSolid>();
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var profile = IfcModelBuilder.MakeRectangleProfileDef(m, 200, 400);
+                    extrusions.Add(IfcModelBuilder.MakeExtrudedAreaSolid(m, profile, 2000));
+                    var noDirection = IfcModelBuilder.MakeExtrudedAreaSolid(m, profile, 2000);
+                    noDirection.ExtrudedDirection = null;
+                    extrusions.Add(noDirection);
+                    extrusions.Add(IfcModelBuilder.MakeExtrudedAreaSolid(m, profile, 3000));
+                    txn.Commit();
+                }
+                var mf = m.ModelFactors;
+                var batch = geomEngine.CreateSolids(extrusions, mf.DeflectionTolerance, mf.DeflectionAngle, logger);
+                batch.Should().HaveCount(3);
+                batch[0].Solid.IsValid.Should().BeTrue();
+                batch[0].Solid.Volume.Should().BeApproximately(200 * 400 * 2000, 1);
+                batch[1].Solid.Should().NotBeNull();
+                batch[1].Solid.IsValid.Should().BeFalse("the extrusion has no direction");
+                batch[1].ShapeGeometry.Should().BeNull();
+                batch[2].Solid.IsValid.Should().BeTrue();
+                batch[2].Solid.Volume.Should().BeApproximately(200 * 400 * 3000, 1);
+                batch[2].ShapeGeometry.Should().NotBeNull();
+            }
+        }
+
+        [DataTestMethod]
+        [DataRow(@"TestFiles\Ifc4TestFiles\air-terminal-element.ifc")]
+        [DataRow(@"TestFiles\Ifc4TestFiles\beam-revolved-solid-tapered.ifc")]
+        [DataRow(@"TestFiles\Ifc4TestFiles\sectioned-spine.ifc")]
+        public void Lofts_meshed_from_their_sections_match_the_brep(string fileName)
+        {
+            using (var model = MemoryModel.OpenRead(fileName))
+            {
+                var mf = model.ModelFactors;
+                var items = model.Instances.OfType<IIfcGeometricRepresentationItem>()
+                    .Where(i => i is IIfcExtrudedAreaSolidTapered || i is IIfcRevolvedAreaSolidTapered || i is IIfcSectionedSpine).ToList();
+                items.Should().NotBeEmpty();
+                int built = 0, lofted = 0;
+                var brepTime = new Stopwatch();
+                var loftTime = new Stopwatch();
+                foreach (var item in items)
+                {
+                    brepTime.Start();
+                    var solid = geomEngine.Create(item, logger) as IXbimSolid;
+                    if (solid != null && solid.IsValid)
+                        geomEngine.CreateShapeGeometry(solid, mf.Precision, mf.DeflectionTolerance, mf.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                    brepTime.Stop();
+                    loftTime.Start();
+                    var shapeGeom = geomEngine.CreateLoftShapeGeometry(item, mf.DeflectionTolerance, mf.DeflectionAngle, logger);
+                    loftTime.Stop();
+                    if (solid != null && solid.IsValid)
+                        built++;
+                    if (shapeGeom == null)
+                        continue;
+                    lofted++;
+                    // the bounds the deflection policy is given before meshing
+                    var bounds = geomEngine.LoftBounds(item, logger);
+                    bounds.IsEmpty.Should().BeFalse();
+                    if (!(item is IIfcSectionedSpine))
+                        bounds.Contains(shapeGeom.BoundingBox).Should().BeTrue("the mesh lies between the sections or in the cylinder they turn in");
+                    ReadMesh(shapeGeom, out int triangles, out double volume).Should().BeTrue("every edge is shared by two triangles of opposite winding");
+                    volume.Should().BePositive("the triangles face out");
+                    // the curved edges of the sections are chords in the mesh, so the volume is close but not the same
+                    if (solid != null && solid.IsValid)
+                        volume.Should().BeApproximately(solid.Volume, solid.Volume * 0.05);
+                    Console.WriteLine($"#{item.EntityLabel} {item.ExpressType.Name}: {triangles} triangles, volume {volume:F0}, B-rep volume {solid?.Volume ?? 0:F0}");
+                }
+                lofted.Should().BeGreaterOrEqualTo(built, "the sections are meshed wherever the B-rep can be built");
+                Console.WriteLine($"{items.Count} lofts: B-rep built {built} in {brepTime.ElapsedMilliseconds}ms, meshed from sections {lofted} in {loftTime.ElapsedMilliseconds}ms");
+            }
+        }
+
+        [TestMethod]
+        public void Full_revolution_loft_closes_on_its_first_section()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                using (var txn = m.BeginTransaction(""))
+                {
+                    // a ring of square section about the x axis, it starts and ends on the same section
+                    Func<IfcRectangleProfileDef> section = () =>
+                    {
+                        var profile = IfcModelBuilder.MakeRectangleProfileDef(m, 100, 100);
+                        profile.Position.Location.SetXY(0, 500);
+                        return profile;
+                    };
+                    var ring = m.Instances.New<Ifc4.GeometricModelResource.IfcRevolvedAreaSolidTapered>(r =>
+                    {
+                        r.SweptArea = section();
+                        r.EndSweptArea = section();
+                        r.Axis = IfcModelBuilder.MakeAxis1Placement(m);
+                        r.Angle = 2 * Math.PI / m.ModelFactors.AngleToRadiansConversionFactor;
+                        r.Position = IfcModelBuilder.MakeAxis2Placement3D(m);
+                    });
+                    var shapeGeom = geomEngine.CreateLoftShapeGeometry(ring, m.ModelFactors.DeflectionTolerance, m.ModelFactors.DeflectionAngle, logger);
+                    shapeGeom.Should().NotBeNull();
+                    ReadMesh(shapeGeom, out int triangles, out double volume).Should().BeTrue("every edge is shared by two triangles of opposite winding");
+                    // the area of the section times the length of the circle its centre turns through
+                    var expected = 100 * 100 * 2 * Math.PI * 500;
+                    volume.Should().BeApproximately(expected, expected * 0.02);
+                    // no caps lie on each other where the turn ends, the last ring is the first
+                    using (var ms = new MemoryStream(((IXbimShapeGeometryData)shapeGeom).ShapeData))
+                    using (var br = new BinaryReader(ms))
+                    {
+                        var vertices = br.ReadShapeTriangulation().Vertices.ToList();
+                        vertices.Select(v => (Math.Round(v.X, 2), Math.Round(v.Y, 2), Math.Round(v.Z, 2))).Distinct().Should().HaveCount(vertices.Count);
+                    }
+                    txn.Commit();
+                }
+            }
+        }
+
+        [DataTestMethod]
+        [DataRow(@"TestFiles\CompoundBooleanUnionTest.ifc")]
+        [DataRow(@"TestFiles\multi_boolean_opening_operations_test.ifc")]
+        [DataRow(@"TestFiles\advanced_brep_3.ifc")]
+        public void Hulls_and_oriented_boxes_enclose_whole_models(string fileName)
+        {
+            using (var model = MemoryModel.OpenRead(fileName))
+            {
+                var mf = model.ModelFactors;
+                var shapes = model.Instances.OfType<IIfcShapeRepresentation>()
+                    .SelectMany(r => r.Items).OfType<IIfcGeometricRepresentationItem>()
+                    .Select(item => geomEngine.Create(item, logger))
+                    .Where(g => g != null && g.IsValid && (g is IXbimSolid || g is IXbimSolidSet))
+                    .ToList();
+                shapes.Should().NotBeEmpty();
+                var boxTime = Stopwatch.StartNew();
+                var boxes = shapes.Select(s => geomEngine.OrientedBoundingBox(s)).ToList();
+                boxTime.Stop();
+                var hullTime = Stopwatch.StartNew();
+                var hulls = shapes.Select(s => geomEngine.CreateHullShapeGeometry(s, mf.DeflectionTolerance, mf.DeflectionAngle)).ToList();
+                hullTime.Stop();
+                for (int i = 0; i < shapes.Count; i++)
+                {
+                    var volume = shapes[i] is IXbimSolid solid ? solid.Volume : ((IXbimSolidSet)shapes[i]).Volume;
+                    boxes[i].Should().NotBeNull();
+                    boxes[i].Volume.Should().BeGreaterOrEqualTo(volume * 0.999, "the box holds the shape");
+                    if (hulls[i] == null)
+                        continue;
+                    ReadMesh(hulls[i], out int triangles, out double hullVolume).Should().BeTrue("the hull is closed and consistently wound");
+                    // curved faces are chords in the hull, so it can fall a little inside them
+                    hullVolume.Should().BeGreaterOrEqualTo(volume * 0.95);
+                    boxes[i].Volume.Should().BeGreaterOrEqualTo(hullVolume * 0.999, "the box holds the hull");
+                    geomEngine.CreateHullShapeGeometry(shapes[i], mf.DeflectionTolerance, mf.DeflectionAngle).Should().BeSameAs(hulls[i], "the hull is kept by the shape");
+                }
+                Console.WriteLine($"{fileName}: {shapes.Count} shapes, oriented boxes in {boxTime.ElapsedMilliseconds}ms " +
+                    $"({shapes.Count * 1000.0 / Math.Max(1, boxTime.ElapsedMilliseconds):F0}/s), hulls in {hullTime.ElapsedMilliseconds}ms " +
+                    $"({shapes.Count * 1000.0 / Math.Max(1, hullTime.ElapsedMilliseconds):F0}/s)");
+
+                var context = new Xbim3DModelContext(model) { CreateHullProxies = true };
+                context.CreateContext().Should().BeTrue();
+                context.HullProxies.Should().NotBeEmpty();
+            }
+        }
+
+        [TestMethod]
+        [TestCategory("Performance")]
+        public void Pairwise_clash_checks_on_10k_pairs()
+        {
+            const int memberCount = 150;
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                // members along a line 250 apart, a wide box touches the narrow one after it and overlaps the cylinder before it,
+                // every fifth wide box holds a small one
+                var extrusions = new List<(IIfcExtrudedAreaSolid Extrusion, double X, double HalfWidth)>();
+                using (var txn = m.BeginTransaction(""))
+                {
+                    var profiles = new (IfcProfileDef Profile, double HalfWidth)[]
+                    {
+                        (IfcModelBuilder.MakeRectangleProfileDef(m, 400, 400), 200),
+                        (IfcModelBuilder.MakeRectangleProfileDef(m, 100, 100), 50),
+                        (IfcModelBuilder.MakeCircleProfileDef(m, 80), 80)
+                    };
+                    var small = IfcModelBuilder.MakeRectangleProfileDef(m, 50, 50);
+                    for (int i = 0; i < memberCount; i++)
+                    {
+                        var (profile, halfWidth) = profiles[i % profiles.Length];
+                        var extrusion = IfcModelBuilder.MakeExtrudedAreaSolid(m, profile, 2000);
+                        extrusion.Position.Location.SetXYZ(i * 250, 0, 0);
+                        extrusions.Add((extrusion, i * 250, halfWidth));
+                        if (i % 15 == 0)
+                        {
+                            var inner = IfcModelBuilder.MakeExtrudedAreaSolid(m, small, 1000);
+                            inner.Position.Location.SetXYZ(i * 250, 0, 500);
+                            extrusions.Add((inner, i * 250, 25));
+                        }
+                    }
+                    txn.Commit();
+                }
+                var tolerance = m.ModelFactors.Precision;
+                var solids = extrusions.Select(e => geomEngine.CreateSolid(e.Extrusion, logger)).ToList();
+                solids.Should().OnlyContain(s => s.IsValid);
+
+                var pairs = new List<(int, int)>();
+                for (int i = 0; i < solids.Count; i++)
+                    for (int j = i + 1; j < solids.Count; j++)
+                        pairs.Add((i, j));
+                pairs.Count.Should().BeGreaterThan(10000);
+                var sw = Stopwatch.StartNew();
+                var clashes = pairs.Count(p => geomEngine.Intersects(solids[p.Item1], solids[p.Item2], tolerance));
+                var firstMs = sw.ElapsedMilliseconds;
+                sw.Restart();
+                foreach (var (i, j) in pairs)
+                {
+                    var expected = Math.Abs(extrusions[i].X - extrusions[j].X) <= extrusions[i].HalfWidth + extrusions[j].HalfWidth;
+                    geomEngine.Intersects(solids[i], solids[j], tolerance).Should().Be(expected, $"members {i} and {j}");
+                }
+                var secondMs = sw.ElapsedMilliseconds;
+                Console.WriteLine($"{pairs.Count} pairs, {clashes} clashes: {firstMs}ms building the trees as they were needed " +
+                    $"({pairs.Count * 1000.0 / Math.Max(1, firstMs):F0} pairs/s), {secondMs}ms with the trees kept ({pairs.Count * 1000.0 / Math.Max(1, secondMs):F0} pairs/s)");
+
+                // the same box built again is equal, moved by 1 it is only equal within a tolerance over 1
+                IIfcExtrudedAreaSolid copy, moved;
+                using (var txn = m.BeginTransaction(""))
+                {
+                    copy = IfcModelBuilder.MakeExtrudedAreaSolid(m, (IfcProfileDef)extrusions[0].Extrusion.SweptArea, 2000);
+                    moved = IfcModelBuilder.MakeExtrudedAreaSolid(m, (IfcProfileDef)extrusions[0].Extrusion.SweptArea, 2000);
+                    moved.Position.Location.SetXYZ(1, 0, 0);
+                    txn.Commit();
+                }
+                var copySolid = geomEngine.CreateSolid(copy, logger);
+                var movedSolid = geomEngine.CreateSolid(moved, logger);
+                geomEngine.GeometricallyEquals(solids[0], copySolid, tolerance).Should().BeTrue();
+                geomEngine.GeometricallyEquals(solids[0], movedSolid, 0.5).Should().BeFalse();
+                geomEngine.GeometricallyEquals(solids[0], movedSolid, 1.5).Should().BeTrue();
+                var cylinders = extrusions.Select((e, i) => i).Where(i => extrusions[i].HalfWidth == 80).Take(2).ToList();
+                geomEngine.GeometricallyEquals(solids[0], solids[extrusions.FindIndex(e => e.X == 750)], tolerance).Should().BeFalse("the same box elsewhere");
+                geomEngine.GeometricallyEquals(solids[cylinders[0]], solids[cylinders[1]], tolerance).Should().BeFalse("the same cylinder elsewhere");
+                geomEngine.GeometricallyEquals(solids[cylinders[0]], solids[cylinders[0]], tolerance).Should().BeTrue();
+            }
+        }
+
+        [TestMethod]
+        public void Default_deflection_does_not_take_a_coarser_shape_tree()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                IfcExtrudedAreaSolid small, large;
+                using (var txn = m.BeginTransaction(""))
+                {
+                    small = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeCircleProfileDef(m, 100), 100);
+                    large = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeCircleProfileDef(m, 120), 100);
+                    txn.Commit();
+                }
+                var smallSolid = geomEngine.CreateSolid(small, logger);
+                var largeSolid = geomEngine.CreateSolid(large, logger);
+                // meshed to 40 the radii 20 apart are within the widened tolerance, meshed to the default of about 3 they are not
+                geomEngine.GeometricallyEquals(smallSolid, largeSolid, 0.1, 40).Should().BeTrue();
+                geomEngine.GeometricallyEquals(smallSolid, largeSolid, 0.1).Should().BeFalse("the trees meshed to 40 are too coarse for the default");
+            }
+        }
+
+        [TestMethod]
+        public void Clash_detection_on_instanced_grids()
+        {
+            ClashDetectionOnInstancedGrids(20000);
+        }
+
+        [TestMethod]
+        [TestCategory("Performance")]
+        public void Clash_detection_on_a_million_instances()
+        {
+            ClashDetectionOnInstancedGrids(1000000);
+        }
+
+        private void ClashDetectionOnInstancedGrids(int boxCount)
+        {
+            // boxes 1000 wide on a grid 1200 apart sharing one mesh, every third turned a quarter and every thirteenth mirrored. Every seventh
+            // is moved 300 into the next, every fifth 100 towards it, and every eleventh holds a cylinder of radius 300 that moves with it
+            XbimShapeGeometry box, cylinder;
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                IIfcExtrudedAreaSolid boxSolid, cylinderSolid;
+                using (var txn = m.BeginTransaction(""))
+                {
+                    boxSolid = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeRectangleProfileDef(m, 1000, 1000), 1000);
+                    cylinderSolid = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeCircleProfileDef(m, 300), 600);
+                    txn.Commit();
+                }
+                var mf = m.ModelFactors;
+                box = geomEngine.CreateShapeGeometry(geomEngine.CreateSolid(boxSolid, logger), mf.Precision, mf.DeflectionTolerance, mf.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                cylinder = geomEngine.CreateShapeGeometry(geomEngine.CreateSolid(cylinderSolid, logger), mf.Precision, mf.DeflectionTolerance, mf.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+            }
+            var geometries = new Dictionary<int, XbimShapeGeometry> { [1] = box, [2] = cylinder };
+            var columns = (int)Math.Ceiling(Math.Sqrt(boxCount));
+            Func<int, double> shift = i => i % 7 == 0 ? 300 : i % 5 == 0 ? 100 : 0;
+            var instances = new List<XbimShapeInstance>();
+            var expected = new Dictionary<(int, int), (XbimClashType Type, double Distance)>();
+            for (int i = 0; i < boxCount; i++)
+            {
+                var x = (i % columns) * 1200 + shift(i);
+                var y = (i / columns) * 1200.0;
+                var turn = i % 3 == 0 ? 1 : 0;
+                var mirror = i % 13 == 0 ? -1 : 1;
+                var transform = new XbimMatrix3D(mirror * (1 - turn), mirror * turn, 0, 0, -turn, 1 - turn, 0, 0, 0, 0, 1, 0, x, y, 0, 1);
+                instances.Add(new XbimShapeInstance
+                {
+                    InstanceLabel = instances.Count + 1,
+                    IfcProductLabel = i + 1,
+                    ShapeGeometryLabel = 1,
+                    RepresentationType = XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded,
+                    Transformation = transform,
+                    BoundingBox = box.BoundingBox
+                });
+                var next = i % columns + 1 < columns && i + 1 < boxCount;
+                if (next)
+                {
+                    var gap = 200 + shift(i + 1) - shift(i);
+                    if (gap < 0)
+                        expected[(i + 1, i + 2)] = (XbimClashType.Hard, 0);
+                    else if (gap <= 150)
+                        expected[(i + 1, i + 2)] = (XbimClashType.Clearance, gap);
+                }
+                if (i % 11 != 0)
+                    continue;
+                var cylinderLabel = boxCount + i + 1;
+                instances.Add(new XbimShapeInstance
+                {
+                    InstanceLabel = instances.Count + 1,
+                    IfcProductLabel = cylinderLabel,
+                    ShapeGeometryLabel = 2,
+                    RepresentationType = XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded,
+                    Transformation = XbimMatrix3D.CreateTranslation(new XbimVector3D(x, y, 200)),
+                    BoundingBox = cylinder.BoundingBox
+                });
+                expected[(i + 1, cylinderLabel)] = (XbimClashType.Hard, 0);
+                if (next && 400 + shift(i + 1) - shift(i) <= 150)
+                    expected[(i + 2, cylinderLabel)] = (XbimClashType.Clearance, 400 + shift(i + 1) - shift(i));
+                if (i % columns > 0 && 400 + shift(i) - shift(i - 1) <= 150)
+                    expected[(i, cylinderLabel)] = (XbimClashType.Clearance, 400 + shift(i) - shift(i - 1));
+            }
+
+            var detector = new XbimClashDetector(label => geometries[label]) { Tolerance = 1e-5, Clearance = 150 };
+            var sw = Stopwatch.StartNew();
+            var found = 0;
+            foreach (var clash in detector.FindClashes(instances))
+            {
+                var key = (Math.Min(clash.ProductLabelA, clash.ProductLabelB), Math.Max(clash.ProductLabelA, clash.ProductLabelB));
+                expected.TryGetValue(key, out var expect).Should().BeTrue($"products {key} do not clash");
+                clash.Type.Should().Be(expect.Type, $"products {key}");
+                // the cylinder is meshed as a polygon within the deflection of it
+                clash.Distance.Should().BeApproximately(expect.Distance, 1, $"products {key}");
+                found++;
+            }
+            sw.Stop();
+            found.Should().Be(expected.Count);
+            var statistics = detector.Statistics;
+            statistics.Instances.Should().Be(instances.Count);
+            statistics.MeshesRead.Should().Be(2, "the instances share their meshes");
+            Console.WriteLine($"{instances.Count} instances, {found} clashes: {sw.ElapsedMilliseconds}ms ({instances.Count * 1000.0 / Math.Max(1, sw.ElapsedMilliseconds):F0} instances/s), " +
+                $"tree built in {statistics.BuildMilliseconds}ms, {statistics.CandidatePairs} candidate pairs ({statistics.CandidatePairs * 1000.0 / Math.Max(1, sw.ElapsedMilliseconds - statistics.BuildMilliseconds):F0} pairs/s)");
+
+            // a small mesh cache reads the meshes again as they are needed and gives the same clashes, stopping early stops the search
+            detector.MeshCacheBudget = 1;
+            detector.Clearance = 0;
+            sw.Restart();
+            detector.FindClashes(instances).Count().Should().Be(expected.Values.Count(e => e.Type == XbimClashType.Hard));
+            Console.WriteLine($"hard clashes only with the meshes read {detector.Statistics.MeshesRead} times: {sw.ElapsedMilliseconds}ms");
+            detector.FindClashes(instances).Take(10).Count().Should().Be(10);
+        }
+
+        [TestMethod]
+        public void Clash_detection_holds_a_mesh_whose_ray_leaves_through_a_corner()
+        {
+            XbimShapeGeometry outer, inner;
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                IIfcExtrudedAreaSolid outerSolid, innerSolid;
+                using (var txn = m.BeginTransaction(""))
+                {
+                    outerSolid = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeRectangleProfileDef(m, 1000, 1000), 1000);
+                    innerSolid = IfcModelBuilder.MakeExtrudedAreaSolid(m, IfcModelBuilder.MakeRectangleProfileDef(m, 50, 50), 50);
+                    txn.Commit();
+                }
+                var mf = m.ModelFactors;
+                outer = geomEngine.CreateShapeGeometry(geomEngine.CreateSolid(outerSolid, logger), mf.Precision, mf.DeflectionTolerance, mf.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+                inner = geomEngine.CreateShapeGeometry(geomEngine.CreateSolid(innerSolid, logger), mf.Precision, mf.DeflectionTolerance, mf.DeflectionAngle, XbimGeometryType.PolyhedronBinary, logger);
+            }
+            // the detector casts its first ray from the centre of the first triangle of the inner mesh, move that centre so the ray leaves
+            // the outer box through a corner that several of its triangles share
+            XbimPoint3D centre;
+            using (var ms = new MemoryStream(((IXbimShapeGeometryData)inner).ShapeData))
+            using (var br = new BinaryReader(ms))
+            {
+                var triangulation = br.ReadShapeTriangulation();
+                var vertices = triangulation.Vertices.ToList();
+                var first = triangulation.Faces.First().Indices;
+                centre = new XbimPoint3D(
+                    (vertices[first[0]].X + vertices[first[1]].X + vertices[first[2]].X) / 3,
+                    (vertices[first[0]].Y + vertices[first[1]].Y + vertices[first[2]].Y) / 3,
+                    (vertices[first[0]].Z + vertices[first[1]].Z + vertices[first[2]].Z) / 3);
+            }
+            var ray = new XbimVector3D(0.3129, 0.5281, 0.7893);
+            var origin = new XbimPoint3D(500 - 300 * ray.X, 500 - 300 * ray.Y, 1000 - 300 * ray.Z);
+            var geometries = new Dictionary<int, XbimShapeGeometry> { [1] = outer, [2] = inner };
+            var instances = new List<XbimShapeInstance>
+            {
+                new XbimShapeInstance
+                {
+                    InstanceLabel = 1, IfcProductLabel = 1, ShapeGeometryLabel = 1,
+                    RepresentationType = XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded,
+                    Transformation = XbimMatrix3D.Identity, BoundingBox = outer.BoundingBox
+                },
+                new XbimShapeInstance
+                {
+                    InstanceLabel = 2, IfcProductLabel = 2, ShapeGeometryLabel = 2,
+                    RepresentationType = XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded,
+                    Transformation = XbimMatrix3D.CreateTranslation(origin - centre), BoundingBox = inner.BoundingBox
+                }
+            };
+            var detector = new XbimClashDetector(label => geometries[label]) { Tolerance = 1e-5 };
+            var clashes = detector.FindClashes(instances).ToList();
+            clashes.Should().ContainSingle("the small box is inside the large one");
+            clashes[0].Type.Should().Be(XbimClashType.Hard);
+        }
+
+        [TestMethod]
+        public void Clash_detection_reads_a_model_context()
+        {
+            using (var model = MemoryModel.OpenRead(@"TestFiles\CompoundBooleanUnionTest.ifc"))
+            {
+                var context = new Xbim3DModelContext(model);
+                context.CreateContext().Should().BeTrue();
+                var detector = new XbimClashDetector(context) { Clearance = 10 };
+                var clashes = detector.FindClashes().ToList();
+                detector.Statistics.Instances.Should().BeGreaterThan(0);
+                clashes.Should().OnlyContain(c => c.ProductLabelA != c.ProductLabelB);
+                Console.WriteLine($"{detector.Statistics.Instances} instances, {detector.Statistics.CandidatePairs} candidate pairs, " +
+                    $"{detector.Statistics.HardClashes} hard and {detector.Statistics.ClearanceClashes} clearance clashes in {detector.Statistics.ElapsedMilliseconds}ms");
+            }
+        }
+
+        [TestMethod]
+        public void Size_deflection_policy_scales_with_the_diagonal_within_its_limits()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                var mf = m.ModelFactors;
+                var mm = mf.OneMilliMeter;
+                var policy = new XbimSizeDeflectionPolicy { DiagonalRatio = 0.01, MinLinearDeflectionInMM = 1, MaxLinearDeflectionInMM = 100 };
+                double linear = 7, angular = 0.3;
+
+                // a box of 3000 x 4000 x 0 has a diagonal of 5000, a hundredth of it is within the limits
+                policy.GetDeflection(null, new XbimRect3D(0, 0, 0, 3000 * mm, 4000 * mm, 0), mf, ref linear, ref angular);
+                linear.Should().BeApproximately(50 * mm, 1e-9 * mm, "the ratio of the diagonal");
+                angular.Should().Be(0.3, "the angle is left as it is");
+
+                policy.GetDeflection(null, new XbimRect3D(0, 0, 0, 30 * mm, 40 * mm, 0), mf, ref linear, ref angular);
+                linear.Should().BeApproximately(1 * mm, 1e-9 * mm, "clamped to the minimum");
+                policy.GetDeflection(null, new XbimRect3D(0, 0, 0, 300000 * mm, 400000 * mm, 0), mf, ref linear, ref angular);
+                linear.Should().BeApproximately(100 * mm, 1e-9 * mm, "clamped to the maximum");
+
+                linear = 7;
+                policy.GetDeflection(null, XbimRect3D.Empty, mf, ref linear, ref angular);
+                linear.Should().Be(7, "empty bounds keep the default");
+            }
+        }
+
+        [TestMethod]
+        public void Triangle_budget_deflection_policy_meshes_a_cylinder_to_the_budget()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                var mf = m.ModelFactors;
+                var mm = mf.OneMilliMeter;
+                var policy = new XbimTriangleBudgetDeflectionPolicy { TriangleBudget = 2000, MinLinearDeflectionInMM = 0.5, MaxAngularDeflection = 0.5 };
+                var bounds = new XbimRect3D(0, 0, 0, 3000 * mm, 4000 * mm, 0);
+                double linear = 7, angular = 0.3;
+
+                // 2000 triangles are 500 segments of a cylinder whose radius is half the diagonal
+                policy.GetDeflection(null, bounds, mf, ref linear, ref angular);
+                angular.Should().BeApproximately(2 * Math.PI / 500, 1e-12);
+                linear.Should().BeApproximately(2500 * mm * (1 - Math.Cos(Math.PI / 500)), 1e-9 * mm);
+
+                // a small budget is at least 8 segments, whose angle is over the maximum
+                policy.TriangleBudget = 10;
+                policy.GetDeflection(null, bounds, mf, ref linear, ref angular);
+                angular.Should().Be(0.5, "clamped to the maximum angle");
+                linear.Should().BeApproximately(2500 * mm * (1 - Math.Cos(Math.PI / 8)), 1e-9 * mm);
+
+                policy.TriangleBudget = 2000;
+                policy.GetDeflection(null, new XbimRect3D(0, 0, 0, 3 * mm, 4 * mm, 0), mf, ref linear, ref angular);
+                linear.Should().BeApproximately(0.5 * mm, 1e-9 * mm, "clamped to the minimum");
+
+                linear = 7; angular = 0.3;
+                policy.GetDeflection(null, XbimRect3D.Empty, mf, ref linear, ref angular);
+                policy.TriangleBudget = 0;
+                policy.GetDeflection(null, bounds, mf, ref linear, ref angular);
+                linear.Should().Be(7, "no bounds or no budget keep the default");
+                angular.Should().Be(0.3);
+            }
+        }
+
+        [TestMethod]
+        public void Type_deflection_policy_matches_types_in_order_then_falls_back()
+        {
+            using (var m = new MemoryModel(new Ifc4.EntityFactoryIfc4()))
+            {
+                var mf = m.ModelFactors;
+                var mm = mf.OneMilliMeter;
+                IIfcProduct wall, standardCase, column;
+                using (var txn = m.BeginTransaction(""))
+                {
+                    wall = m.Instances.New<Ifc4.SharedBldgElements.IfcWall>();
+                    standardCase = m.Instances.New<Ifc4.SharedBldgElements.IfcWallStandardCase>();
+                    column = m.Instances.New<Ifc4.SharedBldgElements.IfcColumn>();
+                    txn.Commit();
+                }
+                var policy = new XbimTypeDeflectionPolicy()
+                    .Add<IIfcWallStandardCase>(2, 0.2)
+                    .Add<IIfcWall>(5, 0.4);
+                var bounds = new XbimRect3D(0, 0, 0, 3000 * mm, 4000 * mm, 0);
+                double linear = 7, angular = 0.3;
+
+                policy.GetDeflection(wall, bounds, mf, ref linear, ref angular);
+                linear.Should().BeApproximately(5 * mm, 1e-9 * mm);
+                angular.Should().Be(0.4);
+                policy.GetDeflection(standardCase, bounds, mf, ref linear, ref angular);
+                linear.Should().BeApproximately(2 * mm, 1e-9 * mm, "the first type added that matches");
+                angular.Should().Be(0.2);
+
+                linear = 7; angular = 0.3;
+                policy.GetDeflection(column, bounds, mf, ref linear, ref angular);
+                policy.GetDeflection(null, bounds, mf, ref linear, ref angular);
+                linear.Should().Be(7, "no match and no fallback keep the default");
+                angular.Should().Be(0.3);
+
+                policy.Fallback = new XbimSizeDeflectionPolicy { DiagonalRatio = 0.01, MinLinearDeflectionInMM = 1, MaxLinearDeflectionInMM = 100 };
+                policy.GetDeflection(column, bounds, mf, ref linear, ref angular);
+                linear.Should().BeApproximately(50 * mm, 1e-9 * mm, "the fallback policy");
+            }
+        }
+
+        //reads the binary mesh, returns true if it is closed and consistently wound
+        private static bool ReadMesh(XbimShapeGeometry shapeGeom, out int triangles, out double volume)
+        {
+            triangles = 0;
+            volume = 0;
+            var edges = new HashSet<(int, int)>();
+            var closed = true;
+            using (var ms = new MemoryStream(((IXbimShapeGeometryData)shapeGeom).ShapeData))
+            using (var br = new BinaryReader(ms))
+            {
+                var triangulation = br.ReadShapeTriangulation();
+                var vertices = triangulation.Vertices.ToList();
+                foreach (var face in triangulation.Faces)
+                {
+                    triangles += face.TriangleCount;
+                    for (int i = 0; i + 2 < face.Indices.Count; i += 3)
+                    {
+                        var a = face.Indices[i];
+                        var b = face.Indices[i + 1];
+                        var c = face.Indices[i + 2];
+                        closed &= edges.Add((a, b)) & edges.Add((b, c)) & edges.Add((c, a));
+                        var va = vertices[a] - new XbimPoint3D(0, 0, 0);
+                        var vb = vertices[b] - new XbimPoint3D(0, 0, 0);
+                        var vc = vertices[c] - new XbimPoint3D(0, 0, 0);
+                        volume += XbimVector3D.DotProduct(va, XbimVector3D.CrossProduct(vb, vc)) / 6;
+                    }
+                }
+            }
+            return closed && edges.All(e => edges.Contains((e.Item2, e.Item1)));
+        }
+    }
+}
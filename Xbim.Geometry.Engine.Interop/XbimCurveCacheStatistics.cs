@@ -0,0 +1,48 @@
+﻿using System;
+using System.Diagnostics;
+
+namespace Xbim.Geometry.Engine.Interop
+{
+    /// <summary>
+    /// How often the directrices of swept solids were found in the curve cache
+    /// </summary>
+    public class XbimCurveCacheStatistics
+    {
+        public XbimCurveCacheStatistics(long hits, long misses, long curves, long buildTicks, long savedTicks)
+        {
+            Hits = hits;
+            Misses = misses;
+            Curves = curves;
+            BuildTime = TimeSpan.FromSeconds((double)buildTicks / Stopwatch.Frequency);
+            SavedTime = TimeSpan.FromSeconds((double)savedTicks / Stopwatch.Frequency);
+        }
+
+        public long Hits { get; }
+        /// <summary>
+        /// The lookups of curves not yet built with the same trims, lookups in models that are in a transaction are not counted
+        /// </summary>
+        public long Misses { get; }
+        /// <summary>
+        /// The curves added to the caches
+        /// </summary>
+        public long Curves { get; }
+        /// <summary>
+        /// The time taken to build the curves added
+        /// </summary>
+        public TimeSpan BuildTime { get; }
+        /// <summary>
+        /// The time the hits would have taken to build the curves again
+        /// </summary>
+        public TimeSpan SavedTime { get; }
+
+        public double HitRate
+        {
+            get { return Hits + Misses > 0 ? (double)Hits / (Hits + Misses) : 0; }
+        }
+
+        public override string ToString()
+        {
+            return $"{Hits} hits, {Misses} misses ({HitRate:P0}), {Curves} curves, {SavedTime.TotalMilliseconds:F1}ms saved";
+        }
+    }
+}
@@ -0,0 +1,33 @@
+﻿using System;
+using System.Diagnostics;
+
+namespace Xbim.Geometry.Engine.Interop
+{
+    /// <summary>
+    /// The calls XbimGeometryEngine.Create made for one type of representation item
+    /// </summary>
+    public class XbimDispatchStatistics
+    {
+        public XbimDispatchStatistics(string typeName, long calls, long ticks)
+        {
+            TypeName = typeName;
+            Calls = calls;
+            Elapsed = TimeSpan.FromSeconds((double)ticks / Stopwatch.Frequency);
+        }
+
+        /// <summary>
+        /// The name of the runtime type of the items, e.g. IfcExtrudedAreaSolid
+        /// </summary>
+        public string TypeName { get; }
+        public long Calls { get; }
+        /// <summary>
+        /// The time taken by the builder, including the operands and members it builds
+        /// </summary>
+        public TimeSpan Elapsed { get; }
+
+        public override string ToString()
+        {
+            return $"{TypeName}: {Calls} calls, {Elapsed.TotalMilliseconds:F1}ms";
+        }
+    }
+}
@@ -0,0 +1,55 @@
+﻿using System;
+using System.Threading;
+
+namespace Xbim.Geometry.Engine.Interop
+{
+    /// <summary>
+    /// Links a CancellationToken and a time budget to the OCC algorithms the engine runs on the calling thread.
+    /// Booleans, sewing and shape fixing poll the scope through their progress indicator and stop within milliseconds,
+    /// meshing and pipe sweeps are not started once the scope is cancelled or its budget is spent
+    /// </summary>
+    public static class XbimGeometryCancellation
+    {
+        private static readonly Lazy<Func<CancellationToken, double, IDisposable>> _enter = new Lazy<Func<CancellationToken, double, IDisposable>>(() =>
+        {
+            var engineType = XbimGeometryEngine.LoadEngineType();
+            var method = engineType.GetMethod("EnterCancellationScope");
+            if (method == null)
+                throw new MissingMethodException(engineType.FullName, "EnterCancellationScope");
+            return (Func<CancellationToken, double, IDisposable>)Delegate.CreateDelegate(typeof(Func<CancellationToken, double, IDisposable>), method);
+        });
+
+        private static readonly Lazy<Func<IDisposable>> _enterParallel = new Lazy<Func<IDisposable>>(() =>
+        {
+            var engineType = XbimGeometryEngine.LoadEngineType();
+            var method = engineType.GetMethod("EnterParallelBooleanScope");
+            if (method == null)
+                throw new MissingMethodException(engineType.FullName, "EnterParallelBooleanScope");
+            return (Func<IDisposable>)Delegate.CreateDelegate(typeof(Func<IDisposable>), method);
+        });
+
+        /// <summary>
+        /// Opens a cancellation scope on the calling thread, use in a using statement and dispose on the same thread. Scopes nest,
+        /// an inner scope is stopped when any enclosing scope is
+        /// </summary>
+        /// <param name="token">cancels the scope, may be CancellationToken.None</param>
+        /// <param name="budget">the time the work in the scope may take, TimeSpan.Zero for no limit</param>
+        /// <returns>null if the token cannot be cancelled and there is no budget</returns>
+        public static IDisposable Enter(CancellationToken token, TimeSpan budget)
+        {
+            if (!token.CanBeCanceled && budget <= TimeSpan.Zero)
+                return null;
+            return _enter.Value(token, budget.TotalSeconds);
+        }
+
+        /// <summary>
+        /// Opens a scope in which the booleans run on the calling thread spread the intersection of their tools over several threads,
+        /// for the few products whose booleans would otherwise keep one core busy after the others have finished. It is stopped with
+        /// any enclosing scope, dispose on the same thread
+        /// </summary>
+        public static IDisposable EnterParallel()
+        {
+            return _enterParallel.Value();
+        }
+    }
+}
@@ -1,6 +1,9 @@
 ﻿using Microsoft.Extensions.Logging;
+using Microsoft.Extensions.Logging.Abstractions;
 using System;
+using System.Collections.Generic;
 using System.IO;
+using System.Linq;
 using System.Reflection;
 using System.Runtime.CompilerServices;
 using Xbim.Common;
@@ -14,6 +17,9 @@ namespace Xbim.Geometry.Engine.Interop
     {
         private readonly IXbimGeometryEngine _engine;
 
+        // the concrete engine type, used to reach engine features that are not part of IXbimGeometryEngine
+        private readonly Type _engineType;
+
         private readonly ILogger<XbimGeometryEngine> _logger;
 
         static XbimGeometryEngine()
@@ -51,6 +57,7 @@ namespace Xbim.Geometry.Engine.Interop
                     throw new Exception("Failed to create Geometry Engine");
                 }
 
+                _engineType = t;
                 _engine = obj as IXbimGeometryEngine;
                 if (_engine == null)
                 {
@@ -67,6 +74,15 @@ namespace Xbim.Geometry.Engine.Interop
 
         }
 
+        /// <summary>
+        /// Loads the engine assembly built for the architecture of the process and returns the concrete engine type
+        /// </summary>
+        internal static Type LoadEngineType()
+        {
+            var conventions = new XbimArchitectureConventions();
+            return Assembly.Load($"{conventions.ModuleName}.dll").GetType("Xbim.Geometry.XbimGeometryCreator", true);
+        }
+
         public IXbimGeometryObject Create(IIfcGeometricRepresentationItem ifcRepresentation, ILogger logger)
         {
             using (new Tracer(LogHelper.CurrentFunctionName(), this._logger, ifcRepresentation))
@@ -837,6 +853,356 @@ namespace Xbim.Geometry.Engine.Interop
             }
         }
 
+        /// <summary>
+        /// Times the node transform kernel used by the triangulation writers against the scalar loop it replaced
+        /// </summary>
+        /// <param name="nodeCount">number of nodes transformed per iteration</param>
+        /// <param name="iterations">number of passes over the nodes</param>
+        /// <returns>the scalar, SSE2 and AVX2 times in milliseconds, -1 where the processor does not support the instruction set</returns>
+        public double[] BenchmarkMeshKernel(int nodeCount, int iterations)
+        {
+            using (new Tracer(LogHelper.CurrentFunctionName(), this._logger))
+            {
+                return InvokeEngine<double[]>(nameof(BenchmarkMeshKernel), nodeCount, iterations);
+            }
+        }
+
+        /// <summary>
+        /// Chains straight edges end to end from the first one, matching each step to the nearest free end point within the tolerance
+        /// </summary>
+        /// <param name="points">the start and end point of each edge, 6 coordinates per edge</param>
+        /// <param name="tolerance">the largest gap between end points that is chained</param>
+        /// <param name="linearScan">measures every free edge at each step instead of looking up the end points in a grid, the results are the same</param>
+        /// <returns>1 if every edge was chained else 0, 1 if the chain closes else 0, the largest gap accepted, the number of edges chained,
+        /// then the indices of the chained edges followed by those that were not taken</returns>
+        public double[] SortEdgesForWire(double[] points, double tolerance, bool linearScan)
+        {
+            using (new Tracer(LogHelper.CurrentFunctionName(), this._logger))
+            {
+                return InvokeEngine<double[]>(nameof(SortEdgesForWire), points, tolerance, linearScan);
+            }
+        }
+
+        /// <summary>
+        /// The instruction set selected at runtime by the triangulation writers, Scalar, SSE2 or AVX2
+        /// </summary>
+        public string MeshKernelInstructionSet => GetEngineProperty<string>(nameof(MeshKernelInstructionSet));
+
+        /// <summary>
+        /// When true planar faces are triangulated by the native polygon triangulator, otherwise by Xbim.Tessellator
+        /// Defaults to the NativePolygonTriangulator app setting, or true. This is a process wide setting
+        /// </summary>
+        public bool UseNativePolygonTriangulator
+        {
+            get => GetEngineField<bool>(nameof(UseNativePolygonTriangulator));
+            set => SetEngineField(nameof(UseNativePolygonTriangulator), value);
+        }
+
+        /// <summary>
+        /// When true solids, shells and compounds built from IFC report their estimated native size to the GC, so that wrappers of large
+        /// B-reps are collected sooner. Wrappers of existing shapes, such as the members of sets and compounds, report nothing, the shape
+        /// they share is counted once by its owner. Defaults to the ReportMemoryPressure app setting, or true. This is a process wide setting
+        /// </summary>
+        public bool ReportMemoryPressure
+        {
+            get => GetEngineField<bool>(nameof(ReportMemoryPressure));
+            set => SetEngineField(nameof(ReportMemoryPressure), value);
+        }
+
+        /// <summary>
+        /// When true the directrices of swept solids are kept for each model and reused by the items that sweep along the same curve with
+        /// the same trims. Defaults to the CurveCache app setting, or true. This is a process wide setting
+        /// </summary>
+        public bool UseCurveCache
+        {
+            get => GetEngineField<bool>(nameof(UseCurveCache));
+            set => SetEngineField(nameof(UseCurveCache), value);
+        }
+
+        /// <summary>
+        /// When true the edges of an IfcAdvancedBrep are projected onto the surfaces of its faces on several threads, the faces are then
+        /// built from them in order as before. Defaults to the ParallelAdvancedFaces app setting, or true. This is a process wide setting
+        /// </summary>
+        public bool ParallelAdvancedFaces
+        {
+            get => GetEngineField<bool>(nameof(ParallelAdvancedFaces));
+            set => SetEngineField(nameof(ParallelAdvancedFaces), value);
+        }
+
+        /// <summary>
+        /// A message other than an error is logged at most this many times for the same entity, the repeats are counted and summarised by
+        /// ReportSuppressedLogs. Defaults to the LogRepeatLimit app setting, or 0 for no limit. This is a process wide setting. The counts are
+        /// cleared when they are reported, and summarised to the logger in use when 100000 different messages have been counted
+        /// </summary>
+        public int LogRepeatLimit
+        {
+            get => GetEngineField<int>(nameof(LogRepeatLimit));
+            set => SetEngineField(nameof(LogRepeatLimit), value);
+        }
+
+        /// <summary>
+        /// Logs how many times each suppressed message was repeated and clears the counts. Returns the number of messages suppressed
+        /// </summary>
+        public int ReportSuppressedLogs(ILogger logger)
+        {
+            return InvokeEngine<int>(nameof(ReportSuppressedLogs), logger ?? NullLogger.Instance);
+        }
+
+        /// <summary>
+        /// A rough size in bytes of the native faces, edges and triangulation of the shape, or of the members of a set
+        /// </summary>
+        public long EstimateNativeBytes(IXbimGeometryObject geometryObject)
+        {
+            if (geometryObject == null)
+                return 0;
+            return InvokeEngine<long>(nameof(EstimateNativeBytes), geometryObject);
+        }
+
+        /// <summary>
+        /// The bytes reported to the GC for the shape, or for the members of a set, zero once the shape has been disposed
+        /// </summary>
+        public long MemoryPressure(IXbimGeometryObject geometryObject)
+        {
+            if (geometryObject == null)
+                return 0;
+            return InvokeEngine<long>(nameof(MemoryPressure), geometryObject);
+        }
+
+        /// <summary>
+        /// The number of faces of the shape, or of the members of a set, and how many of them are curved
+        /// </summary>
+        public int CountFaces(IXbimGeometryObject geometryObject, out int curvedFaces)
+        {
+            curvedFaces = 0;
+            if (geometryObject == null)
+                return 0;
+            var counts = InvokeEngine<int[]>(nameof(CountFaces), geometryObject);
+            curvedFaces = counts[1];
+            return counts[0];
+        }
+
+        /// <summary>
+        /// Writes the shape, or the members of a set, in the OCC binary BRep format. Returns null if the object has no shape
+        /// </summary>
+        public byte[] ToBinaryBrep(IXbimGeometryObject geometryObject)
+        {
+            if (geometryObject == null)
+                return null;
+            return InvokeEngine<byte[]>(nameof(ToBinaryBrep), geometryObject);
+        }
+
+        /// <summary>
+        /// Reads an object written by ToBinaryBrep, sets are read back as a set of the same kind and compounds keep their sewing tolerance.
+        /// Returns null if the data cannot be read
+        /// </summary>
+        public IXbimGeometryObject FromBinaryBrep(byte[] data)
+        {
+            if (data == null)
+                return null;
+            return InvokeEngine<IXbimGeometryObject>(nameof(FromBinaryBrep), data);
+        }
+
+        /// <summary>
+        /// Create builds items of type T, or of types derived from it, with the builder instead of the built in one, e.g. to mesh a type directly.
+        /// The builder registered last for a type wins. This is a process wide setting
+        /// </summary>
+        public void RegisterBuilder<T>(Func<T, ILogger, IXbimGeometryObject> builder) where T : IIfcGeometricRepresentationItem
+        {
+            if (builder == null)
+                throw new ArgumentNullException(nameof(builder));
+            Func<IIfcGeometricRepresentationItem, ILogger, IXbimGeometryObject> build = (item, logger) => builder((T)item, logger);
+            InvokeEngine<object>(nameof(RegisterBuilder), typeof(T), build);
+        }
+
+        /// <summary>
+        /// Restores the built in builder of type T, returns false if no builder was registered for it
+        /// </summary>
+        public bool RemoveBuilder<T>() where T : IIfcGeometricRepresentationItem
+        {
+            return InvokeEngine<bool>(nameof(RemoveBuilder), typeof(T));
+        }
+
+        /// <summary>
+        /// The calls made to Create and the time they took by the type of the representation item, since the process started or the statistics were reset
+        /// </summary>
+        public IReadOnlyList<XbimDispatchStatistics> DispatchStatistics()
+        {
+            var statistics = InvokeEngine<Dictionary<string, long[]>>(nameof(DispatchStatistics));
+            return statistics.Select(s => new XbimDispatchStatistics(s.Key, s.Value[0], s.Value[1]))
+                .OrderByDescending(s => s.Elapsed).ToList();
+        }
+
+        public void ResetDispatchStatistics()
+        {
+            InvokeEngine<object>(nameof(ResetDispatchStatistics));
+        }
+
+        /// <summary>
+        /// How often the directrices of swept solids were found in the curve cache, since the process started or the statistics were reset
+        /// </summary>
+        public XbimCurveCacheStatistics CurveCacheStatistics()
+        {
+            var statistics = InvokeEngine<long[]>(nameof(CurveCacheStatistics));
+            return new XbimCurveCacheStatistics(statistics[0], statistics[1], statistics[2], statistics[3], statistics[4]);
+        }
+
+        public void ResetCurveCacheStatistics()
+        {
+            InvokeEngine<object>(nameof(ResetCurveCacheStatistics));
+        }
+
+        /// <summary>
+        /// Drops the directrices kept for the model, they are also dropped when the model is collected
+        /// </summary>
+        public void ClearCurveCache(IModel model)
+        {
+            if (model != null)
+                InvokeEngine<object>(nameof(ClearCurveCache), model);
+        }
+
+        /// <summary>
+        /// The average time in nanoseconds Create takes to find the builder of the item, over the given number of lookups
+        /// </summary>
+        public double MeasureDispatch(IIfcGeometricRepresentationItem item, int iterations)
+        {
+            if (item == null)
+                return 0;
+            return InvokeEngine<double>(nameof(MeasureDispatch), item, iterations);
+        }
+
+        /// <summary>
+        /// Meshes an IfcExtrudedAreaSolidTapered, IfcRevolvedAreaSolidTapered or IfcSectionedSpine straight from its cross sections, without
+        /// the B-rep Create builds, so the mesh cannot be used in booleans. Returns null if the item is of another type or cannot be meshed this way
+        /// </summary>
+        public XbimShapeGeometry CreateLoftShapeGeometry(IIfcGeometricRepresentationItem item, double deflection, double angle, ILogger logger = null)
+        {
+            if (item == null)
+                return null;
+            return InvokeEngine<XbimShapeGeometry>(nameof(CreateLoftShapeGeometry), item, deflection, angle, logger ?? NullLogger.Instance);
+        }
+
+        /// <summary>
+        /// A box around the mesh CreateLoftShapeGeometry would make of the item, worked out from its placed sections without meshing them so the
+        /// deflection can be chosen first. It may be larger than the mesh. Empty if the item is of another type or its sections cannot be built
+        /// </summary>
+        public XbimRect3D LoftBounds(IIfcGeometricRepresentationItem item, ILogger logger = null)
+        {
+            if (item == null)
+                return XbimRect3D.Empty;
+            return InvokeEngine<XbimRect3D>(nameof(LoftBounds), item, logger ?? NullLogger.Instance);
+        }
+
+        /// <summary>
+        /// Builds many extrusions in one call, each profile is read once however many items share it and the prisms are made and meshed
+        /// in parallel. Tapered extrusions and composite profiles are built one at a time as CreateSolid builds them. There is an entry for
+        /// each item in order, with the solid CreateSolid would return and, if deflection is greater than 0, its shape geometry, null if the
+        /// solid is not valid. Errors are logged against their item
+        /// </summary>
+        public IList<(IXbimSolid Solid, XbimShapeGeometry ShapeGeometry)> CreateSolids(IEnumerable<IIfcExtrudedAreaSolid> items, double deflection, double angle, ILogger logger = null)
+        {
+            var results = InvokeEngine<KeyValuePair<IXbimSolid, XbimShapeGeometry>[]>(nameof(CreateSolids), items.ToList(), deflection, angle, logger ?? NullLogger.Instance);
+            return results.Select(r => (r.Key, r.Value)).ToList();
+        }
+
+        /// <summary>
+        /// A tight box around a solid, solid set or compound, with sides that follow the shape rather than the world axes. Returns null
+        /// for other objects or empty shapes. The box is kept by the object until it is moved
+        /// </summary>
+        public XbimOrientedBox OrientedBoundingBox(IXbimGeometryObject geometryObject)
+        {
+            if (geometryObject == null)
+                return null;
+            var values = InvokeEngine<double[]>(nameof(OrientedBoundingBox), geometryObject);
+            return values == null ? null : new XbimOrientedBox(values);
+        }
+
+        /// <summary>
+        /// The convex hull of a solid, solid set or compound as a shape geometry of planar triangles, a light proxy for its mesh in
+        /// culling and clash tests. Curved faces are meshed to the deflection and angle first. Returns null for other objects or shapes
+        /// that do not span a volume. The hull is kept by the object until it is moved
+        /// </summary>
+        public XbimShapeGeometry CreateHullShapeGeometry(IXbimGeometryObject geometryObject, double deflection, double angle)
+        {
+            if (geometryObject == null)
+                return null;
+            return InvokeEngine<XbimShapeGeometry>(nameof(CreateHullShapeGeometry), geometryObject, deflection, angle);
+        }
+
+        /// <summary>
+        /// The convex hull of the vertices of a PolyhedronBinary shape geometry as a shape geometry of planar triangles, for shapes meshed
+        /// without a B-rep. Returns null for other formats or meshes that do not span a volume
+        /// </summary>
+        public XbimShapeGeometry CreateHullShapeGeometry(XbimShapeGeometry shapeGeometry)
+        {
+            if (shapeGeometry == null)
+                return null;
+            return InvokeEngine<XbimShapeGeometry>(nameof(CreateHullShapeGeometry), shapeGeometry);
+        }
+
+        /// <summary>
+        /// True if two solids, solid sets, compounds, shells or faces come within the tolerance of each other or a solid of one holds the other.
+        /// The triangles of the two are paired through bounding volume hierarchies kept by the objects, so testing a shape against many
+        /// others meshes it once. Contacts the mesh cannot settle, near curved faces, are measured on the B-rep. A deflection of 0 meshes
+        /// each shape to a hundredth of its size
+        /// </summary>
+        public bool Intersects(IXbimGeometryObject a, IXbimGeometryObject b, double tolerance, double deflection = 0, double angle = 0.5)
+        {
+            if (a == null || b == null)
+                return false;
+            return InvokeEngine<bool>(nameof(Intersects), a, b, tolerance, deflection, angle);
+        }
+
+        /// <summary>
+        /// True if two solids, solid sets, compounds, shells or faces are within the tolerance of each other everywhere. The shapes are
+        /// compared by a symmetric Hausdorff bound over the nodes and triangle centres of their meshes, widened by the deflections of the meshes
+        /// </summary>
+        public bool GeometricallyEquals(IXbimGeometryObject a, IXbimGeometryObject b, double tolerance, double deflection = 0, double angle = 0.5)
+        {
+            if (a == null || b == null)
+                return a == b;
+            return InvokeEngine<bool>(nameof(GeometricallyEquals), a, b, tolerance, deflection, angle);
+        }
+
+        private T InvokeEngine<T>(string methodName, params object[] args)
+        {
+            var method = _engineType.GetMethod(methodName, Array.ConvertAll(args, a => a.GetType()));
+            if (method == null)
+                throw new MissingMethodException(_engineType.FullName, methodName);
+            try
+            {
+                return (T)method.Invoke(method.IsStatic ? null : _engine, args);
+            }
+            catch (TargetInvocationException e) when (e.InnerException != null)
+            {
+                System.Runtime.ExceptionServices.ExceptionDispatchInfo.Capture(e.InnerException).Throw();
+                throw;
+            }
+        }
+
+        private T GetEngineField<T>(string fieldName)
+        {
+            var field = _engineType.GetField(fieldName);
+            if (field == null)
+                throw new MissingFieldException(_engineType.FullName, fieldName);
+            return (T)field.GetValue(field.IsStatic ? null : _engine);
+        }
+
+        private void SetEngineField(string fieldName, object value)
+        {
+            var field = _engineType.GetField(fieldName);
+            if (field == null)
+                throw new MissingFieldException(_engineType.FullName, fieldName);
+            field.SetValue(field.IsStatic ? null : _engine, value);
+        }
+
+        private T GetEngineProperty<T>(string propertyName)
+        {
+            var property = _engineType.GetProperty(propertyName);
+            if (property == null)
+                throw new MissingMemberException(_engineType.FullName, propertyName);
+            return (T)property.GetValue(property.GetMethod.IsStatic ? null : _engine);
+        }
+
 		public void WriteBrep(string filename, IXbimGeometryObject geomObj)
 		{
             // no logger is provided so no tracing is started for this function
@@ -0,0 +1,115 @@
+﻿using System;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+
+namespace Xbim.Geometry.Engine.Interop
+{
+    /// <summary>
+    /// Releases the native shapes of every geometry object created on the calling thread while the session is open when it is disposed,
+    /// rather than when the finalizer eventually runs. Objects that are needed after the session must be passed to Keep.
+    /// Sessions nest, objects kept by an inner session are released by the enclosing one. Dispose on the thread that created the session
+    /// </summary>
+    public sealed class XbimGeometrySession : IDisposable
+    {
+        private static readonly Lazy<Func<object, object>> _begin = new Lazy<Func<object, object>>(() => Bind<Func<object, object>>("BeginGeometrySession"));
+        private static readonly Lazy<Action<object, IXbimGeometryObject>> _keep = new Lazy<Action<object, IXbimGeometryObject>>(() => Bind<Action<object, IXbimGeometryObject>>("KeepInGeometrySession"));
+        private static readonly Lazy<Action<object>> _end = new Lazy<Action<object>>(() => Bind<Action<object>>("EndGeometrySession"));
+        private static readonly Lazy<Action<IXbimGeometryObject>> _detach = new Lazy<Action<IXbimGeometryObject>>(() => Bind<Action<IXbimGeometryObject>>("DetachFromGeometrySessions"));
+        private static readonly Lazy<Func<object, long[]>> _counters = new Lazy<Func<object, long[]>>(() => Bind<Func<object, long[]>>("GeometrySessionCounters"));
+
+        private readonly object _session;
+        private long _privateBytesAtEnd;
+        private bool _disposed;
+
+        public XbimGeometrySession() : this(null)
+        {
+        }
+
+        /// <summary>
+        /// A session for the work on one entity, usually a product. Warnings the engine raises in native code without an entity of their own,
+        /// such as those of booleans, are logged against it
+        /// </summary>
+        public XbimGeometrySession(IPersistEntity entity)
+        {
+            PrivateBytesAtStart = XbimGeometryTelemetry.NativeBytesInUse();
+            _session = _begin.Value(entity);
+        }
+
+        /// <summary>
+        /// Excludes the object, and the members of a set, from the release at the end of the session, returns the object
+        /// </summary>
+        public T Keep<T>(T geometryObject) where T : IXbimGeometryObject
+        {
+            if (geometryObject != null)
+                _keep.Value(_session, geometryObject);
+            return geometryObject;
+        }
+
+        /// <summary>
+        /// Excludes the object from the release of every session open on the calling thread, for objects owned by a cache
+        /// that outlives the sessions. Returns the object
+        /// </summary>
+        public static T Detach<T>(T geometryObject) where T : IXbimGeometryObject
+        {
+            if (geometryObject != null)
+                _detach.Value(geometryObject);
+            return geometryObject;
+        }
+
+        /// <summary>
+        /// The number of geometry objects created in the session
+        /// </summary>
+        public long TrackedObjects
+        {
+            get { return _counters.Value(_session)[0]; }
+        }
+
+        /// <summary>
+        /// The number of geometry objects whose native shapes were released when the session was disposed
+        /// </summary>
+        public long ReleasedObjects
+        {
+            get { return _counters.Value(_session)[1]; }
+        }
+
+        /// <summary>
+        /// The number of objects passed to Keep, including the members of kept sets
+        /// </summary>
+        public long KeptObjects
+        {
+            get { return _counters.Value(_session)[2]; }
+        }
+
+        /// <summary>
+        /// The native bytes in use by the process when the session was opened, see XbimGeometryTelemetry.NativeBytesInUse
+        /// </summary>
+        public long PrivateBytesAtStart { get; private set; }
+
+        /// <summary>
+        /// The growth of the native bytes in use by the process from the start of the session until it was disposed. This is process wide,
+        /// when sessions run in parallel it includes the allocations of other threads
+        /// </summary>
+        public long PrivateBytesRetained
+        {
+            get { return (_disposed ? _privateBytesAtEnd : XbimGeometryTelemetry.NativeBytesInUse()) - PrivateBytesAtStart; }
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+            _disposed = true;
+            _end.Value(_session);
+            _privateBytesAtEnd = XbimGeometryTelemetry.NativeBytesInUse();
+        }
+
+        private static T Bind<T>(string methodName) where T : class
+        {
+            var engineType = XbimGeometryEngine.LoadEngineType();
+            var method = engineType.GetMethod(methodName);
+            if (method == null)
+                throw new MissingMethodException(engineType.FullName, methodName);
+            return (T)(object)Delegate.CreateDelegate(typeof(T), method);
+        }
+    }
+}
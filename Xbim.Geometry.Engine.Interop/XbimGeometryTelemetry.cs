@@ -0,0 +1,247 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using Xbim.Common;
+
+namespace Xbim.Geometry.Engine.Interop
+{
+    public enum XbimGeometryOutcome
+    {
+        Success,
+        Empty,
+        Failed,
+        TimedOut
+    }
+
+    /// <summary>
+    /// The time and native memory at the start of a measured stage
+    /// </summary>
+    public struct XbimTelemetryMark
+    {
+        internal long Timestamp;
+        internal long NativeBytes;
+    }
+
+    /// <summary>
+    /// The cost of converting one representation item, or one product for the boolean stage
+    /// </summary>
+    public class XbimGeometryTelemetryRecord
+    {
+        public int EntityLabel { get; internal set; }
+        public string IfcType { get; internal set; }
+        /// <summary>
+        /// Time in milliseconds to build the B-rep from the IFC definition
+        /// </summary>
+        public double CreateMs { get; internal set; }
+        /// <summary>
+        /// Time in milliseconds to triangulate and write the shape
+        /// </summary>
+        public double MeshMs { get; internal set; }
+        /// <summary>
+        /// Time in milliseconds spent cutting openings and adding projections
+        /// </summary>
+        public double BooleanMs { get; internal set; }
+        public int Triangles { get; internal set; }
+        public int Faces { get; internal set; }
+        /// <summary>
+        /// Growth of the process private bytes not held by the managed heap while the entity was converted.
+        /// This is process wide, when entities are converted in parallel it includes the allocations of other threads
+        /// </summary>
+        public long NativeBytes { get; internal set; }
+        public XbimGeometryOutcome Outcome { get; internal set; }
+
+        public double TotalMs
+        {
+            get { return CreateMs + MeshMs + BooleanMs; }
+        }
+
+        public const string CsvHeader = "Entity Label, IFC Type, Create (ms), Mesh (ms), Boolean (ms), Total (ms), Triangles, Faces, Native Bytes, Outcome";
+
+        public string ToCsv()
+        {
+            return string.Format(CultureInfo.InvariantCulture, "{0},{1},{2:F3},{3:F3},{4:F3},{5:F3},{6},{7},{8},{9}",
+                EntityLabel, IfcType, CreateMs, MeshMs, BooleanMs, TotalMs, Triangles, Faces, NativeBytes, Outcome);
+        }
+
+        public string ToJson()
+        {
+            return string.Format(CultureInfo.InvariantCulture,
+                "{{\"entityLabel\":{0},\"ifcType\":\"{1}\",\"createMs\":{2:F3},\"meshMs\":{3:F3},\"booleanMs\":{4:F3},\"triangles\":{5},\"faces\":{6},\"nativeBytes\":{7},\"outcome\":\"{8}\"}}",
+                EntityLabel, IfcType, CreateMs, MeshMs, BooleanMs, Triangles, Faces, NativeBytes, Outcome);
+        }
+    }
+
+    /// <summary>
+    /// Collects a record of the cost of each entity converted by the geometry engine, the methods may be called from any thread.
+    /// Nothing is measured unless an instance is supplied, e.g. to Xbim3DModelContext.Telemetry
+    /// </summary>
+    public class XbimGeometryTelemetry
+    {
+        private readonly ConcurrentDictionary<int, XbimGeometryTelemetryRecord> _records = new ConcurrentDictionary<int, XbimGeometryTelemetryRecord>();
+        private static readonly double TicksToMs = 1000.0 / Stopwatch.Frequency;
+
+        public IEnumerable<XbimGeometryTelemetryRecord> Records
+        {
+            get { return _records.Values; }
+        }
+
+        public int Count
+        {
+            get { return _records.Count; }
+        }
+
+        public void Clear()
+        {
+            _records.Clear();
+        }
+
+        /// <summary>
+        /// Marks the start of a stage
+        /// </summary>
+        public static XbimTelemetryMark Mark()
+        {
+            return new XbimTelemetryMark { Timestamp = Stopwatch.GetTimestamp(), NativeBytes = NativeBytesInUse() };
+        }
+
+        /// <summary>
+        /// Records the creation of the B-rep of the entity since the mark, returns a mark for the next stage
+        /// </summary>
+        public XbimTelemetryMark RecordCreate(IPersistEntity entity, XbimTelemetryMark start, bool succeeded)
+        {
+            var end = Mark();
+            var record = GetRecord(entity);
+            lock (record)
+            {
+                record.CreateMs += (end.Timestamp - start.Timestamp) * TicksToMs;
+                record.NativeBytes += end.NativeBytes - start.NativeBytes;
+                if (!succeeded) record.Outcome = XbimGeometryOutcome.Failed;
+            }
+            return end;
+        }
+
+        /// <summary>
+        /// Records the triangulation of the entity since the mark, the triangle and face counts are read from the binary shape data
+        /// </summary>
+        public XbimTelemetryMark RecordMesh(IPersistEntity entity, XbimTelemetryMark start, byte[] shapeData)
+        {
+            var end = Mark();
+            var record = GetRecord(entity);
+            CountTriangles(shapeData, out int triangles, out int faces);
+            lock (record)
+            {
+                record.MeshMs += (end.Timestamp - start.Timestamp) * TicksToMs;
+                record.NativeBytes += end.NativeBytes - start.NativeBytes;
+                record.Triangles += triangles;
+                record.Faces += faces;
+                if (triangles == 0 && record.Outcome == XbimGeometryOutcome.Success) record.Outcome = XbimGeometryOutcome.Empty;
+            }
+            return end;
+        }
+
+        /// <summary>
+        /// Records a boolean operation on the entity since the mark
+        /// </summary>
+        public XbimTelemetryMark RecordBoolean(IPersistEntity entity, XbimTelemetryMark start, XbimGeometryOutcome outcome)
+        {
+            var end = Mark();
+            var record = GetRecord(entity);
+            lock (record)
+            {
+                record.BooleanMs += (end.Timestamp - start.Timestamp) * TicksToMs;
+                record.NativeBytes += end.NativeBytes - start.NativeBytes;
+                if (outcome > record.Outcome) record.Outcome = outcome;
+            }
+            return end;
+        }
+
+        /// <summary>
+        /// The records with the longest total time, slowest first
+        /// </summary>
+        public IEnumerable<XbimGeometryTelemetryRecord> Slowest(int count)
+        {
+            return _records.Values.OrderByDescending(r => r.TotalMs).Take(count).ToList();
+        }
+
+        public void WriteCsv(TextWriter writer)
+        {
+            writer.WriteLine(XbimGeometryTelemetryRecord.CsvHeader);
+            foreach (var record in _records.Values.OrderBy(r => r.EntityLabel))
+                writer.WriteLine(record.ToCsv());
+        }
+
+        public void WriteJson(TextWriter writer)
+        {
+            writer.Write("[");
+            var first = true;
+            foreach (var record in _records.Values.OrderBy(r => r.EntityLabel))
+            {
+                if (!first) writer.Write(",");
+                writer.WriteLine();
+                writer.Write(record.ToJson());
+                first = false;
+            }
+            writer.WriteLine();
+            writer.WriteLine("]");
+        }
+
+        private XbimGeometryTelemetryRecord GetRecord(IPersistEntity entity)
+        {
+            return _records.GetOrAdd(entity.EntityLabel, label => new XbimGeometryTelemetryRecord
+            {
+                EntityLabel = label,
+                IfcType = entity.ExpressType.ExpressName
+            });
+        }
+
+        //the binary format starts with a version byte, the vertex and triangle counts, the vertices as floats and then the face count
+        private static void CountTriangles(byte[] shapeData, out int triangles, out int faces)
+        {
+            triangles = 0;
+            faces = 0;
+            if (shapeData == null || shapeData.Length < 9) return;
+            var vertices = BitConverter.ToInt32(shapeData, 1);
+            triangles = BitConverter.ToInt32(shapeData, 5);
+            var faceOffset = 9 + (long)vertices * 3 * sizeof(float);
+            if (faceOffset + sizeof(int) <= shapeData.Length)
+                faces = BitConverter.ToInt32(shapeData, (int)faceOffset);
+        }
+
+        /// <summary>
+        /// The private bytes of the process less the bytes held by the managed heap
+        /// </summary>
+        public static long NativeBytesInUse()
+        {
+            var counters = new ProcessMemoryCounters { Size = (uint)Marshal.SizeOf(typeof(ProcessMemoryCounters)) };
+            if (!GetProcessMemoryInfo(GetCurrentProcess(), ref counters, counters.Size))
+                return 0;
+            return (long)counters.PrivateUsage.ToUInt64() - GC.GetTotalMemory(false);
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct ProcessMemoryCounters
+        {
+            public uint Size;
+            public uint PageFaultCount;
+            public UIntPtr PeakWorkingSetSize;
+            public UIntPtr WorkingSetSize;
+            public UIntPtr QuotaPeakPagedPoolUsage;
+            public UIntPtr QuotaPagedPoolUsage;
+            public UIntPtr QuotaPeakNonPagedPoolUsage;
+            public UIntPtr QuotaNonPagedPoolUsage;
+            public UIntPtr PagefileUsage;
+            public UIntPtr PeakPagefileUsage;
+            public UIntPtr PrivateUsage;
+        }
+
+        [DllImport("kernel32.dll", EntryPoint = "K32GetProcessMemoryInfo")]
+        private static extern bool GetProcessMemoryInfo(IntPtr process, ref ProcessMemoryCounters counters, uint size);
+
+        [DllImport("kernel32.dll")]
+        private static extern IntPtr GetCurrentProcess();
+    }
+}
@@ -0,0 +1,127 @@
+﻿using System;
+using System.Collections.Concurrent;
+
+namespace Xbim.Geometry.Engine.Interop
+{
+    /// <summary>
+    /// A span opened by XbimGeometryTrace.Span, disposing it closes the span
+    /// </summary>
+    public struct XbimTraceSpan : IDisposable
+    {
+        private readonly bool _open;
+
+        internal XbimTraceSpan(bool open)
+        {
+            _open = open;
+        }
+
+        public void Dispose()
+        {
+            if (_open) XbimGeometryTrace.End();
+        }
+    }
+
+    /// <summary>
+    /// Records timed spans of the geometry pipeline on a ring buffer per thread. Managed spans and the native stages of the engine,
+    /// BRepMesh, BOPAlgo_BOP, ShapeFix and UnifySameDomain, share one timeline which is written as a Chrome trace event file
+    /// for chrome://tracing or https://ui.perfetto.dev. Nothing is recorded unless Start has been called, this is process wide
+    /// </summary>
+    public static class XbimGeometryTrace
+    {
+        private class Bridge
+        {
+            public readonly Action<int> Start;
+            public readonly Action Stop;
+            public readonly Action Clear;
+            public readonly Func<int> SpanCount;
+            public readonly Func<string, IntPtr> RegisterName;
+            public readonly Action<IntPtr> Begin;
+            public readonly Action End;
+            public readonly Func<string, bool> Write;
+
+            public Bridge(Type engineType)
+            {
+                Start = Create<Action<int>>(engineType, "StartTrace");
+                Stop = Create<Action>(engineType, "StopTrace");
+                Clear = Create<Action>(engineType, "ClearTrace");
+                SpanCount = (Func<int>)Delegate.CreateDelegate(typeof(Func<int>), engineType.GetProperty("TraceSpanCount").GetGetMethod());
+                RegisterName = Create<Func<string, IntPtr>>(engineType, "RegisterTraceName");
+                Begin = Create<Action<IntPtr>>(engineType, "BeginTraceSpan");
+                End = Create<Action>(engineType, "EndTraceSpan");
+                Write = Create<Func<string, bool>>(engineType, "WriteTrace");
+            }
+
+            private static T Create<T>(Type engineType, string methodName) where T : class
+            {
+                var method = engineType.GetMethod(methodName);
+                if (method == null)
+                    throw new MissingMethodException(engineType.FullName, methodName);
+                return Delegate.CreateDelegate(typeof(T), method) as T;
+            }
+        }
+
+        private static readonly Lazy<Bridge> _bridge = new Lazy<Bridge>(() => new Bridge(XbimGeometryEngine.LoadEngineType()));
+        // native copies of the span names, each name is marshalled once
+        private static readonly ConcurrentDictionary<string, IntPtr> _names = new ConcurrentDictionary<string, IntPtr>();
+        private static volatile bool _enabled;
+
+        public static bool Enabled
+        {
+            get { return _enabled; }
+        }
+
+        /// <summary>
+        /// Discards any previous spans and starts recording
+        /// </summary>
+        /// <param name="spansPerThread">the number of spans kept by each thread, older spans are overwritten</param>
+        public static void Start(int spansPerThread = 65536)
+        {
+            _bridge.Value.Start(spansPerThread);
+            _enabled = true;
+        }
+
+        public static void Stop()
+        {
+            _enabled = false;
+            _bridge.Value.Stop();
+        }
+
+        public static void Clear()
+        {
+            _bridge.Value.Clear();
+        }
+
+        /// <summary>
+        /// The number of spans held, spans overwritten by the ring buffers are not counted
+        /// </summary>
+        public static int SpanCount
+        {
+            get { return _bridge.Value.SpanCount(); }
+        }
+
+        /// <summary>
+        /// Opens a span on the calling thread, use in a using statement. Spans must be closed on the thread that opened them
+        /// </summary>
+        public static XbimTraceSpan Span(string name)
+        {
+            if (!_enabled) return default(XbimTraceSpan);
+            var bridge = _bridge.Value;
+            bridge.Begin(_names.GetOrAdd(name, bridge.RegisterName));
+            return new XbimTraceSpan(true);
+        }
+
+        internal static void End()
+        {
+            _bridge.Value.End();
+        }
+
+        /// <summary>
+        /// Writes the recorded spans as trace event JSON, call Stop first so that no thread is still recording
+        /// </summary>
+        /// <returns>false if the file could not be written</returns>
+        public static bool Write(string fileName)
+        {
+            return _bridge.Value.Write(fileName);
+        }
+    }
+}
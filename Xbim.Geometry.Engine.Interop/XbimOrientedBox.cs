@@ -0,0 +1,105 @@
+﻿using System;
+using System.Collections.Generic;
+using Xbim.Common.Geometry;
+
+namespace Xbim.Geometry.Engine.Interop
+{
+    /// <summary>
+    /// A box around a shape whose sides need not be parallel to the world axes, usually much tighter than the axis aligned bounding box
+    /// of a shape that is rotated in plan
+    /// </summary>
+    public class XbimOrientedBox
+    {
+        /// <summary>
+        /// The box from the 15 values the engine returns, the centre, the x, y and z directions and the half sizes
+        /// </summary>
+        public XbimOrientedBox(double[] values)
+        {
+            if (values == null || values.Length != 15)
+                throw new ArgumentException("An oriented box needs 15 values", nameof(values));
+            Centre = new XbimPoint3D(values[0], values[1], values[2]);
+            XAxis = new XbimVector3D(values[3], values[4], values[5]);
+            YAxis = new XbimVector3D(values[6], values[7], values[8]);
+            ZAxis = new XbimVector3D(values[9], values[10], values[11]);
+            HalfSizes = new XbimVector3D(values[12], values[13], values[14]);
+        }
+
+        public XbimPoint3D Centre { get; }
+        /// <summary>
+        /// The unit directions of the sides of the box
+        /// </summary>
+        public XbimVector3D XAxis { get; }
+        public XbimVector3D YAxis { get; }
+        public XbimVector3D ZAxis { get; }
+        /// <summary>
+        /// Half the length of the box along each of its axes
+        /// </summary>
+        public XbimVector3D HalfSizes { get; }
+
+        public double Volume
+        {
+            get { return 8 * HalfSizes.X * HalfSizes.Y * HalfSizes.Z; }
+        }
+
+        /// <summary>
+        /// The eight corners of the box
+        /// </summary>
+        public IEnumerable<XbimPoint3D> Corners()
+        {
+            for (var i = 0; i < 8; i++)
+            {
+                var x = XbimVector3D.Multiply((i & 1) == 0 ? -HalfSizes.X : HalfSizes.X, XAxis);
+                var y = XbimVector3D.Multiply((i & 2) == 0 ? -HalfSizes.Y : HalfSizes.Y, YAxis);
+                var z = XbimVector3D.Multiply((i & 4) == 0 ? -HalfSizes.Z : HalfSizes.Z, ZAxis);
+                yield return Centre + x + y + z;
+            }
+        }
+
+        /// <summary>
+        /// True if the point is inside the box or within the tolerance of it
+        /// </summary>
+        public bool Contains(XbimPoint3D point, double tolerance = 0)
+        {
+            var offset = point - Centre;
+            return Math.Abs(XbimVector3D.DotProduct(offset, XAxis)) <= HalfSizes.X + tolerance &&
+                Math.Abs(XbimVector3D.DotProduct(offset, YAxis)) <= HalfSizes.Y + tolerance &&
+                Math.Abs(XbimVector3D.DotProduct(offset, ZAxis)) <= HalfSizes.Z + tolerance;
+        }
+
+        /// <summary>
+        /// True if the boxes overlap or come within the tolerance of each other, tested on the separating axes of the two boxes
+        /// </summary>
+        public bool Intersects(XbimOrientedBox other, double tolerance = 0)
+        {
+            var axes = new List<XbimVector3D> { XAxis, YAxis, ZAxis, other.XAxis, other.YAxis, other.ZAxis };
+            foreach (var a in new[] { XAxis, YAxis, ZAxis })
+                foreach (var b in new[] { other.XAxis, other.YAxis, other.ZAxis })
+                {
+                    //parallel edges give no axis, the face axes already cover them
+                    var cross = XbimVector3D.CrossProduct(a, b);
+                    if (cross.Length > 1e-9)
+                        axes.Add(cross.Normalized());
+                }
+            var between = other.Centre - Centre;
+            foreach (var axis in axes)
+            {
+                if (Math.Abs(XbimVector3D.DotProduct(between, axis)) > Radius(axis) + other.Radius(axis) + tolerance)
+                    return false;
+            }
+            return true;
+        }
+
+        //half the length of the box projected onto the axis
+        private double Radius(XbimVector3D axis)
+        {
+            return HalfSizes.X * Math.Abs(XbimVector3D.DotProduct(XAxis, axis)) +
+                HalfSizes.Y * Math.Abs(XbimVector3D.DotProduct(YAxis, axis)) +
+                HalfSizes.Z * Math.Abs(XbimVector3D.DotProduct(ZAxis, axis));
+        }
+
+        public override string ToString()
+        {
+            return $"Centre {Centre}, half sizes {HalfSizes.X:F3} x {HalfSizes.Y:F3} x {HalfSizes.Z:F3}";
+        }
+    }
+}
@@ -377,7 +377,9 @@ void BRepFill_OffsetWire::Init(const TopoDS_Face&     Spine,
   // cut the spine for bissectors.
   //------------------------------------------------------------------
   //  Modified by Sergey KHROMOV - Tue Nov 26 17:39:03 2002 Begin
-  static BRepMAT2d_Explorer Exp;
+  // xbim: a local explorer rather than a static one, so that offsets can be made on several threads at once.
+  // The bisecting locus and the links copy what they need from it
+  BRepMAT2d_Explorer Exp;
 
   Exp.Perform(mySpine);
 
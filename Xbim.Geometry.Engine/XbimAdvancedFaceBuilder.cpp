@@ -0,0 +1,105 @@
+#include "XbimAdvancedFaceBuilder.h"
+#include "XbimCancellation.h"
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <Geom_Plane.hxx>
+#include <Geom2d_Curve.hxx>
+#include <OSD_Parallel.hxx>
+#include <ShapeAnalysis_Edge.hxx>
+#include <ShapeFix_Edge.hxx>
+#include <TopoDS.hxx>
+#include <TopTools_MapOfShape.hxx>
+#include <vector>
+
+namespace
+{
+	//one edge to project onto the surface of one face, the pcurve is left null if the projection is not to be used
+	struct Projection
+	{
+		TopoDS_Edge edge;
+		Handle(Geom_Surface) surface;
+		TopLoc_Location location;
+		TopoDS_Face face;
+		Handle(Geom2d_Curve) pcurve;
+	};
+
+	class ProjectionFunctor
+	{
+	public:
+		ProjectionFunctor(std::vector<Projection>& projections, XbimCancellationContext* context) : projections(projections), context(context) {}
+
+		void operator()(int index) const
+		{
+			//the context belongs to the calling thread, its flag and deadline may be read from any thread while it is entered
+			if (context != nullptr && (context->IsCancelled() || context->IsExpired()))
+				return;
+			Projection& projection = projections[index];
+			try
+			{
+				//FixAddPCurve adds the pcurve to the edge it is given, the shared edge is copied so that no other thread sees it change.
+				//The copy shares the 3D curve and carries the tolerances of the edge and its vertices, which steer the projection
+				TopoDS_Edge local = TopoDS::Edge(BRepBuilderAPI_Copy(projection.edge, Standard_False).Shape());
+				ShapeFix_Edge edgeFixer;
+				edgeFixer.FixAddPCurve(local, projection.face, false);
+				Standard_Real first, last;
+				TopLoc_Location curveLocation;
+				Handle(Geom_Curve) curve = BRep_Tool::Curve(projection.edge, curveLocation, first, last);
+				//the projector replaces the 3D curve when it cannot fit the pcurve to it, that must happen on the shared edge
+				if (BRep_Tool::Curve(local, curveLocation, first, last) != curve)
+					return;
+				projection.pcurve = BRep_Tool::CurveOnSurface(local, projection.surface, projection.location, first, last);
+			}
+			catch (const Standard_Failure&)
+			{
+				projection.pcurve.Nullify();
+			}
+		}
+
+	private:
+		std::vector<Projection>& projections;
+		XbimCancellationContext* context;
+	};
+}
+
+int XbimAdvancedFaceBuilder::AddPCurves(const TopoDS_Face* faces, const TopoDS_Edge* edges, const int* faceIndices, int count, bool runParallel)
+{
+	//the checks FixAddPCurve makes before it projects, each edge is projected once per face however often the face uses it
+	std::vector<Projection> projections;
+	std::vector<TopTools_MapOfShape> projected;
+	ShapeAnalysis_Edge edgeAnalyser;
+	for (int i = 0; i < count; ++i)
+	{
+		int faceIndex = faceIndices[i];
+		if ((int)projected.size() <= faceIndex)
+			projected.resize(faceIndex + 1);
+		if (!projected[faceIndex].Add(edges[i]))
+			continue;
+		Projection projection;
+		projection.face = faces[faceIndex];
+		projection.surface = BRep_Tool::Surface(projection.face, projection.location);
+		if (projection.surface.IsNull() || projection.surface->IsKind(STANDARD_TYPE(Geom_Plane)))
+			continue;
+		if (edgeAnalyser.HasPCurve(edges[i], projection.surface, projection.location))
+			continue;
+		projection.edge = edges[i];
+		projections.push_back(projection);
+	}
+	if (projections.empty())
+		return 0;
+
+	ProjectionFunctor functor(projections, XbimCancellation::Current());
+	OSD_Parallel::For(0, (int)projections.size(), functor, !runParallel || projections.size() < 2);
+
+	//in the order of the faces, as the serial build adds them, a face that uses an edge twice gets its pcurve once
+	BRep_Builder builder;
+	int added = 0;
+	for (const Projection& projection : projections)
+	{
+		if (projection.pcurve.IsNull() || edgeAnalyser.HasPCurve(projection.edge, projection.surface, projection.location))
+			continue;
+		builder.UpdateEdge(projection.edge, projection.pcurve, projection.surface, projection.location, 0.);
+		added++;
+	}
+	return added;
+}
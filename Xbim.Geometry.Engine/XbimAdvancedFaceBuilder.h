@@ -0,0 +1,18 @@
+#pragma once
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Edge.hxx>
+
+//The parallel part of XbimCompound::InitAdvancedFaces. The edges of an advanced brep are shared by the faces that bound them, so the
+//faces cannot be built on separate threads, but projecting each edge onto the surface of each face, the slow part for B-Spline
+//surfaces, only reads them. The projections are made on OCC's thread pool against face local copies of the edges and the pcurves
+//are then added to the shared edges on the calling thread. The header is included by /clr code so it takes plain arrays, the
+//implementation is compiled natively
+class XbimAdvancedFaceBuilder
+{
+public:
+	//adds the pcurve of edges[i] on faces[faceIndices[i]] for each i, as ShapeFix_Edge::FixAddPCurve would one at a time. Edges
+	//that already have a pcurve on the face, or whose face is planar, are left as they are, as are edges whose projection failed
+	//or would replace the 3D curve, the serial FixAddPCurve that follows deals with those. The projections stop if the cancellation
+	//context of the calling thread is cancelled or expires. Returns the number of pcurves added
+	static int AddPCurves(const TopoDS_Face* faces, const TopoDS_Edge* edges, const int* faceIndices, int count, bool runParallel);
+};
@@ -0,0 +1,78 @@
+#include "XbimCancellation.h"
+#include <windows.h>
+
+namespace
+{
+	thread_local XbimCancellationContext* currentContext = nullptr;
+
+	long long Now()
+	{
+		LARGE_INTEGER ticks;
+		QueryPerformanceCounter(&ticks);
+		return ticks.QuadPart;
+	}
+}
+
+bool XbimCancellationContext::IsCancelled() const
+{
+	for (const XbimCancellationContext* context = this; context != nullptr; context = context->parent)
+		if (context->cancelled) return true;
+	return false;
+}
+
+bool XbimCancellationContext::IsExpired() const
+{
+	long long now = 0;
+	for (const XbimCancellationContext* context = this; context != nullptr; context = context->parent)
+	{
+		if (context->deadline == 0) continue;
+		if (now == 0) now = Now();
+		if (now > context->deadline) return true;
+	}
+	return false;
+}
+
+XbimCancellationContext* XbimCancellation::Current()
+{
+	return currentContext;
+}
+
+XbimCancellationContext* XbimCancellation::Enter(double budgetSeconds)
+{
+	XbimCancellationContext* context = new XbimCancellationContext();
+	if (budgetSeconds > 0)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		context->deadline = Now() + (long long)(budgetSeconds * frequency.QuadPart);
+	}
+	context->parent = currentContext;
+	currentContext = context;
+	return context;
+}
+
+void XbimCancellation::Leave(XbimCancellationContext* context)
+{
+	if (context == nullptr) return;
+	if (currentContext == context)
+		currentContext = context->parent;
+	delete context;
+}
+
+void XbimCancellation::Cancel(XbimCancellationContext* context)
+{
+	if (context != nullptr) context->cancelled = true;
+}
+
+bool XbimCancellation::RunParallel()
+{
+	for (const XbimCancellationContext* context = currentContext; context != nullptr; context = context->parent)
+		if (context->runParallel) return true;
+	return false;
+}
+
+bool XbimCancellation::Cancelled()
+{
+	XbimCancellationContext* context = currentContext;
+	return context != nullptr && (context->IsCancelled() || context->IsExpired());
+}
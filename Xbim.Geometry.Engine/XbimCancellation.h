@@ -0,0 +1,42 @@
+#pragma once
+#include <Standard_Failure.hxx>
+
+//A cancellation flag and an optional deadline shared by the OCC algorithms run on behalf of one job or product.
+//Contexts are entered and left on the thread that runs the work and nest, a nested context is cancelled when its parent is.
+//The header is included by /clr code so it must not pull in <atomic>, the implementation is compiled natively
+class XbimCancellationContext
+{
+public:
+	volatile bool cancelled;
+	//QueryPerformanceCounter ticks, 0 for no deadline
+	long long deadline;
+	//the OCC algorithms of the job may spread their work over several threads
+	bool runParallel;
+	XbimCancellationContext* parent;
+
+	XbimCancellationContext() : cancelled(false), deadline(0), runParallel(false), parent(nullptr) {}
+	//true if this context or any parent has been cancelled
+	bool IsCancelled() const;
+	//true if the deadline of this context or any parent has passed
+	bool IsExpired() const;
+};
+
+class XbimCancellation
+{
+public:
+	//the innermost context entered on the calling thread, null if there is none
+	static XbimCancellationContext* Current();
+	//creates a context nested in the current one and makes it current, budgetSeconds <= 0 sets no deadline
+	static XbimCancellationContext* Enter(double budgetSeconds);
+	//restores the parent of the context and deletes it, must be called on the thread that entered it
+	static void Leave(XbimCancellationContext* context);
+	//may be called from any thread while the context is entered
+	static void Cancel(XbimCancellationContext* context);
+	//true if the current context of the calling thread is cancelled or expired
+	static bool Cancelled();
+	//true if the current context of the calling thread, or any parent, allows its algorithms to run in parallel
+	static bool RunParallel();
+};
+
+//for OCC algorithms that take no progress indicator in this version, e.g. BRepOffsetAPI_MakePipeShell, the check is made before they run
+#define XBIM_THROW_IF_CANCELLED() if (XbimCancellation::Cancelled()) throw Standard_Failure("Geometry operation cancelled")
@@ -0,0 +1,59 @@
+#pragma once
+#include "XbimCancellation.h"
+
+using namespace System;
+using namespace System::Threading;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		//enters a native cancellation context on the calling thread and cancels it when the token is cancelled.
+		//Every XbimProgressMonitor created on the thread while the scope is open stops its algorithm when the token is
+		//cancelled or the budget is spent. Dispose on the thread that created the scope
+		ref class XbimCancellationScope : IDisposable
+		{
+		private:
+			XbimCancellationContext* context;
+			CancellationTokenRegistration registration;
+			bool registered;
+
+			void Cancel()
+			{
+				XbimCancellation::Cancel(context);
+			}
+
+			void Init(CancellationToken token, double budgetSeconds, bool runParallel)
+			{
+				context = XbimCancellation::Enter(budgetSeconds);
+				context->runParallel = runParallel;
+				if (token.CanBeCanceled)
+				{
+					registration = token.Register(gcnew Action(this, &XbimCancellationScope::Cancel));
+					registered = true;
+				}
+			}
+
+		public:
+			XbimCancellationScope(CancellationToken token, double budgetSeconds)
+			{
+				Init(token, budgetSeconds, false);
+			}
+
+			//runParallel lets the booleans run in the scope use several threads
+			XbimCancellationScope(CancellationToken token, double budgetSeconds, bool runParallel)
+			{
+				Init(token, budgetSeconds, runParallel);
+			}
+
+			~XbimCancellationScope()
+			{
+				//disposing the registration waits for a callback running on another thread, the context is then safe to delete
+				if (registered) delete safe_cast<IDisposable^>(registration);
+				registered = false;
+				XbimCancellation::Leave(context);
+				context = nullptr;
+			}
+		};
+	}
+}
@@ -5,9 +5,13 @@
 #include "XbimSolidSet.h"
 #include "XbimShellSet.h"
 #include "XbimFaceSet.h"
+#include "XbimTraceRecorder.h"
+#include "XbimProgressMonitor.h"
 #include "XbimEdgeSet.h"
 #include "XbimVertexSet.h"
 #include "XbimConvert.h"
+#include "XbimCoordinates.h"
+#include "XbimAdvancedFaceBuilder.h"
 #include "XbimGeometryObjectSet.h"
 #include <BRep_Builder.hxx>
 #include <BRepBuilderAPI_Sewing.hxx>
@@ -72,6 +76,7 @@
 #include <BRepTools_WireExplorer.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepFill.hxx>
+#include <vector>
 // #include <ShapeBuild_ReShape.hxx> // this was suggeste in PR79 - but it does not seem to make the difference with OCC72
 
 using namespace System;
@@ -81,6 +86,25 @@ using namespace Xbim::Common::XbimExtensions;
 using namespace Xbim::Ifc4::Interfaces;
 using namespace System::Diagnostics;
 
+namespace
+{
+	//a bound of an advanced face, its edges are the shared edges oriented as the bound uses them
+	struct AdvancedFaceLoop
+	{
+		TopTools_SequenceOfShape edges;
+		bool isOuter;
+		bool reversed;
+	};
+
+	//an advanced face as read from the model, the surface is reversed if the face has the opposite sense
+	struct AdvancedFacePlan
+	{
+		TopoDS_Face surface;
+		bool buildRuledSurface;
+		std::vector<AdvancedFaceLoop> loops;
+	};
+}
+
 namespace Xbim
 {
 	namespace Geometry
@@ -96,6 +120,8 @@ namespace Xbim
 			IntPtr temp = System::Threading::Interlocked::Exchange(ptrContainer, IntPtr::Zero);
 			if (temp != IntPtr::Zero)
 				delete (TopoDS_Compound*)(temp.ToPointer());
+			ReleaseBounds();
+			ReleaseMemoryPressure();
 			System::GC::SuppressFinalize(this);
 		}
 
@@ -207,52 +233,61 @@ namespace Xbim
 		{
 			_sewingTolerance = faceSet->Model->ModelFactors->Precision;
 			Init(faceSet, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(IIfcShellBasedSurfaceModel^ sbsm, ILogger^ logger)
 		{
 			_sewingTolerance = sbsm->Model->ModelFactors->Precision;
 			Init(sbsm, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(IIfcFaceBasedSurfaceModel^ fbsm, ILogger^ logger)
 		{
 			_sewingTolerance = fbsm->Model->ModelFactors->Precision;
 			Init(fbsm, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(IIfcManifoldSolidBrep^ solid, ILogger^ logger)
 		{
 			_sewingTolerance = solid->Model->ModelFactors->Precision;
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 		XbimCompound::XbimCompound(IIfcFacetedBrep^ solid, ILogger^ logger)
 		{
 			_sewingTolerance = solid->Model->ModelFactors->Precision;
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(IIfcFacetedBrepWithVoids^ solid, ILogger^ logger)
 		{
 			_sewingTolerance = solid->Model->ModelFactors->Precision;
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 		XbimCompound::XbimCompound(IIfcAdvancedBrep^ solid, ILogger^ logger)
 		{
 			_sewingTolerance = solid->Model->ModelFactors->Precision;
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(IIfcAdvancedBrepWithVoids^ solid, ILogger^ logger)
 		{
 			_sewingTolerance = solid->Model->ModelFactors->Precision;
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(IIfcClosedShell^ solid, ILogger^ logger)
 		{
 			_sewingTolerance = solid->Model->ModelFactors->Precision;
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(const TopoDS_Compound& compound, bool sewn, double tolerance)
@@ -261,7 +296,6 @@ namespace Xbim
 			*pCompound = compound;
 			_isSewn = sewn;
 			_sewingTolerance = tolerance;
-
 		}
 		XbimCompound::XbimCompound(const TopoDS_Compound& compound, bool sewn, double tolerance, Object^ tag) :XbimCompound(compound, sewn, tolerance)
 		{
@@ -322,6 +356,7 @@ namespace Xbim
 		{
 			_sewingTolerance = faceSet->Model->ModelFactors->Precision;
 			Init(faceSet, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimCompound::XbimCompound(IIfcPolygonalFaceSet^ faceSet, ILogger^ logger)
@@ -341,6 +376,7 @@ namespace Xbim
 			BRep_Builder builder;
 			builder.MakeCompound(*pCompound);
 			builder.Add(*pCompound, shape);
+			UpdateMemoryPressure();
 		}
 
 #pragma region Initialisers
@@ -719,41 +755,46 @@ namespace Xbim
 
 				TopTools_DataMapOfIntegerShape edgeCurves;
 				TopTools_DataMapOfIntegerShape vertexGeometries;
+				//the faces read from the model, advancedFaces holds the entity of each plan
+				std::vector<AdvancedFacePlan> facePlans;
+				List<IIfcAdvancedFace^>^ advancedFaces = gcnew List<IIfcAdvancedFace^>();
 
 				//XbimGeometryCreator::LogTrace(logger, aFace, "Enumerating {0} faces for IfcAdvancedBrep", Enumerable::Count(faces));
 
+				//read the surfaces and the shared edges on the calling thread, they come from the model
 				for each (IIfcFace ^ unloadedFace in  faces)
 				{
 					IIfcAdvancedFace^ advancedFace = dynamic_cast<IIfcAdvancedFace^>(model->Instances[unloadedFace->EntityLabel]); //improves performance and reduces memory load								
-					TopoDS_Wire topoOuterLoop;
-					TopTools_SequenceOfShape  topoInnerLoops;
 					TopoDS_Face topoAdvancedFace;
 					int numberOfBounds = advancedFace->Bounds->Count;
 					//workaround for badly defined linear extrusions in old Revit files
 					IIfcSurfaceOfLinearExtrusion^ solExtrusion = dynamic_cast<IIfcSurfaceOfLinearExtrusion^>(advancedFace->FaceSurface);
 
-					bool buildRuledSurface = (solExtrusion != nullptr);
-					BRepBuilderAPI_MakeFace faceMaker;
-
 					XbimFace^ xAdvancedFace = gcnew XbimFace(advancedFace->FaceSurface, logger);
 					if (!xAdvancedFace->IsValid)
 					{
-						XbimGeometryCreator::LogWarning(logger, advancedFace->FaceSurface, "Failed to create face surface #{0}", advancedFace->FaceSurface->EntityLabel);
+						XBIM_LOG_WARNING(logger, advancedFace->FaceSurface, "Failed to create face surface #{0}", advancedFace->FaceSurface->EntityLabel);
 						continue;
 					}
 					topoAdvancedFace = xAdvancedFace;
 					if (!advancedFace->SameSense)
 						topoAdvancedFace.Reverse();
-					faceMaker.Init(topoAdvancedFace);
+					facePlans.emplace_back();
+					AdvancedFacePlan& facePlan = facePlans.back();
+					facePlan.surface = topoAdvancedFace;
+					facePlan.buildRuledSurface = (solExtrusion != nullptr);
+					advancedFaces->Add(advancedFace);
 
-					for each (IIfcFaceBound ^ ifcBound in advancedFace->Bounds) //build all the loops
+					for each (IIfcFaceBound ^ ifcBound in advancedFace->Bounds) //read all the loops
 					{
-						TopTools_SequenceOfShape loopEdges;
-						bool isOuter = (numberOfBounds == 1) || (dynamic_cast<IIfcFaceOuterBound^>(ifcBound) != nullptr);
 						IIfcEdgeLoop^ edgeLoop = dynamic_cast<IIfcEdgeLoop^>(ifcBound->Bound);
 
 						if (edgeLoop != nullptr) //they always should be
 						{
+							facePlan.loops.emplace_back();
+							AdvancedFaceLoop& loop = facePlan.loops.back();
+							loop.isOuter = (numberOfBounds == 1) || (dynamic_cast<IIfcFaceOuterBound^>(ifcBound) != nullptr);
+							loop.reversed = !ifcBound->Orientation;
 
 							for each (IIfcOrientedEdge ^ orientedEdge in edgeLoop->EdgeList)
 							{
@@ -790,7 +831,7 @@ namespace Xbim
 									XbimCurve^ curve = gcnew XbimCurve(edgeCurve->EdgeGeometry, logger);
 									if (!curve->IsValid)
 									{
-										XbimGeometryCreator::LogWarning(logger, edgeCurve, "Failed to create edge #{0} with zero length. It has been ignored", edgeCurve->EntityLabel);
+										XBIM_LOG_WARNING(logger, edgeCurve, "Failed to create edge #{0} with zero length. It has been ignored", edgeCurve->EntityLabel);
 										continue;
 									}
 									Handle(Geom_Curve) sharedEdgeGeom = curve;
@@ -811,13 +852,13 @@ namespace Xbim
 
 										if (!foundP1) //assume before the start of the curve
 										{
-											XbimGeometryCreator::LogWarning(logger, edgeCurve, "Failed to project vertex to edge geometry: #{0}, start point assumed", edgeCurve->EdgeGeometry->EntityLabel);
+											XBIM_LOG_WARNING(logger, edgeCurve, "Failed to project vertex to edge geometry: #{0}, start point assumed", edgeCurve->EdgeGeometry->EntityLabel);
 											trimParam1 = sharedEdgeGeom->FirstParameter();
 											trim1Tolerance = _sewingTolerance;
 										}
 										if (!foundP2) //assume before the start of the curve
 										{
-											XbimGeometryCreator::LogWarning(logger, edgeCurve, "Failed to project vertex to edge geometry: #{0}, start point assumed", edgeCurve->EdgeGeometry->EntityLabel);
+											XBIM_LOG_WARNING(logger, edgeCurve, "Failed to project vertex to edge geometry: #{0}, start point assumed", edgeCurve->EdgeGeometry->EntityLabel);
 											trimParam2 = sharedEdgeGeom->LastParameter();
 											trim2Tolerance = _sewingTolerance;
 										}
@@ -837,25 +878,25 @@ namespace Xbim
 											{
 
 											case BRepBuilderAPI_PointProjectionFailed:
-												XbimGeometryCreator::LogDebug(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_PointProjectionFailed", edgeCurve->EntityLabel);
+												XBIM_LOG_DEBUG(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_PointProjectionFailed", edgeCurve->EntityLabel);
 												break;
 											case BRepBuilderAPI_ParameterOutOfRange:
-												XbimGeometryCreator::LogDebug(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_ParameterOutOfRange", edgeCurve->EntityLabel);
+												XBIM_LOG_DEBUG(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_ParameterOutOfRange", edgeCurve->EntityLabel);
 												break;
 											case BRepBuilderAPI_DifferentPointsOnClosedCurve:
-												XbimGeometryCreator::LogDebug(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_DifferentPointsOnClosedCurve", edgeCurve->EntityLabel);
+												XBIM_LOG_DEBUG(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_DifferentPointsOnClosedCurve", edgeCurve->EntityLabel);
 												break;
 											case BRepBuilderAPI_PointWithInfiniteParameter:
-												XbimGeometryCreator::LogDebug(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_PointWithInfiniteParameter", edgeCurve->EntityLabel);
+												XBIM_LOG_DEBUG(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_PointWithInfiniteParameter", edgeCurve->EntityLabel);
 												break;
 											case BRepBuilderAPI_DifferentsPointAndParameter:
-												XbimGeometryCreator::LogDebug(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_DifferentsPointAndParameter", edgeCurve->EntityLabel);
+												XBIM_LOG_DEBUG(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_DifferentsPointAndParameter", edgeCurve->EntityLabel);
 												break;
 											case BRepBuilderAPI_LineThroughIdenticPoints:
-												XbimGeometryCreator::LogDebug(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_LineThroughIdenticPoints", edgeCurve->EntityLabel);
+												XBIM_LOG_DEBUG(logger, edgeCurve, "Failed to create edge #{0}: BRepBuilderAPI_LineThroughIdenticPoints", edgeCurve->EntityLabel);
 												break;
 											default:
-												XbimGeometryCreator::LogDebug(logger, edgeCurve, "Failed to create edge #{0}: Unknown error", edgeCurve->EntityLabel);
+												XBIM_LOG_DEBUG(logger, edgeCurve, "Failed to create edge #{0}: Unknown error", edgeCurve->EntityLabel);
 												break;
 											}
 											continue; //carry on and try and ignore, no sensible fall back at this point
@@ -885,52 +926,90 @@ namespace Xbim
 
 								}
 
-								if (!buildRuledSurface)
-									edgeFixer.FixAddPCurve(topoEdgeCurve, topoAdvancedFace, false); //add pcurves								
-
-								loopEdges.Append(topoEdgeCurve);
+								loop.edges.Append(topoEdgeCurve);
 
 							}
+						}
+					}
+				}
 
+				//project the edges onto the surfaces of their faces, for B-Spline surfaces this is most of the work and it may run in parallel
+				std::vector<TopoDS_Face> projectionFaces;
+				std::vector<TopoDS_Edge> projectionEdges;
+				std::vector<int> projectionFaceIndices;
+				for (int faceIndex = 0; faceIndex < (int)facePlans.size(); faceIndex++)
+				{
+					const AdvancedFacePlan& facePlan = facePlans[faceIndex];
+					projectionFaces.push_back(facePlan.surface);
+					if (facePlan.buildRuledSurface) continue; //the surface is replaced when the face is built
+					for (const AdvancedFaceLoop& loop : facePlan.loops)
+					{
+						for (auto it = loop.edges.cbegin(); it != loop.edges.cend(); it++)
+						{
+							projectionEdges.push_back(TopoDS::Edge(*it));
+							projectionFaceIndices.push_back(faceIndex);
+						}
+					}
+				}
+				if (projectionEdges.size() > 0)
+				{
+					XBIM_TRACE_SCOPE("AddPCurves");
+					XbimAdvancedFaceBuilder::AddPCurves(projectionFaces.data(), projectionEdges.data(), projectionFaceIndices.data(), (int)projectionEdges.size(), XbimGeometryCreator::ParallelAdvancedFaces);
+				}
 
-							TopoDS_Wire loopWire;
-							builder.MakeWire(loopWire);
+				//build the loops and faces in the order of the model, they change the shared edges and vertices so they stay on the calling thread
+				for (int faceIndex = 0; faceIndex < (int)facePlans.size(); faceIndex++)
+				{
+					const AdvancedFacePlan& facePlan = facePlans[faceIndex];
+					IIfcAdvancedFace^ advancedFace = advancedFaces[faceIndex];
+					TopoDS_Wire topoOuterLoop;
+					TopTools_SequenceOfShape  topoInnerLoops;
+					TopoDS_Face topoAdvancedFace = facePlan.surface;
+					bool buildRuledSurface = facePlan.buildRuledSurface;
+					BRepBuilderAPI_MakeFace faceMaker;
+					faceMaker.Init(topoAdvancedFace);
 
-							for (auto it = loopEdges.cbegin(); it != loopEdges.cend(); it++)
-							{
-								builder.Add(loopWire, *it);
-							}
+					for (const AdvancedFaceLoop& loop : facePlan.loops) //build all the loops
+					{
+						TopoDS_Wire loopWire;
+						builder.MakeWire(loopWire);
 
-							ShapeFix_Wire wireFixer(loopWire, topoAdvancedFace, _sewingTolerance);
-							if (wireFixer.FixReorder())
-								loopWire = wireFixer.Wire();
-							loopWire.Closed(true);
-							BRepCheck_Analyzer analyser(loopWire, Standard_True);
+						for (auto it = loop.edges.cbegin(); it != loop.edges.cend(); it++)
+						{
+							TopoDS_Edge topoEdgeCurve = TopoDS::Edge(*it);
+							if (!buildRuledSurface)
+								edgeFixer.FixAddPCurve(topoEdgeCurve, topoAdvancedFace, false); //adds any pcurve the projections did not
+							builder.Add(loopWire, topoEdgeCurve);
+						}
 
-							if (!analyser.IsValid())
-							{
-								ShapeFix_Wire sfw(loopWire, topoAdvancedFace, _sewingTolerance);
-								if (sfw.Perform())
-								{
-									loopWire = sfw.Wire();
-									loopWire.Checked(true);
-								}
-							}
-							else
-								loopWire.Checked(true);
+						ShapeFix_Wire wireFixer(loopWire, topoAdvancedFace, _sewingTolerance);
+						if (wireFixer.FixReorder())
+							loopWire = wireFixer.Wire();
+						loopWire.Closed(true);
+						BRepCheck_Analyzer analyser(loopWire, Standard_True);
 
-							if (!ifcBound->Orientation)
+						if (!analyser.IsValid())
+						{
+							ShapeFix_Wire sfw(loopWire, topoAdvancedFace, _sewingTolerance);
+							if (sfw.Perform())
 							{
-								loopWire.Reverse();
+								loopWire = sfw.Wire();
+								loopWire.Checked(true);
 							}
+						}
+						else
+							loopWire.Checked(true);
 
-							if (isOuter)
-								topoOuterLoop = loopWire;
-							else
-							{
-								topoInnerLoops.Append(loopWire);
-							}
+						if (loop.reversed)
+						{
+							loopWire.Reverse();
+						}
 
+						if (loop.isOuter)
+							topoOuterLoop = loopWire;
+						else
+						{
+							topoInnerLoops.Append(loopWire);
 						}
 					}
 					//XbimGeometryCreator::LogDebug(logger, xAdvancedFace, "Face Bounds built");
@@ -1067,7 +1146,7 @@ namespace Xbim
 								TopoDS_Wire innerWire = TopoDS::Wire(*it);
 								faceMaker.Add(innerWire);
 								if (!faceMaker.IsDone())
-									XbimGeometryCreator::LogWarning(logger, advancedFace, "Could not apply inner bound to face #{0}, it has been ignored", advancedFace->EntityLabel);
+									XBIM_LOG_WARNING(logger, advancedFace, "Could not apply inner bound to face #{0}, it has been ignored", advancedFace->EntityLabel);
 							}
 
 							ShapeFix_Face fixFaceWire(faceMaker.Face());
@@ -1077,7 +1156,7 @@ namespace Xbim
 						catch (Standard_Failure sf)
 						{
 							String^ err = gcnew String(sf.GetMessageString());
-							XbimGeometryCreator::LogWarning(logger, advancedFace, "Could not apply  bound to face #{0}: {1}, it has been ignored", advancedFace->EntityLabel, err);
+							XBIM_LOG_WARNING(logger, advancedFace, "Could not apply  bound to face #{0}: {1}, it has been ignored", advancedFace->EntityLabel, err);
 						}
 					}
 
@@ -1087,8 +1166,10 @@ namespace Xbim
 						BRepCheck_Analyzer analyser(topoAdvancedFace, Standard_False);
 						if (!analyser.IsValid())
 						{
+							XBIM_TRACE_SCOPE("ShapeFix");
 							ShapeFix_Shape sfs(topoAdvancedFace);
-							if (sfs.Perform())
+							Handle(XbimProgressMonitor) pi = new XbimProgressMonitor();
+							if (sfs.Perform(pi))
 							{
 								topoAdvancedFace = TopoDS::Face(sfs.Shape());
 								topoAdvancedFace.Checked(true);
@@ -1099,7 +1180,7 @@ namespace Xbim
 					}
 					catch (Standard_Failure sf)
 					{
-						XbimGeometryCreator::LogDebug(logger, unloadedFace, "Fixing Face Failed");
+						XBIM_LOG_DEBUG(logger, advancedFace, "Fixing Face Failed");
 					}
 
 
@@ -1115,7 +1196,7 @@ namespace Xbim
 					if (!XbimNativeApi::FixShell(shell, 10, errMsg))
 					{
 						String^ err = gcnew String(errMsg.c_str());
-						XbimGeometryCreator::LogWarning(logger, nullptr, "Failed to fix shell in advanced brep: " + err);
+						XBIM_LOG_WARNING(logger, nullptr, "Failed to fix shell in advanced brep: " + err);
 					}
 					else
 						checker.Init(shell);
@@ -1134,7 +1215,7 @@ namespace Xbim
 						if (!XbimNativeApi::FixShape(shape, 10, errMsg))
 						{
 							String^ err = gcnew String(errMsg.c_str());
-							XbimGeometryCreator::LogWarning(logger, nullptr, "InitAdvancedFaces: Failed to fix shape: " + err);
+							XBIM_LOG_WARNING(logger, nullptr, "InitAdvancedFaces: Failed to fix shape: " + err);
 						}
 						return shape;
 					}
@@ -1151,7 +1232,7 @@ namespace Xbim
 			catch (Standard_Failure exc)
 			{
 				String^ err = gcnew String(exc.GetMessageString());
-				XbimGeometryCreator::LogWarning(logger, nullptr, "General failure in advanced face building: " + err);
+				XBIM_LOG_WARNING(logger, nullptr, "General failure in advanced face building: " + err);
 				return shell;
 			}
 
@@ -1182,31 +1263,47 @@ namespace Xbim
 			TopoDS_Shell shell;
 			builder.MakeShell(shell);
 			int faceCount = 0;
-			//create a list of all the vertices
-			List<XbimVertex^>^ vertices = gcnew List<XbimVertex^>(Enumerable::Count(faceSet->Coordinates->CoordList));
+			//the coordinates and indices are copied out of the model in one pass each and the vertices built from them natively
+			array<double>^ coords = XbimCoordinates::Points(faceSet->Coordinates->CoordList, logger, faceSet->Coordinates);
+			array<int>^ triangles = XbimCoordinates::Indices(faceSet->CoordIndex, 3);
+			int vertexCount = coords->Length / 3;
+			int triangleCount = triangles->Length / 3;
+			std::vector<TopoDS_Vertex> vertices(vertexCount);
 			Dictionary<long long, XbimEdge^>^ edgeMap = gcnew Dictionary<long long, XbimEdge^>();
 
-			for each (IEnumerable<Ifc4::MeasureResource::IfcLengthMeasure> ^ cp in faceSet->Coordinates->CoordList)
+			if (vertexCount > 0)
 			{
-				XbimTriplet<Ifc4::MeasureResource::IfcLengthMeasure> tpl = IEnumerableExtensions::AsTriplet<Ifc4::MeasureResource::IfcLengthMeasure>(cp);
-				XbimVertex^ v = gcnew XbimVertex(tpl.A, tpl.B, tpl.C, _sewingTolerance);
-				vertices->Add(v);
+				pin_ptr<double> pinned = &coords[0];
+				const double* c = pinned;
+				for (int i = 0; i < vertexCount; i++, c += 3)
+				{
+					gp_Pnt point(c[0], c[1], c[2]);
+					if (!XbimCoordinates::IsMissing(point))
+						builder.MakeVertex(vertices[i], point, _sewingTolerance);
+				}
 			}
 
-
 			//make the triangles
-			for each (IEnumerable<Ifc4::MeasureResource::IfcPositiveInteger> ^ indices in faceSet->CoordIndex)
+			for (int t = 0; t < triangleCount; t++)
 			{
 				try
 				{
-					XbimTriplet<Ifc4::MeasureResource::IfcPositiveInteger> tpl = IEnumerableExtensions::AsTriplet<Ifc4::MeasureResource::IfcPositiveInteger>(indices);
-
 					TopoDS_Vertex v1; TopoDS_Vertex v2; TopoDS_Vertex v3;
-					int i1 = (int)tpl.A - 1;
-					int i2 = (int)tpl.B - 1;
-					int i3 = (int)tpl.C - 1;
+					int i1 = triangles[3 * t];
+					int i2 = triangles[3 * t + 1];
+					int i3 = triangles[3 * t + 2];
 					if (i1 == i2 || i2 == i3 || i1 == i3)
 						continue;//not a triangle
+					if (i1 < 0 || i2 < 0 || i3 < 0 || i1 >= vertexCount || i2 >= vertexCount || i3 >= vertexCount)
+					{
+						XBIM_LOG_WARNING(logger, faceSet, "Triangle index out of range. Triangle ignored");
+						continue;
+					}
+					if (vertices[i1].IsNull() || vertices[i2].IsNull() || vertices[i3].IsNull())
+					{
+						XBIM_LOG_WARNING(logger, faceSet, "Triangle refers to a point that has been ignored. Triangle ignored");
+						continue;
+					}
 					v1 = vertices[i1];
 					v2 = vertices[i2];
 					v3 = vertices[i3];
@@ -1332,6 +1429,7 @@ namespace Xbim
 				unifier.SetLinearTolerance(_sewingTolerance);
 				try
 				{
+					XBIM_TRACE_SCOPE("UnifySameDomain");
 					unifier.Build();
 					builder.Add(*pCompound, unifier.Shape());
 				}
@@ -1370,26 +1468,30 @@ namespace Xbim
 
 					if (polyloop == nullptr || !XbimConvert::IsPolygon((IIfcPolyLoop^)bound->Bound))
 					{
-						XbimGeometryCreator::LogDebug(logger, bound, "Polyloop bound is not a polygon and has been ignored");
+						XBIM_LOG_DEBUG(logger, bound, "Polyloop bound is not a polygon and has been ignored");
 						continue; //skip non-polygonal faces
 					}
 
-					int originalCount = polyloop->Polygon->Count;
+					array<double>^ coords = XbimCoordinates::Points(polyloop->Polygon, logger, polyloop);
+					int originalCount = coords->Length / 3;
 
 					if (originalCount < 3)
 					{
-						XbimGeometryCreator::LogWarning(logger, polyloop, "Invalid loop, it has less than three points. Wire discarded");
+						XBIM_LOG_WARNING(logger, polyloop, "Invalid loop, it has less than three points. Wire discarded");
 						continue;
 					}
 					bool isOuter = numBounds == 1 || (dynamic_cast<IIfcFaceOuterBound^>(bound) != nullptr);
 					TopoDS_Vertex currentTail;
 					BRepBuilderAPI_MakeWire wireMaker;
+					pin_ptr<double> pinned = &coords[0];
+					const double* c = pinned;
 
-					for each (IIfcCartesianPoint ^ cp in Enumerable::Concat(polyloop->Polygon, Enumerable::Take(polyloop->Polygon, 1))) //add the start on to the polygon
+					for (int pointIdx = 0; pointIdx <= originalCount; pointIdx++) //add the start on to the polygon
 					{
 						try
 						{
-							gp_Pnt p = XbimConvert::GetPoint3d(cp);
+							const double* xyz = c + 3 * (pointIdx % originalCount);
+							gp_Pnt p(xyz[0], xyz[1], xyz[2]);
 							inspector.ClearResList();
 							inspector.SetCurrent(p.Coord());
 							vertexCellFilter.Inspect(p.Coord(), inspector);
@@ -1471,13 +1573,13 @@ namespace Xbim
 						catch (Standard_Failure sf)
 						{
 							String^ err = gcnew String(sf.GetMessageString());
-							XbimGeometryCreator::LogWarning(logger, polyloop, "Failure building loop: " + err);
+							XBIM_LOG_WARNING(logger, polyloop, "Failure building loop: " + err);
 							continue;
 						}
 					}
 					if (!wireMaker.IsDone()) //if its not the first point its gone wrong
 					{
-						XbimGeometryCreator::LogDebug(logger, polyloop, "Empty loop built and ignored");
+						XBIM_LOG_DEBUG(logger, polyloop, "Empty loop built and ignored");
 						continue;
 					}
 					else
@@ -1516,7 +1618,7 @@ namespace Xbim
 				if (outerLoop.IsNull())
 				{
 					//no bounded face
-					XbimGeometryCreator::LogDebug(logger, ifcFace, "No outer loop built,  face ignored");
+					XBIM_LOG_DEBUG(logger, ifcFace, "No outer loop built,  face ignored");
 					continue;
 				}
 
@@ -1544,7 +1646,7 @@ namespace Xbim
 								}
 								catch (Standard_Failure sf)
 								{
-									XbimGeometryCreator::LogDebug(logger, ifcFace, "Inner wire has invalid normal,  wire ignored");
+									XBIM_LOG_DEBUG(logger, ifcFace, "Inner wire has invalid normal,  wire ignored");
 									continue;
 								}
 							}
@@ -1555,13 +1657,13 @@ namespace Xbim
 					}
 					else
 					{
-						XbimGeometryCreator::LogDebug(logger, ifcFace, "Face could not be built,  face ignored");
+						XBIM_LOG_DEBUG(logger, ifcFace, "Face could not be built,  face ignored");
 						continue;
 					}
 				}
 				catch (const std::exception&)
 				{
-					XbimGeometryCreator::LogDebug(logger, ifcFace, "Outer loop is not a bounded area,  face ignored");
+					XBIM_LOG_DEBUG(logger, ifcFace, "Outer loop is not a bounded area,  face ignored");
 					continue;
 				}
 			}
@@ -1584,8 +1686,10 @@ namespace Xbim
 				}
 				else
 				{
+					XBIM_TRACE_SCOPE("ShapeFix");
 					ShapeFix_Shape shapeFixer(shell);
-					if (shapeFixer.Perform())
+					Handle(XbimProgressMonitor) pi = new XbimProgressMonitor();
+					if (shapeFixer.Perform(pi))
 						return shapeFixer.Shape();
 					else
 						return shell;
@@ -1652,7 +1756,7 @@ namespace Xbim
 					if (faceNormal.DotProduct(loopNormal) > 0) //they should be in opposite directions, so reverse
 						wire->Reverse();
 					if (!face->Add(wire))
-						XbimGeometryCreator::LogWarning(logger, owningFace, "Failed to add an inner bound");
+						XBIM_LOG_WARNING(logger, owningFace, "Failed to add an inner bound");
 				}
 			}
 			return face;
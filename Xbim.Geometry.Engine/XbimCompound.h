@@ -57,6 +57,7 @@ namespace Xbim
 			~XbimCompound(){ InstanceCleanup(); }
 			!XbimCompound(){ InstanceCleanup(); }
 			XbimCompound(double sewingTolerance);
+			//wraps an existing compound, often a temporary member of a set, so it does not report memory pressure
 			XbimCompound(const TopoDS_Compound& compound, bool sewn, double tolerance);
 			XbimCompound(const TopoDS_Compound& compound, bool sewn, double tolerance, Object^ tag);
 			XbimCompound(IIfcConnectedFaceSet^ faceSet, ILogger^ logger);
@@ -694,7 +694,10 @@ namespace Xbim
 
 		gp_Pnt XbimConvert::GetPoint3d(IIfcCartesianPoint^ cartesian)
 		{
-			return gp_Pnt(cartesian->X, cartesian->Y, XbimConvert::GetZValueOrZero(cartesian));
+			//read the list once, X, Y, Z and Dim each go back to it. Missing coordinates are 0, as in XbimCoordinates::Points
+			IList<IfcLengthMeasure>^ coordinates = cartesian->Coordinates;
+			int dim = coordinates == nullptr ? 0 : coordinates->Count;
+			return gp_Pnt(dim > 0 ? (double)coordinates[0] : 0.0, dim > 1 ? (double)coordinates[1] : 0.0, dim > 2 ? (double)coordinates[2] : 0.0);
 		}
 
 		gp_Pnt2d XbimConvert::GetPoint2d(IIfcCartesianPoint^ cartesian)
@@ -0,0 +1,315 @@
+#include "XbimConvexHull.h"
+#include "XbimSolidBatch.h"
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+	//a directed edge of the hull as a key, each edge belongs to the face it runs anticlockwise round
+	inline unsigned long long EdgeKey(int a, int b)
+	{
+		return ((unsigned long long)(unsigned int)a << 32) | (unsigned int)b;
+	}
+}
+
+void XbimConvexHull::ShapePoints(const TopoDS_Shape& shape, double linearDeflection, double angularDeflection, std::vector<double>& points)
+{
+	XbimSolidBatch::MeshCurvedFaces(shape, linearDeflection, angularDeflection);
+	TopTools_IndexedMapOfShape vertexMap;
+	TopExp::MapShapes(shape, TopAbs_VERTEX, vertexMap);
+	points.reserve(points.size() + 3 * vertexMap.Extent());
+	for (int i = 1; i <= vertexMap.Extent(); i++)
+	{
+		gp_Pnt p = BRep_Tool::Pnt(TopoDS::Vertex(vertexMap(i)));
+		points.push_back(p.X());
+		points.push_back(p.Y());
+		points.push_back(p.Z());
+	}
+	for (TopExp_Explorer faceExplorer(shape, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next())
+	{
+		TopLoc_Location location;
+		const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(TopoDS::Face(faceExplorer.Current()), location);
+		if (mesh.IsNull())
+			continue;
+		const gp_Trsf& transform = location.Transformation();
+		const TColgp_Array1OfPnt& nodes = mesh->Nodes();
+		for (int i = nodes.Lower(); i <= nodes.Upper(); i++)
+		{
+			gp_Pnt p = nodes(i).Transformed(transform);
+			points.push_back(p.X());
+			points.push_back(p.Y());
+			points.push_back(p.Z());
+		}
+	}
+}
+
+double XbimConvexHull::Distance(const Face& face, int point) const
+{
+	const double* p = points + 3 * point;
+	return face.normal[0] * p[0] + face.normal[1] * p[1] + face.normal[2] * p[2] - face.offset;
+}
+
+int XbimConvexHull::AddFace(int a, int b, int c)
+{
+	Face face;
+	face.v[0] = a;
+	face.v[1] = b;
+	face.v[2] = c;
+	const double* pa = points + 3 * a;
+	const double* pb = points + 3 * b;
+	const double* pc = points + 3 * c;
+	double u[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+	double w[3] = { pc[0] - pa[0], pc[1] - pa[1], pc[2] - pa[2] };
+	double n[3] = { u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0] };
+	double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	for (int i = 0; i < 3; i++)
+		face.normal[i] = length > 0 ? n[i] / length : 0;
+	face.offset = face.normal[0] * pa[0] + face.normal[1] * pa[1] + face.normal[2] * pa[2];
+	face.removed = false;
+	faces.push_back(face);
+	return (int)faces.size() - 1;
+}
+
+bool XbimConvexHull::Build(const double* pointData, int count)
+{
+	points = pointData;
+	faces.clear();
+	hullPoints.clear();
+	hullTriangles.clear();
+	if (count < 4)
+		return false;
+
+	//the tolerance grows with the size of the coordinates, as their rounding does
+	double extent = 0;
+	int minIndex[3] = { 0, 0, 0 };
+	int maxIndex[3] = { 0, 0, 0 };
+	for (int i = 0; i < count; i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			extent = std::max(extent, std::abs(points[3 * i + k]));
+			if (points[3 * i + k] < points[3 * minIndex[k] + k]) minIndex[k] = i;
+			if (points[3 * i + k] > points[3 * maxIndex[k] + k]) maxIndex[k] = i;
+		}
+	}
+	tolerance = std::max(extent * 1e-10, 1e-12);
+
+	//the first tetrahedron, from the two extreme points furthest apart, the point furthest from their line and the point furthest from their plane
+	auto squaredDistance = [&](int a, int b)
+	{
+		double d = 0;
+		for (int k = 0; k < 3; k++)
+			d += (points[3 * a + k] - points[3 * b + k]) * (points[3 * a + k] - points[3 * b + k]);
+		return d;
+	};
+	int i0 = minIndex[0], i1 = maxIndex[0];
+	for (int k = 1; k < 3; k++)
+	{
+		if (squaredDistance(minIndex[k], maxIndex[k]) > squaredDistance(i0, i1))
+		{
+			i0 = minIndex[k];
+			i1 = maxIndex[k];
+		}
+	}
+	if (std::sqrt(squaredDistance(i0, i1)) <= tolerance)
+		return false;
+	int i2 = -1;
+	double furthest = tolerance;
+	{
+		const double* a = points + 3 * i0;
+		const double* b = points + 3 * i1;
+		double d[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		double length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+		for (int i = 0; i < count; i++)
+		{
+			const double* p = points + 3 * i;
+			double v[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+			double c[3] = { v[1] * d[2] - v[2] * d[1], v[2] * d[0] - v[0] * d[2], v[0] * d[1] - v[1] * d[0] };
+			double distance = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]) / length;
+			if (distance > furthest)
+			{
+				furthest = distance;
+				i2 = i;
+			}
+		}
+	}
+	if (i2 < 0)
+		return false;
+	int i3 = -1;
+	furthest = tolerance;
+	{
+		AddFace(i0, i1, i2);
+		for (int i = 0; i < count; i++)
+		{
+			double distance = std::abs(Distance(faces[0], i));
+			if (distance > furthest)
+			{
+				furthest = distance;
+				i3 = i;
+			}
+		}
+		faces.clear();
+	}
+	if (i3 < 0)
+		return false;
+
+	std::unordered_map<unsigned long long, int> edges;
+	auto addFace = [&](int a, int b, int c)
+	{
+		int f = AddFace(a, b, c);
+		edges[EdgeKey(a, b)] = f;
+		edges[EdgeKey(b, c)] = f;
+		edges[EdgeKey(c, a)] = f;
+		return f;
+	};
+	//each face of the tetrahedron is turned so that the fourth corner is behind it
+	int corners[4] = { i0, i1, i2, i3 };
+	int tetrahedron[4][4] = { { 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 }, { 2, 3, 0, 1 } };
+	for (auto& t : tetrahedron)
+	{
+		int a = corners[t[0]], b = corners[t[1]], c = corners[t[2]];
+		AddFace(a, b, c);
+		bool flip = Distance(faces.back(), corners[t[3]]) > 0;
+		faces.pop_back();
+		if (flip)
+			std::swap(b, c);
+		addFace(a, b, c);
+	}
+	for (int i = 0; i < count; i++)
+	{
+		for (int f = 0; f < 4; f++)
+		{
+			if (Distance(faces[f], i) > tolerance)
+			{
+				faces[f].outside.push_back(i);
+				break;
+			}
+		}
+	}
+
+	std::vector<int> pending = { 0, 1, 2, 3 };
+	std::vector<int> visible;
+	std::vector<int> horizon;
+	std::vector<int> stack;
+	std::vector<char> isVisible;
+	while (!pending.empty())
+	{
+		int start = pending.back();
+		pending.pop_back();
+		if (faces[start].removed || faces[start].outside.empty())
+			continue;
+		int apex = faces[start].outside.front();
+		double apexDistance = Distance(faces[start], apex);
+		for (int point : faces[start].outside)
+		{
+			double distance = Distance(faces[start], point);
+			if (distance > apexDistance)
+			{
+				apexDistance = distance;
+				apex = point;
+			}
+		}
+
+		//the faces the apex can see, found by walking across their edges, and the edges round them
+		visible.clear();
+		horizon.clear();
+		isVisible.resize(faces.size(), 0);
+		stack.assign(1, start);
+		isVisible[start] = 1;
+		while (!stack.empty())
+		{
+			int f = stack.back();
+			stack.pop_back();
+			visible.push_back(f);
+			for (int e = 0; e < 3; e++)
+			{
+				int a = faces[f].v[e];
+				int b = faces[f].v[(e + 1) % 3];
+				auto twin = edges.find(EdgeKey(b, a));
+				if (twin == edges.end())
+					return false; //the hull is no longer closed
+				int neighbour = twin->second;
+				if (isVisible[neighbour])
+					continue;
+				if (Distance(faces[neighbour], apex) > tolerance)
+				{
+					isVisible[neighbour] = 1;
+					stack.push_back(neighbour);
+				}
+				else
+				{
+					horizon.push_back(a);
+					horizon.push_back(b);
+				}
+			}
+		}
+
+		//the visible faces are replaced by a cone from the horizon to the apex, which takes the points still outside
+		std::vector<int> orphans;
+		for (int f : visible)
+		{
+			Face& face = faces[f];
+			face.removed = true;
+			for (int e = 0; e < 3; e++)
+			{
+				auto edge = edges.find(EdgeKey(face.v[e], face.v[(e + 1) % 3]));
+				if (edge != edges.end() && edge->second == f)
+					edges.erase(edge);
+			}
+			for (int point : face.outside)
+				if (point != apex)
+					orphans.push_back(point);
+			face.outside.clear();
+			face.outside.shrink_to_fit();
+		}
+		size_t firstNew = faces.size();
+		for (size_t h = 0; h < horizon.size(); h += 2)
+			pending.push_back(addFace(horizon[h], horizon[h + 1], apex));
+		isVisible.assign(faces.size(), 0);
+		for (int point : orphans)
+		{
+			for (size_t f = firstNew; f < faces.size(); f++)
+			{
+				if (Distance(faces[f], point) > tolerance)
+				{
+					faces[f].outside.push_back(point);
+					break;
+				}
+			}
+		}
+	}
+
+	//the corners used by the remaining faces, numbered in the order they are met
+	std::unordered_map<int, int> corner;
+	for (const Face& face : faces)
+	{
+		if (face.removed)
+			continue;
+		for (int k = 0; k < 3; k++)
+		{
+			auto found = corner.find(face.v[k]);
+			int index;
+			if (found == corner.end())
+			{
+				index = (int)corner.size();
+				corner.emplace(face.v[k], index);
+				hullPoints.push_back(points[3 * face.v[k]]);
+				hullPoints.push_back(points[3 * face.v[k] + 1]);
+				hullPoints.push_back(points[3 * face.v[k] + 2]);
+			}
+			else
+				index = found->second;
+			hullTriangles.push_back(index);
+		}
+	}
+	faces.clear();
+	faces.shrink_to_fit();
+	return !hullTriangles.empty();
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+#include <vector>
+
+//Builds the convex hull of a set of points by quickhull. Each face of the hull takes the points outside it, the furthest is added,
+//the faces it can see are removed and their horizon is joined to it, until no point is outside. The header is included by /clr
+//code, the implementation is compiled natively
+class XbimConvexHull
+{
+public:
+	//the B-rep vertices of the shape and the triangulation nodes of its faces as xyz triples, the faces WriteTriangulation would give
+	//to BRepMesh are meshed first, if they are not already
+	static void ShapePoints(const TopoDS_Shape& shape, double linearDeflection, double angularDeflection, std::vector<double>& points);
+
+	//builds the hull of count points given as xyz triples. Returns false if they lie on a plane, a line or a point
+	bool Build(const double* points, int count);
+	//the corners of the hull as xyz triples
+	const std::vector<double>& Points() const { return hullPoints; }
+	//the triangles of the hull as triples of indices into Points, anticlockwise seen from outside
+	const std::vector<int>& Triangles() const { return hullTriangles; }
+
+private:
+	struct Face
+	{
+		int v[3];
+		double normal[3];
+		double offset;
+		std::vector<int> outside;
+		bool removed;
+	};
+
+	const double* points;
+	double tolerance;
+	std::vector<Face> faces;
+	std::vector<double> hullPoints;
+	std::vector<int> hullTriangles;
+
+	double Distance(const Face& face, int point) const;
+	int AddFace(int a, int b, int c);
+};
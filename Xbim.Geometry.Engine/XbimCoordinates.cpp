@@ -0,0 +1,100 @@
+#include "XbimCoordinates.h"
+#include "XbimGeometryCreator.h"
+#include <gp_Pnt.hxx>
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		array<double>^ XbimCoordinates::Points(IEnumerable<IIfcCartesianPoint^>^ points, ILogger^ logger, Object^ owner)
+		{
+			IList<IIfcCartesianPoint^>^ list = dynamic_cast<IList<IIfcCartesianPoint^>^>(points);
+			if (list == nullptr)
+				list = gcnew List<IIfcCartesianPoint^>(points);
+			int count = list->Count;
+			array<double>^ coords = gcnew array<double>(3 * count);
+			int taken = 0;
+			for (int i = 0; i < count; i++)
+			{
+				IIfcCartesianPoint^ point = list[i];
+				IList<IfcLengthMeasure>^ coordinates = point == nullptr ? nullptr : point->Coordinates;
+				int dim = coordinates == nullptr ? 0 : coordinates->Count;
+				if (dim < 2)
+				{
+					XBIM_LOG_WARNING(logger, owner, "Point {0} is missing or has less than 2 coordinates. It has been ignored", i + 1);
+					continue;
+				}
+				coords[3 * taken] = (double)coordinates[0];
+				coords[3 * taken + 1] = (double)coordinates[1];
+				coords[3 * taken + 2] = dim > 2 ? (double)coordinates[2] : 0;
+				taken++;
+			}
+			if (taken < count)
+				Array::Resize(coords, 3 * taken);
+			return coords;
+		}
+
+		array<double>^ XbimCoordinates::Points(IIfcCartesianPointList^ pointList, ILogger^ logger)
+		{
+			IIfcCartesianPointList3D^ points3D = dynamic_cast<IIfcCartesianPointList3D^>(pointList);
+			if (points3D != nullptr)
+				return Points(points3D->CoordList, logger, pointList);
+			IIfcCartesianPointList2D^ points2D = dynamic_cast<IIfcCartesianPointList2D^>(pointList);
+			if (points2D != nullptr)
+				return Points(points2D->CoordList, logger, pointList);
+			return nullptr;
+		}
+
+		array<double>^ XbimCoordinates::Points(IEnumerable<IItemSet<IfcLengthMeasure>^>^ coordList, ILogger^ logger, Object^ owner)
+		{
+			IList<IItemSet<IfcLengthMeasure>^>^ list = dynamic_cast<IList<IItemSet<IfcLengthMeasure>^>^>(coordList);
+			if (list == nullptr)
+				list = gcnew List<IItemSet<IfcLengthMeasure>^>(coordList);
+			int count = list->Count;
+			array<double>^ coords = gcnew array<double>(3 * count);
+			for (int i = 0; i < count; i++)
+			{
+				IList<IfcLengthMeasure>^ coordinates = list[i];
+				int dim = coordinates == nullptr ? 0 : coordinates->Count;
+				if (dim < 2)
+				{
+					XBIM_LOG_WARNING(logger, owner, "Point {0} is missing or has less than 2 coordinates. It has been ignored", i + 1);
+					coords[3 * i] = coords[3 * i + 1] = coords[3 * i + 2] = Double::NaN;
+					continue;
+				}
+				coords[3 * i] = (double)coordinates[0];
+				coords[3 * i + 1] = (double)coordinates[1];
+				coords[3 * i + 2] = dim > 2 ? (double)coordinates[2] : 0;
+			}
+			return coords;
+		}
+
+		array<int>^ XbimCoordinates::Indices(IEnumerable<IItemSet<IfcPositiveInteger>^>^ coordIndex, int arity)
+		{
+			IList<IItemSet<IfcPositiveInteger>^>^ list = dynamic_cast<IList<IItemSet<IfcPositiveInteger>^>^>(coordIndex);
+			if (list == nullptr)
+				list = gcnew List<IItemSet<IfcPositiveInteger>^>(coordIndex);
+			int count = list->Count;
+			array<int>^ indices = gcnew array<int>(arity * count);
+			for (int i = 0; i < count; i++)
+			{
+				IList<IfcPositiveInteger>^ entry = list[i];
+				int entryCount = entry->Count;
+				for (int j = 0; j < arity; j++)
+					indices[arity * i + j] = j < entryCount ? (int)entry[j] - 1 : -1;
+			}
+			return indices;
+		}
+
+		void XbimCoordinates::Append(array<double>^ coords, TColgp_SequenceOfPnt& pointSeq)
+		{
+			if (coords == nullptr || coords->Length < 3)
+				return;
+			pin_ptr<double> pinned = &coords[0];
+			const double* c = pinned;
+			int count = coords->Length / 3;
+			for (int i = 0; i < count; i++, c += 3)
+				pointSeq.Append(gp_Pnt(c[0], c[1], c[2]));
+		}
+	}
+}
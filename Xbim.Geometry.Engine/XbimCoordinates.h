@@ -0,0 +1,36 @@
+#pragma once
+#include <TColgp_SequenceOfPnt.hxx>
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace Xbim::Common;
+using namespace Xbim::Ifc4::Interfaces;
+using namespace Xbim::Ifc4::MeasureResource;
+using namespace Microsoft::Extensions::Logging;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		//Copies the coordinates and indices of IFC point lists into flat arrays in one pass, so the native builders read them through a
+		//pinned pointer rather than enumerating the model and casting a measure at a time. Lists the model implements as IList are read
+		//through their indexer, others are enumerated once
+		ref class XbimCoordinates abstract sealed
+		{
+		public:
+			//x, y, z of each point, z is 0 for 2D points. A point that is null or has fewer than 2 coordinates is logged against owner and left out
+			static array<double>^ Points(IEnumerable<IIfcCartesianPoint^>^ points, ILogger^ logger, Object^ owner);
+			//x, y, z of each point, z is 0 for 2D lists. Null if the list is neither 2D nor 3D
+			static array<double>^ Points(IIfcCartesianPointList^ pointList, ILogger^ logger);
+			//an entry that is null or has fewer than 2 coordinates is logged against owner and kept as a missing point, so the indices into
+			//the list still hold
+			static array<double>^ Points(IEnumerable<IItemSet<IfcLengthMeasure>^>^ coordList, ILogger^ logger, Object^ owner);
+			//true for a missing point of a coordinate list, its coordinates are NaN
+			static bool IsMissing(const gp_Pnt& point) { return Double::IsNaN(point.X()); }
+			//arity zero based indices per entry, missing ones are -1
+			static array<int>^ Indices(IEnumerable<IItemSet<IfcPositiveInteger>^>^ coordIndex, int arity);
+			//appends the points of Points to the sequence
+			static void Append(array<double>^ coords, TColgp_SequenceOfPnt& pointSeq);
+		};
+	}
+}
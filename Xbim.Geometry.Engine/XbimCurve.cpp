@@ -2,6 +2,7 @@
 #include "XbimCurve2D.h"
 #include "XbimFace.h"
 #include "XbimConvert.h"
+#include "XbimCoordinates.h"
 #include "XbimGeometryCreator.h"
 #include <gce_MakeLin.hxx>
 #include <GC_MakeLine.hxx>
@@ -491,7 +492,8 @@ namespace Xbim
 		void XbimCurve::Init(IIfcPolyline^ pline, ILogger^ logger)
 		{
 
-			int pointCount = pline->Points->Count;
+			array<double>^ coords = XbimCoordinates::Points(pline->Points, logger, pline);
+			int pointCount = coords->Length / 3;
 			if (pointCount < 2)
 			{
 				XbimGeometryCreator::LogError(logger, pline, "Polyline with less than 2 points is not a line. It has been ignored");
@@ -500,8 +502,8 @@ namespace Xbim
 			//optimisation for singl segment polyline
 			if (pointCount == 2) //just trim a line
 			{
-				gp_Pnt pnt1 = XbimConvert::GetPoint3d(pline->Points[0]);
-				gp_Pnt pnt2 = XbimConvert::GetPoint3d(pline->Points[1]);
+				gp_Pnt pnt1(coords[0], coords[1], coords[2]);
+				gp_Pnt pnt2(coords[3], coords[4], coords[5]);
 				double len = pnt1.Distance(pnt2);
 				if (std::abs(len) < Precision::Confusion())
 				{
@@ -528,9 +530,7 @@ namespace Xbim
 
 			for (Standard_Integer i = 1; i <= pointCount; i++)
 			{
-				IIfcCartesianPoint^ cp = pline->Points[i - 1];
-				gp_Pnt pnt(cp->X, cp->Y, XbimConvert::GetZValueOrZero(cp));
-				poles.SetValue(i, pnt);
+				poles.SetValue(i, gp_Pnt(coords[3 * i - 3], coords[3 * i - 2], coords[3 * i - 1]));
 				knots.SetValue(i, Standard_Real(i - 1));
 				mults.SetValue(i, 1);
 			}
@@ -0,0 +1,85 @@
+#include "XbimCurveCache.h"
+#include "XbimGeometrySession.h"
+#include <BRepBuilderAPI_Copy.hxx>
+#include <TopoDS.hxx>
+
+using namespace System::Threading;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		bool XbimCurveCache::IsCacheable(IIfcCurve^ curve)
+		{
+			return curve != nullptr && curve->Model != nullptr && curve->Model->CurrentTransaction == nullptr;
+		}
+
+		XbimWire^ XbimCurveCache::Copy(XbimWire^ wire)
+		{
+			//the topology is copied so tolerances and pcurves added by one user are not seen by another, the curves are shared
+			BRepBuilderAPI_Copy copier(wire, Standard_False);
+			XbimWire^ copy = gcnew XbimWire(TopoDS::Wire(copier.Shape()), wire->Tag);
+			GC::KeepAlive(wire);
+			return copy;
+		}
+
+		bool XbimCurveCache::TryGet(IIfcCurve^ curve, int kind, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, XbimWire^% wire)
+		{
+			wire = nullptr;
+			if (!IsCacheable(curve))
+				return false;
+			ConcurrentDictionary<XbimCurveKey, XbimCurveCacheEntry^>^ cache;
+			XbimCurveCacheEntry^ entry;
+			if (!models->TryGetValue(curve->Model, cache) || !cache->TryGetValue(XbimCurveKey(curve->EntityLabel, kind, startParam, endParam), entry))
+			{
+				Interlocked::Increment(misses);
+				return false;
+			}
+			Interlocked::Increment(hits);
+			Interlocked::Add(savedTicks, entry->BuildTicks);
+			wire = Copy(entry->Wire);
+			return true;
+		}
+
+		void XbimCurveCache::Add(IIfcCurve^ curve, int kind, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, XbimWire^ wire, Int64 ticks)
+		{
+			if (wire == nullptr || !wire->IsValid || !IsCacheable(curve))
+				return;
+			ConcurrentDictionary<XbimCurveKey, XbimCurveCacheEntry^>^ cache = models->GetOrCreateValue(curve->Model);
+			XbimCurveCacheEntry^ entry = gcnew XbimCurveCacheEntry();
+			entry->Wire = Copy(wire);
+			//the copy belongs to the cache, the session open for the item that built it must not release it
+			XbimGeometrySession::Detach(entry->Wire);
+			entry->BuildTicks = ticks;
+			//threads that built the same curve at once keep the first
+			if (cache->TryAdd(XbimCurveKey(curve->EntityLabel, kind, startParam, endParam), entry))
+			{
+				Interlocked::Increment(curves);
+				Interlocked::Add(buildTicks, ticks);
+			}
+			else
+				delete entry->Wire;
+		}
+
+		void XbimCurveCache::Clear(IModel^ model)
+		{
+			if (model != nullptr)
+				models->Remove(model);
+		}
+
+		array<Int64>^ XbimCurveCache::Statistics()
+		{
+			return gcnew array<Int64>{ Interlocked::Read(hits), Interlocked::Read(misses), Interlocked::Read(curves),
+				Interlocked::Read(buildTicks), Interlocked::Read(savedTicks) };
+		}
+
+		void XbimCurveCache::ResetStatistics()
+		{
+			Interlocked::Exchange(hits, 0);
+			Interlocked::Exchange(misses, 0);
+			Interlocked::Exchange(curves, 0);
+			Interlocked::Exchange(buildTicks, 0);
+			Interlocked::Exchange(savedTicks, 0);
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "XbimWire.h"
+
+using namespace System;
+using namespace System::Collections::Concurrent;
+using namespace System::Runtime::CompilerServices;
+using namespace Xbim::Common;
+using namespace Xbim::Ifc4::Interfaces;
+using namespace Xbim::Ifc4::MeasureResource;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		//a curve with the trims applied to it, Kind tells apart the builders that apply the trims differently
+		value struct XbimCurveKey : IEquatable<XbimCurveKey>
+		{
+			int CurveLabel;
+			int Kind;
+			bool HasStart;
+			double Start;
+			bool HasEnd;
+			double End;
+
+			XbimCurveKey(int curveLabel, int kind, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam) :
+				CurveLabel(curveLabel), Kind(kind), HasStart(startParam.HasValue), Start(startParam.HasValue ? (double)startParam.Value : 0),
+				HasEnd(endParam.HasValue), End(endParam.HasValue ? (double)endParam.Value : 0) {}
+			virtual bool Equals(XbimCurveKey other)
+			{
+				return CurveLabel == other.CurveLabel && Kind == other.Kind && HasStart == other.HasStart && Start == other.Start &&
+					HasEnd == other.HasEnd && End == other.End;
+			}
+			virtual int GetHashCode() override { return (CurveLabel * 397) ^ (Kind * 31) ^ Start.GetHashCode() ^ (End.GetHashCode() * 17); }
+		};
+
+		ref class XbimCurveCacheEntry
+		{
+		public:
+			XbimWire^ Wire;
+			Int64 BuildTicks;
+		};
+
+		//Keeps the wires built for the directrices of swept solids, MEP and rebar models often sweep several items along the same curve.
+		//Each model has its own cache, dropped with the model when it is collected or by Clear. Only models outside a transaction are
+		//cached, their curves cannot change. Callers get their own copy of the topology, so they may fillet the wire or change its
+		//tolerances, the curves are shared. The methods may be called from any thread
+		ref class XbimCurveCache abstract sealed
+		{
+		private:
+			static ConditionalWeakTable<IModel^, ConcurrentDictionary<XbimCurveKey, XbimCurveCacheEntry^>^>^ models =
+				gcnew ConditionalWeakTable<IModel^, ConcurrentDictionary<XbimCurveKey, XbimCurveCacheEntry^>^>();
+			static Int64 hits;
+			static Int64 misses;
+			static Int64 curves;
+			static Int64 buildTicks;
+			static Int64 savedTicks;
+			static bool IsCacheable(IIfcCurve^ curve);
+			static XbimWire^ Copy(XbimWire^ wire);
+		public:
+			literal int Directrix = 0;
+			literal int FixedReferenceDirectrix = 1;
+			static bool TryGet(IIfcCurve^ curve, int kind, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, XbimWire^% wire);
+			//keeps a copy of the wire, built in the given stopwatch ticks
+			static void Add(IIfcCurve^ curve, int kind, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, XbimWire^ wire, Int64 ticks);
+			static void Clear(IModel^ model);
+			//hits, misses, curves added to the caches, the stopwatch ticks spent building them and the ticks the hits saved
+			static array<Int64>^ Statistics();
+			static void ResetStatistics();
+		};
+	}
+}
@@ -7,6 +7,7 @@
 #include "XbimConvert.h"
 #include "XbimWire.h"
 #include "XbimFace.h"
+#include "XbimProgressMonitor.h"
 #include <BRepBuilderAPI_Transform.hxx> 
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <TopExp_Explorer.hxx>
@@ -287,7 +288,8 @@ namespace Xbim
 			ShapeFix_Shape fixer(aWire);
 			fixer.SetPrecision(tolerance);
 			fixer.SetMaxTolerance(tolerance);
-			fixer.Perform();
+			Handle(XbimProgressMonitor) pi = new XbimProgressMonitor();
+			fixer.Perform(pi);
 			TopoDS_Wire theWire = TopoDS::Wire(fixer.Shape());
 
 			TColGeom_SequenceOfCurve CurveSeq;
@@ -772,6 +774,7 @@ namespace Xbim
 			IntPtr temp = System::Threading::Interlocked::Exchange(ptrContainer, IntPtr::Zero);
 			if (temp != IntPtr::Zero)
 				delete (TopoDS_Edge*)(temp.ToPointer());
+			ReleaseBounds();
 			System::GC::SuppressFinalize(this);
 		}
 
@@ -0,0 +1,172 @@
+#include "XbimEdgeChain.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	//the arithmetic of gp_Pnt::SquareDistance, so the distances and the choices made on them are those of the linear scan
+	inline double SquareDistance(const double* a, const double* b)
+	{
+		double d = 0, dd;
+		dd = a[0]; dd -= b[0]; dd *= dd; d += dd;
+		dd = a[1]; dd -= b[1]; dd *= dd; d += dd;
+		dd = a[2]; dd -= b[2]; dd *= dd; d += dd;
+		return d;
+	}
+
+	//the nearest pair of the ends of an edge (b1, e1) and of the chain (b2, e2): 0 b1-b2, 1 b1-e2, 2 e1-b2, 3 e1-e2
+	inline int Match(const double* b1, const double* e1, const double* b2, const double* e2, double& minDis)
+	{
+		double distance[4] = { SquareDistance(b1, b2), SquareDistance(b1, e2), SquareDistance(e1, b2), SquareDistance(e1, e2) };
+		int index = -1;
+		minDis = DBL_MAX;
+		for (int i = 0; i < 4; ++i)
+		{
+			if (distance[i] < minDis)
+			{
+				minDis = distance[i];
+				index = i;
+			}
+		}
+		minDis = std::sqrt(minDis);
+		return index;
+	}
+
+	//cubes twice the tolerance across, every point nearer than the tolerance to a position is in one of the 27 cubes around it
+	class Grid
+	{
+	public:
+		explicit Grid(double tolerance) : cellSize(2 * tolerance) {}
+
+		void Add(const double* p, int edge)
+		{
+			cells[Key(Cell(p[0]), Cell(p[1]), Cell(p[2]))].push_back(edge);
+		}
+
+		//appends the edges with an end point in the cubes around p, an edge may be appended more than once
+		void Near(const double* p, std::vector<int>& edges) const
+		{
+			std::int64_t x = Cell(p[0]), y = Cell(p[1]), z = Cell(p[2]);
+			for (std::int64_t i = x - 1; i <= x + 1; ++i)
+				for (std::int64_t j = y - 1; j <= y + 1; ++j)
+					for (std::int64_t k = z - 1; k <= z + 1; ++k)
+					{
+						auto cell = cells.find(Key(i, j, k));
+						if (cell != cells.end())
+							edges.insert(edges.end(), cell->second.begin(), cell->second.end());
+					}
+		}
+
+	private:
+		double cellSize;
+		std::unordered_map<std::uint64_t, std::vector<int>> cells;
+
+		std::int64_t Cell(double v) const { return (std::int64_t)std::floor(v / cellSize); }
+
+		//cubes whose keys collide share a bucket, which only adds edges to measure
+		static std::uint64_t Key(std::int64_t x, std::int64_t y, std::int64_t z)
+		{
+			return ((std::uint64_t)x * 73856093u) ^ ((std::uint64_t)y * 19349663u) ^ ((std::uint64_t)z * 83492791u);
+		}
+	};
+}
+
+int XbimEdgeChain::Build(const double* points, int edgeCount, double tolerance, int* order, int* chainEnds, double* maxGap, bool linearScan)
+{
+	*maxGap = 0;
+	if (edgeCount <= 0)
+		return 0;
+
+	//coordinates too large for the cubes of the tolerance to be numbered, or not numbers at all, fall back to measuring every free edge
+	bool bucketed = !linearScan && tolerance > 0;
+	for (int i = 0; bucketed && i < 6 * edgeCount; ++i)
+		bucketed = std::fabs(points[i]) < 1e15 * tolerance;
+	Grid grid(bucketed ? tolerance : 0);
+	if (bucketed)
+	{
+		for (int i = 1; i < edgeCount; ++i)
+		{
+			grid.Add(points + 6 * i, i);
+			grid.Add(points + 6 * i + 3, i);
+		}
+	}
+
+	std::vector<char> taken(edgeCount, 0);
+	std::deque<int> chain;
+	std::vector<int> candidates;
+	int front = 0, back = 1;
+	taken[0] = 1;
+	chain.push_back(0);
+
+	while (true)
+	{
+		const double* b2 = points + 3 * front;
+		const double* e2 = points + 3 * back;
+		int minID = -1, id2 = -1;
+		double minminDis = DBL_MAX;
+		auto measure = [&](int i)
+		{
+			if (taken[i])
+				return;
+			double minDis;
+			int id = Match(points + 6 * i, points + 6 * i + 3, b2, e2, minDis);
+			if (minDis < minminDis || (minDis == minminDis && i < minID))
+			{
+				id2 = id;
+				minID = i;
+				minminDis = minDis;
+			}
+		};
+		if (bucketed)
+		{
+			//an edge outside the cubes around both ends is further than the tolerance from them, it could not be taken
+			candidates.clear();
+			grid.Near(b2, candidates);
+			grid.Near(e2, candidates);
+			for (int i : candidates)
+				measure(i);
+		}
+		else
+		{
+			for (int i = 0; i < edgeCount; ++i)
+				measure(i);
+		}
+		if (minID == -1 || !(minminDis < tolerance))
+			break;
+
+		taken[minID] = 1;
+		if (id2 == 0)
+		{
+			chain.push_front(minID);
+			front = 2 * minID + 1;
+		}
+		else if (id2 == 1)
+		{
+			chain.push_back(minID);
+			back = 2 * minID + 1;
+		}
+		else if (id2 == 2)
+		{
+			chain.push_front(minID);
+			front = 2 * minID;
+		}
+		else if (id2 == 3)
+		{
+			chain.push_back(minID);
+			back = 2 * minID;
+		}
+		if (*maxGap < minminDis)
+			*maxGap = minminDis;
+	}
+
+	int count = 0;
+	for (int edge : chain)
+		order[count++] = edge;
+	chainEnds[0] = front;
+	chainEnds[1] = back;
+	return count;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+//Chains edges end to end by the positions of their end points, the matching behind XbimWire::SortEdgesForWire. The end points are
+//bucketed in a grid of the tolerance so each step measures only the free edges near the ends of the chain, not all of them. The
+//header is included by /clr code so it takes plain arrays, the implementation is compiled natively
+class XbimEdgeChain
+{
+public:
+	//points holds the start and end point of each edge, 6 coordinates per edge. The chain starts with edge 0, at each step the free
+	//edge with an end point nearest to an end of the chain is added at that end, if nearer than the tolerance, ties go to the lowest
+	//index. Fills order with the edges chained, front to back, and chainEnds with the indices (2 * edge + 0 or 1) of the end points
+	//at the front and back of the chain. maxGap receives the largest distance accepted. Returns the number of edges chained
+	//linearScan measures every free edge at each step instead of those in the grid, the results are the same
+	static int Build(const double* points, int edgeCount, double tolerance, int* order, int* chainEnds, double* maxGap, bool linearScan = false);
+};
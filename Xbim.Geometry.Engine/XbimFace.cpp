@@ -1,6 +1,7 @@
 #include "XbimFace.h"
 #include "XbimOccWriter.h"
 #include "XbimCurve.h"
+#include "XbimProgressMonitor.h"
 #include <BRepBuilderAPI_Transform.hxx>
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <BRepTools_WireExplorer.hxx>
@@ -9,6 +10,7 @@
 #include <BRepCheck_Analyzer.hxx>
 #include "XbimGeometryCreator.h"
 #include "XbimConvert.h" 
+#include "XbimCoordinates.h"
 #include <TopExp_Explorer.hxx>
 #include <BRep_Builder.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
@@ -74,6 +76,7 @@ namespace Xbim
 			IntPtr temp = System::Threading::Interlocked::Exchange(ptrContainer, IntPtr::Zero);
 			if (temp != IntPtr::Zero)
 				delete (TopoDS_Face*)(temp.ToPointer());
+			ReleaseBounds();
 			System::GC::SuppressFinalize(this);
 		}
 
@@ -597,8 +600,8 @@ namespace Xbim
 
 		void XbimFace::Init(IIfcPolyLoop^ polyloop, ILogger^ logger)
 		{
-			List<IIfcCartesianPoint^>^ polygon = Enumerable::ToList(polyloop->Polygon);
-			int originalCount = polygon->Count;
+			array<double>^ polygon = XbimCoordinates::Points(polyloop->Polygon, logger, polyloop);
+			int originalCount = polygon->Length / 3;
 			double tolerance = polyloop->Model->ModelFactors->Precision;
 			if (originalCount < 3)
 			{
@@ -609,11 +612,7 @@ namespace Xbim
 			TColgp_SequenceOfPnt pointSeq;
 
 			BRepBuilderAPI_MakeWire wireMaker;
-			for (int i = 0; i < originalCount; i++)
-			{
-				pointSeq.Append(XbimConvert::GetPoint3d(polygon[i]));
-
-			}
+			XbimCoordinates::Append(polygon, pointSeq);
 
 			XbimFace::RemoveDuplicatePoints(pointSeq, true, tolerance);
 
@@ -810,8 +809,14 @@ namespace Xbim
 				BRepBuilderAPI_MakeWire wireMaker;
 				for (int i = 0; i < originalCount; i++)
 				{
-					pointSeq.Append(XbimConvert::GetPoint3d(polyloop->Polygon[i]));
-					if (useVertexMap) handles.push_back(polyloop->Polygon[i]->EntityLabel);
+					IIfcCartesianPoint^ point = polyloop->Polygon[i];
+					if (point == nullptr || point->Coordinates == nullptr || point->Coordinates->Count < 2)
+					{
+						XBIM_LOG_WARNING(logger, polyloop, "Point {0} is missing or has less than 2 coordinates. It has been ignored", i + 1);
+						continue;
+					}
+					pointSeq.Append(XbimConvert::GetPoint3d(point));
+					if (useVertexMap) handles.push_back(point->EntityLabel);
 				}
 				if (useVertexMap)
 					XbimFace::RemoveDuplicatePoints(pointSeq, handles, true, tolerance);
@@ -1072,7 +1077,8 @@ namespace Xbim
 						{
 							ShapeFix_Shape faceFixer(*pFace);
 							faceFixer.SetPrecision(tolerance);
-							if (faceFixer.Perform())
+							Handle(XbimProgressMonitor) pi = new XbimProgressMonitor();
+							if (faceFixer.Perform(pi))
 							{
 								TopoDS_Shape shape = faceFixer.Shape();
 								TopTools_IndexedMapOfShape map;
@@ -18,6 +18,10 @@
 #include <BRep_Tool.hxx>
 #include <TColgp_Array1OfPnt.hxx>
 #include <BRepTools.hxx>
+#include <BinTools.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopExp_Explorer.hxx>
+#include <BRepAdaptor_Surface.hxx>
 #include <BRep_Builder.hxx>
 #include <BRepOffsetAPI_MakePipe.hxx>
 #include <BRepOffsetAPI_MakePipeShell.hxx>
@@ -32,7 +36,27 @@
 #include <Geom2d_Line.hxx>
 #include <IntAna2d_AnaIntersection.hxx>
 #include <GeomLib.hxx>
+#include <Bnd_Box.hxx>
+#include <BRepBndLib.hxx>
+#include <gp_Lin.hxx>
+#include <ElCLib.hxx>
+#include <Precision.hxx>
+#include <BRepBuilderAPI_MakeEdge.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include "XbimMesh.h"
+#include "XbimMeshKernel.h"
+#include "XbimTraceRecorder.h"
+#include "XbimCancellationScope.h"
+#include "XbimGeometrySession.h"
+#include "XbimNativeLog.h"
+#include "XbimLogLimiter.h"
+#include "XbimCurveCache.h"
+#include "XbimLoftMesher.h"
+#include "XbimSolidBatch.h"
+#include "XbimShapeTree.h"
+#include "XbimShapeBounds.h"
+#include "XbimConvexHull.h"
+#include <vcclr.h>
 using System::Runtime::InteropServices::Marshal;
 
 using namespace  System::Threading;
@@ -50,55 +74,257 @@ namespace Xbim
 #pragma warning( push )
 #pragma warning( disable : 4691)
 
-		void XbimGeometryCreator::LogInfo(ILogger^ logger, Object^ entity, String^ format, ...array<Object^>^ arg)
+		bool XbimGeometryCreator::IsLogEnabled(ILogger^ logger, LogLevel level)
+		{
+			return logger != nullptr && logger->IsEnabled(level);
+		}
+
+		//the level is checked before anything is formatted, errors are never suppressed
+		void XbimGeometryCreator::Log(LogLevel level, ILogger^ logger, Object^ entity, String^ format, array<Object^>^ arg)
 		{
-			String^ msg = String::Format(format, arg);
+			if (logger == nullptr || !logger->IsEnabled(level))
+				return;
+			if (level < LogLevel::Error && !XbimLogLimiter::Allow(LogRepeatLimit, level, entity, format, logger))
+				return;
+			//messages without arguments are often built by concatenation and may contain braces
+			String^ msg = (arg == nullptr || arg->Length == 0) ? format : String::Format(format, arg);
 			IPersistEntity^ ifcEntity = dynamic_cast<IPersistEntity^>(entity);
-			if (logger != nullptr)
-			{
+			if (ifcEntity != nullptr)
+				LoggerExtensions::Log(logger, level, "GeomEngine: #{0}={1} [{2}]", ifcEntity->EntityLabel, ifcEntity->GetType()->Name, msg);
+			else
+				if (entity == nullptr)
+					LoggerExtensions::Log(logger, level, "GeomEngine: [{0}]", msg);
+				else
+					LoggerExtensions::Log(logger, level, "GeomEngine: {0} [{1}]", entity->GetType()->Name, msg);
+		}
+
+		int XbimGeometryCreator::ReportSuppressedLogs(ILogger^ logger)
+		{
+			return XbimLogLimiter::Report(logger, LogRepeatLimit);
+		}
 
-				if (ifcEntity != nullptr)
-					LoggerExtensions::LogInformation(logger, "GeomEngine: #{0}={1} [{2}]", ifcEntity->EntityLabel, ifcEntity->GetType()->Name, msg);
+		void XbimGeometryCreator::ReportNativeLog(ILogger^ logger, Object^ entity)
+		{
+			if (XbimNativeLog::Pending() == 0)
+				return;
+			const int capacity = 64;
+			const char* messages[capacity];
+			int counts[capacity];
+			int count = XbimNativeLog::Drain(messages, counts, capacity);
+			for (int i = 0; i < count; i++)
+			{
+				//native messages are literals without braces, the count is an argument so that the repeats of a message share a format
+				if (counts[i] == 1)
+					LogWarning(logger, entity, gcnew String(messages[i]));
 				else
-					if (entity == nullptr)
-						LoggerExtensions::LogInformation(logger, "GeomEngine: [{0}]", msg);
-					else
-						LoggerExtensions::LogInformation(logger, "GeomEngine: {0} [{1}]", entity->GetType()->Name, msg);
+					LogWarning(logger, entity, String::Concat(gcnew String(messages[i]), " ({0} times)"), counts[i]);
 			}
 		}
 
+		void XbimGeometryCreator::LogInfo(ILogger^ logger, Object^ entity, String^ format, ...array<Object^>^ arg)
+		{
+			Log(LogLevel::Information, logger, entity, format, arg);
+		}
+
 		void XbimGeometryCreator::LogWarning(ILogger^ logger, Object^ entity, String^ format, ...array<Object^>^ arg)
 		{
-			String^ msg = String::Format(format, arg);
-			IPersistEntity^ ifcEntity = dynamic_cast<IPersistEntity^>(entity);
-			if (logger != nullptr)
+			Log(LogLevel::Warning, logger, entity, format, arg);
+		}
+
+		void XbimGeometryCreator::LogDebug(ILogger^ logger, Object^ entity, String^ format, ...array<Object^>^ arg)
+		{
+			Log(LogLevel::Debug, logger, entity, format, arg);
+		}
+
+		array<double>^ XbimGeometryCreator::BenchmarkMeshKernel(int nodeCount, int iterations)
+		{
+			double scalarMs, sse2Ms, avx2Ms;
+			XbimMeshKernel::Benchmark(nodeCount, iterations, scalarMs, sse2Ms, avx2Ms);
+			return gcnew array<double>{ scalarMs, sse2Ms, avx2Ms };
+		}
+
+		array<double>^ XbimGeometryCreator::SortEdgesForWire(array<double>^ points, double tolerance, bool linearScan)
+		{
+			if (points == nullptr || points->Length % 6 != 0)
+				throw gcnew ArgumentException("Six coordinates are required for each edge", "points");
+			NCollection_Vector<TopoDS_Edge> edges, sorted, notTaken;
+			TopTools_IndexedMapOfShape edgeMap;
+			for (int i = 0; i < points->Length; i += 6)
 			{
-				if (ifcEntity != nullptr)
-					LoggerExtensions::LogWarning(logger, "GeomEngine: #{0}={1} [{2}]", ifcEntity->EntityLabel, ifcEntity->GetType()->Name, msg);
-				else
-					if (entity == nullptr)
-						LoggerExtensions::LogWarning(logger, "GeomEngine: [{0}]", msg);
-					else
-						LoggerExtensions::LogWarning(logger, "GeomEngine: {0} [{1}]", entity->GetType()->Name, msg);
+				BRepBuilderAPI_MakeEdge edgeMaker(gp_Pnt(points[i], points[i + 1], points[i + 2]), gp_Pnt(points[i + 3], points[i + 4], points[i + 5]));
+				if (!edgeMaker.IsDone())
+					throw gcnew ArgumentException(String::Format("Edge {0} has no length", i / 6), "points");
+				edges.Append(edgeMaker.Edge());
+				edgeMap.Add(edgeMaker.Edge());
 			}
+			bool closed = false;
+			double maxGap = 0;
+			bool chained = XbimWire::SortEdgesForWire(edges, sorted, notTaken, tolerance, &closed, &maxGap, linearScan);
+			array<double>^ result = gcnew array<double>(4 + sorted.Length() + notTaken.Length());
+			result[0] = chained ? 1 : 0;
+			result[1] = closed ? 1 : 0;
+			result[2] = maxGap;
+			result[3] = sorted.Length();
+			int next = 4;
+			for (NCollection_Vector<TopoDS_Edge>::Iterator it(sorted); it.More(); it.Next())
+				result[next++] = edgeMap.FindIndex(it.Value()) - 1;
+			for (NCollection_Vector<TopoDS_Edge>::Iterator it(notTaken); it.More(); it.Next())
+				result[next++] = edgeMap.FindIndex(it.Value()) - 1;
+			return result;
 		}
 
-		void XbimGeometryCreator::LogDebug(ILogger^ logger, Object^ entity, String^ format, ...array<Object^>^ arg)
+		String^ XbimGeometryCreator::MeshKernelInstructionSet::get()
 		{
-			String^ msg = String::Format(format, arg);
-			IPersistEntity^ ifcEntity = dynamic_cast<IPersistEntity^>(entity);
-			if (logger != nullptr)
+			switch (XbimMeshKernel::Active())
 			{
-				if (ifcEntity != nullptr)
-					LoggerExtensions::LogDebug(logger, "GeomEngine: #{0}={1} [{2}]", ifcEntity->EntityLabel, ifcEntity->GetType()->Name, msg);
-				else
-					if (entity == nullptr)
-						LoggerExtensions::LogDebug(logger, "GeomEngine: [{0}]", msg);
-					else
-						LoggerExtensions::LogDebug(logger, "GeomEngine: {0} [{1}]", entity->GetType()->Name, msg);
+			case XbimMeshKernel::AVX2:
+				return "AVX2";
+			case XbimMeshKernel::SSE2:
+				return "SSE2";
+			default:
+				return "Scalar";
 			}
 		}
 
+		void XbimGeometryCreator::StartTrace(int spansPerThread)
+		{
+			XbimTraceRecorder::Start(spansPerThread);
+		}
+
+		void XbimGeometryCreator::StopTrace()
+		{
+			XbimTraceRecorder::Stop();
+		}
+
+		void XbimGeometryCreator::ClearTrace()
+		{
+			XbimTraceRecorder::Clear();
+		}
+
+		bool XbimGeometryCreator::Tracing::get()
+		{
+			return XbimTraceRecorder::enabled;
+		}
+
+		int XbimGeometryCreator::TraceSpanCount::get()
+		{
+			return XbimTraceRecorder::SpanCount();
+		}
+
+		IntPtr XbimGeometryCreator::RegisterTraceName(String^ name)
+		{
+			IntPtr ansi = Marshal::StringToHGlobalAnsi(name);
+			try
+			{
+				return IntPtr((void*)XbimTraceRecorder::RegisterName((const char*)ansi.ToPointer()));
+			}
+			finally
+			{
+				Marshal::FreeHGlobal(ansi);
+			}
+		}
+
+		void XbimGeometryCreator::BeginTraceSpan(IntPtr name)
+		{
+			if (XbimTraceRecorder::enabled) XbimTraceRecorder::Begin((const char*)name.ToPointer());
+		}
+
+		void XbimGeometryCreator::EndTraceSpan()
+		{
+			XBIM_TRACE_END();
+		}
+
+		bool XbimGeometryCreator::WriteTrace(String^ fileName)
+		{
+			pin_ptr<const wchar_t> path = PtrToStringChars(fileName);
+			return XbimTraceRecorder::Write(path);
+		}
+
+		IDisposable^ XbimGeometryCreator::EnterCancellationScope(System::Threading::CancellationToken token, double budgetSeconds)
+		{
+			return gcnew XbimCancellationScope(token, budgetSeconds);
+		}
+
+		IDisposable^ XbimGeometryCreator::EnterParallelBooleanScope()
+		{
+			return gcnew XbimCancellationScope(System::Threading::CancellationToken::None, 0, true);
+		}
+
+		Int64 XbimGeometryCreator::EstimateNativeBytes(IXbimGeometryObject^ geometryObject)
+		{
+			XbimOccShape^ shape = dynamic_cast<XbimOccShape^>(geometryObject);
+			if (shape != nullptr) return shape->NativeBytesEstimate;
+			Int64 bytes = 0;
+			if (dynamic_cast<XbimSetObject^>(geometryObject) != nullptr)
+				for each (Object^ member in safe_cast<System::Collections::IEnumerable^>(geometryObject))
+					bytes += EstimateNativeBytes(dynamic_cast<IXbimGeometryObject^>(member));
+			return bytes;
+		}
+
+		Int64 XbimGeometryCreator::MemoryPressure(IXbimGeometryObject^ geometryObject)
+		{
+			XbimOccShape^ shape = dynamic_cast<XbimOccShape^>(geometryObject);
+			if (shape != nullptr) return shape->MemoryPressure;
+			Int64 bytes = 0;
+			if (dynamic_cast<XbimSetObject^>(geometryObject) != nullptr)
+				for each (Object^ member in safe_cast<System::Collections::IEnumerable^>(geometryObject))
+					bytes += MemoryPressure(dynamic_cast<IXbimGeometryObject^>(member));
+			return bytes;
+		}
+
+		array<int>^ XbimGeometryCreator::CountFaces(IXbimGeometryObject^ geometryObject)
+		{
+			int faces = 0;
+			int curvedFaces = 0;
+			AddFaceCounts(geometryObject, faces, curvedFaces);
+			return gcnew array<int> { faces, curvedFaces };
+		}
+
+		void XbimGeometryCreator::AddFaceCounts(IXbimGeometryObject^ geometryObject, int% faces, int% curvedFaces)
+		{
+			XbimOccShape^ occShape = dynamic_cast<XbimOccShape^>(geometryObject);
+			if (occShape != nullptr)
+			{
+				if (!occShape->IsValid) return;
+				const TopoDS_Shape& shape = occShape;
+				for (TopExp_Explorer explorer(shape, TopAbs_FACE); explorer.More(); explorer.Next())
+				{
+					faces++;
+					BRepAdaptor_Surface surface(TopoDS::Face(explorer.Current()), Standard_False);
+					if (surface.GetType() != GeomAbs_Plane) curvedFaces++;
+				}
+			}
+			else if (dynamic_cast<XbimSetObject^>(geometryObject) != nullptr)
+				for each (Object^ member in safe_cast<System::Collections::IEnumerable^>(geometryObject))
+					AddFaceCounts(dynamic_cast<IXbimGeometryObject^>(member), faces, curvedFaces);
+		}
+
+		Object^ XbimGeometryCreator::BeginGeometrySession(Object^ entity)
+		{
+			return gcnew XbimGeometrySession(entity);
+		}
+
+		void XbimGeometryCreator::KeepInGeometrySession(Object^ session, IXbimGeometryObject^ geometryObject)
+		{
+			safe_cast<XbimGeometrySession^>(session)->Keep(geometryObject);
+		}
+
+		void XbimGeometryCreator::EndGeometrySession(Object^ session)
+		{
+			safe_cast<XbimGeometrySession^>(session)->End();
+		}
+
+		void XbimGeometryCreator::DetachFromGeometrySessions(IXbimGeometryObject^ geometryObject)
+		{
+			XbimGeometrySession::Detach(geometryObject);
+		}
+
+		array<Int64>^ XbimGeometryCreator::GeometrySessionCounters(Object^ session)
+		{
+			XbimGeometrySession^ geometrySession = safe_cast<XbimGeometrySession^>(session);
+			return gcnew array<Int64> { geometrySession->TrackedObjects, geometrySession->ReleasedObjects, geometrySession->KeptObjects };
+		}
+
 		void XbimGeometryCreator::WriteBrep(String^ filename, IXbimGeometryObject^ geomObj)
 		{
 			throw gcnew System::NotImplementedException();
@@ -115,18 +341,7 @@ namespace Xbim
 
 		void XbimGeometryCreator::LogError(ILogger^ logger, Object^ entity, String^ format, ...array<Object^>^ arg)
 		{
-			String^ msg = String::Format(format, arg);
-			IPersistEntity^ ifcEntity = dynamic_cast<IPersistEntity^>(entity);
-			if (logger != nullptr)
-			{
-				if (ifcEntity != nullptr)
-					LoggerExtensions::LogError(logger, "GeomEngine: #{0}={1} [{2}]", ifcEntity->EntityLabel, ifcEntity->GetType()->Name, msg);
-				else
-					if (entity == nullptr)
-						LoggerExtensions::LogError(logger, "GeomEngine: [{0}]", msg);
-					else
-						LoggerExtensions::LogError(logger, "GeomEngine: {0} [{1}]", entity->GetType()->Name, msg);
-			}
+			Log(LogLevel::Error, logger, entity, format, arg);
 		}
 #pragma warning( pop)
 
@@ -170,143 +385,535 @@ namespace Xbim
 				LogError(logger, geomRep, "Argument error: XbimGeometryCreator::Create,  Geometry Representation Item cannot be null");
 				return nullptr;
 			}
+			XbimGeometryDispatchEntry^ entry = XbimGeometryDispatch::Resolve(geomRep->GetType());
+			if (entry->Builder == nullptr)
+			{
+				LogError(logger, geomRep, "Geometry Representation of Type {0} is not implemented", geomRep->GetType()->Name);
+				return XbimGeometryObjectSet::Empty;
+			}
+			Int64 started = System::Diagnostics::Stopwatch::GetTimestamp();
 			try
 			{
-				IIfcSweptAreaSolid^ sweptAreaSolid = dynamic_cast<IIfcSweptAreaSolid^>(geomRep);
-				if (sweptAreaSolid != nullptr)
-				{
-					if (dynamic_cast<IIfcCompositeProfileDef^>(sweptAreaSolid->SweptArea)) //handle these as composite solids
-					{
-						XbimSolidSet^ solidset = (XbimSolidSet^)CreateSolidSet(sweptAreaSolid, logger);
-						if (objectLocation != nullptr) solidset->Move(objectLocation);
-						return Trim(solidset);
-					}
-					else
-					{
-						XbimSolid^ solid = (XbimSolid^)CreateSolid((IIfcSweptAreaSolid^)geomRep, logger);
-						if (objectLocation != nullptr) solid->Move(objectLocation);
-						return solid;
-					}
-				}
-				else if (dynamic_cast<IIfcManifoldSolidBrep^>(geomRep))
+				try
 				{
-					XbimCompound^ comp = gcnew XbimCompound((IIfcManifoldSolidBrep^)geomRep, logger);
-					if (objectLocation != nullptr) comp->Move(objectLocation);
-					return comp;
+					return entry->Builder(this, geomRep, objectLocation, logger);
 				}
-				else if (dynamic_cast<IIfcSweptDiskSolid^>(geomRep))
+				finally
 				{
-					XbimSolid^ solid = (XbimSolid^)CreateSolid((IIfcSweptDiskSolid^)geomRep, logger);
-					if (objectLocation != nullptr) solid->Move(objectLocation);
-					return solid;
+					ReportNativeLog(logger, geomRep);
+					Interlocked::Increment(entry->Counter->Calls);
+					Interlocked::Add(entry->Counter->Ticks, System::Diagnostics::Stopwatch::GetTimestamp() - started);
 				}
-				else if (dynamic_cast<IIfcBooleanResult^>(geomRep))
+			}
+			catch (const std::exception &exc)
+			{
+				String^ err = gcnew String(exc.what());
+				LogError(logger, geomRep, "Error creating geometry #{2} representation of type {0}, {1}", geomRep->GetType()->Name, err, geomRep->EntityLabel);
+				return XbimGeometryObjectSet::Empty;
+			}
+			//catch ()
+			catch (...)
+			{
+				throw gcnew Exception(String::Format("General Error Creating {0}, #{1}", geomRep->GetType()->Name, geomRep->EntityLabel));
+			}
+		}
+
+		void XbimGeometryCreator::RegisterBuilders()
+		{
+			//the order matters where an item implements more than one of the interfaces
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcSweptAreaSolid::typeid, gcnew XbimGeometryBuilder(&BuildSweptAreaSolid));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcManifoldSolidBrep::typeid, gcnew XbimGeometryBuilder(&BuildManifoldSolidBrep));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcSweptDiskSolid::typeid, gcnew XbimGeometryBuilder(&BuildSweptDiskSolid));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcBooleanResult::typeid, gcnew XbimGeometryBuilder(&BuildBooleanResult));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcFaceBasedSurfaceModel::typeid, gcnew XbimGeometryBuilder(&BuildFaceBasedSurfaceModel));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcShellBasedSurfaceModel::typeid, gcnew XbimGeometryBuilder(&BuildShellBasedSurfaceModel));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcTriangulatedFaceSet::typeid, gcnew XbimGeometryBuilder(&BuildTriangulatedFaceSet));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcPolygonalFaceSet::typeid, gcnew XbimGeometryBuilder(&BuildPolygonalFaceSet));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcSectionedSpine::typeid, gcnew XbimGeometryBuilder(&BuildSectionedSpine));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcHalfSpaceSolid::typeid, gcnew XbimGeometryBuilder(&BuildHalfSpaceSolid));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcCurve::typeid, gcnew XbimGeometryBuilder(&BuildCurve));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcCompositeCurveSegment::typeid, gcnew XbimGeometryBuilder(&BuildCompositeCurveSegment));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcBoundingBox::typeid, gcnew XbimGeometryBuilder(&BuildBoundingBox));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcSurface::typeid, gcnew XbimGeometryBuilder(&BuildSurface));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcCsgSolid::typeid, gcnew XbimGeometryBuilder(&BuildCsgSolid));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcSphere::typeid, gcnew XbimGeometryBuilder(&BuildSphere));
+			XbimGeometryDispatch::RegisterBuiltIn(IIfcGeometricSet::typeid, gcnew XbimGeometryBuilder(&BuildGeometricSet));
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildSweptAreaSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			IIfcSweptAreaSolid^ sweptAreaSolid = (IIfcSweptAreaSolid^)item;
+			if (dynamic_cast<IIfcCompositeProfileDef^>(sweptAreaSolid->SweptArea)) //handle these as composite solids
+			{
+				XbimSolidSet^ solidset = (XbimSolidSet^)creator->CreateSolidSet(sweptAreaSolid, logger);
+				if (objectLocation != nullptr) solidset->Move(objectLocation);
+				return creator->Trim(solidset);
+			}
+			XbimSolid^ solid = (XbimSolid^)creator->CreateSolid(sweptAreaSolid, logger);
+			if (objectLocation != nullptr) solid->Move(objectLocation);
+			return solid;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildManifoldSolidBrep(XbimGeometryCreator^ /*creator*/, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimCompound^ comp = gcnew XbimCompound((IIfcManifoldSolidBrep^)item, logger);
+			if (objectLocation != nullptr) comp->Move(objectLocation);
+			return comp;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildSweptDiskSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimSolid^ solid = (XbimSolid^)creator->CreateSolid((IIfcSweptDiskSolid^)item, logger);
+			if (objectLocation != nullptr) solid->Move(objectLocation);
+			return solid;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildBooleanResult(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimSolidSet^ solidSet = gcnew XbimSolidSet((IIfcBooleanResult^)item, logger);
+			if (objectLocation != nullptr) solidSet->Move(objectLocation);
+			return creator->Trim(solidSet);
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildFaceBasedSurfaceModel(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimCompound^ comp = (XbimCompound^)creator->CreateSurfaceModel((IIfcFaceBasedSurfaceModel^)item, logger);
+			if (objectLocation != nullptr) comp->Move(objectLocation);
+			return comp;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildShellBasedSurfaceModel(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimCompound^ comp = (XbimCompound^)creator->CreateSurfaceModel((IIfcShellBasedSurfaceModel^)item, logger);
+			if (objectLocation != nullptr) comp->Move(objectLocation);
+			return comp;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildTriangulatedFaceSet(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimCompound^ comp = (XbimCompound^)creator->CreateSurfaceModel((IIfcTriangulatedFaceSet^)item, logger);
+			if (objectLocation != nullptr) comp->Move(objectLocation);
+			return comp;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildPolygonalFaceSet(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			IIfcPolygonalFaceSet^ polySet = (IIfcPolygonalFaceSet^)item;
+			if (polySet->Closed.HasValue && polySet->Closed.Value)
+			{
+				XbimSolidSet^ ss = (XbimSolidSet^)creator->CreateSolidSet(polySet, logger);
+				if (objectLocation != nullptr) ss->Move(objectLocation);
+				return ss;
+			}
+			XbimCompound^ comp = (XbimCompound^)creator->CreateSurfaceModel(polySet, logger);
+			if (objectLocation != nullptr) comp->Move(objectLocation);
+			return comp;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildSectionedSpine(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimSolid^ solid = (XbimSolid^)creator->CreateSolid((IIfcSectionedSpine^)item, logger);
+			if (objectLocation != nullptr) solid->Move(objectLocation);
+			return solid;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildHalfSpaceSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimSolid^ solid = (XbimSolid^)creator->CreateSolid((IIfcHalfSpaceSolid^)item, logger);
+			if (objectLocation != nullptr) solid->Move(objectLocation);
+			return solid;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildCurve(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimWire^ wire = (XbimWire^)creator->CreateWire((IIfcCurve^)item, logger);
+			if (objectLocation != nullptr) wire->Move(objectLocation);
+			return wire;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildCompositeCurveSegment(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimWire^ wire = (XbimWire^)creator->CreateWire((IIfcCompositeCurveSegment^)item, logger);
+			if (objectLocation != nullptr) wire->Move(objectLocation);
+			return wire;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildBoundingBox(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimSolid^ solid = (XbimSolid^)creator->CreateSolid((IIfcBoundingBox^)item, logger);
+			if (objectLocation != nullptr) solid->Move(objectLocation);
+			return solid;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildSurface(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimFace^ face = (XbimFace^)creator->CreateFace((IIfcSurface^)item, logger);
+			if (objectLocation != nullptr) face->Move(objectLocation);
+			return face;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildCsgSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimSolidSet^ solidSet = (XbimSolidSet^)creator->CreateSolidSet((IIfcCsgSolid^)item, logger);
+			if (objectLocation != nullptr) solidSet->Move(objectLocation);
+			return creator->Trim(solidSet);
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildSphere(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			XbimSolid^ solid = (XbimSolid^)creator->CreateSolid((IIfcSphere^)item, logger);
+			if (objectLocation != nullptr) solid->Move(objectLocation);
+			return solid;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::BuildGeometricSet(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			if (objectLocation != nullptr) LogError(logger, item, "Move is not implemented for IIfcGeometricSet");
+			return creator->CreateGeometricSet((IIfcGeometricSet^)item, logger);
+		}
+
+		void XbimGeometryCreator::RegisterBuilder(Type^ ifcType, Func<IIfcGeometricRepresentationItem^, ILogger^, IXbimGeometryObject^>^ builder)
+		{
+			if (ifcType == nullptr || builder == nullptr)
+				throw gcnew ArgumentNullException(ifcType == nullptr ? "ifcType" : "builder");
+			XbimCustomGeometryBuilder^ adapter = gcnew XbimCustomGeometryBuilder(builder);
+			XbimGeometryDispatch::RegisterCustom(ifcType, gcnew XbimGeometryBuilder(adapter, &XbimCustomGeometryBuilder::Build));
+		}
+
+		bool XbimGeometryCreator::RemoveBuilder(Type^ ifcType)
+		{
+			return ifcType != nullptr && XbimGeometryDispatch::RemoveCustom(ifcType);
+		}
+
+		Dictionary<String^, array<Int64>^>^ XbimGeometryCreator::DispatchStatistics()
+		{
+			return XbimGeometryDispatch::Statistics();
+		}
+
+		void XbimGeometryCreator::ResetDispatchStatistics()
+		{
+			XbimGeometryDispatch::ResetStatistics();
+		}
+
+		double XbimGeometryCreator::MeasureDispatch(IIfcGeometricRepresentationItem^ item, int iterations)
+		{
+			if (item == nullptr || iterations <= 0)
+				return 0;
+			//the first call resolves the builder, the loop times the lookups Create makes on every later call
+			XbimGeometryDispatch::Resolve(item->GetType());
+			int found = 0;
+			Int64 started = System::Diagnostics::Stopwatch::GetTimestamp();
+			for (int i = 0; i < iterations; i++)
+				if (XbimGeometryDispatch::Resolve(item->GetType())->Builder != nullptr) found++;
+			Int64 elapsed = System::Diagnostics::Stopwatch::GetTimestamp() - started;
+			GC::KeepAlive(found);
+			return elapsed * 1e9 / System::Diagnostics::Stopwatch::Frequency / iterations;
+		}
+
+		array<Int64>^ XbimGeometryCreator::CurveCacheStatistics()
+		{
+			return XbimCurveCache::Statistics();
+		}
+
+		void XbimGeometryCreator::ResetCurveCacheStatistics()
+		{
+			XbimCurveCache::ResetStatistics();
+		}
+
+		void XbimGeometryCreator::ClearCurveCache(IModel^ model)
+		{
+			XbimCurveCache::Clear(model);
+		}
+
+		static bool AddLoftSection(XbimLoftMesher& mesher, IIfcProfileDef^ profile, ILogger^ logger)
+		{
+			XbimFace^ face = gcnew XbimFace(profile, logger);
+			if (!face->IsValid)
+				return false;
+			bool added = mesher.AddSection(face);
+			GC::KeepAlive(face);
+			return added;
+		}
+
+		XbimShapeGeometry^ XbimGeometryCreator::CreateLoftShapeGeometry(IIfcGeometricRepresentationItem^ item, double deflection, double angle, ILogger^ logger)
+		{
+			XbimLoftMesher mesher(deflection, angle);
+			IIfcAxis2Placement3D^ position = nullptr;
+			bool meshed = false;
+			try
+			{
+				if (IIfcExtrudedAreaSolidTapered^ tapered = dynamic_cast<IIfcExtrudedAreaSolidTapered^>(item))
 				{
-					XbimSolidSet^ solidSet = gcnew XbimSolidSet((IIfcBooleanResult^)geomRep, logger);
-					if (objectLocation != nullptr) solidSet->Move(objectLocation);
-					return Trim(solidSet);
+					if (tapered->Depth <= 0 || !AddLoftSection(mesher, tapered->SweptArea, logger) || !AddLoftSection(mesher, tapered->EndSweptArea, logger))
+						return nullptr;
+					IIfcDirection^ dir = tapered->ExtrudedDirection;
+					gp_Vec direction(dir->X, dir->Y, dir->Z);
+					if (direction.Magnitude() < Precision::Confusion())
+						return nullptr;
+					meshed = mesher.Extrude(direction.Normalized() * tapered->Depth);
+					position = tapered->Position;
 				}
-				else if (dynamic_cast<IIfcFaceBasedSurfaceModel^>(geomRep))
+				else if (IIfcRevolvedAreaSolidTapered^ revolved = dynamic_cast<IIfcRevolvedAreaSolidTapered^>(item))
 				{
-					XbimCompound^ comp = (XbimCompound^)CreateSurfaceModel((IIfcFaceBasedSurfaceModel^)geomRep, logger);
-					if (objectLocation != nullptr) comp->Move(objectLocation);
-					return comp;
+					if (!AddLoftSection(mesher, revolved->SweptArea, logger) || !AddLoftSection(mesher, revolved->EndSweptArea, logger))
+						return nullptr;
+					IIfcAxis1Placement^ revolaxis = revolved->Axis;
+					XbimVector3D zDir = revolaxis->Z;
+					gp_Ax1 axis(gp_Pnt(revolaxis->Location->X, revolaxis->Location->Y, revolaxis->Location->Z), gp_Dir(zDir.X, zDir.Y, zDir.Z));
+					double radianConvert = revolved->Model->ModelFactors->AngleToRadiansConversionFactor;
+					meshed = mesher.Revolve(axis, Math::Min(revolved->Angle * radianConvert, Math::PI * 2));
+					position = revolved->Position;
 				}
-				else if (dynamic_cast<IIfcShellBasedSurfaceModel^>(geomRep))
+				else if (IIfcSectionedSpine^ spine = dynamic_cast<IIfcSectionedSpine^>(item))
 				{
-					XbimCompound^ comp = (XbimCompound^)CreateSurfaceModel((IIfcShellBasedSurfaceModel^)geomRep, logger);
-					if (objectLocation != nullptr) comp->Move(objectLocation);
-					return comp;
+					List<IIfcAxis2Placement3D^>^ positions = Enumerable::ToList<IIfcAxis2Placement3D^>(spine->CrossSectionPositions);
+					if (positions->Count < 2 || positions->Count != Enumerable::Count(spine->CrossSections))
+						return nullptr;
+					for each (IIfcProfileDef^ profile in spine->CrossSections)
+						if (!AddLoftSection(mesher, profile, logger))
+							return nullptr;
+					XbimWire^ spineWire = gcnew XbimWire(spine->SpineCurve, logger, XbimConstraints::None);
+					if (!spineWire->IsValid)
+						return nullptr;
+					std::vector<gp_Ax3> placements;
+					for each (IIfcAxis2Placement3D^ placement in positions)
+						placements.push_back(XbimConvert::ToAx3(placement));
+					meshed = mesher.Sweep(spineWire, placements.data());
+					GC::KeepAlive(spineWire);
 				}
-				else if (dynamic_cast<IIfcTriangulatedFaceSet^>(geomRep))
+				else
+					return nullptr;
+			}
+			catch (const Standard_Failure& sf)
+			{
+				XBIM_LOG_DEBUG(logger, item, "Could not mesh the sections directly: {0}", gcnew String(sf.GetMessageString()));
+				return nullptr;
+			}
+			if (!meshed)
+			{
+				XBIM_LOG_DEBUG(logger, item, "Could not mesh the sections directly: {0}", gcnew String(mesher.Error()));
+				return nullptr;
+			}
+			if (position != nullptr) //optional in Ifc4
+				mesher.Transform(XbimConvert::ToTransform(position));
+
+			//the layout CreateShapeGeometry writes, the strips of the sweep have a normal at every index and the caps one each
+			const std::vector<double>& points = mesher.Points();
+			int numVertices = mesher.PointCount();
+			MemoryStream^ memStream = gcnew MemoryStream(0x4000);
+			BinaryWriter^ binaryWriter = gcnew BinaryWriter(memStream);
+			binaryWriter->Write((unsigned char)1); //stream format version
+			binaryWriter->Write((UInt32)numVertices);
+			binaryWriter->Write((UInt32)mesher.TriangleCount());
+			array<Byte>^ vertexBlock = gcnew array<Byte>(numVertices * 3 * sizeof(float));
+			{
+				pin_ptr<Byte> pinned = &vertexBlock[0];
+				XbimMeshKernel::ToFloat(points.data(), numVertices * 3, reinterpret_cast<float*>(pinned));
+			}
+			binaryWriter->Write(vertexBlock);
+			binaryWriter->Write((Int32)mesher.FaceCount());
+			for (int f = 0; f < mesher.FaceCount(); f++)
+			{
+				const std::vector<int>& triangles = mesher.Triangles(f);
+				const std::vector<double>& normals = mesher.Normals(f);
+				if (mesher.IsPlanar(f))
 				{
-					XbimCompound^ comp = (XbimCompound^)CreateSurfaceModel((IIfcTriangulatedFaceSet^)geomRep, logger);
-					if (objectLocation != nullptr) comp->Move(objectLocation);
-					return comp;
+					binaryWriter->Write((Int32)(triangles.size() / 3));
+					XbimPackedNormal(normals[0], normals[1], normals[2]).Write(binaryWriter);
+					for (int index : triangles)
+						XbimOccShape::WriteIndex(binaryWriter, index, numVertices);
 				}
-				else if (dynamic_cast<IIfcPolygonalFaceSet^>(geomRep))
+				else
 				{
-					IIfcPolygonalFaceSet^ polySet = (IIfcPolygonalFaceSet^)geomRep;
-					if (polySet->Closed.HasValue && polySet->Closed.Value)
-					{
-						XbimSolidSet^ ss = (XbimSolidSet^)CreateSolidSet(polySet, logger);
-						if (objectLocation != nullptr) ss->Move(objectLocation);
-						return ss;
-					}
-					else
+					binaryWriter->Write((Int32)(-(int)(triangles.size() / 3)));
+					for (size_t i = 0; i < triangles.size(); i++)
 					{
-						XbimCompound^ comp = (XbimCompound^)CreateSurfaceModel((IIfcPolygonalFaceSet^)geomRep, logger);
-						if (objectLocation != nullptr) comp->Move(objectLocation);
-						return comp;
+						XbimOccShape::WriteIndex(binaryWriter, triangles[i], numVertices);
+						XbimPackedNormal(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]).Write(binaryWriter);
 					}
 				}
-				else if (dynamic_cast<IIfcSectionedSpine^>(geomRep))
-				{
-					XbimSolid^ solid = (XbimSolid^)CreateSolid((IIfcSectionedSpine^)geomRep, logger);
-					if (objectLocation != nullptr) solid->Move(objectLocation);
-					return solid;
-				}
-				else if (dynamic_cast<IIfcHalfSpaceSolid^>(geomRep))
-				{
-					XbimSolid^ solid = (XbimSolid^)CreateSolid((IIfcHalfSpaceSolid^)geomRep, logger);
-					if (objectLocation != nullptr) solid->Move(objectLocation);
-					return solid;
-				}
-				else if (dynamic_cast<IIfcCurve^>(geomRep))
-				{
-					XbimWire^ wire = (XbimWire^)CreateWire((IIfcCurve^)geomRep, logger);
-					if (objectLocation != nullptr) wire->Move(objectLocation);
-					return wire;
-				}
-				else if (dynamic_cast<IIfcCompositeCurveSegment^>(geomRep))
-				{
-					XbimWire^ wire = (XbimWire^)CreateWire((IIfcCompositeCurveSegment^)geomRep, logger);
-					if (objectLocation != nullptr) wire->Move(objectLocation);
-					return wire;
-				}
-				else if (dynamic_cast<IIfcBoundingBox^>(geomRep))
-				{
-					XbimSolid^ solid = (XbimSolid^)CreateSolid((IIfcBoundingBox^)geomRep, logger);
-					if (objectLocation != nullptr) solid->Move(objectLocation);
-					return solid;
-				}
-				else if (dynamic_cast<IIfcSurface^>(geomRep))
-				{
-					XbimFace^ face = (XbimFace^)CreateFace((IIfcSurface^)geomRep, logger);
-					if (objectLocation != nullptr) face->Move(objectLocation);
-					return face;
-				}
-				else if (dynamic_cast<IIfcCsgSolid^>(geomRep))
+			}
+			binaryWriter->Flush();
+
+			XbimShapeGeometry^ shapeGeom = gcnew XbimShapeGeometry();
+			((IXbimShapeGeometryData^)shapeGeom)->ShapeData = memStream->ToArray();
+			delete binaryWriter;
+			delete memStream;
+			Bnd_Box bounds;
+			for (size_t i = 0; i < points.size(); i += 3)
+				bounds.Add(gp_Pnt(points[i], points[i + 1], points[i + 2]));
+			Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+			bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+			shapeGeom->BoundingBox = XbimRect3D(xMin, yMin, zMin, xMax - xMin, yMax - yMin, zMax - zMin);
+			shapeGeom->LOD = XbimLOD::LOD_Unspecified;
+			shapeGeom->Format = XbimGeometryType::PolyhedronBinary;
+			return shapeGeom;
+		}
+
+		static bool AddLoftSectionBounds(Bnd_Box& bounds, IIfcProfileDef^ profile, const gp_Trsf& placement, ILogger^ logger)
+		{
+			XbimFace^ face = gcnew XbimFace(profile, logger);
+			if (!face->IsValid)
+				return false;
+			Bnd_Box faceBounds;
+			BRepBndLib::Add(face, faceBounds);
+			GC::KeepAlive(face);
+			if (faceBounds.IsVoid())
+				return false;
+			bounds.Add(faceBounds.Transformed(placement));
+			return true;
+		}
+
+		XbimRect3D XbimGeometryCreator::LoftBounds(IIfcGeometricRepresentationItem^ item, ILogger^ logger)
+		{
+			Bnd_Box bounds;
+			IIfcAxis2Placement3D^ position = nullptr;
+			try
+			{
+				if (IIfcExtrudedAreaSolidTapered^ tapered = dynamic_cast<IIfcExtrudedAreaSolidTapered^>(item))
 				{
-					XbimSolidSet^ solidSet = (XbimSolidSet^)CreateSolidSet((IIfcCsgSolid^)geomRep, logger);
-					if (objectLocation != nullptr) solidSet->Move(objectLocation);
-					return Trim(solidSet);
+					IIfcDirection^ dir = tapered->ExtrudedDirection;
+					gp_Vec direction(dir->X, dir->Y, dir->Z);
+					if (direction.Magnitude() < Precision::Confusion())
+						return XbimRect3D::Empty;
+					gp_Trsf end;
+					end.SetTranslation(direction.Normalized() * tapered->Depth);
+					if (!AddLoftSectionBounds(bounds, tapered->SweptArea, gp_Trsf(), logger) || !AddLoftSectionBounds(bounds, tapered->EndSweptArea, end, logger))
+						return XbimRect3D::Empty;
+					position = tapered->Position;
 				}
-				else if (dynamic_cast<IIfcSphere^>(geomRep))
+				else if (IIfcRevolvedAreaSolidTapered^ revolved = dynamic_cast<IIfcRevolvedAreaSolidTapered^>(item))
 				{
-					XbimSolid^ solid = (XbimSolid^)CreateSolid((IIfcSphere^)geomRep, logger);
-					if (objectLocation != nullptr) solid->Move(objectLocation);
-					return solid;
+					Bnd_Box sections;
+					if (!AddLoftSectionBounds(sections, revolved->SweptArea, gp_Trsf(), logger) || !AddLoftSectionBounds(sections, revolved->EndSweptArea, gp_Trsf(), logger))
+						return XbimRect3D::Empty;
+					IIfcAxis1Placement^ revolaxis = revolved->Axis;
+					XbimVector3D zDir = revolaxis->Z;
+					gp_Lin axis(gp_Pnt(revolaxis->Location->X, revolaxis->Location->Y, revolaxis->Location->Z), gp_Dir(zDir.X, zDir.Y, zDir.Z));
+					//the sections turn within the cylinder about the axis through the furthest corner of their box, the box of the
+					//cylinder is the stretch of the axis they span enlarged by its radius
+					Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+					sections.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+					double radius = 0;
+					for (int corner = 0; corner < 8; corner++)
+					{
+						gp_Pnt p(corner & 1 ? xMax : xMin, corner & 2 ? yMax : yMin, corner & 4 ? zMax : zMin);
+						radius = Math::Max(radius, axis.Distance(p));
+						bounds.Add(ElCLib::Value(ElCLib::Parameter(axis, p), axis));
+					}
+					bounds.Enlarge(radius);
+					bounds.Add(sections);
+					position = revolved->Position;
 				}
-				else if (dynamic_cast<IIfcGeometricSet^>(geomRep))
+				else if (IIfcSectionedSpine^ spine = dynamic_cast<IIfcSectionedSpine^>(item))
 				{
-					if (objectLocation != nullptr) LogError(logger, geomRep, "Move is not implemented for IIfcGeometricSet");
-					return CreateGeometricSet((IIfcGeometricSet^)geomRep, logger);
+					List<IIfcAxis2Placement3D^>^ positions = Enumerable::ToList<IIfcAxis2Placement3D^>(spine->CrossSectionPositions);
+					if (positions->Count < 2 || positions->Count != Enumerable::Count(spine->CrossSections))
+						return XbimRect3D::Empty;
+					int i = 0;
+					for each (IIfcProfileDef^ profile in spine->CrossSections)
+						if (!AddLoftSectionBounds(bounds, profile, XbimConvert::ToTransform(positions[i++]), logger))
+							return XbimRect3D::Empty;
+					XbimWire^ spineWire = gcnew XbimWire(spine->SpineCurve, logger, XbimConstraints::None);
+					if (!spineWire->IsValid)
+						return XbimRect3D::Empty;
+					BRepBndLib::Add(spineWire, bounds);
+					GC::KeepAlive(spineWire);
 				}
+				else
+					return XbimRect3D::Empty;
 			}
-			catch (const std::exception &exc)
-			{
-				String^ err = gcnew String(exc.what());
-				LogError(logger, geomRep, "Error creating geometry #{2} representation of type {0}, {1}", geomRep->GetType()->Name, err, geomRep->EntityLabel);
-				return XbimGeometryObjectSet::Empty;
-			}
-			//catch ()
-			catch (...)
+			catch (const Standard_Failure& sf)
 			{
-				throw gcnew Exception(String::Format("General Error Creating {0}, #{1}", geomRep->GetType()->Name, geomRep->EntityLabel));
+				XBIM_LOG_DEBUG(logger, item, "Could not bound the sections: {0}", gcnew String(sf.GetMessageString()));
+				return XbimRect3D::Empty;
 			}
-			LogError(logger, geomRep, "Geometry Representation of Type {0} is not implemented", geomRep->GetType()->Name);
-			return XbimGeometryObjectSet::Empty;
+			if (bounds.IsVoid())
+				return XbimRect3D::Empty;
+			if (position != nullptr) //optional in Ifc4
+				bounds = bounds.Transformed(XbimConvert::ToTransform(position));
+			Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+			bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+			return XbimRect3D(xMin, yMin, zMin, xMax - xMin, yMax - yMin, zMax - zMin);
+		}
+
+		array<double>^ XbimGeometryCreator::OrientedBoundingBox(IXbimGeometryObject^ geometryObject)
+		{
+			if (XbimSolidSet^ solidSet = dynamic_cast<XbimSolidSet^>(geometryObject))
+				return solidSet->OrientedBox();
+			if (dynamic_cast<XbimSolid^>(geometryObject) != nullptr || dynamic_cast<XbimCompound^>(geometryObject) != nullptr)
+				return ((XbimOccShape^)geometryObject)->OrientedBox();
+			return nullptr;
+		}
+
+		XbimShapeGeometry^ XbimGeometryCreator::CreateHullShapeGeometry(IXbimGeometryObject^ geometryObject, double deflection, double angle)
+		{
+			if (XbimSolidSet^ solidSet = dynamic_cast<XbimSolidSet^>(geometryObject))
+				return solidSet->ConvexHull(deflection, angle);
+			if (dynamic_cast<XbimSolid^>(geometryObject) != nullptr || dynamic_cast<XbimCompound^>(geometryObject) != nullptr)
+				return ((XbimOccShape^)geometryObject)->ConvexHull(deflection, angle);
+			return nullptr;
+		}
+
+		XbimShapeGeometry^ XbimGeometryCreator::CreateHullShapeGeometry(XbimShapeGeometry^ shapeGeometry)
+		{
+			if (shapeGeometry == nullptr || shapeGeometry->Format != XbimGeometryType::PolyhedronBinary)
+				return nullptr;
+			//the stream format version, the vertex and triangle counts, then the vertices as float triples
+			array<Byte>^ data = ((IXbimShapeGeometryData^)shapeGeometry)->ShapeData;
+			const int header = 1 + 2 * sizeof(UInt32);
+			if (data == nullptr || data->Length < header)
+				return nullptr;
+			int numVertices = (int)BitConverter::ToUInt32(data, 1);
+			if (numVertices < 4 || data->Length < header + (Int64)numVertices * 3 * sizeof(float))
+				return nullptr;
+			std::vector<double> points(numVertices * 3);
+			for (int i = 0; i < numVertices * 3; i++)
+				points[i] = BitConverter::ToSingle(data, header + i * (int)sizeof(float));
+			XbimConvexHull convexHull;
+			if (!convexHull.Build(points.data(), numVertices))
+				return nullptr;
+			XbimShapeGeometry^ hull = XbimShapeBounds::HullShapeGeometry(convexHull);
+			hull->LocalShapeDisplacement = shapeGeometry->LocalShapeDisplacement;
+			return hull;
+		}
+
+		//the triangle tree kept by a shape that has faces, the other shapes cannot be compared
+		static const XbimShapeTree* ShapeTreeOf(IXbimGeometryObject^ geometryObject, double deflection, double angle)
+		{
+			const XbimShapeTree* tree = nullptr;
+			if (XbimSolidSet^ solidSet = dynamic_cast<XbimSolidSet^>(geometryObject))
+				tree = solidSet->ShapeTree(deflection, angle);
+			else if (dynamic_cast<XbimSolid^>(geometryObject) != nullptr || dynamic_cast<XbimCompound^>(geometryObject) != nullptr ||
+				dynamic_cast<XbimShell^>(geometryObject) != nullptr || dynamic_cast<XbimFace^>(geometryObject) != nullptr)
+				tree = ((XbimOccShape^)geometryObject)->ShapeTree(deflection, angle);
+			else
+				throw gcnew NotSupportedException(String::Format("{0} cannot be compared, only solids, solid sets, compounds, shells and faces",
+					geometryObject == nullptr ? "null" : geometryObject->GetType()->Name));
+			if (tree == nullptr)
+				throw gcnew ArgumentException("The shape is not valid");
+			return tree;
+		}
+
+		bool XbimGeometryCreator::Intersects(IXbimGeometryObject^ a, IXbimGeometryObject^ b, double tolerance, double deflection, double angle)
+		{
+			const XbimShapeTree* treeA = ShapeTreeOf(a, deflection, angle);
+			const XbimShapeTree* treeB = ShapeTreeOf(b, deflection, angle);
+			bool intersects = XbimShapeTree::Intersects(*treeA, *treeB, tolerance);
+			//the trees are owned by the objects
+			GC::KeepAlive(a);
+			GC::KeepAlive(b);
+			return intersects;
+		}
+
+		bool XbimGeometryCreator::GeometricallyEquals(IXbimGeometryObject^ a, IXbimGeometryObject^ b, double tolerance, double deflection, double angle)
+		{
+			const XbimShapeTree* treeA = ShapeTreeOf(a, deflection, angle);
+			const XbimShapeTree* treeB = ShapeTreeOf(b, deflection, angle);
+			bool equals = XbimShapeTree::Equals(*treeA, *treeB, tolerance);
+			GC::KeepAlive(a);
+			GC::KeepAlive(b);
+			return equals;
 		}
 
 		/*XbimMesh^ XbimGeometryCreator::CreateMeshGeometry(IXbimGeometryObject^ geometryObject, double precision, double deflection, double angle)
@@ -610,6 +1217,105 @@ namespace Xbim
 			return gcnew XbimSolid(IIfcSolid, logger);
 		};
 
+		array<KeyValuePair<IXbimSolid^, XbimShapeGeometry^>>^ XbimGeometryCreator::CreateSolids(IEnumerable<IIfcExtrudedAreaSolid^>^ items, double deflection, double angle, ILogger^ logger)
+		{
+			List<IIfcExtrudedAreaSolid^>^ itemList = Enumerable::ToList(items);
+			array<KeyValuePair<IXbimSolid^, XbimShapeGeometry^>>^ results = gcnew array<KeyValuePair<IXbimSolid^, XbimShapeGeometry^>>(itemList->Count);
+			array<IXbimSolid^>^ solids = gcnew array<IXbimSolid^>(itemList->Count);
+
+			//read the parameters, the profiles are shared by many extrusions in most models
+			std::vector<XbimSolidBatch::Extrusion> extrusions;
+			List<int>^ batched = gcnew List<int>(itemList->Count);
+			Dictionary<IIfcProfileDef^, XbimFace^>^ profiles = gcnew Dictionary<IIfcProfileDef^, XbimFace^>();
+			for (int i = 0; i < itemList->Count; i++)
+			{
+				IIfcExtrudedAreaSolid^ item = itemList[i];
+				if (item == nullptr)
+					continue;
+				try
+				{
+					IIfcCompositeProfileDef^ compProf = dynamic_cast<IIfcCompositeProfileDef^>(item->SweptArea);
+					if (dynamic_cast<IIfcExtrudedAreaSolidTapered^>(item) != nullptr || compProf != nullptr || item->Depth <= 0 || item->Depth > 1e36)
+					{
+						solids[i] = gcnew XbimSolid(item, logger); //logs its own errors
+						continue;
+					}
+					XbimFace^ face;
+					if (!profiles->TryGetValue(item->SweptArea, face))
+					{
+						face = gcnew XbimFace(item->SweptArea, logger);
+						profiles->Add(item->SweptArea, face);
+					}
+					if (face->BoundingBox.IsEmpty)
+					{
+						solids[i] = gcnew XbimSolid();
+						continue;
+					}
+					IIfcDirection^ dir = item->ExtrudedDirection;
+					gp_Vec vec(dir->X, dir->Y, dir->Z);
+					vec.Normalize();
+					XbimSolidBatch::Extrusion extrusion;
+					extrusion.profile = face;
+					extrusion.direction = vec * item->Depth;
+					if (item->Position != nullptr) //In Ifc4 this is now optional
+						extrusion.location = XbimConvert::ToLocation(item->Position);
+					extrusion.precision = item->Model->ModelFactors->Precision;
+					extrusions.push_back(extrusion);
+					batched->Add(i);
+				}
+				catch (const Standard_Failure& sf)
+				{
+					LogWarning(logger, item, "Could not read the extrusion: {0}", gcnew String(sf.GetMessageString()));
+					solids[i] = gcnew XbimSolid();
+				}
+				catch (Exception^ e) //a missing direction or a profile the builders reject, only this item is lost
+				{
+					LogWarning(logger, item, "Could not read the extrusion: {0}", e->Message);
+					solids[i] = gcnew XbimSolid();
+				}
+			}
+
+			{
+				XBIM_TRACE_SCOPE("MakePrisms");
+				XbimSolidBatch::MakePrisms(extrusions.data(), (int)extrusions.size(), deflection, angle, true);
+			}
+			XBIM_THROW_IF_CANCELLED();
+			for (int k = 0; k < batched->Count; k++)
+			{
+				const XbimSolidBatch::Extrusion& extrusion = extrusions[k];
+				if (extrusion.solid.IsNull())
+				{
+					LogWarning(logger, itemList[batched[k]], "Invalid extrusion, could not create solid");
+					solids[batched[k]] = gcnew XbimSolid();
+				}
+				else
+					solids[batched[k]] = gcnew XbimSolid(extrusion.solid);
+			}
+			GC::KeepAlive(profiles);
+
+			for (int i = 0; i < itemList->Count; i++)
+			{
+				XbimShapeGeometry^ shapeGeom = nullptr;
+				if (deflection > 0 && solids[i] != nullptr && solids[i]->IsValid)
+				{
+					try
+					{
+						shapeGeom = CreateShapeGeometry(solids[i], itemList[i]->Model->ModelFactors->Precision, deflection, angle, XbimGeometryType::PolyhedronBinary, logger);
+					}
+					catch (const Standard_Failure& sf)
+					{
+						LogWarning(logger, itemList[i], "Could not mesh the extrusion: {0}", gcnew String(sf.GetMessageString()));
+					}
+					catch (Exception^ e)
+					{
+						LogWarning(logger, itemList[i], "Could not mesh the extrusion: {0}", e->Message);
+					}
+				}
+				results[i] = KeyValuePair<IXbimSolid^, XbimShapeGeometry^>(solids[i], shapeGeom);
+			}
+			return results;
+		}
+
 		IXbimSolid^ XbimGeometryCreator::CreateSolid(IIfcRevolvedAreaSolid^ IIfcSolid, ILogger^ logger)
 		{
 			return gcnew XbimSolid(IIfcSolid, logger);
@@ -1220,6 +1926,7 @@ namespace Xbim
 					pipeMaker.SetTolerance(precision, precision, 1.0e-2);
 
 					pipeMaker.Add(placedRect75mm, Standard_False, Standard_True);
+					XBIM_THROW_IF_CANCELLED();
 					pipeMaker.Build();
 					pipeMakerStatus = pipeMaker.GetStatus();
 					
@@ -1321,25 +2028,7 @@ namespace Xbim
 			{
 				std::istringstream iss(cStr);
 				BRepTools::Read(result, iss, builder);
-				switch (result.ShapeType())
-				{
-				case TopAbs_VERTEX:
-					return gcnew XbimVertex(TopoDS::Vertex(result));
-				case TopAbs_EDGE:
-					return gcnew XbimEdge(TopoDS::Edge(result));
-				case TopAbs_WIRE:
-					return gcnew XbimWire(TopoDS::Wire(result));
-				case TopAbs_FACE:
-					return gcnew XbimFace(TopoDS::Face(result));
-				case TopAbs_SHELL:
-					return gcnew XbimShell(TopoDS::Shell(result));
-				case TopAbs_SOLID:
-					return gcnew XbimSolid(TopoDS::Solid(result));
-				case TopAbs_COMPOUND:
-					return gcnew XbimCompound(TopoDS::Compound(result), true, 1e-5);
-				default:
-					return nullptr;
-				}
+				return WrapShape(result);
 			}
 			catch (...)
 			{
@@ -1362,6 +2051,137 @@ namespace Xbim
 				return nullptr;
 		}
 
+		IXbimGeometryObject^ XbimGeometryCreator::WrapShape(const TopoDS_Shape& shape)
+		{
+			return WrapShape(shape, true, 1e-5);
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::WrapShape(const TopoDS_Shape& shape, bool sewn, double sewingTolerance)
+		{
+			if (shape.IsNull()) return nullptr;
+			switch (shape.ShapeType())
+			{
+			case TopAbs_VERTEX:
+				return gcnew XbimVertex(TopoDS::Vertex(shape));
+			case TopAbs_EDGE:
+				return gcnew XbimEdge(TopoDS::Edge(shape));
+			case TopAbs_WIRE:
+				return gcnew XbimWire(TopoDS::Wire(shape));
+			case TopAbs_FACE:
+				return gcnew XbimFace(TopoDS::Face(shape));
+			case TopAbs_SHELL:
+				return gcnew XbimShell(TopoDS::Shell(shape));
+			case TopAbs_SOLID:
+				return gcnew XbimSolid(TopoDS::Solid(shape));
+			case TopAbs_COMPOUND:
+				return gcnew XbimCompound(TopoDS::Compound(shape), sewn, sewingTolerance);
+			default:
+				return nullptr;
+			}
+		}
+
+		//the first byte records the kind of object that was written
+		static const char BinaryBrepShape = 0;
+		static const char BinaryBrepSolidSet = 1;
+		static const char BinaryBrepGeometryObjectSet = 2;
+
+		//the BRep is followed by how a compound was sewn, one record for a shape or for each member of a set of other objects.
+		//Data written without them reads back as sewn at 1e-5
+		static void WriteSewing(std::ostream& os, IXbimGeometryObject^ geometryObject)
+		{
+			XbimCompound^ compound = dynamic_cast<XbimCompound^>(geometryObject);
+			double tolerance = compound != nullptr ? compound->SewingTolerance : 1e-5;
+			os.put(compound == nullptr || compound->IsSewn ? 1 : 0);
+			os.write((const char*)&tolerance, sizeof(double));
+		}
+
+		static void ReadSewing(std::istream& is, bool& sewn, double& tolerance)
+		{
+			sewn = true;
+			tolerance = 1e-5;
+			int flag = is.get();
+			double value;
+			if (flag == std::char_traits<char>::eof() || !is.read((char*)&value, sizeof(double))) return;
+			sewn = flag != 0;
+			tolerance = value;
+		}
+
+		array<Byte>^ XbimGeometryCreator::ToBinaryBrep(IXbimGeometryObject^ geometryObject)
+		{
+			char kind;
+			TopoDS_Shape shape;
+			XbimOccShape^ occShape = dynamic_cast<XbimOccShape^>(geometryObject);
+			if (occShape != nullptr)
+			{
+				if (!occShape->IsValid) return nullptr;
+				kind = BinaryBrepShape;
+				shape = occShape;
+			}
+			else if (dynamic_cast<XbimSetObject^>(geometryObject) != nullptr)
+			{
+				kind = dynamic_cast<IXbimSolidSet^>(geometryObject) != nullptr ? BinaryBrepSolidSet : BinaryBrepGeometryObjectSet;
+				shape = XbimGeometryObjectSet::CreateCompound(safe_cast<IEnumerable<IXbimGeometryObject^>^>(geometryObject));
+			}
+			else
+				return nullptr;
+			std::ostringstream oss(std::ios::out | std::ios::binary);
+			oss.put(kind);
+			BinTools::Write(shape, oss);
+			if (kind == BinaryBrepShape)
+				WriteSewing(oss, geometryObject);
+			else if (kind == BinaryBrepGeometryObjectSet)
+			{
+				//in the order CreateCompound adds them
+				for each (IXbimGeometryObject^ member in safe_cast<IEnumerable<IXbimGeometryObject^>^>(geometryObject))
+					if (dynamic_cast<XbimOccShape^>(member) != nullptr || dynamic_cast<IEnumerable<IXbimGeometryObject^>^>(member) != nullptr)
+						WriteSewing(oss, member);
+			}
+			std::string data = oss.str();
+			array<Byte>^ bytes = gcnew array<Byte>((int)data.size());
+			Marshal::Copy(IntPtr((void*)data.data()), bytes, 0, bytes->Length);
+			return bytes;
+		}
+
+		IXbimGeometryObject^ XbimGeometryCreator::FromBinaryBrep(array<Byte>^ data)
+		{
+			if (data == nullptr || data->Length < 2) return nullptr;
+			std::string buffer(data->Length, '\0');
+			Marshal::Copy(data, 0, IntPtr((void*)buffer.data()), data->Length);
+			std::istringstream iss(buffer, std::ios::in | std::ios::binary);
+			char kind = (char)iss.get();
+			TopoDS_Shape shape;
+			try
+			{
+				BinTools::Read(shape, iss);
+			}
+			catch (const Standard_Failure&)
+			{
+				return nullptr;
+			}
+			if (shape.IsNull()) return nullptr;
+			bool sewn;
+			double sewingTolerance;
+			switch (kind)
+			{
+			case BinaryBrepSolidSet:
+				return gcnew XbimSolidSet(shape);
+			case BinaryBrepGeometryObjectSet:
+			{
+				XbimGeometryObjectSet^ geometryObjects = gcnew XbimGeometryObjectSet();
+				for (TopoDS_Iterator it(shape); it.More(); it.Next())
+				{
+					ReadSewing(iss, sewn, sewingTolerance);
+					IXbimGeometryObject^ member = WrapShape(it.Value(), sewn, sewingTolerance);
+					if (member != nullptr) geometryObjects->Add(member);
+				}
+				return geometryObjects;
+			}
+			default:
+				ReadSewing(iss, sewn, sewingTolerance);
+				return WrapShape(shape, sewn, sewingTolerance);
+			}
+		}
+
 		
 
 		IXbimGeometryObject^ XbimGeometryCreator::Trim(XbimSetObject^ geometryObject)
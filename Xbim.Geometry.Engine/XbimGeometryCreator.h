@@ -2,6 +2,7 @@
 #include "XbimVertex.h"
 #include "XbimVertex.h"
 #include "XbimEdge.h"
+#include "XbimGeometryDispatch.h"
 using namespace System;
 using namespace System::IO;
 using namespace Xbim::Common;
@@ -66,6 +67,27 @@ namespace Xbim
 				if (!bool::TryParse(ignoreIfcSweptDiskSolidParamsString, IgnoreIfcSweptDiskSolidParams))
 					IgnoreIfcSweptDiskSolidParams = false;
 
+				String^ nativePolygonTriangulatorString = ConfigurationManager::AppSettings["NativePolygonTriangulator"];
+				if (!bool::TryParse(nativePolygonTriangulatorString, UseNativePolygonTriangulator))
+					UseNativePolygonTriangulator = true;
+
+				String^ reportMemoryPressureString = ConfigurationManager::AppSettings["ReportMemoryPressure"];
+				if (!bool::TryParse(reportMemoryPressureString, ReportMemoryPressure))
+					ReportMemoryPressure = true;
+
+				String^ logRepeatLimitString = ConfigurationManager::AppSettings["LogRepeatLimit"];
+				if (!int::TryParse(logRepeatLimitString, LogRepeatLimit))
+					LogRepeatLimit = 0;
+
+				String^ curveCacheString = ConfigurationManager::AppSettings["CurveCache"];
+				if (!bool::TryParse(curveCacheString, UseCurveCache))
+					UseCurveCache = true;
+
+				String^ parallelAdvancedFacesString = ConfigurationManager::AppSettings["ParallelAdvancedFaces"];
+				if (!bool::TryParse(parallelAdvancedFacesString, ParallelAdvancedFaces))
+					ParallelAdvancedFaces = true;
+
+				RegisterBuilders();
 			}
 		protected:
 			~XbimGeometryCreator()
@@ -80,6 +102,15 @@ namespace Xbim
 			static void LogWarning(ILogger^ logger, Object^ entity, String^ format, ... array<Object^>^ arg);
 			static void LogError(ILogger^ logger, Object^ entity, String^ format, ... array<Object^>^ arg);
 			static void LogDebug(ILogger^ logger, Object^ entity, String^ format, ... array<Object^>^ arg);
+			//true if the logger writes messages of the level, the XBIM_LOG macros test this before the arguments are boxed
+			static bool IsLogEnabled(ILogger^ logger, LogLevel level);
+			//a message other than an error is logged at most this many times for the same entity, the repeats are counted and reported
+			//by ReportSuppressedLogs. Defaults to the LogRepeatLimit app setting, or 0 for no limit. This is a process wide setting
+			static int LogRepeatLimit;
+			//logs how many times each suppressed message was repeated and clears the counts, returns the number of messages suppressed
+			static int ReportSuppressedLogs(ILogger^ logger);
+			//logs the warnings raised by native code on the calling thread since they were last reported
+			static void ReportNativeLog(ILogger^ logger, Object^ entity);
 
 			virtual void WriteBrep(String^ filename, IXbimGeometryObject^ geomObj);
 			virtual IXbimGeometryObject^ ReadBrep(String^ filename);
@@ -89,6 +120,97 @@ namespace Xbim
 			static double LinearDeflectionInMM;
 			static double AngularDeflectionInRadians;
 			static bool IgnoreIfcSweptDiskSolidParams;
+			//planar faces are triangulated by the native ear clipping triangulator, if false or if it fails the managed tessellator is used
+			static bool UseNativePolygonTriangulator;
+			//solids, shells and compounds built from IFC report their estimated native size to the GC so that it collects them sooner,
+			//wrappers of existing OCC shapes do not, they would walk and count the shared topology again
+			static bool ReportMemoryPressure;
+			//the directrices of swept solids are kept per model and reused by the items that sweep along the same curve with the same trims
+			static bool UseCurveCache;
+			//the edges of an advanced brep are projected onto the surfaces of its faces on OCC's thread pool
+			static bool ParallelAdvancedFaces;
+			//the estimated native size in bytes of the shape, or of the members of a set
+			static Int64 EstimateNativeBytes(IXbimGeometryObject^ geometryObject);
+			//the bytes reported to the GC for the shape, or for the members of a set
+			static Int64 MemoryPressure(IXbimGeometryObject^ geometryObject);
+			//the number of faces of the shape, or of the members of a set, and how many of them are not planar
+			static array<int>^ CountFaces(IXbimGeometryObject^ geometryObject);
+
+			//times the node transform kernel used by the triangulation writers against the scalar gp_Trsf loop
+			//returns the scalar, SSE2 and AVX2 times in milliseconds, -1 if the processor does not support the instruction set
+			static array<double>^ BenchmarkMeshKernel(int nodeCount, int iterations);
+			//chains straight edges end to end with XbimWire::SortEdgesForWire, points holds the start and end of each edge, 6 coordinates per edge
+			//returns 1 if every edge was chained else 0, 1 if the chain closes else 0, the largest gap accepted, the number of edges chained, then the
+			//indices of the chained edges followed by those not taken. linearScan measures every free edge at each step instead of using the grid
+			static array<double>^ SortEdgesForWire(array<double>^ points, double tolerance, bool linearScan);
+			//the instruction set used by the triangulation writers, Scalar, SSE2 or AVX2
+			static property String^ MeshKernelInstructionSet { String^ get(); }
+
+			//span recording of the geometry pipeline, written as a Chrome trace event file. Each thread keeps the last spansPerThread spans
+			static void StartTrace(int spansPerThread);
+			static void StopTrace();
+			static void ClearTrace();
+			static property bool Tracing { bool get(); }
+			static property int TraceSpanCount { int get(); }
+			//returns a native copy of the span name, register a name once and pass the handle to BeginTraceSpan
+			static IntPtr RegisterTraceName(String^ name);
+			static void BeginTraceSpan(IntPtr name);
+			static void EndTraceSpan();
+			static bool WriteTrace(String^ fileName);
+
+			//OCC algorithms run on the calling thread until the returned scope is disposed stop when the token is cancelled
+			//or when budgetSeconds have passed, budgetSeconds <= 0 sets no deadline. Scopes nest
+			static IDisposable^ EnterCancellationScope(System::Threading::CancellationToken token, double budgetSeconds);
+			//booleans run on the calling thread until the returned scope is disposed spread the intersection of their tools over several threads
+			static IDisposable^ EnterParallelBooleanScope();
+
+			//geometry objects created on the calling thread until the session is ended have their native shapes released
+			//when it ends, unless kept. The session is returned as an opaque handle for the other session methods. Warnings native
+			//code raises in the session are logged against the entity, which may be null
+			static Object^ BeginGeometrySession(Object^ entity);
+			static void KeepInGeometrySession(Object^ session, IXbimGeometryObject^ geometryObject);
+			static void EndGeometrySession(Object^ session);
+			//keeps the object in every open session of the calling thread, its owner releases it
+			static void DetachFromGeometrySessions(IXbimGeometryObject^ geometryObject);
+			//the tracked, released and kept object counts of the session
+			static array<Int64>^ GeometrySessionCounters(Object^ session);
+
+			//Create builds items of the type, or of types derived from it, with the builder instead of the built in one. Process wide
+			static void RegisterBuilder(Type^ ifcType, Func<IIfcGeometricRepresentationItem^, ILogger^, IXbimGeometryObject^>^ builder);
+			//restores the built in builder, returns false if the type has no registered builder
+			static bool RemoveBuilder(Type^ ifcType);
+			//the calls made by Create and their elapsed stopwatch ticks by the runtime type of the item
+			static Dictionary<String^, array<Int64>^>^ DispatchStatistics();
+			static void ResetDispatchStatistics();
+			//the average time in nanoseconds Create takes to find the builder of the item
+			static double MeasureDispatch(IIfcGeometricRepresentationItem^ item, int iterations);
+			//hits, misses, curves added, the stopwatch ticks spent building them and the ticks the hits saved, since the process started or the statistics were reset
+			static array<Int64>^ CurveCacheStatistics();
+			static void ResetCurveCacheStatistics();
+			//drops the directrices kept for the model, they are also dropped when the model is collected
+			static void ClearCurveCache(IModel^ model);
+			//meshes an IfcExtrudedAreaSolidTapered, IfcRevolvedAreaSolidTapered or IfcSectionedSpine straight from its cross sections, without
+			//the B-rep Create builds. Null if the item is of another type or cannot be meshed this way, it should then be built with Create
+			static XbimShapeGeometry^ CreateLoftShapeGeometry(IIfcGeometricRepresentationItem^ item, double deflection, double angle, ILogger^ logger);
+			//a box around the item CreateLoftShapeGeometry would mesh, from its placed sections and without meshing them, so the deflection
+			//can be chosen first. It may be larger than the mesh, a revolution is bounded by the cylinder it turns in. Empty if it cannot be worked out
+			static XbimRect3D LoftBounds(IIfcGeometricRepresentationItem^ item, ILogger^ logger);
+			//the centre, the x, y and z directions and the half sizes of a tight box around a solid, solid set or compound, 15 values. Null
+			//for other objects or empty shapes. The box is kept by the object
+			static array<double>^ OrientedBoundingBox(IXbimGeometryObject^ geometryObject);
+			//the convex hull of a solid, solid set or compound as a shape geometry of planar triangles, a light proxy for its mesh. Null for
+			//other objects or shapes that do not span a volume. The hull is kept by the object
+			static XbimShapeGeometry^ CreateHullShapeGeometry(IXbimGeometryObject^ geometryObject, double deflection, double angle);
+			//the convex hull of the vertices of a PolyhedronBinary shape geometry, for shapes meshed without a B-rep. Null for other formats
+			//or meshes that do not span a volume
+			static XbimShapeGeometry^ CreateHullShapeGeometry(XbimShapeGeometry^ shapeGeometry);
+			//true if two solids, solid sets, compounds, shells or faces come within the tolerance of each other or a solid of one holds the
+			//other. The triangles of the two are paired through bounding volume hierarchies kept by the objects, contacts the mesh cannot
+			//settle are measured on the B-rep. A deflection of 0 meshes each shape to a hundredth of its size
+			static bool Intersects(IXbimGeometryObject^ a, IXbimGeometryObject^ b, double tolerance, double deflection, double angle);
+			//true if two such shapes are within the tolerance of each other everywhere, by a symmetric Hausdorff bound over the nodes and
+			//triangle centres of their meshes, widened by the deflections of the meshes
+			static bool GeometricallyEquals(IXbimGeometryObject^ a, IXbimGeometryObject^ b, double tolerance, double deflection, double angle);
 
 			virtual XbimShapeGeometry^ CreateShapeGeometry(IXbimGeometryObject^ geometryObject, double precision, double deflection, double angle, XbimGeometryType storageType, ILogger^ logger);
 
@@ -160,6 +282,11 @@ namespace Xbim
 			//static IXbimSolid^ CreateSolid(IIfcSolidModel^ IIfcSolid);
 			virtual IXbimSolid^ CreateSolid(IIfcSweptAreaSolid^ ifcSolid, ILogger^ logger);
 			virtual IXbimSolid^ CreateSolid(IIfcExtrudedAreaSolid^ ifcSolid, ILogger^ logger);
+			//builds many extrusions in one call, each profile is read once however many items share it and the prisms are made and meshed
+			//on OCC's thread pool. Tapered extrusions and composite profiles are built one at a time as CreateSolid builds them. There is an
+			//entry for each item in order, with the solid CreateSolid would return and, if deflection > 0, its shape geometry, null if the
+			//solid is not valid. Errors are logged against their item
+			array<KeyValuePair<IXbimSolid^, XbimShapeGeometry^>>^ CreateSolids(IEnumerable<IIfcExtrudedAreaSolid^>^ items, double deflection, double angle, ILogger^ logger);
 			virtual IXbimSolid^ CreateSolid(IIfcRevolvedAreaSolid^ ifcSolid, ILogger^ logger);
 			virtual IXbimSolid^ CreateSolid(IIfcSweptDiskSolid^ ifcSolid, ILogger^ logger);
 			virtual IXbimSolid^ CreateSolid(IIfcBoundingBox^ ifcSolid, ILogger^ logger);
@@ -253,8 +380,41 @@ namespace Xbim
 			virtual IXbimGeometryObject^ Moved(IXbimGeometryObject^ geometryObject, IIfcObjectPlacement^ objectPlacement, ILogger^ logger);
 			virtual IXbimGeometryObject^ FromBrep(String^ brepStr);
 			virtual String^ ToBrep(IXbimGeometryObject^ geometryObject);
+			//binary BRep is smaller and faster to read and write than the text form, sets are written as a compound of their members
+			//and read back as a set of the same kind, compounds keep their sewing tolerance. Returns null if the object is not a shape or a set
+			static array<Byte>^ ToBinaryBrep(IXbimGeometryObject^ geometryObject);
+			static IXbimGeometryObject^ FromBinaryBrep(array<Byte>^ data);
+		private:
+			static IXbimGeometryObject^ WrapShape(const TopoDS_Shape& shape);
+			static IXbimGeometryObject^ WrapShape(const TopoDS_Shape& shape, bool sewn, double sewingTolerance);
+			static void AddFaceCounts(IXbimGeometryObject^ geometryObject, int% faces, int% curvedFaces);
+			static void Log(LogLevel level, ILogger^ logger, Object^ entity, String^ format, array<Object^>^ arg);
+			//the built in builders of Create, registered in the order the types are tried
+			static void RegisterBuilders();
+			static IXbimGeometryObject^ BuildSweptAreaSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildManifoldSolidBrep(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildSweptDiskSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildBooleanResult(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildFaceBasedSurfaceModel(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildShellBasedSurfaceModel(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildTriangulatedFaceSet(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildPolygonalFaceSet(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildSectionedSpine(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildHalfSpaceSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildCurve(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildCompositeCurveSegment(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildBoundingBox(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildSurface(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildCsgSolid(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildSphere(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+			static IXbimGeometryObject^ BuildGeometricSet(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
 
 		};
 			
 	};
-}
\ No newline at end of file
+}
+
+//log only if the level is enabled, so that the arguments are not boxed and the message is not formatted when it is not
+#define XBIM_LOG_WARNING(logger, entity, format, ...) do { if (Xbim::Geometry::XbimGeometryCreator::IsLogEnabled(logger, Microsoft::Extensions::Logging::LogLevel::Warning)) Xbim::Geometry::XbimGeometryCreator::LogWarning(logger, entity, format, __VA_ARGS__); } while (0)
+#define XBIM_LOG_INFO(logger, entity, format, ...) do { if (Xbim::Geometry::XbimGeometryCreator::IsLogEnabled(logger, Microsoft::Extensions::Logging::LogLevel::Information)) Xbim::Geometry::XbimGeometryCreator::LogInfo(logger, entity, format, __VA_ARGS__); } while (0)
+#define XBIM_LOG_DEBUG(logger, entity, format, ...) do { if (Xbim::Geometry::XbimGeometryCreator::IsLogEnabled(logger, Microsoft::Extensions::Logging::LogLevel::Debug)) Xbim::Geometry::XbimGeometryCreator::LogDebug(logger, entity, format, __VA_ARGS__); } while (0)
@@ -0,0 +1,137 @@
+#include "XbimGeometryDispatch.h"
+#include "XbimGeometryCreator.h"
+#include "XbimConvert.h"
+
+using namespace System::Threading;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		IXbimGeometryObject^ XbimCustomGeometryBuilder::Build(XbimGeometryCreator^ /*creator*/, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger)
+		{
+			IXbimGeometryObject^ geometry = build(item, logger);
+			if (geometry != nullptr && objectLocation != nullptr)
+				geometry = geometry->Transform(XbimConvert::ToMatrix3D(objectLocation));
+			return geometry;
+		}
+
+		void XbimGeometryDispatch::RegisterBuiltIn(Type^ ifcType, XbimGeometryBuilder^ builder)
+		{
+			Monitor::Enter(registrationLock);
+			try
+			{
+				builtIn->Add(KeyValuePair<Type^, XbimGeometryBuilder^>(ifcType, builder));
+				resolved->Clear();
+			}
+			finally
+			{
+				Monitor::Exit(registrationLock);
+			}
+		}
+
+		void XbimGeometryDispatch::RegisterCustom(Type^ ifcType, XbimGeometryBuilder^ builder)
+		{
+			Monitor::Enter(registrationLock);
+			try
+			{
+				for (int i = custom->Count - 1; i >= 0; i--)
+					if (custom[i].Key == ifcType) custom->RemoveAt(i);
+				//the latest registration is tried first
+				custom->Insert(0, KeyValuePair<Type^, XbimGeometryBuilder^>(ifcType, builder));
+				resolved->Clear();
+			}
+			finally
+			{
+				Monitor::Exit(registrationLock);
+			}
+		}
+
+		bool XbimGeometryDispatch::RemoveCustom(Type^ ifcType)
+		{
+			Monitor::Enter(registrationLock);
+			try
+			{
+				for (int i = 0; i < custom->Count; i++)
+				{
+					if (custom[i].Key == ifcType)
+					{
+						custom->RemoveAt(i);
+						resolved->Clear();
+						return true;
+					}
+				}
+				return false;
+			}
+			finally
+			{
+				Monitor::Exit(registrationLock);
+			}
+		}
+
+		XbimGeometryDispatchEntry^ XbimGeometryDispatch::Resolve(Type^ runtimeType)
+		{
+			XbimGeometryDispatchEntry^ entry;
+			if (resolved->TryGetValue(runtimeType, entry))
+				return entry;
+			return ResolveNew(runtimeType);
+		}
+
+		XbimGeometryDispatchEntry^ XbimGeometryDispatch::ResolveNew(Type^ runtimeType)
+		{
+			Monitor::Enter(registrationLock);
+			try
+			{
+				XbimGeometryDispatchEntry^ entry = gcnew XbimGeometryDispatchEntry();
+				entry->Counter = counters->GetOrAdd(runtimeType, gcnew XbimGeometryDispatchCounter());
+				for each (KeyValuePair<Type^, XbimGeometryBuilder^> registration in custom)
+				{
+					if (registration.Key->IsAssignableFrom(runtimeType))
+					{
+						entry->Builder = registration.Value;
+						break;
+					}
+				}
+				if (entry->Builder == nullptr)
+				{
+					for each (KeyValuePair<Type^, XbimGeometryBuilder^> registration in builtIn)
+					{
+						if (registration.Key->IsAssignableFrom(runtimeType))
+						{
+							entry->Builder = registration.Value;
+							break;
+						}
+					}
+				}
+				//unsupported types are cached too, so they are not searched for again
+				resolved[runtimeType] = entry;
+				return entry;
+			}
+			finally
+			{
+				Monitor::Exit(registrationLock);
+			}
+		}
+
+		Dictionary<String^, array<Int64>^>^ XbimGeometryDispatch::Statistics()
+		{
+			Dictionary<String^, array<Int64>^>^ statistics = gcnew Dictionary<String^, array<Int64>^>();
+			for each (KeyValuePair<Type^, XbimGeometryDispatchCounter^> counter in counters)
+			{
+				Int64 calls = Interlocked::Read(counter.Value->Calls);
+				if (calls == 0) continue;
+				statistics[counter.Key->Name] = gcnew array<Int64>{ calls, Interlocked::Read(counter.Value->Ticks) };
+			}
+			return statistics;
+		}
+
+		void XbimGeometryDispatch::ResetStatistics()
+		{
+			for each (KeyValuePair<Type^, XbimGeometryDispatchCounter^> counter in counters)
+			{
+				Interlocked::Exchange(counter.Value->Calls, 0);
+				Interlocked::Exchange(counter.Value->Ticks, 0);
+			}
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Generic;
+using namespace System::Collections::Concurrent;
+using namespace Microsoft::Extensions::Logging;
+using namespace Xbim::Common::Geometry;
+using namespace Xbim::Ifc4::Interfaces;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		ref class XbimGeometryCreator;
+
+		//builds the geometry of a representation item, moved to the object location if one is given
+		delegate IXbimGeometryObject^ XbimGeometryBuilder(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+
+		//the calls made for one runtime type, kept when the builders are registered again
+		ref class XbimGeometryDispatchCounter
+		{
+		public:
+			Int64 Calls;
+			Int64 Ticks;
+		};
+
+		//the builder resolved for one runtime type, Builder is null if there is none
+		ref class XbimGeometryDispatchEntry
+		{
+		public:
+			XbimGeometryBuilder^ Builder;
+			XbimGeometryDispatchCounter^ Counter;
+		};
+
+		//adapts a builder registered through the interop, which does not know about the object location
+		ref class XbimCustomGeometryBuilder
+		{
+		private:
+			Func<IIfcGeometricRepresentationItem^, ILogger^, IXbimGeometryObject^>^ build;
+		public:
+			XbimCustomGeometryBuilder(Func<IIfcGeometricRepresentationItem^, ILogger^, IXbimGeometryObject^>^ build) : build(build) {}
+			IXbimGeometryObject^ Build(XbimGeometryCreator^ creator, IIfcGeometricRepresentationItem^ item, IIfcAxis2Placement3D^ objectLocation, ILogger^ logger);
+		};
+
+		//maps the runtime type of a representation item to its builder. Builders are registered against IFC interfaces, the first
+		//registration the runtime type implements wins, as the first match of the dynamic_cast chain it replaces did. The builder of
+		//each runtime type is resolved once and then found with a single lookup. Custom builders take precedence over the built in ones
+		ref class XbimGeometryDispatch abstract sealed
+		{
+		private:
+			static Object^ registrationLock = gcnew Object();
+			static List<KeyValuePair<Type^, XbimGeometryBuilder^>>^ builtIn = gcnew List<KeyValuePair<Type^, XbimGeometryBuilder^>>();
+			static List<KeyValuePair<Type^, XbimGeometryBuilder^>>^ custom = gcnew List<KeyValuePair<Type^, XbimGeometryBuilder^>>();
+			static ConcurrentDictionary<Type^, XbimGeometryDispatchEntry^>^ resolved = gcnew ConcurrentDictionary<Type^, XbimGeometryDispatchEntry^>();
+			static ConcurrentDictionary<Type^, XbimGeometryDispatchCounter^>^ counters = gcnew ConcurrentDictionary<Type^, XbimGeometryDispatchCounter^>();
+			static XbimGeometryDispatchEntry^ ResolveNew(Type^ runtimeType);
+		public:
+			static void RegisterBuiltIn(Type^ ifcType, XbimGeometryBuilder^ builder);
+			//replaces any custom builder of the type
+			static void RegisterCustom(Type^ ifcType, XbimGeometryBuilder^ builder);
+			//returns false if the type has no custom builder
+			static bool RemoveCustom(Type^ ifcType);
+			static XbimGeometryDispatchEntry^ Resolve(Type^ runtimeType);
+			//calls and elapsed stopwatch ticks by runtime type name
+			static Dictionary<String^, array<Int64>^>^ Statistics();
+			static void ResetStatistics();
+		};
+	}
+}
@@ -1,11 +1,15 @@
 #include "XbimGeometryObject.h"
 #include "XbimOccShape.h"
+#include "XbimGeometrySession.h"
 #include <BRepTools.hxx>
 namespace Xbim
 {
 	namespace Geometry
 	{
-				
+		XbimGeometryObject::XbimGeometryObject()
+		{
+			XbimGeometrySession::Track(this);
+		}
 
 		String^ XbimGeometryObject::ToBRep::get()
 		{
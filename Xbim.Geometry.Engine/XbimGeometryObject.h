@@ -78,7 +78,7 @@ namespace Xbim
 		private:
 			Object^ tag;
 		public:
-			XbimGeometryObject(){};
+			XbimGeometryObject();
 #pragma region destructors
 
 			virtual ~XbimGeometryObject() {};
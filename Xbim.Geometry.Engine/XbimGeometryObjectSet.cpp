@@ -5,6 +5,7 @@
 #include "XbimEdgeSet.h"
 #include "XbimVertexSet.h"
 #include "XbimGeometryCreator.h"
+#include "XbimGeometrySession.h"
 
 #include <TopTools_IndexedMapOfShape.hxx>
 #include <TopExp.hxx>
@@ -500,6 +501,8 @@ namespace Xbim
 				builder.MakeCompound(occCompound);
 
 				TopTools_ListIteratorOfListOfShape itl(toBeProcessed);
+				//the shapes carry no entity, the messages are logged against the product whose session is open
+				Object^ entity = XbimGeometrySession::CurrentEntity;
 
 				for (; itl.More(); itl.Next())
 				{
@@ -520,6 +523,7 @@ namespace Xbim
 					{
 						success = BOOLEAN_FAIL;
 					}
+					XbimGeometryCreator::ReportNativeLog(logger, entity);
 					String^ msg = "";
 					switch (success)
 					{
@@ -539,7 +543,7 @@ namespace Xbim
 						break;
 					}
 					if (!String::IsNullOrWhiteSpace(msg))
-						XbimGeometryCreator::LogWarning(logger, nullptr, msg);
+						XbimGeometryCreator::LogWarning(logger, entity, msg);
 
 				}
 
@@ -0,0 +1,72 @@
+#include "XbimGeometrySession.h"
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		XbimGeometrySession::XbimGeometrySession() : XbimGeometrySession(nullptr) {}
+
+		XbimGeometrySession::XbimGeometrySession(Object^ entity) : entity(entity)
+		{
+			tracked = gcnew List<XbimGeometryObject^>();
+			kept = gcnew HashSet<Object^>(gcnew XbimReferenceComparer());
+			parent = current;
+			current = this;
+		}
+
+		Object^ XbimGeometrySession::CurrentEntity::get()
+		{
+			for (XbimGeometrySession^ session = current; session != nullptr; session = session->parent)
+				if (session->entity != nullptr) return session->entity;
+			return nullptr;
+		}
+
+		void XbimGeometrySession::Track(XbimGeometryObject^ geometryObject)
+		{
+			XbimGeometrySession^ session = current;
+			if (session != nullptr) session->tracked->Add(geometryObject);
+		}
+
+		void XbimGeometrySession::Keep(IXbimGeometryObject^ geometryObject)
+		{
+			if (geometryObject == nullptr || !kept->Add(geometryObject)) return;
+			//compounds create new wrappers when enumerated, only sets hold their members
+			XbimSetObject^ set = dynamic_cast<XbimSetObject^>(geometryObject);
+			if (set != nullptr) KeepSetMembers(set);
+		}
+
+		void XbimGeometrySession::Detach(IXbimGeometryObject^ geometryObject)
+		{
+			for (XbimGeometrySession^ session = current; session != nullptr; session = session->parent)
+				session->Keep(geometryObject);
+		}
+
+		void XbimGeometrySession::KeepSetMembers(XbimSetObject^ set)
+		{
+			System::Collections::IEnumerable^ members = dynamic_cast<System::Collections::IEnumerable^>(set);
+			if (members == nullptr) return;
+			for each (Object^ member in members)
+				Keep(dynamic_cast<IXbimGeometryObject^>(member));
+		}
+
+		void XbimGeometrySession::End()
+		{
+			if (ended) return;
+			ended = true;
+			if (current == this) current = parent;
+			trackedCount = tracked->Count;
+			for each (XbimGeometryObject^ geometryObject in tracked)
+			{
+				if (kept->Contains(geometryObject))
+				{
+					//without an enclosing session kept objects are released by their owner, or the finalizer
+					if (parent != nullptr) parent->tracked->Add(geometryObject);
+					continue;
+				}
+				delete geometryObject;
+				released++;
+			}
+			tracked->Clear();
+		}
+	}
+}
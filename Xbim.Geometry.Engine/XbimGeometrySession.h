@@ -0,0 +1,62 @@
+#pragma once
+#include "XbimGeometryObject.h"
+
+using namespace System;
+using namespace System::Collections::Generic;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		//compares wrappers by reference, XbimEdge and XbimFace override Equals with a geometric comparison
+		private ref class XbimReferenceComparer : IEqualityComparer<Object^>
+		{
+		public:
+			virtual bool Equals(Object^ x, Object^ y) { return Object::ReferenceEquals(x, y); }
+			virtual int GetHashCode(Object^ obj) { return System::Runtime::CompilerServices::RuntimeHelpers::GetHashCode(obj); }
+		};
+
+		//tracks every geometry object created on the calling thread while the session is open and releases the native
+		//shapes of all of them when the session ends, instead of leaving them to the finalizer. Objects that must outlive
+		//the session are excluded with Keep. Sessions nest, an object belongs to the innermost session of its thread and
+		//objects kept by a nested session pass to the session that encloses it.
+		//OCC allocates through a single process wide memory manager so the shapes cannot be given an allocator of their own,
+		//the session releases the handles it owns and OCC frees the memory when the last reference to it goes
+		ref class XbimGeometrySession
+		{
+		private:
+			[ThreadStatic]
+			static XbimGeometrySession^ current;
+			XbimGeometrySession^ parent;
+			List<XbimGeometryObject^>^ tracked;
+			HashSet<Object^>^ kept;
+			Object^ entity;
+			long long trackedCount;
+			long long released;
+			bool ended;
+
+			void KeepSetMembers(XbimSetObject^ set);
+		public:
+			//opens a session on the calling thread, it must be ended on the same thread
+			XbimGeometrySession();
+			//a session for the work on an IFC entity, the messages that native code raises with no entity are logged against it
+			XbimGeometrySession(Object^ entity);
+			static property XbimGeometrySession^ Current { XbimGeometrySession^ get() { return current; } }
+			//the entity of the innermost session of the calling thread that has one, null if none has
+			static property Object^ CurrentEntity { Object^ get(); }
+			//called by every geometry object when it is constructed
+			static void Track(XbimGeometryObject^ geometryObject);
+
+			//excludes the object and, for a set, its members from the release at the end of the session
+			void Keep(IXbimGeometryObject^ geometryObject);
+			//keeps the object in the current session and every session enclosing it, so none of them releases it
+			static void Detach(IXbimGeometryObject^ geometryObject);
+			//releases the native shapes of every object that has not been kept and closes the session
+			void End();
+
+			property long long TrackedObjects { long long get() { return ended ? trackedCount : tracked->Count; } }
+			property long long ReleasedObjects { long long get() { return released; } }
+			property long long KeptObjects { long long get() { return kept->Count; } }
+		};
+	}
+}
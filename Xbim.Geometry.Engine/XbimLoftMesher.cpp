@@ -0,0 +1,590 @@
+#include "XbimLoftMesher.h"
+#include "XbimPolygonTriangulator.h"
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_CompCurve.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepTools.hxx>
+#include <BRepTools_WireExplorer.hxx>
+#include <GCPnts_TangentialDeflection.hxx>
+#include <gp_Lin.hxx>
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	//the most segments an edge or a revolution is divided into
+	const int MaxSegments = 512;
+
+	std::vector<TopoDS_Edge> WireEdges(const TopoDS_Wire& wire, const TopoDS_Face& face)
+	{
+		std::vector<TopoDS_Edge> edges;
+		for (BRepTools_WireExplorer exp(wire, face); exp.More(); exp.Next())
+		{
+			if (!BRep_Tool::Degenerated(exp.Current()))
+				edges.push_back(exp.Current());
+		}
+		return edges;
+	}
+
+	//straight edges need no points between their ends, curves are divided as the B-rep mesher would divide them
+	int EdgeSegments(const TopoDS_Edge& edge, double linearDeflection, double angularDeflection)
+	{
+		BRepAdaptor_Curve curve(edge);
+		if (curve.GetType() == GeomAbs_Line)
+			return 1;
+		GCPnts_TangentialDeflection sampler(curve, angularDeflection, linearDeflection, 2);
+		return std::min(std::max(sampler.NbPoints() - 1, 1), MaxSegments);
+	}
+
+	//twice the signed area of the uv points from start for count points
+	double SignedArea(const std::vector<double>& uv, int start, int count)
+	{
+		double area = 0;
+		for (int i = 0; i < count; i++)
+		{
+			int j = start + i;
+			int k = start + (i + 1) % count;
+			area += uv[2 * j] * uv[2 * k + 1] - uv[2 * k] * uv[2 * j + 1];
+		}
+		return area;
+	}
+
+	//carries the x direction of a frame from one point of a curve to the next by the double reflection method of Wang et al.,
+	//the tangents are unit vectors
+	gp_Vec CarryFrame(const gp_Pnt& from, const gp_Vec& fromTangent, const gp_Vec& x, const gp_Pnt& to, const gp_Vec& toTangent)
+	{
+		gp_Vec v1(from, to);
+		double c1 = v1.SquareMagnitude();
+		if (c1 < Precision::SquareConfusion())
+			return x;
+		gp_Vec xL = x - v1 * (2. / c1 * v1.Dot(x));
+		gp_Vec tL = fromTangent - v1 * (2. / c1 * v1.Dot(fromTangent));
+		gp_Vec v2 = toTangent - tL;
+		double c2 = v2.SquareMagnitude();
+		if (c2 < Precision::SquareConfusion())
+			return xL;
+		return xL - v2 * (2. / c2 * v2.Dot(xL));
+	}
+}
+
+XbimLoftMesher::XbimLoftMesher(double linearDeflection, double angularDeflection) :
+	linearDeflection(linearDeflection > 0 ? linearDeflection : Precision::Confusion()),
+	angularDeflection(angularDeflection > 0 ? angularDeflection : 0.5),
+	error(nullptr)
+{
+}
+
+int XbimLoftMesher::TriangleCount() const
+{
+	size_t count = 0;
+	for (const Face& face : faces)
+		count += face.triangles.size() / 3;
+	return (int)count;
+}
+
+bool XbimLoftMesher::AddSection(const TopoDS_Face& profile)
+{
+	TopoDS_Wire outerWire = BRepTools::OuterWire(profile);
+	if (outerWire.IsNull())
+	{
+		error = "the profile has no outer wire";
+		return false;
+	}
+	std::vector<std::vector<TopoDS_Edge>> wires;
+	wires.push_back(WireEdges(outerWire, profile));
+	for (TopoDS_Iterator it(profile); it.More(); it.Next())
+	{
+		if (it.Value().ShapeType() == TopAbs_WIRE && !it.Value().IsSame(outerWire))
+			wires.push_back(WireEdges(TopoDS::Wire(it.Value()), profile));
+	}
+	for (const std::vector<TopoDS_Edge>& edges : wires)
+	{
+		if (edges.empty())
+		{
+			error = "the profile has an empty wire";
+			return false;
+		}
+	}
+	if (!sections.empty())
+	{
+		const std::vector<std::vector<TopoDS_Edge>>& first = sections.front();
+		bool matches = first.size() == wires.size();
+		for (size_t w = 0; matches && w < wires.size(); w++)
+			matches = first[w].size() == wires[w].size();
+		if (!matches)
+		{
+			error = "the sections do not have the same wires and edges";
+			return false;
+		}
+	}
+	sections.push_back(wires);
+	return true;
+}
+
+bool XbimLoftMesher::Sample()
+{
+	if (sections.empty())
+	{
+		error = "there are no sections";
+		return false;
+	}
+	const std::vector<std::vector<TopoDS_Edge>>& first = sections.front();
+	try
+	{
+		segments.assign(first.size(), std::vector<int>());
+		for (size_t w = 0; w < first.size(); w++)
+		{
+			segments[w].assign(first[w].size(), 1);
+			for (const std::vector<std::vector<TopoDS_Edge>>& section : sections)
+				for (size_t e = 0; e < section[w].size(); e++)
+					segments[w][e] = std::max(segments[w][e], EdgeSegments(section[w][e], linearDeflection, angularDeflection));
+		}
+		wireStarts.clear();
+		wireSizes.clear();
+		int size = 0;
+		for (const std::vector<int>& wireSegments : segments)
+		{
+			int wireSize = 0;
+			for (int n : wireSegments)
+				wireSize += n;
+			wireStarts.push_back(size);
+			wireSizes.push_back(wireSize);
+			size += wireSize;
+		}
+
+		samples.assign(sections.size(), std::vector<double>());
+		for (size_t s = 0; s < sections.size(); s++)
+		{
+			std::vector<double>& uv = samples[s];
+			uv.reserve(2 * size);
+			for (size_t w = 0; w < sections[s].size(); w++)
+			{
+				for (size_t e = 0; e < sections[s][w].size(); e++)
+				{
+					const TopoDS_Edge& edge = sections[s][w][e];
+					BRepAdaptor_Curve curve(edge);
+					double u0 = curve.FirstParameter();
+					double u1 = curve.LastParameter();
+					if (edge.Orientation() == TopAbs_REVERSED)
+						std::swap(u0, u1);
+					//the end of each edge is the start of the next
+					int n = segments[w][e];
+					for (int j = 0; j < n; j++)
+					{
+						gp_Pnt p = curve.Value(u0 + (u1 - u0) * j / n);
+						uv.push_back(p.X());
+						uv.push_back(p.Y());
+					}
+				}
+			}
+		}
+	}
+	catch (const Standard_Failure&)
+	{
+		error = "the sections could not be sampled";
+		return false;
+	}
+
+	wireSigns.clear();
+	for (size_t w = 0; w < wireSizes.size(); w++)
+	{
+		double area = SignedArea(samples[0], wireStarts[w], wireSizes[w]);
+		if (wireSizes[w] < 3 || std::abs(area) < Precision::SquareConfusion())
+		{
+			error = "a wire of the profile has no area";
+			return false;
+		}
+		for (size_t s = 1; s < samples.size(); s++)
+		{
+			if ((SignedArea(samples[s], wireStarts[w], wireSizes[w]) > 0) != (area > 0))
+			{
+				error = "the sections do not turn the same way";
+				return false;
+			}
+		}
+		wireSigns.push_back((area > 0) == (w == 0) ? 1 : -1);
+	}
+	return true;
+}
+
+bool XbimLoftMesher::Extrude(const gp_Vec& direction)
+{
+	if (direction.Magnitude() < Precision::Confusion())
+	{
+		error = "the extrusion has no depth";
+		return false;
+	}
+	if (!Sample())
+		return false;
+	int last = (int)sections.size() - 1;
+	std::vector<Ring> rings(2);
+	rings[0] = { gp::Origin(), gp::DX(), gp::DY(), 0, last, 0. };
+	rings[1] = { gp_Pnt(direction.XYZ()), gp::DX(), gp::DY(), 0, last, 1. };
+	return Build(rings);
+}
+
+bool XbimLoftMesher::Revolve(const gp_Ax1& axis, double angle)
+{
+	if (angle <= 0)
+	{
+		error = "the revolution has no angle";
+		return false;
+	}
+	if (!Sample())
+		return false;
+	int last = (int)sections.size() - 1;
+	//the sections are divided as a circle through their furthest point from the axis would be
+	gp_Lin line(axis);
+	double radius = 0;
+	for (int s : { 0, last })
+		for (size_t i = 0; i < samples[s].size(); i += 2)
+			radius = std::max(radius, line.Distance(gp_Pnt(samples[s][i], samples[s][i + 1], 0)));
+	int count = (int)std::ceil(angle / angularDeflection);
+	if (radius > linearDeflection)
+		count = std::max(count, (int)std::ceil(angle / (2 * std::acos(1 - linearDeflection / radius))));
+	//a full turn ends on the ring it started from, that ring closes the sweep rather than two caps lying on each other
+	bool fullTurn = angle >= 2 * M_PI - Precision::Angular();
+	count = std::min(std::max(count, fullTurn ? 3 : 1), MaxSegments);
+
+	std::vector<Ring> rings(fullTurn ? count : count + 1);
+	for (int i = 0; i < (int)rings.size(); i++)
+	{
+		gp_Trsf rotation;
+		rotation.SetRotation(axis, angle * i / count);
+		rings[i] = { gp::Origin().Transformed(rotation), gp::DX().Transformed(rotation), gp::DY().Transformed(rotation), 0, last, (double)i / count };
+	}
+	return Build(rings, fullTurn);
+}
+
+bool XbimLoftMesher::Sweep(const TopoDS_Wire& spine, const gp_Ax3* positions)
+{
+	int count = (int)sections.size();
+	if (count < 2)
+	{
+		error = "a sweep needs two sections";
+		return false;
+	}
+	if (!Sample())
+		return false;
+
+	std::vector<gp_Pnt> path;
+	try
+	{
+		BRepAdaptor_CompCurve spineCurve(spine);
+		GCPnts_TangentialDeflection sampler(spineCurve, angularDeflection, linearDeflection, 2);
+		for (int i = 1; i <= sampler.NbPoints(); i++)
+		{
+			gp_Pnt p = sampler.Value(i);
+			if (path.empty() || p.Distance(path.back()) > Precision::Confusion())
+				path.push_back(p);
+		}
+	}
+	catch (const Standard_Failure&)
+	{
+		error = "the spine could not be sampled";
+		return false;
+	}
+	if (path.size() < 2)
+	{
+		error = "the spine has no length";
+		return false;
+	}
+	std::vector<double> lengths(path.size(), 0.);
+	for (size_t j = 1; j < path.size(); j++)
+		lengths[j] = lengths[j - 1] + path[j - 1].Distance(path[j]);
+
+	//where each section lies along the spine, and how far it is off it
+	std::vector<double> at(count);
+	std::vector<gp_Vec> offsets(count);
+	size_t from = 0;
+	for (int i = 0; i < count; i++)
+	{
+		gp_Pnt location = positions[i].Location();
+		double nearest = std::numeric_limits<double>::max();
+		for (size_t j = from; j + 1 < path.size(); j++)
+		{
+			gp_Vec segment(path[j], path[j + 1]);
+			double length = segment.Magnitude();
+			double t = std::min(std::max(gp_Vec(path[j], location).Dot(segment) / (length * length), 0.), 1.);
+			gp_Pnt foot(path[j].XYZ() + segment.XYZ() * t);
+			double distance = foot.Distance(location);
+			if (distance < nearest - Precision::Confusion())
+			{
+				nearest = distance;
+				at[i] = lengths[j] + length * t;
+				offsets[i] = gp_Vec(foot, location);
+				from = j;
+			}
+		}
+		if (i > 0 && at[i] <= at[i - 1] + Precision::Confusion())
+		{
+			error = "the sections are not in order along the spine";
+			return false;
+		}
+	}
+
+	std::vector<Ring> rings;
+	for (int i = 0; i + 1 < count; i++)
+	{
+		const gp_Ax3& start = positions[i];
+		const gp_Ax3& end = positions[i + 1];
+		rings.push_back({ start.Location(), start.XDirection(), start.YDirection(), i, i, 0. });
+
+		//the points of the spine between the sections, with their tangents
+		std::vector<gp_Pnt> points;
+		std::vector<gp_Vec> tangents;
+		std::vector<double> weights;
+		for (size_t j = 0; j < path.size(); j++)
+		{
+			if (lengths[j] <= at[i] + Precision::Confusion() || lengths[j] >= at[i + 1] - Precision::Confusion())
+				continue;
+			gp_Vec tangent(0, 0, 0);
+			if (j > 0)
+				tangent += gp_Vec(path[j - 1], path[j]).Normalized();
+			if (j + 1 < path.size())
+				tangent += gp_Vec(path[j], path[j + 1]).Normalized();
+			if (tangent.Magnitude() < Precision::Confusion())
+			{
+				error = "the spine turns back on itself";
+				return false;
+			}
+			double w = (lengths[j] - at[i]) / (at[i + 1] - at[i]);
+			points.push_back(path[j].Translated(offsets[i] * (1 - w) + offsets[i + 1] * w));
+			tangents.push_back(tangent.Normalized());
+			weights.push_back(w);
+		}
+
+		//carry the start frame to the end section, then share the twist that is left to meet the end frame out along the way
+		std::vector<gp_Vec> xs;
+		gp_Pnt previous = start.Location();
+		gp_Vec previousTangent(start.Direction());
+		gp_Vec x(start.XDirection());
+		for (size_t k = 0; k < points.size(); k++)
+		{
+			x = CarryFrame(previous, previousTangent, x, points[k], tangents[k]);
+			xs.push_back(x);
+			previous = points[k];
+			previousTangent = tangents[k];
+		}
+		gp_Vec endTangent(end.Direction());
+		x = CarryFrame(previous, previousTangent, x, end.Location(), endTangent);
+		x -= endTangent * x.Dot(endTangent);
+		double twist = x.Magnitude() > Precision::Confusion() ? x.AngleWithRef(gp_Vec(end.XDirection()), endTangent) : 0.;
+		for (size_t k = 0; k < points.size(); k++)
+		{
+			gp_Vec xk = xs[k].Rotated(gp_Ax1(gp::Origin(), gp_Dir(tangents[k])), twist * weights[k]);
+			xk -= tangents[k] * xk.Dot(tangents[k]);
+			if (xk.Magnitude() < Precision::Confusion())
+			{
+				error = "the frame of the sweep is lost";
+				return false;
+			}
+			gp_Dir xDir(xk);
+			rings.push_back({ points[k], xDir, gp_Dir(tangents[k]).Crossed(xDir), i, i + 1, weights[k] });
+		}
+	}
+	const gp_Ax3& last = positions[count - 1];
+	rings.push_back({ last.Location(), last.XDirection(), last.YDirection(), count - 1, count - 1, 0. });
+	return Build(rings);
+}
+
+gp_Pnt XbimLoftMesher::Point(int ring, int index) const
+{
+	size_t i = 3 * ((size_t)ring * (samples[0].size() / 2) + index);
+	return gp_Pnt(points[i], points[i + 1], points[i + 2]);
+}
+
+gp_Vec XbimLoftMesher::SideNormal(int ringCount, bool closed, int ring, int wire, int edgeStart, int edgeSegments, int j) const
+{
+	int start = wireStarts[wire];
+	int size = wireSizes[wire];
+	int at = start + (edgeStart + j) % size;
+	int before = start + (edgeStart + std::max(j - 1, 0)) % size;
+	int after = start + (edgeStart + std::min(j + 1, edgeSegments)) % size;
+	gp_Vec alongProfile(Point(ring, before), Point(ring, after));
+	gp_Vec alongSweep = closed
+		? gp_Vec(Point((ring + ringCount - 1) % ringCount, at), Point((ring + 1) % ringCount, at))
+		: gp_Vec(Point(std::max(ring - 1, 0), at), Point(std::min(ring + 1, ringCount - 1), at));
+	return alongProfile.Crossed(alongSweep) * wireSigns[wire];
+}
+
+bool XbimLoftMesher::AddCap(const Ring& ring, int ringIndex, bool start)
+{
+	int ringSize = (int)(samples[0].size() / 2);
+	gp_Dir normal = ring.x.Crossed(ring.y);
+	XbimPolygonTriangulator triangulator;
+	triangulator.Begin(gp_Ax3(ring.origin, normal, ring.x));
+	for (size_t w = 0; w < wireSizes.size(); w++)
+	{
+		triangulator.BeginContour();
+		for (int k = 0; k < wireSizes[w]; k++)
+			triangulator.AddPoint(Point(ringIndex, wireStarts[w] + k));
+	}
+	//the sweep runs along the normal of the sections, so the start faces back against it
+	if (!triangulator.Triangulate(start))
+	{
+		error = "an end of the loft could not be triangulated";
+		return false;
+	}
+	Face face;
+	face.planar = true;
+	face.triangles.reserve(triangulator.Triangles().size());
+	for (int t : triangulator.Triangles())
+		face.triangles.push_back(ringIndex * ringSize + t);
+	gp_Dir faceNormal = start ? normal.Reversed() : normal;
+	face.normals = { faceNormal.X(), faceNormal.Y(), faceNormal.Z() };
+	faces.push_back(face);
+	return true;
+}
+
+bool XbimLoftMesher::Build(const std::vector<Ring>& rings, bool closed)
+{
+	int ringSize = (int)(samples[0].size() / 2);
+	int ringCount = (int)rings.size();
+	points.clear();
+	faces.clear();
+	points.reserve(3 * (size_t)ringSize * ringCount);
+	for (const Ring& ring : rings)
+	{
+		const std::vector<double>& a = samples[ring.a];
+		const std::vector<double>& b = samples[ring.b];
+		for (int i = 0; i < ringSize; i++)
+		{
+			double u = a[2 * i] * (1 - ring.w) + b[2 * i] * ring.w;
+			double v = a[2 * i + 1] * (1 - ring.w) + b[2 * i + 1] * ring.w;
+			gp_XYZ p = ring.origin.XYZ() + ring.x.XYZ() * u + ring.y.XYZ() * v;
+			points.push_back(p.X());
+			points.push_back(p.Y());
+			points.push_back(p.Z());
+		}
+	}
+
+	//one strip of quads for each edge of the sections, the strips of curved edges are smooth along the edge
+	for (size_t w = 0; w < segments.size(); w++)
+	{
+		int start = wireStarts[w];
+		int size = wireSizes[w];
+		int edgeStart = 0;
+		for (int n : segments[w])
+		{
+			Face face;
+			face.planar = false;
+			int strips = closed ? ringCount : ringCount - 1;
+			face.triangles.reserve(6 * (size_t)n * strips);
+			face.normals.reserve(18 * (size_t)n * strips);
+			auto addTriangle = [&](const int(&corners)[3][2])
+			{
+				gp_Pnt p[3];
+				for (int c = 0; c < 3; c++)
+					p[c] = Point(corners[c][0] % ringCount, start + (edgeStart + corners[c][1]) % size);
+				gp_Vec triangleNormal = gp_Vec(p[0], p[1]).Crossed(gp_Vec(p[0], p[2]));
+				for (int c = 0; c < 3; c++)
+				{
+					int ring = corners[c][0] % ringCount;
+					face.triangles.push_back(ring * ringSize + start + (edgeStart + corners[c][1]) % size);
+					gp_Vec normal = SideNormal(ringCount, closed, ring, (int)w, edgeStart, n, corners[c][1]);
+					if (normal.SquareMagnitude() < Precision::SquareConfusion())
+						normal = triangleNormal;
+					if (normal.SquareMagnitude() < Precision::SquareConfusion())
+						normal = gp_Vec(0, 0, 1);
+					normal.Normalize();
+					face.normals.push_back(normal.X());
+					face.normals.push_back(normal.Y());
+					face.normals.push_back(normal.Z());
+				}
+			};
+			for (int r = 0; r < strips; r++)
+			{
+				for (int j = 0; j < n; j++)
+				{
+					if (wireSigns[w] > 0)
+					{
+						addTriangle({ { r, j }, { r, j + 1 }, { r + 1, j + 1 } });
+						addTriangle({ { r, j }, { r + 1, j + 1 }, { r + 1, j } });
+					}
+					else
+					{
+						addTriangle({ { r, j }, { r + 1, j + 1 }, { r, j + 1 } });
+						addTriangle({ { r, j }, { r + 1, j }, { r + 1, j + 1 } });
+					}
+				}
+			}
+			faces.push_back(face);
+			edgeStart += n;
+		}
+	}
+	if (!closed && (!AddCap(rings.front(), 0, true) || !AddCap(rings.back(), ringCount - 1, false)))
+		return false;
+
+	//the strips and caps face out if the sweep runs along the normal of the sections, turn them round if it runs the other way
+	gp_XYZ origin = Point(0, 0).XYZ();
+	double volume = 0;
+	for (const Face& face : faces)
+	{
+		const std::vector<int>& t = face.triangles;
+		for (size_t i = 0; i < t.size(); i += 3)
+		{
+			gp_XYZ a = gp_XYZ(points[3 * t[i]], points[3 * t[i] + 1], points[3 * t[i] + 2]) - origin;
+			gp_XYZ b = gp_XYZ(points[3 * t[i + 1]], points[3 * t[i + 1] + 1], points[3 * t[i + 1] + 2]) - origin;
+			gp_XYZ c = gp_XYZ(points[3 * t[i + 2]], points[3 * t[i + 2] + 1], points[3 * t[i + 2] + 2]) - origin;
+			volume += a.Dot(b.Crossed(c));
+		}
+	}
+	if (volume < 0)
+	{
+		for (Face& face : faces)
+		{
+			for (size_t i = 0; i < face.triangles.size(); i += 3)
+			{
+				std::swap(face.triangles[i + 1], face.triangles[i + 2]);
+				if (!face.planar)
+					for (int k = 0; k < 3; k++)
+						std::swap(face.normals[3 * (i + 1) + k], face.normals[3 * (i + 2) + k]);
+			}
+			for (double& value : face.normals)
+				value = -value;
+		}
+	}
+	return true;
+}
+
+void XbimLoftMesher::Transform(const gp_Trsf& transform)
+{
+	for (size_t i = 0; i < points.size(); i += 3)
+	{
+		gp_XYZ p(points[i], points[i + 1], points[i + 2]);
+		transform.Transforms(p);
+		points[i] = p.X();
+		points[i + 1] = p.Y();
+		points[i + 2] = p.Z();
+	}
+	for (Face& face : faces)
+	{
+		for (size_t i = 0; i < face.normals.size(); i += 3)
+		{
+			gp_Vec normal(face.normals[i], face.normals[i + 1], face.normals[i + 2]);
+			normal.Transform(transform);
+			if (normal.SquareMagnitude() > 0)
+				normal.Normalize();
+			face.normals[i] = normal.X();
+			face.normals[i + 1] = normal.Y();
+			face.normals[i + 2] = normal.Z();
+		}
+		//a mirror turns the triangles inside out
+		if (transform.IsNegative())
+		{
+			for (size_t i = 0; i < face.triangles.size(); i += 3)
+			{
+				std::swap(face.triangles[i + 1], face.triangles[i + 2]);
+				if (!face.planar)
+					for (int k = 0; k < 3; k++)
+						std::swap(face.normals[3 * (i + 1) + k], face.normals[3 * (i + 2) + k]);
+			}
+		}
+	}
+}
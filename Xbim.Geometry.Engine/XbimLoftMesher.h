@@ -0,0 +1,85 @@
+#pragma once
+#include <gp_Ax1.hxx>
+#include <gp_Ax3.hxx>
+#include <gp_Trsf.hxx>
+#include <gp_Vec.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Wire.hxx>
+#include <vector>
+
+//Meshes tapered extrusions, tapered revolutions and sectioned spines directly from their cross sections, without the pipe shell or
+//loft B-rep the solid builders make. Every section is sampled edge by edge at the same parameters, so the nth point of each section
+//corresponds, the sections are placed as rings along the sweep and joined by triangle strips, and the ends are capped. Between two
+//sections the points are interpolated linearly. The mesh is closed and outward facing but has no B-rep behind it, so it is only used
+//for shapes that take no part in booleans. The header is included by /clr code, the implementation is compiled natively
+class XbimLoftMesher
+{
+public:
+	XbimLoftMesher(double linearDeflection, double angularDeflection);
+
+	//adds a cross section, the profile lies in the XY plane. Returns false if its wires and edges do not match those of the first section
+	bool AddSection(const TopoDS_Face& profile);
+	//places the first section at the origin and the last at the end of the direction
+	bool Extrude(const gp_Vec& direction);
+	//turns the first section about the axis through the angle in radians, changing into the last section as it goes. A full turn
+	//closes on the first section and has no caps
+	bool Revolve(const gp_Ax1& axis, double angle);
+	//places section i at positions[i] and carries it along the spine to the next with rotation minimising frames, twisted evenly to meet it
+	bool Sweep(const TopoDS_Wire& spine, const gp_Ax3* positions);
+	//moves the mesh, after it has been built
+	void Transform(const gp_Trsf& transform);
+
+	//the points of the mesh as xyz triples
+	const std::vector<double>& Points() const { return points; }
+	int PointCount() const { return (int)(points.size() / 3); }
+	int FaceCount() const { return (int)faces.size(); }
+	//the triangles of the face as triples of indices into Points
+	const std::vector<int>& Triangles(int face) const { return faces[face].triangles; }
+	//one normal for a planar face, one for each index of Triangles otherwise, as xyz triples
+	const std::vector<double>& Normals(int face) const { return faces[face].normals; }
+	bool IsPlanar(int face) const { return faces[face].planar; }
+	int TriangleCount() const;
+	//why the last call failed
+	const char* Error() const { return error; }
+
+private:
+	struct Face
+	{
+		std::vector<int> triangles;
+		std::vector<double> normals;
+		bool planar;
+	};
+
+	//a placed section, the points are interpolated from section a to section b by w
+	struct Ring
+	{
+		gp_Pnt origin;
+		gp_Dir x, y;
+		int a, b;
+		double w;
+	};
+
+	double linearDeflection;
+	double angularDeflection;
+	const char* error;
+	//the edges of each wire of each section, in wire order, the outer wire first
+	std::vector<std::vector<std::vector<TopoDS_Edge>>> sections;
+	//the segments of each edge of each wire, the same for every section
+	std::vector<std::vector<int>> segments;
+	//the sampled points of each section as uv pairs, wire after wire
+	std::vector<std::vector<double>> samples;
+	//where each wire starts in the samples and how it turns, 1 if its points run anticlockwise for an outer wire or clockwise for a hole
+	std::vector<int> wireStarts;
+	std::vector<int> wireSizes;
+	std::vector<int> wireSigns;
+	std::vector<double> points;
+	std::vector<Face> faces;
+
+	bool Sample();
+	//a closed sweep joins the last ring back to the first and is not capped
+	bool Build(const std::vector<Ring>& rings, bool closed = false);
+	gp_Pnt Point(int ring, int index) const;
+	gp_Vec SideNormal(int ringCount, bool closed, int ring, int wire, int edgeStart, int edgeSegments, int j) const;
+	bool AddCap(const Ring& ring, int ringIndex, bool start);
+};
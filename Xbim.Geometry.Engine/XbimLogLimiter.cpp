@@ -0,0 +1,58 @@
+#include "XbimLogLimiter.h"
+
+using namespace System::Collections::Generic;
+using namespace System::Threading;
+using namespace Xbim::Common;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		bool XbimLogLimiter::Allow(int limit, LogLevel level, Object^ entity, String^ format, ILogger^ logger)
+		{
+			if (limit <= 0)
+				return true;
+			IPersistEntity^ ifcEntity = dynamic_cast<IPersistEntity^>(entity);
+			XbimLogKey key(level, ifcEntity == nullptr ? 0 : ifcEntity->EntityLabel, format);
+			XbimLogCount^ count;
+			if (!counts->TryGetValue(key, count))
+			{
+				int added = Interlocked::Increment(keys);
+				if (added > maxKeys)
+				{
+					//the thread that crosses the limit reports the counts and restarts them, the others log without counting meanwhile
+					if (added != maxKeys + 1)
+						return true;
+					Interlocked::Add(flushed, Summarise(logger, limit));
+					Interlocked::Increment(keys);
+				}
+				count = counts->GetOrAdd(key, gcnew XbimLogCount(entity == nullptr ? nullptr : entity->GetType()->Name));
+			}
+			return Interlocked::Increment(count->Count) <= limit;
+		}
+
+		int XbimLogLimiter::Report(ILogger^ logger, int limit)
+		{
+			return Summarise(logger, limit) + Interlocked::Exchange(flushed, 0);
+		}
+
+		int XbimLogLimiter::Summarise(ILogger^ logger, int limit)
+		{
+			int suppressed = 0;
+			for each (KeyValuePair<XbimLogKey, XbimLogCount^> pair in counts)
+			{
+				int repeats = pair.Value->Count - limit;
+				if (limit <= 0 || repeats <= 0) continue;
+				suppressed += repeats;
+				if (logger == nullptr || !logger->IsEnabled(pair.Key.Level)) continue;
+				if (pair.Key.EntityLabel != 0)
+					LoggerExtensions::Log(logger, pair.Key.Level, "GeomEngine: #{0}={1} [{2} further times: {3}]", pair.Key.EntityLabel, pair.Value->EntityType, repeats, pair.Key.Format);
+				else
+					LoggerExtensions::Log(logger, pair.Key.Level, "GeomEngine: [{0} further times: {1}]", repeats, pair.Key.Format);
+			}
+			counts->Clear();
+			Interlocked::Exchange(keys, 0);
+			return suppressed;
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+using namespace System;
+using namespace System::Collections::Concurrent;
+using namespace Microsoft::Extensions::Logging;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		//a message logged about an entity, the format is compared by value as some messages are built by concatenation
+		value struct XbimLogKey : IEquatable<XbimLogKey>
+		{
+			LogLevel Level;
+			int EntityLabel;
+			String^ Format;
+
+			XbimLogKey(LogLevel level, int entityLabel, String^ format) : Level(level), EntityLabel(entityLabel), Format(format) {}
+			virtual bool Equals(XbimLogKey other) { return Level == other.Level && EntityLabel == other.EntityLabel && String::Equals(Format, other.Format); }
+			virtual int GetHashCode() override { return (Format == nullptr ? 0 : Format->GetHashCode()) ^ (EntityLabel * 397) ^ (int)Level; }
+		};
+
+		ref class XbimLogCount
+		{
+		public:
+			int Count;
+			String^ EntityType;
+			XbimLogCount(String^ entityType) : Count(0), EntityType(entityType) {}
+		};
+
+		//counts the messages the engine logs about each entity, once a message has been logged limit times for an entity its repeats are
+		//suppressed and reported as one summary by Report. Nothing is counted unless a limit is set.
+		//The counts are cleared when they are reported, by the caller at the end of its work, e.g. Xbim3DModelContext at the end of
+		//CreateContext, or by Allow itself when they reach maxKeys, so a caller that never reports keeps limiting with bounded memory
+		ref class XbimLogLimiter abstract sealed
+		{
+		private:
+			//when this many different messages have been counted their repeats are reported to the logger in hand and counting restarts
+			literal int maxKeys = 100000;
+			static ConcurrentDictionary<XbimLogKey, XbimLogCount^>^ counts = gcnew ConcurrentDictionary<XbimLogKey, XbimLogCount^>();
+			static int keys = 0;
+			//the repeats suppressed in counts that were reported when maxKeys was reached, added to the result of the next Report
+			static int flushed = 0;
+			static int Summarise(ILogger^ logger, int limit);
+		public:
+			//false if the message should be suppressed, limit <= 0 suppresses nothing
+			static bool Allow(int limit, LogLevel level, Object^ entity, String^ format, ILogger^ logger);
+			//logs how many times each suppressed message was repeated and clears the counts. Returns the number of messages suppressed
+			//since the last Report
+			static int Report(ILogger^ logger, int limit);
+		};
+	}
+}
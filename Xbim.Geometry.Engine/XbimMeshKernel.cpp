@@ -0,0 +1,367 @@
+#include "XbimMeshKernel.h"
+#include <gp_Quaternion.hxx>
+#include <gp_Dir.hxx>
+#include <gp_XYZ.hxx>
+#include <OSD_Timer.hxx>
+#include <intrin.h>
+#include <immintrin.h>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	const double ZeroNormalTolerance = 1e-24; //squared length below which a normal is treated as degenerate, Poly::ComputeNormals uses (0,0,1)
+
+	XbimMeshKernel::InstructionSet DetectInstructionSet()
+	{
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		if (maxLeaf < 1) return XbimMeshKernel::Scalar;
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!sse2) return XbimMeshKernel::Scalar;
+		if (maxLeaf < 7 || !osxsave || !avx) return XbimMeshKernel::SSE2;
+		//the OS must save the ymm registers on a context switch
+		if ((_xgetbv(0) & 0x6) != 0x6) return XbimMeshKernel::SSE2;
+		__cpuidex(info, 7, 0);
+		bool avx2 = (info[1] & (1 << 5)) != 0;
+		return avx2 ? XbimMeshKernel::AVX2 : XbimMeshKernel::SSE2;
+	}
+
+	const XbimMeshKernel::InstructionSet supportedSet = DetectInstructionSet();
+	XbimMeshKernel::InstructionSet activeSet = supportedSet;
+
+	inline void TransformNodeScalar(const XbimMeshKernel::Transform& t, const double* p, double* out)
+	{
+		const double* m = t.matrix;
+		double x = p[0], y = p[1], z = p[2];
+		out[0] = m[0] * x + m[1] * y + m[2] * z + m[3];
+		out[1] = m[4] * x + m[5] * y + m[6] * z + m[7];
+		out[2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+	}
+
+	inline void TransformNormalScalar(const XbimMeshKernel::Transform& t, const double* n, double sign, double* out)
+	{
+		const double* r = t.rotation;
+		double x = n[0], y = n[1], z = n[2];
+		double lenSq = x * x + y * y + z * z;
+		if (lenSq < ZeroNormalTolerance)
+		{
+			x = 0; y = 0; z = sign;
+		}
+		else
+		{
+			double s = sign / std::sqrt(lenSq);
+			x *= s; y *= s; z *= s;
+		}
+		out[0] = r[0] * x + r[1] * y + r[2] * z;
+		out[1] = r[3] * x + r[4] * y + r[5] * z;
+		out[2] = r[6] * x + r[7] * y + r[8] * z;
+	}
+
+	void TransformScalar(const XbimMeshKernel::Transform& t, const double* nodes, const double* normals, int count, double sign, double* outNodes, double* outNormals)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			TransformNodeScalar(t, nodes + i * 3, outNodes + i * 3);
+			if (normals != nullptr)
+				TransformNormalScalar(t, normals + i * 3, sign, outNormals + i * 3);
+		}
+	}
+
+	//normalises, reverses and rotates two normals held as separate x, y and z lanes
+	inline void NormaliseRotateSSE2(const double* r, __m128d sign, __m128d& x, __m128d& y, __m128d& z)
+	{
+		__m128d lenSq = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)), _mm_mul_pd(z, z));
+		__m128d degenerate = _mm_cmplt_pd(lenSq, _mm_set1_pd(ZeroNormalTolerance));
+		__m128d safeLenSq = _mm_or_pd(_mm_andnot_pd(degenerate, lenSq), _mm_and_pd(degenerate, _mm_set1_pd(1.0)));
+		__m128d scale = _mm_div_pd(sign, _mm_sqrt_pd(safeLenSq));
+		x = _mm_andnot_pd(degenerate, _mm_mul_pd(x, scale));
+		y = _mm_andnot_pd(degenerate, _mm_mul_pd(y, scale));
+		z = _mm_or_pd(_mm_andnot_pd(degenerate, _mm_mul_pd(z, scale)), _mm_and_pd(degenerate, sign));
+		__m128d rx = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(r[0]), x), _mm_mul_pd(_mm_set1_pd(r[1]), y)), _mm_mul_pd(_mm_set1_pd(r[2]), z));
+		__m128d ry = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(r[3]), x), _mm_mul_pd(_mm_set1_pd(r[4]), y)), _mm_mul_pd(_mm_set1_pd(r[5]), z));
+		__m128d rz = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(r[6]), x), _mm_mul_pd(_mm_set1_pd(r[7]), y)), _mm_mul_pd(_mm_set1_pd(r[8]), z));
+		x = rx; y = ry; z = rz;
+	}
+
+	//loads two xyz triples and splits them into x, y and z lanes
+	inline void LoadPairSSE2(const double* p, __m128d& x, __m128d& y, __m128d& z)
+	{
+		__m128d a = _mm_loadu_pd(p);     //x0 y0
+		__m128d b = _mm_loadu_pd(p + 2); //z0 x1
+		__m128d c = _mm_loadu_pd(p + 4); //y1 z1
+		x = _mm_shuffle_pd(a, b, 2);
+		y = _mm_shuffle_pd(a, c, 1);
+		z = _mm_shuffle_pd(b, c, 2);
+	}
+
+	inline void StorePairSSE2(double* p, __m128d x, __m128d y, __m128d z)
+	{
+		_mm_storeu_pd(p, _mm_unpacklo_pd(x, y));
+		_mm_storeu_pd(p + 2, _mm_shuffle_pd(z, x, 2));
+		_mm_storeu_pd(p + 4, _mm_unpackhi_pd(y, z));
+	}
+
+	void TransformSSE2(const XbimMeshKernel::Transform& t, const double* nodes, const double* normals, int count, double sign, double* outNodes, double* outNormals)
+	{
+		const double* m = t.matrix;
+		__m128d m0 = _mm_set1_pd(m[0]), m1 = _mm_set1_pd(m[1]), m2 = _mm_set1_pd(m[2]), m3 = _mm_set1_pd(m[3]);
+		__m128d m4 = _mm_set1_pd(m[4]), m5 = _mm_set1_pd(m[5]), m6 = _mm_set1_pd(m[6]), m7 = _mm_set1_pd(m[7]);
+		__m128d m8 = _mm_set1_pd(m[8]), m9 = _mm_set1_pd(m[9]), m10 = _mm_set1_pd(m[10]), m11 = _mm_set1_pd(m[11]);
+		__m128d vSign = _mm_set1_pd(sign);
+		int i = 0;
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128d x, y, z;
+			LoadPairSSE2(nodes + i * 3, x, y, z);
+			__m128d tx = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m0, x), _mm_mul_pd(m1, y)), _mm_add_pd(_mm_mul_pd(m2, z), m3));
+			__m128d ty = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m4, x), _mm_mul_pd(m5, y)), _mm_add_pd(_mm_mul_pd(m6, z), m7));
+			__m128d tz = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m8, x), _mm_mul_pd(m9, y)), _mm_add_pd(_mm_mul_pd(m10, z), m11));
+			StorePairSSE2(outNodes + i * 3, tx, ty, tz);
+			if (normals != nullptr)
+			{
+				LoadPairSSE2(normals + i * 3, x, y, z);
+				NormaliseRotateSSE2(t.rotation, vSign, x, y, z);
+				StorePairSSE2(outNormals + i * 3, x, y, z);
+			}
+		}
+		if (i < count)
+			TransformScalar(t, nodes + i * 3, normals == nullptr ? nullptr : normals + i * 3, count - i, sign, outNodes + i * 3, normals == nullptr ? nullptr : outNormals + i * 3);
+	}
+
+	//loads four xyz triples as x, y and z lanes using gathers
+	inline void LoadQuadAVX2(const double* p, __m256i offsets, __m256d& x, __m256d& y, __m256d& z)
+	{
+		x = _mm256_i64gather_pd(p, offsets, 8);
+		y = _mm256_i64gather_pd(p + 1, offsets, 8);
+		z = _mm256_i64gather_pd(p + 2, offsets, 8);
+	}
+
+	//AVX2 has no scatter, the lanes are interleaved through a small stack buffer
+	inline void StoreQuadAVX2(double* p, __m256d x, __m256d y, __m256d z)
+	{
+		alignas(32) double lx[4], ly[4], lz[4];
+		_mm256_store_pd(lx, x);
+		_mm256_store_pd(ly, y);
+		_mm256_store_pd(lz, z);
+		for (int k = 0; k < 4; k++)
+		{
+			p[k * 3] = lx[k];
+			p[k * 3 + 1] = ly[k];
+			p[k * 3 + 2] = lz[k];
+		}
+	}
+
+	void TransformAVX2(const XbimMeshKernel::Transform& t, const double* nodes, const double* normals, int count, double sign, double* outNodes, double* outNormals)
+	{
+		const double* m = t.matrix;
+		const double* r = t.rotation;
+		__m256i offsets = _mm256_set_epi64x(9, 6, 3, 0);
+		__m256d m0 = _mm256_set1_pd(m[0]), m1 = _mm256_set1_pd(m[1]), m2 = _mm256_set1_pd(m[2]), m3 = _mm256_set1_pd(m[3]);
+		__m256d m4 = _mm256_set1_pd(m[4]), m5 = _mm256_set1_pd(m[5]), m6 = _mm256_set1_pd(m[6]), m7 = _mm256_set1_pd(m[7]);
+		__m256d m8 = _mm256_set1_pd(m[8]), m9 = _mm256_set1_pd(m[9]), m10 = _mm256_set1_pd(m[10]), m11 = _mm256_set1_pd(m[11]);
+		__m256d vSign = _mm256_set1_pd(sign);
+		__m256d one = _mm256_set1_pd(1.0);
+		__m256d tolerance = _mm256_set1_pd(ZeroNormalTolerance);
+		int i = 0;
+		for (; i + 4 <= count; i += 4)
+		{
+			__m256d x, y, z;
+			LoadQuadAVX2(nodes + i * 3, offsets, x, y, z);
+			__m256d tx = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m0, x), _mm256_mul_pd(m1, y)), _mm256_add_pd(_mm256_mul_pd(m2, z), m3));
+			__m256d ty = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m4, x), _mm256_mul_pd(m5, y)), _mm256_add_pd(_mm256_mul_pd(m6, z), m7));
+			__m256d tz = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(m8, x), _mm256_mul_pd(m9, y)), _mm256_add_pd(_mm256_mul_pd(m10, z), m11));
+			StoreQuadAVX2(outNodes + i * 3, tx, ty, tz);
+			if (normals != nullptr)
+			{
+				LoadQuadAVX2(normals + i * 3, offsets, x, y, z);
+				__m256d lenSq = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)), _mm256_mul_pd(z, z));
+				__m256d degenerate = _mm256_cmp_pd(lenSq, tolerance, _CMP_LT_OQ);
+				__m256d scale = _mm256_div_pd(vSign, _mm256_sqrt_pd(_mm256_blendv_pd(lenSq, one, degenerate)));
+				x = _mm256_andnot_pd(degenerate, _mm256_mul_pd(x, scale));
+				y = _mm256_andnot_pd(degenerate, _mm256_mul_pd(y, scale));
+				z = _mm256_blendv_pd(_mm256_mul_pd(z, scale), vSign, degenerate);
+				__m256d rx = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(r[0]), x), _mm256_mul_pd(_mm256_set1_pd(r[1]), y)), _mm256_mul_pd(_mm256_set1_pd(r[2]), z));
+				__m256d ry = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(r[3]), x), _mm256_mul_pd(_mm256_set1_pd(r[4]), y)), _mm256_mul_pd(_mm256_set1_pd(r[5]), z));
+				__m256d rz = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(r[6]), x), _mm256_mul_pd(_mm256_set1_pd(r[7]), y)), _mm256_mul_pd(_mm256_set1_pd(r[8]), z));
+				StoreQuadAVX2(outNormals + i * 3, rx, ry, rz);
+			}
+		}
+		_mm256_zeroupper();
+		if (i < count)
+			TransformSSE2(t, nodes + i * 3, normals == nullptr ? nullptr : normals + i * 3, count - i, sign, outNodes + i * 3, normals == nullptr ? nullptr : outNormals + i * 3);
+	}
+
+	//the loop the writers used before the kernel, kept as the benchmark reference
+	void TransformReference(const gp_Trsf& trsf, const gp_Quaternion& quaternion, const double* nodes, const double* normals, int count, bool reverse, double* outNodes, double* outNormals)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			const double* p = nodes + i * 3;
+			double px = p[0], py = p[1], pz = p[2];
+			trsf.Transforms(px, py, pz);
+			outNodes[i * 3] = px; outNodes[i * 3 + 1] = py; outNodes[i * 3 + 2] = pz;
+			const double* n = normals + i * 3;
+			gp_Dir dir(n[0], n[1], n[2]);
+			if (reverse) dir.Reverse();
+			gp_Vec v = quaternion.Multiply(dir);
+			outNormals[i * 3] = v.X(); outNormals[i * 3 + 1] = v.Y(); outNormals[i * 3 + 2] = v.Z();
+		}
+	}
+}
+
+XbimMeshKernel::Transform::Transform() : isIdentity(true)
+{
+	for (int i = 0; i < 12; i++) matrix[i] = (i % 5 == 0) ? 1.0 : 0.0; //diagonal of a 3x4 is every 5th entry
+	for (int i = 0; i < 9; i++) rotation[i] = (i % 4 == 0) ? 1.0 : 0.0;
+}
+
+XbimMeshKernel::Transform::Transform(const gp_Trsf& trsf)
+{
+	isIdentity = trsf.Form() == gp_Identity;
+	for (int r = 0; r < 3; r++)
+		for (int c = 0; c < 4; c++)
+			matrix[r * 4 + c] = trsf.Value(r + 1, c + 1);
+	gp_Mat rot = trsf.GetRotation().GetMatrix();
+	for (int r = 0; r < 3; r++)
+		for (int c = 0; c < 3; c++)
+			rotation[r * 3 + c] = rot.Value(r + 1, c + 1);
+}
+
+XbimMeshKernel::InstructionSet XbimMeshKernel::Supported()
+{
+	return supportedSet;
+}
+
+XbimMeshKernel::InstructionSet XbimMeshKernel::Active()
+{
+	return activeSet;
+}
+
+void XbimMeshKernel::SetActive(InstructionSet instructionSet)
+{
+	activeSet = instructionSet > supportedSet ? supportedSet : instructionSet;
+}
+
+void XbimMeshKernel::AccumulateNormals(const double* nodes, int nodeCount, const int* triangles, int triangleCount, double* normals)
+{
+	std::fill(normals, normals + nodeCount * 3, 0.0);
+	for (int t = 0; t < triangleCount; t++)
+	{
+		const int* tri = triangles + t * 3;
+		int i0 = (tri[0] - 1) * 3, i1 = (tri[1] - 1) * 3, i2 = (tri[2] - 1) * 3;
+		double ax = nodes[i1] - nodes[i0], ay = nodes[i1 + 1] - nodes[i0 + 1], az = nodes[i1 + 2] - nodes[i0 + 2];
+		double bx = nodes[i2] - nodes[i0], by = nodes[i2 + 1] - nodes[i0 + 1], bz = nodes[i2 + 2] - nodes[i0 + 2];
+		double nx = ay * bz - az * by, ny = az * bx - ax * bz, nz = ax * by - ay * bx;
+		normals[i0] += nx; normals[i0 + 1] += ny; normals[i0 + 2] += nz;
+		normals[i1] += nx; normals[i1 + 1] += ny; normals[i1 + 2] += nz;
+		normals[i2] += nx; normals[i2 + 1] += ny; normals[i2 + 2] += nz;
+	}
+}
+
+void XbimMeshKernel::TransformNodes(const Transform& transform, const double* nodes, const double* normals, int nodeCount, bool reverse, double* outNodes, double* outNormals)
+{
+	if (nodeCount <= 0) return;
+	double sign = reverse ? -1.0 : 1.0;
+	switch (activeSet)
+	{
+	case AVX2:
+		TransformAVX2(transform, nodes, normals, nodeCount, sign, outNodes, outNormals);
+		break;
+	case SSE2:
+		TransformSSE2(transform, nodes, normals, nodeCount, sign, outNodes, outNormals);
+		break;
+	default:
+		TransformScalar(transform, nodes, normals, nodeCount, sign, outNodes, outNormals);
+		break;
+	}
+}
+
+void XbimMeshKernel::TransformTriangulation(const Handle(Poly_Triangulation)& mesh, const gp_Trsf& location, bool reverse, bool withNormals, FaceBuffers& buffers)
+{
+	int nodeCount = mesh->NbNodes();
+	buffers.nodes.resize(nodeCount * 3);
+	if (nodeCount == 0) return;
+	//TColgp_Array1OfPnt is a contiguous block of gp_Pnt, each an xyz triple of doubles
+	const double* nodes = mesh->Nodes().First().XYZ().GetData();
+	Transform transform(location);
+	if (!withNormals)
+	{
+		TransformNodes(transform, nodes, nullptr, nodeCount, reverse, buffers.nodes.data(), nullptr);
+		return;
+	}
+	int triangleCount = mesh->NbTriangles();
+	const Poly_Array1OfTriangle& triangles = mesh->Triangles();
+	buffers.triangles.resize(triangleCount * 3);
+	for (int t = 0; t < triangleCount; t++)
+		triangles(t + 1).Get(buffers.triangles[t * 3], buffers.triangles[t * 3 + 1], buffers.triangles[t * 3 + 2]);
+	buffers.accumulated.resize(nodeCount * 3);
+	buffers.normals.resize(nodeCount * 3);
+	AccumulateNormals(nodes, nodeCount, buffers.triangles.data(), triangleCount, buffers.accumulated.data());
+	TransformNodes(transform, nodes, buffers.accumulated.data(), nodeCount, reverse, buffers.nodes.data(), buffers.normals.data());
+}
+
+void XbimMeshKernel::ToFloat(const double* values, int count, float* outValues)
+{
+	int i = 0;
+	if (activeSet != Scalar)
+	{
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(values + i));
+			__m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(values + i + 2));
+			_mm_storeu_ps(outValues + i, _mm_movelh_ps(lo, hi));
+		}
+	}
+	for (; i < count; i++)
+		outValues[i] = (float)values[i];
+}
+
+void XbimMeshKernel::Benchmark(int nodeCount, int iterations, double& scalarMs, double& sse2Ms, double& avx2Ms)
+{
+	scalarMs = sse2Ms = avx2Ms = -1;
+	if (nodeCount <= 0 || iterations <= 0) return;
+	std::vector<double> nodes(nodeCount * 3), normals(nodeCount * 3), outNodes(nodeCount * 3), outNormals(nodeCount * 3);
+	for (int i = 0; i < nodeCount; i++)
+	{
+		double a = i * 0.001;
+		nodes[i * 3] = std::cos(a) * 1000; nodes[i * 3 + 1] = std::sin(a) * 1000; nodes[i * 3 + 2] = i * 0.1;
+		normals[i * 3] = std::cos(a); normals[i * 3 + 1] = std::sin(a); normals[i * 3 + 2] = 0.25;
+	}
+	gp_Trsf trsf;
+	trsf.SetRotation(gp_Quaternion(gp_Vec(1, 2, 3), 0.7));
+	trsf.SetTranslationPart(gp_Vec(100, -200, 300));
+	gp_Quaternion quaternion = trsf.GetRotation();
+	Transform transform(trsf);
+
+	OSD_Timer timer;
+	timer.Start();
+	for (int it = 0; it < iterations; it++)
+		TransformReference(trsf, quaternion, nodes.data(), normals.data(), nodeCount, true, outNodes.data(), outNormals.data());
+	timer.Stop();
+	scalarMs = timer.ElapsedTime() * 1000;
+
+	if (supportedSet >= SSE2)
+	{
+		timer.Reset();
+		timer.Start();
+		for (int it = 0; it < iterations; it++)
+			TransformSSE2(transform, nodes.data(), normals.data(), nodeCount, -1.0, outNodes.data(), outNormals.data());
+		timer.Stop();
+		sse2Ms = timer.ElapsedTime() * 1000;
+	}
+	if (supportedSet >= AVX2)
+	{
+		timer.Reset();
+		timer.Start();
+		for (int it = 0; it < iterations; it++)
+			TransformAVX2(transform, nodes.data(), normals.data(), nodeCount, -1.0, outNodes.data(), outNormals.data());
+		timer.Stop();
+		avx2Ms = timer.ElapsedTime() * 1000;
+	}
+}
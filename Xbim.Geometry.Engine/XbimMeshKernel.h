@@ -0,0 +1,60 @@
+#pragma once
+#include <gp_Trsf.hxx>
+#include <Poly_Triangulation.hxx>
+#include <vector>
+
+//Vectorised kernels used by the triangulation writers to move Poly_Triangulation buffers into world space.
+//All buffers are contiguous xyz triples, the implementation is chosen at runtime from the instruction sets of the processor
+class XbimMeshKernel
+{
+public:
+	enum InstructionSet
+	{
+		Scalar = 0,
+		SSE2 = 1,
+		AVX2 = 2
+	};
+
+	//row major 3x4 matrix of the location (scale included) and the 3x3 rotation used for normals
+	struct Transform
+	{
+		double matrix[12];
+		double rotation[9];
+		bool isIdentity;
+		Transform();
+		Transform(const gp_Trsf& trsf);
+	};
+
+	//world space nodes and normals of one face triangulation, held between faces so the buffers are only grown, never reallocated per face
+	struct FaceBuffers
+	{
+		std::vector<double> nodes;
+		std::vector<double> normals;
+		std::vector<int> triangles;
+		std::vector<double> accumulated;
+	};
+
+	static InstructionSet Supported();
+	static InstructionSet Active();
+	//forces a specific implementation, the request is clamped to what the processor supports
+	static void SetActive(InstructionSet instructionSet);
+
+	//accumulates the area weighted normal of every triangle at its nodes, triangles are 1 based node indices as held by Poly_Triangle
+	//the normals are left unnormalised, TransformNodes normalises them
+	static void AccumulateNormals(const double* nodes, int nodeCount, const int* triangles, int triangleCount, double* normals);
+
+	//transforms nodeCount nodes by the transform and writes them to outNodes
+	//if normals is not null each normal is normalised, reversed if required and rotated into outNormals
+	static void TransformNodes(const Transform& transform, const double* nodes, const double* normals, int nodeCount, bool reverse, double* outNodes, double* outNormals);
+
+	//transforms the nodes of a face triangulation by its location into buffers.nodes, when withNormals is true the node normals are
+	//accumulated from the triangles, this replaces Poly::ComputeNormals, then reversed and rotated into buffers.normals in the same pass
+	static void TransformTriangulation(const Handle(Poly_Triangulation)& mesh, const gp_Trsf& location, bool reverse, bool withNormals, FaceBuffers& buffers);
+
+	//converts count doubles to floats
+	static void ToFloat(const double* values, int count, float* outValues);
+
+	//times the scalar gp_Trsf/gp_Quaternion loop used by the writers against each available implementation, results are in milliseconds
+	//scalarMs, sse2Ms and avx2Ms are set to -1 if the implementation is not supported
+	static void Benchmark(int nodeCount, int iterations, double& scalarMs, double& sse2Ms, double& avx2Ms);
+};
@@ -1,5 +1,6 @@
 #include "XbimNativeApi.h"
 #include "XbimProgressMonitor.h"
+#include "XbimTraceRecorder.h"
 #include <ShapeFix_Shape.hxx>
 #include <BRepBuilderAPI_Sewing.hxx>
 
@@ -7,6 +8,7 @@ bool XbimNativeApi::FixShell(TopoDS_Shell& shell, double timeOut, std::string& e
 {
 	try
 	{
+		XBIM_TRACE_SCOPE("ShapeFix");
 		ShapeFix_Shell shellFixer(shell);
 		Handle(XbimProgressMonitor) pi = new XbimProgressMonitor(timeOut);
 		if (shellFixer.Perform(pi))
@@ -18,6 +20,11 @@ bool XbimNativeApi::FixShell(TopoDS_Shell& shell, double timeOut, std::string& e
 			errMsg = "ShapeFix_Shell timed out";
 			return false;
 		}
+		if (pi->Cancelled())
+		{
+			errMsg = "ShapeFix_Shell cancelled";
+			return false;
+		}
 		return true;
 	}
 	catch (Standard_Failure sf)
@@ -33,6 +40,7 @@ bool XbimNativeApi::FixShape(TopoDS_Shape& shape, double timeOut, std::string& e
 {
 	try
 	{
+		XBIM_TRACE_SCOPE("ShapeFix");
 		ShapeFix_Shape shapeFixer(shape);
 		Handle(XbimProgressMonitor) pi = new XbimProgressMonitor(timeOut);
 		if (shapeFixer.Perform(pi))
@@ -44,6 +52,11 @@ bool XbimNativeApi::FixShape(TopoDS_Shape& shape, double timeOut, std::string& e
 			errMsg = "ShapeFix_Shape timed out";
 			return false;
 		}
+		if (pi->Cancelled())
+		{
+			errMsg = "ShapeFix_Shape cancelled";
+			return false;
+		}
 		return true;
 	}
 	catch (Standard_Failure sf)
@@ -59,6 +72,7 @@ bool XbimNativeApi::SewShape(TopoDS_Shape& shape, double tolerance, double timeO
 {
 	try
 	{
+		XBIM_TRACE_SCOPE("Sewing");
 		BRepBuilderAPI_Sewing seamstress(tolerance);
 		seamstress.Add(shape);
 		Handle(XbimProgressMonitor) pi = new XbimProgressMonitor(timeOut);
@@ -68,6 +82,11 @@ bool XbimNativeApi::SewShape(TopoDS_Shape& shape, double tolerance, double timeO
 			errMsg = "Shape sewing timed out";
 			return false;
 		}
+		if (pi->Cancelled())
+		{
+			errMsg = "Shape sewing cancelled";
+			return false;
+		}
 		shape = seamstress.SewedShape();
 		return true;
 	}
@@ -0,0 +1,50 @@
+#include "XbimNativeLog.h"
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+	struct Event
+	{
+		const char* message;
+		int count;
+	};
+
+	//a message raised in a loop is counted, not stored again, so the buffer stays small
+	const std::size_t maxEvents = 64;
+	thread_local std::vector<Event> events;
+}
+
+void XbimNativeLog::Warning(const char* message)
+{
+	for (Event& event : events)
+	{
+		if (event.message == message)
+		{
+			event.count++;
+			return;
+		}
+	}
+	//further messages are dropped until the buffer is drained
+	if (events.size() < maxEvents)
+		events.push_back({ message, 1 });
+}
+
+int XbimNativeLog::Pending()
+{
+	return (int)events.size();
+}
+
+int XbimNativeLog::Drain(const char** messages, int* counts, int capacity)
+{
+	int copied = 0;
+	for (const Event& event : events)
+	{
+		if (copied == capacity) break;
+		messages[copied] = event.message;
+		counts[copied] = event.count;
+		copied++;
+	}
+	events.clear();
+	return copied;
+}
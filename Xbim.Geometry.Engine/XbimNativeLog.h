@@ -0,0 +1,18 @@
+#pragma once
+
+//Buffers the warnings raised by natively compiled code, e.g. the booleans, on the thread that raised them. The managed code that called
+//it reports them afterwards, so raising one costs no managed transition and no formatting. Each message is kept once with the number
+//of times it was raised. The header is included by /clr code so it must not pull in <vector> or <mutex>, the implementation is compiled natively
+class XbimNativeLog
+{
+public:
+	//messages are held by pointer and must be string literals
+	static void Warning(const char* message);
+	//the number of different messages buffered on the calling thread
+	static int Pending();
+	//copies up to capacity of the messages buffered on the calling thread, in the order first raised, with the times each was raised
+	//and clears the buffer. Returns the number copied
+	static int Drain(const char** messages, int* counts, int capacity);
+};
+
+#define XBIM_NATIVE_WARNING(message) XbimNativeLog::Warning(message)
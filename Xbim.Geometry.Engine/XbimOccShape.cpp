@@ -1,10 +1,16 @@
 #include "XbimOccShape.h"
 #include "XbimFaceSet.h"
 #include "XbimShell.h"
+#include "XbimTraceRecorder.h"
+#include "XbimCancellation.h"
 #include "XbimSolid.h"
 #include "XbimCompound.h"
 #include "XbimPoint3DWithTolerance.h"
 #include "XbimConvert.h"
+#include "XbimMeshKernel.h"
+#include "XbimPolygonTriangulator.h"
+#include "XbimGeometryCreator.h"
+#include "XbimShapeBounds.h"
 #include <BRepCheck_Analyzer.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <Poly_Triangulation.hxx>
@@ -24,6 +30,11 @@
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <BRepBuilderAPI_Transform.hxx>
 #include <Geom_Plane.hxx>
+#include <BRep_Builder.hxx>
+#include <TopoDS_Compound.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopTools_ListIteratorOfListOfShape.hxx>
 
 using namespace System::Threading;
 using namespace System::Collections::Generic;
@@ -37,6 +48,93 @@ namespace Xbim
 		{
 		}
 
+		array<double>^ XbimOccShape::OrientedBox()
+		{
+			if (!IsValid) return nullptr;
+			if (bounds == nullptr) bounds = gcnew XbimShapeBounds();
+			const TopoDS_Shape& shape = this;
+			return bounds->OrientedBox(shape, XbimShapeBounds::Stamp(shape));
+		}
+
+		XbimShapeGeometry^ XbimOccShape::ConvexHull(double deflection, double angle)
+		{
+			if (!IsValid) return nullptr;
+			if (bounds == nullptr) bounds = gcnew XbimShapeBounds();
+			const TopoDS_Shape& shape = this;
+			XbimShapeGeometry^ hull = bounds->ConvexHull(shape, XbimShapeBounds::Stamp(shape), deflection, angle);
+			//the curved faces may have been meshed for the hull
+			UpdateMemoryPressure();
+			return hull;
+		}
+
+		const XbimShapeTree* XbimOccShape::ShapeTree(double deflection, double angle)
+		{
+			if (!IsValid) return nullptr;
+			if (bounds == nullptr) bounds = gcnew XbimShapeBounds();
+			const TopoDS_Shape& shape = this;
+			return bounds->Tree(shape, XbimShapeBounds::Stamp(shape), deflection, angle);
+		}
+
+		bool XbimOccShape::Equals(IXbimGeometryObject^ geometryObject, double tolerance)
+		{
+			return XbimGeometryCreator::GeometricallyEquals(this, geometryObject, tolerance, 0, 0.5);
+		}
+
+		bool XbimOccShape::Intersects(IXbimGeometryObject^ geometryObject, double tolerance)
+		{
+			return XbimGeometryCreator::Intersects(this, geometryObject, tolerance, 0, 0.5);
+		}
+
+		//approximate sizes of a face with its surface, of an edge with its 3D and parametric curves and end vertices,
+		//and of a triangulation node with its uv parameters and of a triangle
+		static const long long FaceBytes = 640;
+		static const long long EdgeBytes = 480;
+		static const long long NodeBytes = 40;
+		static const long long TriangleBytes = 12;
+
+		Int64 XbimOccShape::EstimateNativeBytes(const TopoDS_Shape& shape)
+		{
+			if (shape.IsNull()) return 0;
+			long long bytes = 0;
+			for (TopExp_Explorer faceExplorer(shape, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next())
+			{
+				bytes += FaceBytes;
+				TopLoc_Location location;
+				const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(TopoDS::Face(faceExplorer.Current()), location);
+				if (!triangulation.IsNull())
+					bytes += triangulation->NbNodes() * NodeBytes + triangulation->NbTriangles() * TriangleBytes;
+			}
+			//an edge shared by two faces is visited twice
+			long long edgeVisits = 0;
+			for (TopExp_Explorer edgeExplorer(shape, TopAbs_EDGE); edgeExplorer.More(); edgeExplorer.Next())
+				edgeVisits++;
+			return bytes + edgeVisits * EdgeBytes / 2;
+		}
+
+		void XbimOccShape::UpdateMemoryPressure()
+		{
+			if (!XbimGeometryCreator::ReportMemoryPressure) return;
+			Int64 estimate = NativeBytesEstimate;
+			Int64 reported = memoryPressure;
+			if (estimate > reported)
+				GC::AddMemoryPressure(estimate - reported);
+			else if (estimate < reported)
+				GC::RemoveMemoryPressure(reported - estimate);
+			memoryPressure = estimate;
+		}
+
+		void XbimOccShape::ReleaseMemoryPressure()
+		{
+			Int64 reported = Interlocked::Exchange(memoryPressure, 0LL);
+			if (reported > 0) GC::RemoveMemoryPressure(reported);
+		}
+
+		void XbimOccShape::ReleaseBounds()
+		{
+			delete bounds;
+			bounds = nullptr;
+		}
+
 
 
 		void XbimOccShape::WriteTriangulation(TextWriter^ textWriter, double tolerance, double deflection, double angle)
@@ -46,11 +144,14 @@ namespace Xbim
 			XbimFaceSet^ faces = gcnew XbimFaceSet(this);
 
 			if (faces->Count == 0) return;
+			if (XbimCancellation::Cancelled()) return; //BRepMesh takes no progress indicator in this version of OCC
 
 			Monitor::Enter(this);
 			try
 			{
+				XBIM_TRACE_SCOPE("BRepMesh");
 				BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time				
+				if (memoryPressure > 0) UpdateMemoryPressure(); //the triangulation is held by the faces of the shape
 			}
 			finally
 			{
@@ -65,6 +166,7 @@ namespace Xbim
 			List<List<size_t>^>^ normalLookup = gcnew List<List<size_t>^>(faces->Count);
 			List<XbimVector3D>^ normals = gcnew List<XbimVector3D>(faces->Count * 4);
 			List<XbimFace^>^ writtenFaces = gcnew List<XbimFace^>(faces->Count);
+			XbimMeshKernel::FaceBuffers buffers; //reused for every face
 			//First write out all the vertices
 			int faceIndex = 0;
 			int triangleCount = 0;
@@ -74,30 +176,27 @@ namespace Xbim
 				const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(face, loc);
 				if (mesh.IsNull())
 					continue;
-				gp_Trsf transform = loc.Transformation();
-				gp_Quaternion quaternion = transform.GetRotation();
-				const TColgp_Array1OfPnt& nodes = mesh->Nodes();
 				triangleCount += mesh->NbTriangles();
 				bool faceReversed = face->IsReversed;
 				bool isPolygonal = face->IsPolygonal;
 				pointLookup->Add(gcnew List<size_t>(mesh->NbNodes()));
+				//the same kernel as the binary writer, so both write the same normals
+				XbimMeshKernel::TransformTriangulation(mesh, loc.Transformation(), faceReversed, !isPolygonal, buffers);
+				const double* worldNodes = buffers.nodes.data();
 				List<size_t>^ norms;
 				if (!isPolygonal)
 				{
-					Poly::ComputeNormals(mesh); //we need the normals
+					const double* worldNormals = buffers.normals.data();
 					norms = gcnew List<size_t>(mesh->NbNodes());
-					for (Standard_Integer i = 1; i <= mesh->NbNodes() * 3; i += 3) //visit each node
+					for (Standard_Integer i = 0; i < mesh->NbNodes() * 3; i += 3) //visit each node
 					{
-						gp_Dir dir(mesh->Normals().Value(i), mesh->Normals().Value(i + 1), mesh->Normals().Value(i + 2));
-						if (faceReversed) dir.Reverse();
 						size_t index;
-						dir = quaternion.Multiply(dir);
-						XbimPoint3DWithTolerance^ n = gcnew XbimPoint3DWithTolerance(dir.X(), dir.Y(), dir.Z(), tolerance);
+						XbimPoint3DWithTolerance^ n = gcnew XbimPoint3DWithTolerance(worldNormals[i], worldNormals[i + 1], worldNormals[i + 2], tolerance);
 						if (!normalMap->TryGetValue(n, index))
 						{
 							index = normalMap->Count;
 							normalMap->Add(n, index);
-							normals->Add(XbimVector3D(dir.X(), dir.Y(), dir.Z()));
+							normals->Add(XbimVector3D(worldNormals[i], worldNormals[i + 1], worldNormals[i + 2]));
 						}
 						norms->Add(index);
 					}
@@ -116,12 +215,10 @@ namespace Xbim
 					norms->Add(index);
 				}
 				normalLookup->Add(norms);
-				for (Standard_Integer i = 1; i <= mesh->NbNodes(); i++) //visit each node for vertices
+				for (Standard_Integer i = 0; i < mesh->NbNodes() * 3; i += 3) //visit each node for vertices
 				{
-					gp_XYZ p = nodes.Value(i).XYZ();
-					transform.Transforms(p);
 					size_t index;
-					XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(p.X(), p.Y(), p.Z(), tolerance);
+					XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(worldNodes[i], worldNodes[i + 1], worldNodes[i + 2], tolerance);
 					if (!pointMap->TryGetValue(pt, index))
 					{
 						index = pointMap->Count;
@@ -182,12 +279,15 @@ namespace Xbim
 		void XbimOccShape::WriteTriangulation(IXbimMeshReceiver^ meshReceiver, double tolerance, double deflection, double angle)
 		{
 			if (!IsValid) return;
+			if (XbimCancellation::Cancelled()) return; //BRepMesh takes no progress indicator in this version of OCC
 			if (meshReceiver == nullptr)
 			{
 				try
 				{
 					Monitor::Enter(this);
+					XBIM_TRACE_SCOPE("BRepMesh");
 					BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time	
+					if (memoryPressure > 0) UpdateMemoryPressure(); //the triangulation is held by the faces of the shape
 				}
 				finally
 				{
@@ -215,9 +315,13 @@ namespace Xbim
 				}
 			}
 
-			BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time		
-
+			{
+				XBIM_TRACE_SCOPE("BRepMesh");
+				BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time		
+				if (memoryPressure > 0) UpdateMemoryPressure(); //the triangulation is held by the faces of the shape
+			}
 
+			XbimMeshKernel::FaceBuffers buffers; //reused for every face
 			for (int f = 1; f <= faceMap.Extent(); f++)
 			{
 				const TopoDS_Face& face = TopoDS::Face(faceMap(f));
@@ -230,24 +334,13 @@ namespace Xbim
 					continue;
 				//check if we have a seam
 				bool hasSeam = hasSeams[f - 1];
-				gp_Trsf transform = loc.Transformation();
-				gp_Quaternion quaternion = transform.GetRotation();
 				const TColgp_Array1OfPnt& nodes = mesh->Nodes();
-				Poly::ComputeNormals(mesh); //we need the normals					
-
+				//transform the nodes and rotate the normals to the new location in one pass
+				XbimMeshKernel::TransformTriangulation(mesh, loc.Transformation(), faceReversed, true, buffers);
+				const double* worldNodes = buffers.nodes.data();
+				double* norms = buffers.normals.data();
 				if (hasSeam)
 				{
-
-					TColStd_Array1OfReal norms(1, mesh->Normals().Length());
-					for (Standard_Integer i = 1; i <= mesh->NbNodes() * 3; i += 3) //visit each node
-					{
-						gp_Dir dir(mesh->Normals().Value(i), mesh->Normals().Value(i + 1), mesh->Normals().Value(i + 2));
-						if (faceReversed) dir.Reverse();
-						dir = quaternion.Multiply(dir);
-						norms.SetValue(i, dir.X());
-						norms.SetValue(i + 1, dir.Y());
-						norms.SetValue(i + 2, dir.Z());
-					}
 					Dictionary<XbimPoint3DWithTolerance^, int>^ uniquePointsOnFace = gcnew Dictionary<XbimPoint3DWithTolerance^, int>(mesh->NbNodes());
 					for (Standard_Integer j = 1; j <= mesh->NbNodes(); j++) //visit each node for vertices
 					{
@@ -257,46 +350,24 @@ namespace Xbim
 						if (uniquePointsOnFace->TryGetValue(pt, nodeIndex)) //we have a duplicate point on face need to smooth the normal
 						{
 							//balance the two normals
-							gp_Vec normalA(norms.Value(nodeIndex), norms.Value(nodeIndex) + 1, norms.Value(nodeIndex) + 2);
-							gp_Vec normalB(norms.Value(j), norms.Value(j) + 1, norms.Value(j) + 2);
-							gp_Vec normalBalanced = normalA + normalB;
+							double* normalA = norms + (nodeIndex - 1) * 3;
+							double* normalB = norms + (j - 1) * 3;
+							gp_Vec normalBalanced(normalA[0] + normalB[0], normalA[1] + normalB[1], normalA[2] + normalB[2]);
 							normalBalanced.Normalize();
-							norms.SetValue(nodeIndex, normalBalanced.X());
-							norms.SetValue(nodeIndex + 1, normalBalanced.Y());
-							norms.SetValue(nodeIndex + 2, normalBalanced.Z());
-							norms.SetValue(j, normalBalanced.X());
-							norms.SetValue(j + 1, normalBalanced.Y());
-							norms.SetValue(j + 2, normalBalanced.Z());
+							normalA[0] = normalB[0] = normalBalanced.X();
+							normalA[1] = normalB[1] = normalBalanced.Y();
+							normalA[2] = normalB[2] = normalBalanced.Z();
 						}
 						else
 							uniquePointsOnFace->Add(pt, j);
 					}
-					//write the nodes
-					for (Standard_Integer j = 0; j < mesh->NbNodes(); j++) //visit each node for vertices
-					{
-						gp_Pnt p = nodes.Value(j + 1);
-						Standard_Real px = p.X();
-						Standard_Real py = p.Y();
-						Standard_Real pz = p.Z();
-						transform.Transforms(px, py, pz); //transform the point to the right location
-						gp_Dir dir(norms.Value((j * 3) + 1), norms.Value((j * 3) + 2), norms.Value((j * 3) + 3));
-						meshReceiver->AddNode(faceId, px, py, pz, dir.X(), dir.Y(), dir.Z()); //add the node to the face
-					}
 				}
-				else //write the nodes
+				//write the nodes
+				for (Standard_Integer j = 0; j < mesh->NbNodes(); j++) //visit each node for vertices
 				{
-					for (Standard_Integer j = 0; j < mesh->NbNodes(); j++) //visit each node for vertices
-					{
-						gp_Pnt p = nodes.Value(j + 1);
-						Standard_Real px = p.X();
-						Standard_Real py = p.Y();
-						Standard_Real pz = p.Z();
-						transform.Transforms(px, py, pz); //transform the point to the right location
-						gp_Dir dir(mesh->Normals().Value((j * 3) + 1), mesh->Normals().Value((j * 3) + 2), mesh->Normals().Value((j * 3) + 3));
-						if (faceReversed) dir.Reverse();
-						dir = quaternion.Multiply(dir); //rotate the norm to the new location
-						meshReceiver->AddNode(faceId, px, py, pz, dir.X(), dir.Y(), dir.Z()); //add the node to the face
-					}
+					const double* p = worldNodes + j * 3;
+					const double* n = norms + j * 3;
+					meshReceiver->AddNode(faceId, p[0], p[1], p[2], n[0], n[1], n[2]); //add the node to the face
 				}
 
 				Standard_Integer t[3];
@@ -330,6 +401,73 @@ namespace Xbim
 				bw->Write(index);
 		}
 
+		//adds the points of a wire of a planar face to the contour. A straight edge shared with a face meshed by BRepMesh takes the nodes
+		//BRepMesh put on it, so the two faces meet without cracks. Returns true if any edge had nodes between its vertices
+		static bool AddWireContour(const TopoDS_Wire& wire, const TopoDS_Face& face, const TopTools_IndexedDataMapOfShapeListOfShape& meshedEdgeFaces, std::vector<gp_Pnt>& contour)
+		{
+			bool edgeNodes = false;
+			for (BRepTools_WireExplorer exp(wire, face); exp.More(); exp.Next())
+			{
+				gp_Pnt start = BRep_Tool::Pnt(exp.CurrentVertex());
+				contour.push_back(start);
+				const TopoDS_Edge& edge = exp.Current();
+				if (!meshedEdgeFaces.Contains(edge)) continue;
+				for (TopTools_ListIteratorOfListOfShape it(meshedEdgeFaces.FindFromKey(edge)); it.More(); it.Next())
+				{
+					TopLoc_Location loc;
+					const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(TopoDS::Face(it.Value()), loc);
+					if (mesh.IsNull()) continue;
+					const Handle(Poly_PolygonOnTriangulation)& polygon = BRep_Tool::PolygonOnTriangulation(edge, mesh, loc);
+					if (polygon.IsNull()) continue;
+					const TColStd_Array1OfInteger& nodes = polygon->Nodes();
+					if (nodes.Length() > 2)
+					{
+						const TColgp_Array1OfPnt& meshNodes = mesh->Nodes();
+						const gp_Trsf& trsf = loc.Transformation();
+						//the polygon follows the parameter of the edge curve, which may run against the wire
+						bool forward = meshNodes(nodes(nodes.Lower())).Transformed(trsf).SquareDistance(start) <= meshNodes(nodes(nodes.Upper())).Transformed(trsf).SquareDistance(start);
+						for (int k = 1; k < nodes.Length() - 1; k++)
+							contour.push_back(meshNodes(nodes(forward ? nodes.Lower() + k : nodes.Upper() - k)).Transformed(trsf));
+						edgeNodes = true;
+					}
+					break;
+				}
+			}
+			return edgeNodes;
+		}
+
+		//collects the wires of a planar face as contours, the outer wire first. Returns true if any edge had nodes between its vertices
+		static bool PlanarFaceContours(const TopoDS_Face& face, const TopTools_IndexedDataMapOfShapeListOfShape& meshedEdgeFaces, std::vector<std::vector<gp_Pnt>>& contours)
+		{
+			contours.clear();
+			TopoDS_Wire outerWire = BRepTools::OuterWire(face);
+			if (outerWire.IsNull()) return false;
+			contours.emplace_back();
+			bool edgeNodes = AddWireContour(outerWire, face, meshedEdgeFaces, contours.back());
+			for (TopExp_Explorer wireExplorer(face, TopAbs_WIRE); wireExplorer.More(); wireExplorer.Next())
+			{
+				const TopoDS_Wire& wire = TopoDS::Wire(wireExplorer.Current());
+				if (wire.IsSame(outerWire)) continue;
+				contours.emplace_back();
+				edgeNodes |= AddWireContour(wire, face, meshedEdgeFaces, contours.back());
+			}
+			return edgeNodes;
+		}
+
+		//loads the contours of a planar face into the triangulator, the outer one first, and triangulates them
+		static bool TriangulatePlanarFace(const std::vector<std::vector<gp_Pnt>>& contours, const Handle(Geom_Plane)& plane, bool faceReversed, XbimPolygonTriangulator& triangulator)
+		{
+			if (contours.empty()) return false;
+			triangulator.Begin(plane->Position());
+			for (const std::vector<gp_Pnt>& contour : contours)
+			{
+				triangulator.BeginContour();
+				for (const gp_Pnt& p : contour)
+					triangulator.AddPoint(p);
+			}
+			return triangulator.Triangulate(faceReversed);
+		}
+
 		void XbimOccShape::WriteTriangulation(BinaryWriter^ binaryWriter, double tolerance, double deflection, double angle)
 		{
 
@@ -340,10 +478,17 @@ namespace Xbim
 			TopExp::MapShapes(shape, TopAbs_FACE, faceMap);
 			int faceCount = faceMap.Extent();
 			if (faceCount == 0) return;
+			if (XbimCancellation::Cancelled()) return; //BRepMesh takes no progress indicator in this version of OCC
 
 			Dictionary<XbimPoint3DWithTolerance^, int>^ pointMap = gcnew Dictionary<XbimPoint3DWithTolerance^, int>();
 			List<List<int>^>^ pointLookup = gcnew List<List<int>^>(faceCount);
-			List<XbimPoint3D>^ points = gcnew List<XbimPoint3D>(faceCount * 3);;
+			std::vector<double> points; //unique vertices as contiguous xyz triples
+			points.reserve(faceCount * 9);
+			XbimMeshKernel::FaceBuffers buffers; //reused for every face
+			XbimPolygonTriangulator polygonTriangulator; //reused for every planar face
+			std::vector<std::vector<gp_Pnt>> contours; //reused for every planar face
+			TopTools_IndexedDataMapOfShapeListOfShape meshedEdgeFaces; //the faces meshed by BRepMesh on each of their edges
+			bool useNativeTriangulator = XbimGeometryCreator::UseNativePolygonTriangulator;
 
 			List<List<XbimPackedNormal>^>^ normalLookup = gcnew List<List<XbimPackedNormal>^>(faceCount);
 
@@ -353,7 +498,13 @@ namespace Xbim
 			List<List<int>^>^ tessellations = gcnew List<List<int>^>(faceCount);
 			bool isPolyhedron = true;
 			array<bool>^ hasSeams = gcnew array<bool>(faceCount);
-			//we check if the shape is a faceted poltgon, i.e. all faces are planar and all edges are linear, if so then we do not need to use OCC meshing which is general purpose and a little slower than LibMesh
+			array<bool>^ isPolygonalFace = gcnew array<bool>(faceCount);
+			BRep_Builder builder;
+			TopoDS_Compound curvedFaces;
+			builder.MakeCompound(curvedFaces);
+			//we check each face to see if it is a planar polygon, i.e. the face is planar and all its edges are linear, if so then we do not need to use OCC meshing which is general purpose and a little slower than LibMesh
+			//only the remaining faces are meshed by OCC, the results are welded together through the point map and any nodes OCC puts on a
+			//straight edge are added to the polygon on the other side of it
 			for (int f = 1; f <= faceMap.Extent(); f++)
 			{
 				const TopoDS_Face& face = TopoDS::Face(faceMap(f));
@@ -361,8 +512,8 @@ namespace Xbim
 				bool isPlane = !plane.IsNull();
 				//set the seam value to false for default, seams cannot be on planar surfaces
 				hasSeams[f - 1] = false;
-				if (!isPlane) isPolyhedron = false; //must be a plane to be a polyhedron
-				if (isPolyhedron && isPlane) //if the shape is still potentially a polyhedron then check that this planar face has no curves
+				bool isPolygonal = isPlane; //must be a plane to be a polygon
+				if (isPlane) //check that this planar face has no curves
 				{
 					for (TopExp_Explorer edgeExplorer(face, TopAbs_EDGE); edgeExplorer.More(); edgeExplorer.Next())					
 					{
@@ -386,12 +537,18 @@ namespace Xbim
 								if (tcType == STANDARD_TYPE(Geom_Line))
 									continue;
 							}
-							//if here then the shape has curves and we need to use OCC meshing
-							isPolyhedron = false;
+							//if here then the face has curves and we need to use OCC meshing
+							isPolygonal = false;
 							break;
 						}
 					}
 				}
+				isPolygonalFace[f - 1] = isPolygonal;
+				if (!isPolygonal)
+				{
+					builder.Add(curvedFaces, face);
+					isPolyhedron = false;
+				}
 				if (!isPlane) //curved surface check for any seams that will need smoothing
 				{							
 					for (TopExp_Explorer edgeExplorer(face,TopAbs_EDGE); edgeExplorer.More(); edgeExplorer.Next())
@@ -408,7 +565,12 @@ namespace Xbim
 			}
 
 			if (!isPolyhedron)
-				BRepMesh_IncrementalMesh incrementalMesh(this, deflection, Standard_False, angle); //triangulate the first time							
+			{
+				XBIM_TRACE_SCOPE("BRepMesh");
+				BRepMesh_IncrementalMesh incrementalMesh(curvedFaces, deflection, Standard_False, angle); //triangulate the faces that are not polygons							
+				if (memoryPressure > 0) UpdateMemoryPressure(); //the triangulation is held by the faces of the shape
+				TopExp::MapShapesAndAncestors(curvedFaces, TopAbs_EDGE, TopAbs_FACE, meshedEdgeFaces);
+			}
 			for (int f = 1; f <= faceMap.Extent(); f++)
 			{
 				const TopoDS_Face& face = TopoDS::Face(faceMap(f));
@@ -418,7 +580,9 @@ namespace Xbim
 				//bool isFaceWithCurve = isCurveFace[f - 1];
 				List<XbimPackedNormal>^ norms;
 				Tess^ tess = gcnew Tess();
-				if (!isPolyhedron)
+				//the native triangulator drops collinear points, a face with nodes on its edges goes to the managed one, which keeps them
+				bool edgeNodes = isPolygonalFace[f - 1] && PlanarFaceContours(face, meshedEdgeFaces, contours);
+				if (!isPolygonalFace[f - 1])
 				{
 					TopLoc_Location loc;
 					const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(face, loc);
@@ -426,22 +590,18 @@ namespace Xbim
 						continue;
 					//check if we have a seam
 					bool hasSeam = hasSeams[f - 1];
-					gp_Trsf transform = loc.Transformation();
-					gp_Quaternion quaternion = transform.GetRotation();
-					const TColgp_Array1OfPnt& nodes = mesh->Nodes();
 					triangleCount += mesh->NbTriangles();
 					pointLookup->Add(gcnew List<int>(mesh->NbNodes()));
+					//transform the nodes and, for curved faces, rotate the normals to the new location in one pass
+					XbimMeshKernel::TransformTriangulation(mesh, loc.Transformation(), faceReversed, !isPlanar, buffers);
+					const double* worldNodes = buffers.nodes.data();
 					if (!isPlanar)
 					{
-						Poly::ComputeNormals(mesh); //we need the normals
 						norms = gcnew List<XbimPackedNormal>(mesh->NbNodes());
-						for (Standard_Integer i = 1; i <= mesh->NbNodes() * 3; i += 3) //visit each node
+						const double* worldNormals = buffers.normals.data();
+						for (Standard_Integer i = 0; i < mesh->NbNodes() * 3; i += 3) //visit each node
 						{
-							gp_Dir dir(mesh->Normals().Value(i), mesh->Normals().Value(i + 1), mesh->Normals().Value(i + 2));
-							if (faceReversed) dir.Reverse();
-
-							dir = quaternion.Multiply(dir);
-							XbimPackedNormal packedNormal = XbimPackedNormal(dir.X(), dir.Y(), dir.Z());
+							XbimPackedNormal packedNormal = XbimPackedNormal(worldNormals[i], worldNormals[i + 1], worldNormals[i + 2]);
 							norms->Add(packedNormal);
 						}
 						normalLookup->Add(norms);
@@ -457,15 +617,14 @@ namespace Xbim
 					Dictionary<XbimPoint3DWithTolerance^, int>^ uniquePointsOnFace = nullptr;
 					for (Standard_Integer j = 1; j <= mesh->NbNodes(); j++) //visit each node for vertices
 					{
-						gp_XYZ p = nodes.Value(j).XYZ();
-						transform.Transforms(p);
+						const double* p = worldNodes + (j - 1) * 3;
 						int index;
-						XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(p.X(), p.Y(), p.Z(), tolerance);
+						XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(p[0], p[1], p[2], tolerance);
 						if (!pointMap->TryGetValue(pt, index))
 						{
-							index = points->Count;
+							index = (int)(points.size() / 3);
 							pointMap->Add(pt, index);
-							points->Add(pt->VertexGeometry);
+							points.insert(points.end(), p, p + 3);
 						}
 						pointLookup[faceIndex]->Add(index);
 						if (hasSeam) //keep a record of duplicate points on face triangulation so we can average the normals
@@ -505,55 +664,55 @@ namespace Xbim
 					faceIndex++;
 
 				}
-				else //it is planar we can use LibMeshDotNet
+				else if (useNativeTriangulator && !edgeNodes && TriangulatePlanarFace(contours, plane, faceReversed, polygonTriangulator))
 				{
-					//need to consider whoch side is front annd back
 					gp_Dir faceNormal = faceReversed ? plane->Axis().Direction().Reversed() : plane->Axis().Direction();
-					XbimPackedNormal packedNormal = XbimPackedNormal(faceNormal.X(), faceNormal.Y(), faceNormal.Z());
 					norms = gcnew List<XbimPackedNormal>(1);
-					TopTools_IndexedMapOfShape wireMap;
-					TopExp::MapShapes(face, TopAbs_WIRE, wireMap);
-					if (wireMap.Extent() == 1) //just one loop, it is the outer
+					norms->Add(XbimPackedNormal(faceNormal.X(), faceNormal.Y(), faceNormal.Z()));
+					normalLookup->Add(norms);
+					const std::vector<double>& polygonPoints = polygonTriangulator.Points();
+					const std::vector<int>& polygonTriangles = polygonTriangulator.Triangles();
+					int numPoints = polygonTriangulator.PointCount();
+					triangleCount += polygonTriangulator.TriangleCount();
+					pointLookup->Add(gcnew List<int>(numPoints));
+					for (int i = 0; i < numPoints; i++) //visit each node for vertices
 					{
-						TopoDS_Wire outerWire = TopoDS::Wire(wireMap(1));
-						int numberEdges = outerWire.NbChildren();
-						if (numberEdges > 2)
+						const double* p = &polygonPoints[i * 3];
+						int index;
+						XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(p[0], p[1], p[2], tolerance);
+						if (!pointMap->TryGetValue(pt, index))
 						{
-							array<ContourVertex>^ outerContour = gcnew array<ContourVertex>(numberEdges);
-							BRepTools_WireExplorer exp(outerWire, face);
-							for (int j = 0; exp.More(); exp.Next())
-							{
-								gp_Pnt p = BRep_Tool::Pnt(exp.CurrentVertex());
-								outerContour[j].Position.X = p.X();
-								outerContour[j].Position.Y = p.Y();
-								outerContour[j].Position.Z = p.Z();
-								j++;
-							}
-							tess->AddContour(outerContour); //the original winding is correct as we have oriented the wire to the face in BRepTools_WireExplorer
+							index = (int)(points.size() / 3);
+							pointMap->Add(pt, index);
+							points.insert(points.end(), p, p + 3);
 						}
-
+						pointLookup[faceIndex]->Add(index);
 					}
-					else
+					List<int>^ elems = gcnew List<int>((int)polygonTriangles.size());
+					for (int index : polygonTriangles)
+						elems->Add(index);
+					tessellations->Add(elems);
+					faceIndex++;
+				}
+				else //it is planar we can use LibMeshDotNet, this also handles polygons the native triangulator rejects
+				{
+					//need to consider whoch side is front annd back
+					gp_Dir faceNormal = faceReversed ? plane->Axis().Direction().Reversed() : plane->Axis().Direction();
+					XbimPackedNormal packedNormal = XbimPackedNormal(faceNormal.X(), faceNormal.Y(), faceNormal.Z());
+					norms = gcnew List<XbimPackedNormal>(1);
+					for (const std::vector<gp_Pnt>& contourPoints : contours)
 					{
-						for (int i = 1; i <= wireMap.Extent(); i++)
+						int numberOfPoints = (int)contourPoints.size();
+						if (numberOfPoints > 2)
 						{
-							TopoDS_Wire ccWire = TopoDS::Wire(wireMap(i));
-
-							int numberOfEdges = ccWire.NbChildren();
-							if (numberOfEdges > 2)
+							array<ContourVertex>^ contour = gcnew array<ContourVertex>(numberOfPoints);
+							for (int j = 0; j < numberOfPoints; j++)
 							{
-								array<ContourVertex>^ contour = gcnew array<ContourVertex>(numberOfEdges);
-								BRepTools_WireExplorer exp(ccWire, face);
-								for (int j = 0; exp.More(); exp.Next())
-								{
-									gp_Pnt p = BRep_Tool::Pnt(exp.CurrentVertex());
-									contour[j].Position.X = p.X();
-									contour[j].Position.Y = p.Y();
-									contour[j].Position.Z = p.Z();
-									j++;
-								}
-								tess->AddContour(contour); //the original winding is correct as we have oriented the wire to the face in BRepTools_WireExplorer
+								contour[j].Position.X = contourPoints[j].X();
+								contour[j].Position.Y = contourPoints[j].Y();
+								contour[j].Position.Z = contourPoints[j].Z();
 							}
+							tess->AddContour(contour); //the original winding is correct as we have oriented the wire to the face in BRepTools_WireExplorer
 						}
 					}
 					tess->Tessellate(Xbim::Tessellator::WindingRule::EvenOdd, Xbim::Tessellator::ElementType::Polygons, 3);
@@ -576,9 +735,11 @@ namespace Xbim
 							XbimPoint3DWithTolerance^ pt = gcnew XbimPoint3DWithTolerance(p.X, p.Y, p.Z, tolerance);
 							if (!pointMap->TryGetValue(pt, index))
 							{
-								index = points->Count;
+								index = (int)(points.size() / 3);
 								pointMap->Add(pt, index);
-								points->Add(pt->VertexGeometry);
+								points.push_back(p.X);
+								points.push_back(p.Y);
+								points.push_back(p.Z);
 							}
 							pointLookup[faceIndex]->Add(index);
 						}
@@ -596,15 +757,18 @@ namespace Xbim
 			}
 			// Write out header
 			binaryWriter->Write((unsigned char)1); //stream format version
-			int numVertices = points->Count;
+			int numVertices = (int)(points.size() / 3);
 			binaryWriter->Write((UInt32)numVertices); //number of vertices
 			binaryWriter->Write((UInt32)triangleCount); //number of triangles
-			//write out vertices 
-			for each (XbimPoint3D p in points)
+			//write out vertices as one block of little endian floats, the same layout as writing each float in turn
+			if (numVertices > 0)
 			{
-				binaryWriter->Write((float)p.X);
-				binaryWriter->Write((float)p.Y);
-				binaryWriter->Write((float)p.Z);
+				array<Byte>^ vertexBlock = gcnew array<Byte>(numVertices * 3 * sizeof(float));
+				{
+					pin_ptr<Byte> pinned = &vertexBlock[0];
+					XbimMeshKernel::ToFloat(points.data(), numVertices * 3, reinterpret_cast<float*>(pinned));
+				}
+				binaryWriter->Write(vertexBlock);
 			}
 
 			//now write out the faces
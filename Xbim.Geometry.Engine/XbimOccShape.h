@@ -9,6 +9,7 @@ using namespace System::Collections::Generic;
 using namespace Xbim::Common::Geometry;
 using namespace Xbim::Ifc4::Interfaces;
 
+class XbimShapeTree;
 
 namespace Xbim
 {
@@ -25,19 +26,43 @@ namespace Xbim
 		};
 #pragma managed(pop)
 
+		ref class XbimShapeBounds;
+
 		ref class XbimOccShape abstract : XbimGeometryObject
 		{
-		
-		
-			
+		private:
+			Int64 memoryPressure;
+			XbimShapeBounds^ bounds;
+		protected:
+			//reports the estimated native size of the shape to the GC, call again when the shape grows, e.g. when it is meshed
+			void UpdateMemoryPressure();
+			//removes the pressure reported for the shape, call when the native shape is deleted
+			void ReleaseMemoryPressure();
+			//deletes the box, hull and triangle tree kept for the shape, call when the native shape is deleted
+			void ReleaseBounds();
 		public:
 			static void WriteIndex(BinaryWriter^ bw, UInt32 index, UInt32 maxInt);
+			//a rough size in bytes of the faces, edges and triangulation of the shape, shared sub-shapes are counted for each use
+			static Int64 EstimateNativeBytes(const TopoDS_Shape& shape);
 			XbimOccShape();
+			property Int64 NativeBytesEstimate { Int64 get() { return IsValid ? EstimateNativeBytes(this) : 0; } }
+			//the bytes currently reported to the GC for this wrapper
+			property Int64 MemoryPressure { Int64 get() { return memoryPressure; } }
 			//operators
 			virtual operator const TopoDS_Shape& () abstract;
 			void WriteTriangulation(TextWriter^ textWriter, double tolerance, double deflection, double angle);
 			void WriteTriangulation(BinaryWriter^ binaryWriter, double tolerance, double deflection, double angle);
 			void WriteTriangulation(IXbimMeshReceiver^ mesh, double tolerance, double deflection, double angle);
+			//the centre, the x, y and z directions and the half sizes of a tight box around the shape, kept until the shape is moved
+			array<double>^ OrientedBox();
+			//the convex hull of the shape as a shape geometry of planar triangles, kept until the shape is moved or meshed more finely
+			XbimShapeGeometry^ ConvexHull(double deflection, double angle);
+			//the triangles of the shape in a bounding volume hierarchy, kept until the shape is moved or meshed more finely
+			const XbimShapeTree* ShapeTree(double deflection, double angle);
+			//true if the shapes are within the tolerance of each other everywhere, see XbimGeometryCreator::GeometricallyEquals
+			virtual bool Equals(IXbimGeometryObject^ geometryObject, double tolerance) override;
+			//true if the shapes come within the tolerance of each other or one holds the other, see XbimGeometryCreator::Intersects
+			virtual bool Intersects(IXbimGeometryObject^ geometryObject, double tolerance) override;
 			virtual property bool IsSet{bool get() override { return false; }; }
 			virtual XbimGeometryObject^ Transformed(IIfcCartesianTransformationOperator ^transformation) abstract;
 			virtual XbimGeometryObject^ Moved(IIfcPlacement ^placement) abstract;
@@ -0,0 +1,517 @@
+#include "XbimPolygonTriangulator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+//The ear clipping follows the earcut algorithm by Mapbox (ISC licence), without the z-order hashing used for very large polygons
+
+namespace
+{
+	inline int Sign(double val)
+	{
+		return (0.0 < val) - (val < 0.0);
+	}
+
+	inline bool PointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+	{
+		return (cx - px) * (ay - py) - (ax - px) * (cy - py) >= 0 &&
+			(ax - px) * (by - py) - (bx - px) * (ay - py) >= 0 &&
+			(bx - px) * (cy - py) - (cx - px) * (by - py) >= 0;
+	}
+}
+
+XbimPolygonTriangulator::XbimPolygonTriangulator() : outerDropped(false)
+{
+}
+
+void XbimPolygonTriangulator::Begin(const gp_Ax3& plane)
+{
+	origin = plane.Location();
+	xAxis = plane.XDirection();
+	yAxis = plane.Direction().Crossed(xAxis); //keep the projection right handed about the normal even if the placement is not
+	points.clear();
+	projected.clear();
+	contourStarts.clear();
+	triangles.clear();
+	nodes.clear();
+	holeQueue.clear();
+	outerDropped = false;
+}
+
+void XbimPolygonTriangulator::BeginContour()
+{
+	//drop a previous contour that cannot bound any area
+	if (!contourStarts.empty() && PointCount() - contourStarts.back() < 3)
+	{
+		if (contourStarts.size() == 1)
+			outerDropped = true;
+		points.resize(contourStarts.back() * 3);
+		projected.resize(contourStarts.back() * 2);
+		contourStarts.pop_back();
+	}
+	contourStarts.push_back(PointCount());
+}
+
+void XbimPolygonTriangulator::AddPoint(const gp_Pnt& point)
+{
+	points.push_back(point.X());
+	points.push_back(point.Y());
+	points.push_back(point.Z());
+	gp_XYZ local = point.XYZ() - origin.XYZ();
+	projected.push_back(local.Dot(xAxis.XYZ()));
+	projected.push_back(local.Dot(yAxis.XYZ()));
+}
+
+bool XbimPolygonTriangulator::Triangulate(bool reversed)
+{
+	triangles.clear();
+	nodes.clear();
+	BeginContour(); //closes off the last contour
+	contourStarts.pop_back();
+	if (contourStarts.empty() || outerDropped) return false;
+	int pointCount = PointCount();
+	nodes.reserve(pointCount + contourStarts.size() * 2 + 16);
+	triangles.reserve((pointCount + contourStarts.size() * 2) * 3);
+
+	int outerEnd = contourStarts.size() > 1 ? contourStarts[1] : pointCount;
+	int outerNode = LinkedList(0, outerEnd, true);
+	if (outerNode < 0 || nodes[outerNode].next == nodes[outerNode].prev) return false;
+	if (contourStarts.size() > 1)
+		outerNode = EliminateHoles(outerNode);
+	EarcutLinked(outerNode, 0);
+	if (triangles.empty()) return false;
+
+	//the triangles must cover the polygon, if not the input was self intersecting or the holes overlap
+	double polygonArea = 0;
+	for (size_t c = 0; c < contourStarts.size(); c++)
+	{
+		int end = c + 1 < contourStarts.size() ? contourStarts[c + 1] : pointCount;
+		double a = std::abs(SignedArea(contourStarts[c], end));
+		polygonArea += c == 0 ? a : -a;
+	}
+	double triangleArea = 0;
+	for (size_t t = 0; t < triangles.size(); t += 3)
+	{
+		const double* a = &projected[triangles[t] * 2];
+		const double* b = &projected[triangles[t + 1] * 2];
+		const double* c = &projected[triangles[t + 2] * 2];
+		triangleArea += std::abs((b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]));
+	}
+	polygonArea *= 0.5; //the shoelace sum is twice the area
+	triangleArea *= 0.5;
+	if (std::abs(triangleArea - polygonArea) > 1e-6 * std::max(1.0, std::abs(polygonArea)))
+		return false;
+
+	if (reversed)
+	{
+		for (size_t t = 0; t < triangles.size(); t += 3)
+			std::swap(triangles[t], triangles[t + 2]);
+	}
+	return true;
+}
+
+//create a circular doubly linked list from the points of a contour in the specified winding order
+int XbimPolygonTriangulator::LinkedList(int start, int end, bool clockwise)
+{
+	int last = -1;
+	if (clockwise == (SignedArea(start, end) > 0))
+	{
+		for (int i = start; i < end; i++) last = InsertNode(i, last);
+	}
+	else
+	{
+		for (int i = end - 1; i >= start; i--) last = InsertNode(i, last);
+	}
+	if (last >= 0 && Equals(last, nodes[last].next))
+	{
+		int next = nodes[last].next;
+		RemoveNode(last);
+		last = next;
+	}
+	return last;
+}
+
+//eliminate colinear or duplicate points
+int XbimPolygonTriangulator::FilterPoints(int start, int end)
+{
+	if (start < 0) return start;
+	if (end < 0) end = start;
+	int p = start;
+	bool again;
+	do
+	{
+		again = false;
+		if (!nodes[p].steiner && (Equals(p, nodes[p].next) || Area(nodes[p].prev, p, nodes[p].next) == 0))
+		{
+			RemoveNode(p);
+			p = end = nodes[p].prev;
+			if (p == nodes[p].next) break;
+			again = true;
+		}
+		else
+			p = nodes[p].next;
+	} while (again || p != end);
+	return end;
+}
+
+//main ear slicing loop which triangulates a polygon given as a linked list
+void XbimPolygonTriangulator::EarcutLinked(int ear, int pass)
+{
+	if (ear < 0) return;
+	int stop = ear;
+	while (nodes[ear].prev != nodes[ear].next)
+	{
+		int prev = nodes[ear].prev;
+		int next = nodes[ear].next;
+		if (IsEar(ear))
+		{
+			triangles.push_back(nodes[prev].i);
+			triangles.push_back(nodes[ear].i);
+			triangles.push_back(nodes[next].i);
+			RemoveNode(ear);
+			//skipping the next vertex leads to less sliver triangles
+			ear = nodes[next].next;
+			stop = nodes[next].next;
+			continue;
+		}
+		ear = next;
+		//if we looped through the whole remaining polygon and can't find any more ears
+		if (ear == stop)
+		{
+			if (pass == 0)
+				EarcutLinked(FilterPoints(ear, -1), 1); //try filtering points and slicing again
+			else if (pass == 1)
+				EarcutLinked(CureLocalIntersections(FilterPoints(ear, -1)), 2); //try to cure small local self intersections
+			else if (pass == 2)
+				SplitEarcut(ear); //as a last resort, try splitting the remaining polygon into two
+			break;
+		}
+	}
+}
+
+//check whether a polygon node forms a valid ear with adjacent nodes
+bool XbimPolygonTriangulator::IsEar(int ear)
+{
+	const Node& a = nodes[nodes[ear].prev];
+	const Node& b = nodes[ear];
+	const Node& c = nodes[nodes[ear].next];
+	if (Area(b.prev, ear, b.next) >= 0) return false; //reflex, can't be an ear
+	//now make sure we don't have other points inside the potential ear
+	int p = c.next;
+	while (p != b.prev)
+	{
+		const Node& n = nodes[p];
+		if (PointInTriangle(a.x, a.y, b.x, b.y, c.x, c.y, n.x, n.y) && Area(n.prev, p, n.next) >= 0)
+			return false;
+		p = n.next;
+	}
+	return true;
+}
+
+//go through all polygon nodes and cure small local self intersections
+int XbimPolygonTriangulator::CureLocalIntersections(int start)
+{
+	int p = start;
+	do
+	{
+		int a = nodes[p].prev;
+		int b = nodes[nodes[p].next].next;
+		if (!Equals(a, b) && Intersects(a, p, nodes[p].next, b) && LocallyInside(a, b) && LocallyInside(b, a))
+		{
+			triangles.push_back(nodes[a].i);
+			triangles.push_back(nodes[p].i);
+			triangles.push_back(nodes[b].i);
+			//remove two nodes involved
+			int next = nodes[p].next;
+			RemoveNode(p);
+			RemoveNode(next);
+			p = start = b;
+		}
+		p = nodes[p].next;
+	} while (p != start);
+	return FilterPoints(p, -1);
+}
+
+//try splitting polygon into two and triangulate them independently
+void XbimPolygonTriangulator::SplitEarcut(int start)
+{
+	//look for a valid diagonal that divides the polygon into two
+	int a = start;
+	do
+	{
+		int b = nodes[nodes[a].next].next;
+		while (b != nodes[a].prev)
+		{
+			if (nodes[a].i != nodes[b].i && IsValidDiagonal(a, b))
+			{
+				int c = SplitPolygon(a, b);
+				a = FilterPoints(a, nodes[a].next);
+				c = FilterPoints(c, nodes[c].next);
+				EarcutLinked(a, 0);
+				EarcutLinked(c, 0);
+				return;
+			}
+			b = nodes[b].next;
+		}
+		a = nodes[a].next;
+	} while (a != start);
+}
+
+//link every hole into the outer loop, producing a single ring polygon without holes
+int XbimPolygonTriangulator::EliminateHoles(int outerNode)
+{
+	holeQueue.clear();
+	int pointCount = PointCount();
+	for (size_t h = 1; h < contourStarts.size(); h++)
+	{
+		int start = contourStarts[h];
+		int end = h + 1 < contourStarts.size() ? contourStarts[h + 1] : pointCount;
+		int list = LinkedList(start, end, false);
+		if (list < 0) continue;
+		if (list == nodes[list].next) nodes[list].steiner = true;
+		holeQueue.push_back(GetLeftmost(list));
+	}
+	std::sort(holeQueue.begin(), holeQueue.end(), [this](int a, int b) { return nodes[a].x < nodes[b].x; });
+	//process holes from left to right
+	for (int hole : holeQueue)
+		outerNode = EliminateHole(hole, outerNode);
+	return outerNode;
+}
+
+//find a bridge between vertices that connects hole with an outer ring and link it
+int XbimPolygonTriangulator::EliminateHole(int hole, int outerNode)
+{
+	int bridge = FindHoleBridge(hole, outerNode);
+	if (bridge < 0) return outerNode;
+	int bridgeReverse = SplitPolygon(bridge, hole);
+	int filteredBridge = FilterPoints(bridge, nodes[bridge].next);
+	FilterPoints(bridgeReverse, nodes[bridgeReverse].next);
+	return outerNode == bridge ? filteredBridge : outerNode;
+}
+
+//David Eberly's algorithm for finding a bridge between hole and outer polygon
+int XbimPolygonTriangulator::FindHoleBridge(int hole, int outerNode)
+{
+	int p = outerNode;
+	double hx = nodes[hole].x;
+	double hy = nodes[hole].y;
+	double qx = -std::numeric_limits<double>::infinity();
+	int m = -1;
+	//find a segment intersected by a ray from the hole's leftmost point to the left, the segment's endpoint with lesser x will be potential connection point
+	do
+	{
+		const Node& n = nodes[p];
+		const Node& nn = nodes[n.next];
+		if (hy <= n.y && hy >= nn.y && nn.y != n.y)
+		{
+			double x = n.x + (hy - n.y) * (nn.x - n.x) / (nn.y - n.y);
+			if (x <= hx && x > qx)
+			{
+				qx = x;
+				if (x == hx)
+				{
+					if (hy == n.y) return p;
+					if (hy == nn.y) return n.next;
+				}
+				m = n.x < nn.x ? p : n.next;
+			}
+		}
+		p = n.next;
+	} while (p != outerNode);
+	if (m < 0) return -1;
+	if (hx == qx) return m; //hole touches outer segment, pick leftmost endpoint
+
+	//look for points inside the triangle of hole point, segment intersection and endpoint, if there are none then m is the bridge
+	//otherwise choose the point of the minimum angle with the ray as connection point
+	int stop = m;
+	double mx = nodes[m].x;
+	double my = nodes[m].y;
+	double tanMin = std::numeric_limits<double>::infinity();
+	p = m;
+	do
+	{
+		const Node& n = nodes[p];
+		if (hx >= n.x && n.x >= mx && hx != n.x &&
+			PointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, n.x, n.y))
+		{
+			double tan = std::abs(hy - n.y) / (hx - n.x);
+			if (LocallyInside(p, hole) &&
+				(tan < tanMin || (tan == tanMin && (n.x > nodes[m].x || (n.x == nodes[m].x && SectorContainsSector(m, p))))))
+			{
+				m = p;
+				tanMin = tan;
+			}
+		}
+		p = n.next;
+	} while (p != stop);
+	return m;
+}
+
+//find the leftmost node of a polygon ring
+int XbimPolygonTriangulator::GetLeftmost(int start)
+{
+	int p = start;
+	int leftmost = start;
+	do
+	{
+		if (nodes[p].x < nodes[leftmost].x || (nodes[p].x == nodes[leftmost].x && nodes[p].y < nodes[leftmost].y))
+			leftmost = p;
+		p = nodes[p].next;
+	} while (p != start);
+	return leftmost;
+}
+
+//check if a diagonal between two polygon nodes is valid (lies in polygon interior)
+bool XbimPolygonTriangulator::IsValidDiagonal(int a, int b)
+{
+	const Node& na = nodes[a];
+	const Node& nb = nodes[b];
+	if (nodes[na.next].i == nb.i || nodes[na.prev].i == nb.i || IntersectsPolygon(a, b))
+		return false;
+	if (LocallyInside(a, b) && LocallyInside(b, a) && MiddleInside(a, b) &&
+		(Area(na.prev, a, nb.prev) != 0 || Area(a, nb.prev, b) != 0)) //does not create opposite-facing sectors
+		return true;
+	return Equals(a, b) && Area(na.prev, a, na.next) > 0 && Area(nb.prev, b, nb.next) > 0; //special zero-length case
+}
+
+//check if two segments intersect
+bool XbimPolygonTriangulator::Intersects(int p1, int q1, int p2, int q2)
+{
+	auto onSegment = [this](int p, int q, int r)
+	{
+		const Node& np = nodes[p];
+		const Node& nq = nodes[q];
+		const Node& nr = nodes[r];
+		return nq.x <= std::max(np.x, nr.x) && nq.x >= std::min(np.x, nr.x) &&
+			nq.y <= std::max(np.y, nr.y) && nq.y >= std::min(np.y, nr.y);
+	};
+	int o1 = Sign(Area(p1, q1, p2));
+	int o2 = Sign(Area(p1, q1, q2));
+	int o3 = Sign(Area(p2, q2, p1));
+	int o4 = Sign(Area(p2, q2, q1));
+	if (o1 != o2 && o3 != o4) return true; //general case
+	if (o1 == 0 && onSegment(p1, p2, q1)) return true; //p1, q1 and p2 are collinear and p2 lies on p1q1
+	if (o2 == 0 && onSegment(p1, q2, q1)) return true; //p1, q1 and q2 are collinear and q2 lies on p1q1
+	if (o3 == 0 && onSegment(p2, p1, q2)) return true; //p2, q2 and p1 are collinear and p1 lies on p2q2
+	if (o4 == 0 && onSegment(p2, q1, q2)) return true; //p2, q2 and q1 are collinear and q1 lies on p2q2
+	return false;
+}
+
+//check if a polygon diagonal intersects any polygon segments
+bool XbimPolygonTriangulator::IntersectsPolygon(int a, int b)
+{
+	int p = a;
+	int ai = nodes[a].i;
+	int bi = nodes[b].i;
+	do
+	{
+		int next = nodes[p].next;
+		if (nodes[p].i != ai && nodes[next].i != ai && nodes[p].i != bi && nodes[next].i != bi && Intersects(p, next, a, b))
+			return true;
+		p = next;
+	} while (p != a);
+	return false;
+}
+
+//check if a polygon diagonal is locally inside the polygon
+bool XbimPolygonTriangulator::LocallyInside(int a, int b)
+{
+	const Node& na = nodes[a];
+	return Area(na.prev, a, na.next) < 0 ?
+		Area(a, b, na.next) >= 0 && Area(a, na.prev, b) >= 0 :
+		Area(a, b, na.prev) < 0 || Area(a, na.next, b) < 0;
+}
+
+//check if the middle point of a polygon diagonal is inside the polygon
+bool XbimPolygonTriangulator::MiddleInside(int a, int b)
+{
+	int p = a;
+	bool inside = false;
+	double px = (nodes[a].x + nodes[b].x) / 2;
+	double py = (nodes[a].y + nodes[b].y) / 2;
+	do
+	{
+		const Node& n = nodes[p];
+		const Node& nn = nodes[n.next];
+		if (((n.y > py) != (nn.y > py)) && nn.y != n.y && (px < (nn.x - n.x) * (py - n.y) / (nn.y - n.y) + n.x))
+			inside = !inside;
+		p = n.next;
+	} while (p != a);
+	return inside;
+}
+
+//whether sector in vertex m contains sector in vertex p in the same coordinates
+bool XbimPolygonTriangulator::SectorContainsSector(int m, int p)
+{
+	return Area(nodes[m].prev, m, nodes[p].prev) < 0 && Area(nodes[p].next, m, nodes[m].next) < 0;
+}
+
+//link two polygon vertices with a bridge, if the vertices belong to the same ring it splits the polygon into two
+//if one belongs to the outer ring and another to a hole it merges it into a single ring
+int XbimPolygonTriangulator::SplitPolygon(int a, int b)
+{
+	int a2 = (int)nodes.size();
+	nodes.push_back(Node{ nodes[a].i, nodes[a].x, nodes[a].y, -1, -1, false });
+	int b2 = (int)nodes.size();
+	nodes.push_back(Node{ nodes[b].i, nodes[b].x, nodes[b].y, -1, -1, false });
+	int an = nodes[a].next;
+	int bp = nodes[b].prev;
+
+	nodes[a].next = b;
+	nodes[b].prev = a;
+
+	nodes[a2].next = an;
+	nodes[an].prev = a2;
+
+	nodes[b2].next = a2;
+	nodes[a2].prev = b2;
+
+	nodes[bp].next = b2;
+	nodes[b2].prev = bp;
+	return b2;
+}
+
+//create a node and optionally link it with the previous one in a circular doubly linked list
+int XbimPolygonTriangulator::InsertNode(int i, int last)
+{
+	int p = (int)nodes.size();
+	nodes.push_back(Node{ i, projected[i * 2], projected[i * 2 + 1], p, p, false });
+	if (last >= 0)
+	{
+		nodes[p].next = nodes[last].next;
+		nodes[p].prev = last;
+		nodes[nodes[last].next].prev = p;
+		nodes[last].next = p;
+	}
+	return p;
+}
+
+void XbimPolygonTriangulator::RemoveNode(int p)
+{
+	nodes[nodes[p].next].prev = nodes[p].prev;
+	nodes[nodes[p].prev].next = nodes[p].next;
+}
+
+double XbimPolygonTriangulator::SignedArea(int start, int end) const
+{
+	double sum = 0;
+	for (int i = start, j = end - 1; i < end; j = i++)
+	{
+		sum += (projected[j * 2] - projected[i * 2]) * (projected[i * 2 + 1] + projected[j * 2 + 1]);
+	}
+	return sum;
+}
+
+//signed area of a triangle
+double XbimPolygonTriangulator::Area(int p, int q, int r) const
+{
+	const Node& np = nodes[p];
+	const Node& nq = nodes[q];
+	const Node& nr = nodes[r];
+	return (nq.y - np.y) * (nr.x - nq.x) - (nq.x - np.x) * (nr.y - nq.y);
+}
+
+bool XbimPolygonTriangulator::Equals(int a, int b) const
+{
+	return nodes[a].x == nodes[b].x && nodes[a].y == nodes[b].y;
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <gp_Ax3.hxx>
+#include <gp_Pnt.hxx>
+#include <vector>
+
+//Triangulates planar polygons with holes by ear clipping, holes are bridged into the outer loop first.
+//The contours are projected on to the plane of the face, the buffers are kept between calls so one instance can be reused for every face of a shape
+class XbimPolygonTriangulator
+{
+public:
+	XbimPolygonTriangulator();
+
+	//starts a new polygon on the plane, any previous contours and results are cleared
+	void Begin(const gp_Ax3& plane);
+	//starts a new contour, the first contour is the outer bound, all others are holes. A contour of fewer than 3 points is dropped,
+	//if that is the outer bound the polygon is rejected rather than take the first hole as its bound
+	void BeginContour();
+	//adds a point to the current contour
+	void AddPoint(const gp_Pnt& point);
+
+	//triangulates the contours, triangles are anticlockwise about the plane normal, or clockwise if reversed is true
+	//returns false if the polygon could not be triangulated or the triangles do not cover the polygon area, the caller should then use a more robust method
+	bool Triangulate(bool reversed);
+
+	//the points of all contours in the order they were added, as xyz triples
+	const std::vector<double>& Points() const { return points; }
+	//the triangles as triples of indices into Points
+	const std::vector<int>& Triangles() const { return triangles; }
+	int PointCount() const { return (int)(points.size() / 3); }
+	int TriangleCount() const { return (int)(triangles.size() / 3); }
+
+private:
+	struct Node
+	{
+		int i; //index of the point
+		double x, y; //projected coordinates
+		int prev, next;
+		bool steiner;
+	};
+
+	gp_Pnt origin;
+	gp_Dir xAxis, yAxis;
+	std::vector<double> points;
+	std::vector<double> projected; //uv pairs for each point
+	std::vector<int> contourStarts;
+	std::vector<int> triangles;
+	std::vector<Node> nodes;
+	std::vector<int> holeQueue;
+	bool outerDropped;
+
+	int LinkedList(int start, int end, bool clockwise);
+	int FilterPoints(int start, int end);
+	void EarcutLinked(int ear, int pass);
+	bool IsEar(int ear);
+	int CureLocalIntersections(int start);
+	void SplitEarcut(int start);
+	int EliminateHoles(int outerNode);
+	int EliminateHole(int hole, int outerNode);
+	int FindHoleBridge(int hole, int outerNode);
+	int GetLeftmost(int start);
+	bool IsValidDiagonal(int a, int b);
+	bool Intersects(int p1, int q1, int p2, int q2);
+	bool IntersectsPolygon(int a, int b);
+	bool LocallyInside(int a, int b);
+	bool MiddleInside(int a, int b);
+	bool SectorContainsSector(int m, int p);
+	int SplitPolygon(int a, int b);
+	int InsertNode(int i, int last);
+	void RemoveNode(int p);
+	double SignedArea(int start, int end) const;
+	double Area(int p, int q, int r) const;
+	bool Equals(int a, int b) const;
+};
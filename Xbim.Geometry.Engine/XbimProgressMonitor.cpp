@@ -9,13 +9,39 @@ XbimProgressMonitor::XbimProgressMonitor(Standard_Real maxDurationSeconds, bool
 	Message_ProgressIndicator()
 {
 	maxRunDuration = maxDurationSeconds;
+	timedOut = false;
+	cancelled = false;
+	cancellation = XbimCancellation::Current();
 	if (startTimer) StartTimer();
 }
 
+XbimProgressMonitor::XbimProgressMonitor() :
+	Message_ProgressIndicator()
+{
+	maxRunDuration = -1;
+	timedOut = false;
+	cancelled = false;
+	cancellation = XbimCancellation::Current();
+}
+
 Standard_Boolean XbimProgressMonitor::UserBreak()
 {
-	
-	if (ElapsedTime() > maxRunDuration)
+	if (cancellation != nullptr)
+	{
+		if (cancellation->IsCancelled())
+		{
+			StopTimer();
+			cancelled = true;
+			return true;
+		}
+		if (cancellation->IsExpired())
+		{
+			StopTimer();
+			timedOut = true;
+			return true;
+		}
+	}
+	if (maxRunDuration >= 0 && ElapsedTime() > maxRunDuration)
 	{
 		StopTimer();
 		timedOut = true;
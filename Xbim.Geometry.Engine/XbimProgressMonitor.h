@@ -8,6 +8,7 @@
 # include <Standard_Macro.hxx>
 # include <Message_ProgressIndicator.hxx>
 #include <OSD_Timer.hxx>
+#include "XbimCancellation.h"
 
 //DEFINE_STANDARD_HANDLE(XbimProgressIndicator, Message_ProgressIndicator)
 class XbimProgressMonitor : public Message_ProgressIndicator
@@ -16,14 +17,21 @@ private:
 	OSD_Timer aTimer;
 	Standard_Real maxRunDuration;
 	bool timedOut;
+	bool cancelled;
+	//the cancellation context of the thread that created the monitor, the algorithm may poll from other threads
+	XbimCancellationContext* cancellation;
 public:
+	//stops the algorithm when it runs for longer than maxDurationSeconds or when the current cancellation context is cancelled or expires
 	XbimProgressMonitor(Standard_Real maxDurationSeconds, bool startTimer = true);
+	//stops the algorithm only when the current cancellation context is cancelled or expires
+	XbimProgressMonitor();
 	virtual Standard_Boolean Show(const Standard_Boolean) { return true; }
 	virtual Standard_Boolean UserBreak();
 	void StartTimer() { timedOut = false;  aTimer.Start(); }
 	void StopTimer() { aTimer.Stop(); }
 	Standard_Real ElapsedTime() { return aTimer.ElapsedTime(); }
 	bool TimedOut() { return timedOut; }
+	bool Cancelled() { return cancelled; }
 	/*DEFINE_STANDARD_RTTI(XbimProgressIndicator, Message_ProgressIndicator)*/
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "XbimShapeBounds.h"
+#include "XbimOccShape.h"
+#include "XbimConvexHull.h"
+#include "XbimMeshKernel.h"
+#include <Bnd_Box.hxx>
+#include <Bnd_OBB.hxx>
+#include <BRepBndLib.hxx>
+#include <gp_Vec.hxx>
+#include <vector>
+
+using namespace System::IO;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		int XbimShapeBounds::Stamp(const TopoDS_Shape& shape)
+		{
+			//the hash covers the TShape and the location, Move and Translate change the location of the shape in place
+			return shape.IsNull() ? 0 : shape.HashCode(IntegerLast());
+		}
+
+		void XbimShapeBounds::Check(int shapeStamp)
+		{
+			if (shapeStamp == stamp)
+				return;
+			stamp = shapeStamp;
+			orientedBox = nullptr;
+			hull = nullptr;
+			defaultDeflection = 0;
+			InstanceCleanup();
+		}
+
+		array<double>^ XbimShapeBounds::OrientedBox(const TopoDS_Shape& shape, int shapeStamp)
+		{
+			Check(shapeStamp);
+			if (orientedBox != nullptr || shape.IsNull())
+				return orientedBox;
+			Bnd_OBB obb;
+			//the triangulation is used when the shape has one, the tolerances of the shape are added so the box holds its edges
+			BRepBndLib::AddOBB(shape, obb, Standard_True, Standard_False, Standard_True);
+			if (obb.IsVoid())
+				return nullptr;
+			const gp_XYZ& centre = obb.Center();
+			const gp_XYZ& x = obb.XDirection();
+			const gp_XYZ& y = obb.YDirection();
+			const gp_XYZ& z = obb.ZDirection();
+			orientedBox = gcnew array<double>{ centre.X(), centre.Y(), centre.Z(), x.X(), x.Y(), x.Z(), y.X(), y.Y(), y.Z(),
+				z.X(), z.Y(), z.Z(), obb.XHSize(), obb.YHSize(), obb.ZHSize() };
+			return orientedBox;
+		}
+
+		XbimShapeGeometry^ XbimShapeBounds::ConvexHull(const TopoDS_Shape& shape, int shapeStamp, double deflection, double angle)
+		{
+			Check(shapeStamp);
+			if (hull != nullptr && hullDeflection == deflection && hullAngle == angle)
+				return hull;
+			if (shape.IsNull())
+				return nullptr;
+			std::vector<double> shapePoints;
+			XbimConvexHull::ShapePoints(shape, deflection, angle, shapePoints);
+			XbimConvexHull convexHull;
+			if (!convexHull.Build(shapePoints.data(), (int)(shapePoints.size() / 3)))
+				return nullptr;
+			hull = HullShapeGeometry(convexHull);
+			hullDeflection = deflection;
+			hullAngle = angle;
+			return hull;
+		}
+
+		XbimShapeGeometry^ XbimShapeBounds::HullShapeGeometry(const XbimConvexHull& convexHull)
+		{
+			//the layout CreateShapeGeometry writes, each triangle of the hull is a planar face
+			const std::vector<double>& points = convexHull.Points();
+			const std::vector<int>& triangles = convexHull.Triangles();
+			int numVertices = (int)(points.size() / 3);
+			int numTriangles = (int)(triangles.size() / 3);
+			MemoryStream^ memStream = gcnew MemoryStream(0x1000);
+			BinaryWriter^ binaryWriter = gcnew BinaryWriter(memStream);
+			binaryWriter->Write((unsigned char)1); //stream format version
+			binaryWriter->Write((UInt32)numVertices);
+			binaryWriter->Write((UInt32)numTriangles);
+			array<Byte>^ vertexBlock = gcnew array<Byte>(numVertices * 3 * sizeof(float));
+			{
+				pin_ptr<Byte> pinned = &vertexBlock[0];
+				XbimMeshKernel::ToFloat(points.data(), numVertices * 3, reinterpret_cast<float*>(pinned));
+			}
+			binaryWriter->Write(vertexBlock);
+			binaryWriter->Write((Int32)numTriangles);
+			for (int t = 0; t < numTriangles; t++)
+			{
+				const int* v = &triangles[3 * t];
+				gp_Vec a(points[3 * v[0]], points[3 * v[0] + 1], points[3 * v[0] + 2]);
+				gp_Vec b(points[3 * v[1]], points[3 * v[1] + 1], points[3 * v[1] + 2]);
+				gp_Vec c(points[3 * v[2]], points[3 * v[2] + 1], points[3 * v[2] + 2]);
+				gp_Vec normal = (b - a).Crossed(c - a);
+				double magnitude = normal.Magnitude();
+				if (magnitude > 0)
+					normal /= magnitude;
+				binaryWriter->Write((Int32)1);
+				XbimPackedNormal(normal.X(), normal.Y(), normal.Z()).Write(binaryWriter);
+				for (int i = 0; i < 3; i++)
+					XbimOccShape::WriteIndex(binaryWriter, v[i], numVertices);
+			}
+			binaryWriter->Flush();
+
+			XbimShapeGeometry^ shapeGeom = gcnew XbimShapeGeometry();
+			((IXbimShapeGeometryData^)shapeGeom)->ShapeData = memStream->ToArray();
+			delete binaryWriter;
+			delete memStream;
+			Bnd_Box bounds;
+			for (size_t i = 0; i < points.size(); i += 3)
+				bounds.Add(gp_Pnt(points[i], points[i + 1], points[i + 2]));
+			Standard_Real xMin, yMin, zMin, xMax, yMax, zMax;
+			bounds.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+			shapeGeom->BoundingBox = XbimRect3D(xMin, yMin, zMin, xMax - xMin, yMax - yMin, zMax - zMin);
+			shapeGeom->LOD = XbimLOD::LOD_Unspecified;
+			shapeGeom->Format = XbimGeometryType::PolyhedronBinary;
+			return shapeGeom;
+		}
+
+		const XbimShapeTree* XbimShapeBounds::Tree(const TopoDS_Shape& shape, int shapeStamp, double deflection, double angle)
+		{
+			Check(shapeStamp);
+			//0 asks for the default, which is compared like any other deflection so a coarser tree is not taken for it
+			if (deflection <= 0)
+			{
+				if (defaultDeflection <= 0)
+					defaultDeflection = XbimShapeTree::DefaultDeflection(shape);
+				deflection = defaultDeflection;
+			}
+			//a tree meshed as finely as asked will do
+			if (tree != nullptr && treeDeflection <= deflection && (angle <= 0 || treeAngle <= angle))
+				return tree;
+			InstanceCleanup();
+			tree = new XbimShapeTree(shape, deflection, angle);
+			treeDeflection = deflection;
+			treeAngle = angle;
+			return tree;
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+#include "XbimShapeTree.h"
+
+class XbimConvexHull;
+
+using namespace System;
+using namespace Xbim::Common::Geometry;
+
+namespace Xbim
+{
+	namespace Geometry
+	{
+		//Keeps the oriented bounding box, the convex hull and the triangle tree of a shape for the geometry object that owns it, they are
+		//worked out on first use. The stamp of the shape is checked on every call, a shape that has been moved in place gets them worked out again.
+		//Not thread safe, like the geometry objects that hold it
+		ref class XbimShapeBounds
+		{
+		private:
+			int stamp;
+			array<double>^ orientedBox;
+			XbimShapeGeometry^ hull;
+			double hullDeflection;
+			double hullAngle;
+			XbimShapeTree* tree;
+			//the linear deflection the tree was meshed to, a deflection of 0 is resolved to the default of the shape first
+			double treeDeflection;
+			double treeAngle;
+			double defaultDeflection;
+			void Check(int shapeStamp);
+			void InstanceCleanup()
+			{
+				delete tree;
+				tree = nullptr;
+			};
+		public:
+			~XbimShapeBounds() { InstanceCleanup(); }
+			!XbimShapeBounds() { InstanceCleanup(); }
+			//identifies the shape and its location, the caches are dropped when it changes
+			static int Stamp(const TopoDS_Shape& shape);
+			//the centre, the x, y and z directions and the half sizes of the smallest box found around the shape, 15 values, null if
+			//the shape is empty
+			array<double>^ OrientedBox(const TopoDS_Shape& shape, int shapeStamp);
+			//the hull of the B-rep vertices and triangulation nodes of the shape as planar triangles, null if they do not span a volume
+			XbimShapeGeometry^ ConvexHull(const TopoDS_Shape& shape, int shapeStamp, double deflection, double angle);
+			//the triangles of a built hull as a shape geometry, each one a planar face
+			static XbimShapeGeometry^ HullShapeGeometry(const XbimConvexHull& convexHull);
+			//the triangles of the shape in a bounding volume hierarchy, owned by this object. Built again if asked for a finer deflection,
+			//0 asks for XbimShapeTree::DefaultDeflection and is finer than a tree built for a coarser explicit deflection
+			const XbimShapeTree* Tree(const TopoDS_Shape& shape, int shapeStamp, double deflection, double angle);
+		};
+	}
+}
@@ -0,0 +1,482 @@
+#include "XbimShapeTree.h"
+#include "XbimSolidBatch.h"
+#include <Bnd_Box.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepClass3d_SolidClassifier.hxx>
+#include <BRepExtrema_DistShapeShape.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BVH_Traverse.hxx>
+#include <BVH_Triangulation.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+typedef BVH_Triangulation<Standard_Real, 3> XbimTriangleSet;
+
+struct XbimShapeTree::Data
+{
+	TopoDS_Shape shape;
+	opencascade::handle<XbimTriangleSet> triangles;
+	opencascade::handle<BVH_Tree<Standard_Real, 3>> tree;
+	double deflection;
+	//false if a face could not be meshed, the shape is then only tested on its B-rep
+	bool complete;
+	BVH_Vec3d minCorner;
+	BVH_Vec3d maxCorner;
+	//the solids of the shape with their boxes and a point on each, for the containment test
+	std::vector<TopoDS_Solid> solids;
+	std::vector<Bnd_Box> solidBoxes;
+	std::vector<gp_Pnt> solidPoints;
+};
+
+namespace
+{
+	inline gp_XYZ ToXYZ(const BVH_Vec3d& v)
+	{
+		return gp_XYZ(v.x(), v.y(), v.z());
+	}
+
+	//the distance between two boxes, 0 if they overlap
+	double BoxDistance(const BVH_Vec3d& min1, const BVH_Vec3d& max1, const BVH_Vec3d& min2, const BVH_Vec3d& max2)
+	{
+		double dx = std::max(0., std::max(min1.x() - max2.x(), min2.x() - max1.x()));
+		double dy = std::max(0., std::max(min1.y() - max2.y(), min2.y() - max1.y()));
+		double dz = std::max(0., std::max(min1.z() - max2.z(), min2.z() - max1.z()));
+		return std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	double PointBoxDistance(const gp_XYZ& p, const BVH_Vec3d& min, const BVH_Vec3d& max)
+	{
+		double dx = std::max(0., std::max(min.x() - p.X(), p.X() - max.x()));
+		double dy = std::max(0., std::max(min.y() - p.Y(), p.Y() - max.y()));
+		double dz = std::max(0., std::max(min.z() - p.Z(), p.Z() - max.z()));
+		return std::sqrt(dx * dx + dy * dy + dz * dz);
+	}
+
+	//the closest point of the triangle to p, by the regions of Ericson's Real-Time Collision Detection 5.1.5
+	double PointTriangleDistance(const gp_XYZ& p, const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c)
+	{
+		gp_XYZ ab = b - a, ac = c - a, ap = p - a;
+		double d1 = ab.Dot(ap), d2 = ac.Dot(ap);
+		if (d1 <= 0 && d2 <= 0)
+			return (p - a).Modulus();
+		gp_XYZ bp = p - b;
+		double d3 = ab.Dot(bp), d4 = ac.Dot(bp);
+		if (d3 >= 0 && d4 <= d3)
+			return (p - b).Modulus();
+		double vc = d1 * d4 - d3 * d2;
+		if (vc <= 0 && d1 >= 0 && d3 <= 0)
+			return (p - (a + ab * (d1 / (d1 - d3)))).Modulus();
+		gp_XYZ cp = p - c;
+		double d5 = ab.Dot(cp), d6 = ac.Dot(cp);
+		if (d6 >= 0 && d5 <= d6)
+			return (p - c).Modulus();
+		double vb = d5 * d2 - d1 * d6;
+		if (vb <= 0 && d2 >= 0 && d6 <= 0)
+			return (p - (a + ac * (d2 / (d2 - d6)))).Modulus();
+		double va = d3 * d6 - d5 * d4;
+		if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+			return (p - (b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))))).Modulus();
+		double denominator = va + vb + vc;
+		if (denominator <= 0) //a degenerate triangle
+			return std::min((p - a).Modulus(), std::min((p - b).Modulus(), (p - c).Modulus()));
+		return (p - (a + ab * (vb / denominator) + ac * (vc / denominator))).Modulus();
+	}
+
+	//the distance between segments pq and rs, Ericson 5.1.9
+	double SegmentDistance(const gp_XYZ& p, const gp_XYZ& q, const gp_XYZ& r, const gp_XYZ& s)
+	{
+		gp_XYZ d1 = q - p, d2 = s - r, w = p - r;
+		double a = d1.SquareModulus(), e = d2.SquareModulus(), f = d2.Dot(w);
+		double t1, t2;
+		if (a <= 1e-30 && e <= 1e-30)
+			return w.Modulus();
+		if (a <= 1e-30)
+		{
+			t1 = 0;
+			t2 = std::min(1., std::max(0., f / e));
+		}
+		else
+		{
+			double c = d1.Dot(w);
+			if (e <= 1e-30)
+			{
+				t2 = 0;
+				t1 = std::min(1., std::max(0., -c / a));
+			}
+			else
+			{
+				double b = d1.Dot(d2);
+				double denominator = a * e - b * b;
+				t1 = denominator > 0 ? std::min(1., std::max(0., (b * f - c * e) / denominator)) : 0;
+				t2 = (b * t1 + f) / e;
+				if (t2 < 0)
+				{
+					t2 = 0;
+					t1 = std::min(1., std::max(0., -c / a));
+				}
+				else if (t2 > 1)
+				{
+					t2 = 1;
+					t1 = std::min(1., std::max(0., (b - c) / a));
+				}
+			}
+		}
+		return ((p + d1 * t1) - (r + d2 * t2)).Modulus();
+	}
+
+	//true if segment pq passes through the triangle, Moller and Trumbore
+	bool SegmentCrossesTriangle(const gp_XYZ& p, const gp_XYZ& q, const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c)
+	{
+		gp_XYZ direction = q - p;
+		gp_XYZ e1 = b - a, e2 = c - a;
+		gp_XYZ h = direction.Crossed(e2);
+		double det = e1.Dot(h);
+		//parallel segments are found by the edge and vertex distances
+		if (std::abs(det) <= 1e-14 * e1.Modulus() * e2.Modulus() * direction.Modulus())
+			return false;
+		double inverse = 1. / det;
+		gp_XYZ s = p - a;
+		double u = s.Dot(h) * inverse;
+		if (u < 0 || u > 1)
+			return false;
+		gp_XYZ k = s.Crossed(e1);
+		double v = direction.Dot(k) * inverse;
+		if (v < 0 || u + v > 1)
+			return false;
+		double t = e2.Dot(k) * inverse;
+		return t >= 0 && t <= 1;
+	}
+
+	//the distance between two triangles, 0 if they cross. If no edge passes through the other triangle the closest points are
+	//on an edge of each or a corner of one and the face of the other
+	double TriangleDistance(const gp_XYZ* t1, const gp_XYZ* t2)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (SegmentCrossesTriangle(t1[i], t1[(i + 1) % 3], t2[0], t2[1], t2[2]) ||
+				SegmentCrossesTriangle(t2[i], t2[(i + 1) % 3], t1[0], t1[1], t1[2]))
+				return 0;
+		}
+		double distance = RealLast();
+		for (int i = 0; i < 3; i++)
+		{
+			distance = std::min(distance, PointTriangleDistance(t1[i], t2[0], t2[1], t2[2]));
+			distance = std::min(distance, PointTriangleDistance(t2[i], t1[0], t1[1], t1[2]));
+			for (int j = 0; j < 3; j++)
+				distance = std::min(distance, SegmentDistance(t1[i], t1[(i + 1) % 3], t2[j], t2[(j + 1) % 3]));
+		}
+		return distance;
+	}
+
+	void Corners(const XbimTriangleSet& set, int index, gp_XYZ* corners)
+	{
+		const BVH_Vec4i& element = set.Elements[index];
+		corners[0] = ToXYZ(set.Vertices[element.x()]);
+		corners[1] = ToXYZ(set.Vertices[element.y()]);
+		corners[2] = ToXYZ(set.Vertices[element.z()]);
+	}
+
+	//walks the pairs of triangles whose boxes come within the tolerance and the deflections of each other. A pair of exact triangles
+	//within the tolerance is a hit, a pair with a curved triangle is only a near miss, the mesh cannot tell if the shapes touch
+	class ClashTraverse : public BVH_PairTraverse<Standard_Real, 3, XbimTriangleSet>
+	{
+	public:
+		ClashTraverse(const XbimTriangleSet& a, const XbimTriangleSet& b, double tolerance, double deflectionA, double deflectionB) :
+			a(a), b(b), tolerance(tolerance), deflectionA(deflectionA), deflectionB(deflectionB), hit(false), nearMiss(false) {}
+
+		virtual Standard_Boolean RejectNode(const BVH_Vec3d& min1, const BVH_Vec3d& max1, const BVH_Vec3d& min2, const BVH_Vec3d& max2,
+			Standard_Real& metric) const Standard_OVERRIDE
+		{
+			metric = BoxDistance(min1, max1, min2, max2);
+			return metric > tolerance + deflectionA + deflectionB;
+		}
+
+		virtual Standard_Boolean IsMetricBetter(const Standard_Real& metric1, const Standard_Real& metric2) const Standard_OVERRIDE
+		{
+			return metric1 < metric2;
+		}
+
+		virtual Standard_Boolean Accept(const Standard_Integer index1, const Standard_Integer index2) Standard_OVERRIDE
+		{
+			gp_XYZ t1[3], t2[3];
+			Corners(a, index1, t1);
+			Corners(b, index2, t2);
+			//the fourth value of an element is 1 for the triangles of curved faces
+			double allowance = (a.Elements[index1].w() != 0 ? deflectionA : 0) + (b.Elements[index2].w() != 0 ? deflectionB : 0);
+			double distance = TriangleDistance(t1, t2);
+			if (distance > tolerance + allowance)
+				return Standard_False;
+			if (allowance == 0)
+				hit = true;
+			else
+				nearMiss = true;
+			return Standard_True;
+		}
+
+		virtual Standard_Boolean Stop() const Standard_OVERRIDE { return hit; }
+
+		bool Hit() const { return hit; }
+		bool NearMiss() const { return nearMiss; }
+
+	private:
+		const XbimTriangleSet& a;
+		const XbimTriangleSet& b;
+		double tolerance;
+		double deflectionA;
+		double deflectionB;
+		bool hit;
+		bool nearMiss;
+	};
+
+	//finds the distance from a point to the nearest triangle, stopping once it is known to be no more than the floor
+	class PointTraverse : public BVH_Traverse<Standard_Real, 3, void, Standard_Real>
+	{
+	public:
+		PointTraverse(const XbimTriangleSet& set, const gp_XYZ& point, double floor) : set(set), point(point), floor(floor), best(RealLast()) {}
+
+		virtual Standard_Boolean RejectNode(const BVH_Vec3d& min, const BVH_Vec3d& max, Standard_Real& metric) const Standard_OVERRIDE
+		{
+			metric = PointBoxDistance(point, min, max);
+			return metric >= best;
+		}
+
+		virtual Standard_Boolean IsMetricBetter(const Standard_Real& metric1, const Standard_Real& metric2) const Standard_OVERRIDE
+		{
+			return metric1 < metric2;
+		}
+
+		virtual Standard_Boolean RejectMetric(const Standard_Real& metric) const Standard_OVERRIDE
+		{
+			return metric >= best;
+		}
+
+		virtual Standard_Boolean Accept(const Standard_Integer index, const Standard_Real&) Standard_OVERRIDE
+		{
+			gp_XYZ corners[3];
+			Corners(set, index, corners);
+			double distance = PointTriangleDistance(point, corners[0], corners[1], corners[2]);
+			if (distance >= best)
+				return Standard_False;
+			best = distance;
+			return Standard_True;
+		}
+
+		virtual Standard_Boolean Stop() const Standard_OVERRIDE { return best <= floor; }
+
+		double Best() const { return best; }
+
+	private:
+		const XbimTriangleSet& set;
+		gp_XYZ point;
+		double floor;
+		double best;
+	};
+
+	//the distance to b of the furthest node or triangle centre of a, stopping as soon as it is over the limit
+	double DirectedHausdorff(const XbimTriangleSet& a, const XbimTriangleSet& b, const opencascade::handle<BVH_Tree<Standard_Real, 3>>& treeB,
+		double known, double limit)
+	{
+		double furthest = known;
+		auto test = [&](const gp_XYZ& point)
+		{
+			//a point no further than the furthest found so far cannot change it
+			PointTraverse traverse(b, point, furthest);
+			traverse.Select(treeB);
+			if (traverse.Best() > furthest)
+				furthest = traverse.Best();
+			return furthest <= limit;
+		};
+		for (const BVH_Vec3d& vertex : a.Vertices)
+			if (!test(ToXYZ(vertex)))
+				return furthest;
+		for (int i = 0; i < (int)a.Elements.size(); i++)
+		{
+			gp_XYZ corners[3];
+			Corners(a, i, corners);
+			if (!test((corners[0] + corners[1] + corners[2]) / 3.))
+				return furthest;
+		}
+		return furthest;
+	}
+
+	//the answer on the B-rep, a failure counts as a clash so that it is looked at
+	bool IntersectsExactly(const TopoDS_Shape& a, const TopoDS_Shape& b, double tolerance)
+	{
+		try
+		{
+			BRepExtrema_DistShapeShape distance(a, b);
+			return !distance.IsDone() || distance.Value() <= tolerance;
+		}
+		catch (const Standard_Failure&)
+		{
+			return true;
+		}
+	}
+}
+
+XbimShapeTree::XbimShapeTree(const TopoDS_Shape& original, double linearDeflection, double angularDeflection) : data(new Data())
+{
+	data->triangles = new XbimTriangleSet();
+	data->deflection = 0;
+	data->complete = true;
+	if (original.IsNull())
+		return;
+	//mesh a copy that shares the geometry and keeps any triangulation of the original, the shape of the caller is not touched
+	data->shape = BRepBuilderAPI_Copy(original, Standard_False, Standard_True).Shape();
+	const TopoDS_Shape& shape = data->shape;
+	if (linearDeflection <= 0)
+	{
+		linearDeflection = DefaultDeflection(shape);
+		if (linearDeflection <= 0)
+			return;
+	}
+	BRepMesh_IncrementalMesh incrementalMesh(shape, linearDeflection, Standard_False, angularDeflection);
+
+	XbimTriangleSet& set = *data->triangles;
+	for (TopExp_Explorer faceExplorer(shape, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next())
+	{
+		const TopoDS_Face& face = TopoDS::Face(faceExplorer.Current());
+		TopLoc_Location location;
+		const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(face, location);
+		if (mesh.IsNull())
+		{
+			data->complete = false;
+			continue;
+		}
+		bool curved = XbimSolidBatch::IsCurved(face);
+		if (curved)
+			data->deflection = std::max(data->deflection, mesh->Deflection() > 0 ? mesh->Deflection() : linearDeflection);
+		const gp_Trsf& transform = location.Transformation();
+		const TColgp_Array1OfPnt& nodes = mesh->Nodes();
+		int offset = (int)set.Vertices.size() - nodes.Lower();
+		for (int i = nodes.Lower(); i <= nodes.Upper(); i++)
+		{
+			gp_Pnt node = nodes(i).Transformed(transform);
+			set.Vertices.push_back(BVH_Vec3d(node.X(), node.Y(), node.Z()));
+		}
+		const Poly_Array1OfTriangle& triangles = mesh->Triangles();
+		for (int i = triangles.Lower(); i <= triangles.Upper(); i++)
+		{
+			Standard_Integer n1, n2, n3;
+			triangles(i).Get(n1, n2, n3);
+			set.Elements.push_back(BVH_Vec4i(offset + n1, offset + n2, offset + n3, curved ? 1 : 0));
+		}
+	}
+	if (!set.Elements.empty())
+	{
+		set.MarkDirty();
+		data->tree = set.BVH();
+		data->minCorner = data->tree->MinPoint(0);
+		data->maxCorner = data->tree->MaxPoint(0);
+	}
+
+	for (TopExp_Explorer solidExplorer(shape, TopAbs_SOLID); solidExplorer.More(); solidExplorer.Next())
+	{
+		const TopoDS_Solid& solid = TopoDS::Solid(solidExplorer.Current());
+		TopExp_Explorer vertexExplorer(solid, TopAbs_VERTEX);
+		if (!vertexExplorer.More())
+			continue;
+		Bnd_Box box;
+		BRepBndLib::Add(solid, box);
+		data->solids.push_back(solid);
+		data->solidBoxes.push_back(box);
+		data->solidPoints.push_back(BRep_Tool::Pnt(TopoDS::Vertex(vertexExplorer.Current())));
+	}
+}
+
+XbimShapeTree::~XbimShapeTree()
+{
+	delete data;
+}
+
+int XbimShapeTree::TriangleCount() const
+{
+	return (int)data->triangles->Elements.size();
+}
+
+double XbimShapeTree::Deflection() const
+{
+	return data->deflection;
+}
+
+double XbimShapeTree::DefaultDeflection(const TopoDS_Shape& shape)
+{
+	Bnd_Box box;
+	BRepBndLib::Add(shape, box);
+	return box.IsVoid() ? 0 : 0.01 * std::sqrt(box.SquareExtent());
+}
+
+//true if a point on each solid of inner, or on the shape if it has none, lies inside a solid of outer. Only called once the
+//boundaries are known not to touch, when each part of inner is either wholly inside a solid of outer or wholly outside
+bool XbimShapeTree::Holds(const Data& outer, const Data& inner, double tolerance)
+{
+	if (outer.solids.empty())
+		return false;
+	std::vector<gp_Pnt> points = inner.solidPoints;
+	if (points.empty() && !inner.triangles->Vertices.empty())
+	{
+		const BVH_Vec3d& vertex = inner.triangles->Vertices.front();
+		points.push_back(gp_Pnt(vertex.x(), vertex.y(), vertex.z()));
+	}
+	for (const gp_Pnt& point : points)
+	{
+		for (size_t i = 0; i < outer.solids.size(); i++)
+		{
+			if (outer.solidBoxes[i].IsOut(point))
+				continue;
+			BRepClass3d_SolidClassifier classifier(outer.solids[i], point, tolerance);
+			if (classifier.State() == TopAbs_IN)
+				return true;
+		}
+	}
+	return false;
+}
+
+bool XbimShapeTree::Intersects(const XbimShapeTree& a, const XbimShapeTree& b, double tolerance)
+{
+	if (a.data->shape.IsNull() || b.data->shape.IsNull())
+		return false;
+	//shapes without faces, or with faces that could not be meshed, are only tested on the B-rep
+	if (a.data->tree.IsNull() || b.data->tree.IsNull() || !a.data->complete || !b.data->complete)
+		return IntersectsExactly(a.data->shape, b.data->shape, tolerance);
+	if (BoxDistance(a.data->minCorner, a.data->maxCorner, b.data->minCorner, b.data->maxCorner) > tolerance + a.data->deflection + b.data->deflection)
+		return false;
+
+	ClashTraverse traverse(*a.data->triangles, *b.data->triangles, tolerance, a.data->deflection, b.data->deflection);
+	traverse.Select(a.data->tree, b.data->tree);
+	if (traverse.Hit())
+		return true;
+	if (traverse.NearMiss())
+		return IntersectsExactly(a.data->shape, b.data->shape, tolerance);
+	return Holds(*a.data, *b.data, tolerance) || Holds(*b.data, *a.data, tolerance);
+}
+
+double XbimShapeTree::Hausdorff(const XbimShapeTree& a, const XbimShapeTree& b, double limit)
+{
+	if (a.data->tree.IsNull() || b.data->tree.IsNull())
+		return a.data->tree.IsNull() && b.data->tree.IsNull() ? 0 : RealLast();
+	double distance = DirectedHausdorff(*a.data->triangles, *b.data->triangles, b.data->tree, 0, limit);
+	if (distance > limit)
+		return distance;
+	return DirectedHausdorff(*b.data->triangles, *a.data->triangles, a.data->tree, distance, limit);
+}
+
+bool XbimShapeTree::Equals(const XbimShapeTree& a, const XbimShapeTree& b, double tolerance)
+{
+	if (a.data->tree.IsNull() || b.data->tree.IsNull())
+		return a.data->tree.IsNull() && b.data->tree.IsNull();
+	double limit = tolerance + a.data->deflection + b.data->deflection;
+	//the boxes of equal shapes differ by no more than the limit on any side
+	for (int i = 0; i < 3; i++)
+	{
+		if (std::abs(a.data->minCorner[i] - b.data->minCorner[i]) > limit || std::abs(a.data->maxCorner[i] - b.data->maxCorner[i]) > limit)
+			return false;
+	}
+	return Hausdorff(a, b, limit) <= limit;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <TopoDS_Shape.hxx>
+
+//The triangles of a shape in a bounding volume hierarchy, for clash and comparison tests between shapes. A copy of the shape is meshed,
+//faces already meshed as finely are kept and the shape passed in is left as it is. Triangles of planes bounded by lines lie on the shape, those of other faces within the
+//deflection of it, answers that turn on that difference are settled on the B-rep with BRepExtrema. A built tree is only read, so one
+//tree may be tested against others on many threads. The header is included by /clr code, the implementation is compiled natively
+class XbimShapeTree
+{
+public:
+	//a linear deflection of 0 or less meshes to DefaultDeflection
+	XbimShapeTree(const TopoDS_Shape& shape, double linearDeflection, double angularDeflection);
+	~XbimShapeTree();
+
+	//a hundredth of the diagonal of the bounding box of the shape, 0 if the shape is empty
+	static double DefaultDeflection(const TopoDS_Shape& shape);
+
+	//the number of triangles in the tree
+	int TriangleCount() const;
+	//the largest deflection of the triangulation of a curved face, 0 if every face is a plane bounded by lines
+	double Deflection() const;
+
+	//true if the shapes come within the tolerance of each other or a solid of one holds the other
+	static bool Intersects(const XbimShapeTree& a, const XbimShapeTree& b, double tolerance);
+	//the larger of the distances from the points sampled on each shape, the nodes and the centres of its triangles, to the triangles
+	//of the other, a bound on the Hausdorff distance between them. Returns as soon as it is known to be over the limit
+	static double Hausdorff(const XbimShapeTree& a, const XbimShapeTree& b, double limit);
+	//true if the shapes are within the tolerance of each other everywhere, the tolerance is widened by the deflections of the two
+	static bool Equals(const XbimShapeTree& a, const XbimShapeTree& b, double tolerance);
+
+private:
+	struct Data;
+	Data* data;
+
+	static bool Holds(const Data& outer, const Data& inner, double tolerance);
+
+	XbimShapeTree(const XbimShapeTree&) = delete;
+	XbimShapeTree& operator=(const XbimShapeTree&) = delete;
+};
@@ -61,6 +61,8 @@ namespace Xbim
 			IntPtr temp = System::Threading::Interlocked::Exchange(ptrContainer, IntPtr::Zero);
 			if (temp != IntPtr::Zero)
 				delete (TopoDS_Shell*)(temp.ToPointer());
+			ReleaseBounds();
+			ReleaseMemoryPressure();
 			System::GC::SuppressFinalize(this);
 		}
 
@@ -73,11 +75,13 @@ namespace Xbim
 		XbimShell::XbimShell(IIfcOpenShell^ openShell, ILogger^ logger)
 		{
 			Init(openShell, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimShell::XbimShell(IIfcConnectedFaceSet^ fset, ILogger^ logger)
 		{
 			Init(fset, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimShell::XbimShell(const TopoDS_Shell& shell)
@@ -94,6 +98,7 @@ namespace Xbim
 		XbimShell::XbimShell(IIfcSurfaceOfLinearExtrusion^ linExt, ILogger^ logger)
 		{
 			Init(linExt, logger);
+			UpdateMemoryPressure();
 		}
 
 
@@ -32,6 +32,7 @@ namespace Xbim
 		public:
 			//Constructors
 			XbimShell();
+			//wraps an existing shell, often a temporary member of a set or compound, so it does not report memory pressure
 			XbimShell(const TopoDS_Shell& shell);
 			XbimShell(const TopoDS_Shell& shell, Object^ tag);
 			XbimShell(IIfcOpenShell^ openShell, ILogger^ logger);
@@ -14,6 +14,9 @@
 #include "XbimGeometryCreator.h"
 #include "XbimConvert.h"
 #include "XbimOccWriter.h"
+#include "XbimTraceRecorder.h"
+#include "XbimProgressMonitor.h"
+#include "XbimCurveCache.h"
 
 #include <TopExp.hxx>
 #include <GProp_GProps.hxx>
@@ -109,6 +112,8 @@ namespace Xbim
 			IntPtr temp = System::Threading::Interlocked::Exchange(ptrContainer, IntPtr::Zero);
 			if (temp != IntPtr::Zero)
 				delete (TopoDS_Solid*)(temp.ToPointer());
+			ReleaseBounds();
+			ReleaseMemoryPressure();
 			System::GC::SuppressFinalize(this);
 		}
 
@@ -129,69 +134,75 @@ namespace Xbim
 		XbimSolid::XbimSolid(IIfcSolidModel^ solid, ILogger^ logger)
 		{
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcManifoldSolidBrep^ solid, ILogger^ logger)
 		{
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcSweptAreaSolid^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcSweptAreaSolid^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
 		{
 			Init(repItem, overrideProfileDef, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcRevolvedAreaSolid^ solid, ILogger^ logger)
 		{
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcRevolvedAreaSolidTapered^ repItem, ILogger^ logger)
 		{
 			Init(repItem, nullptr, logger);
-
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcRevolvedAreaSolidTapered^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
 		{
 			Init(repItem, overrideProfileDef, logger);
-
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcRevolvedAreaSolid^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
 		{
 			Init(repItem, overrideProfileDef, logger);
-
+			UpdateMemoryPressure();
 		}
 		XbimSolid::XbimSolid(IIfcExtrudedAreaSolidTapered^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
 		{
 			Init(repItem, overrideProfileDef, logger);
-
+			UpdateMemoryPressure();
 		}
 		XbimSolid::XbimSolid(IIfcExtrudedAreaSolid^ repItem, ILogger^ logger)
 		{
 			Init(repItem, nullptr, logger);
-
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcExtrudedAreaSolidTapered^ repItem, ILogger^ logger)
 		{
 			Init(repItem, nullptr, logger);
-
+			UpdateMemoryPressure();
 		}
 		XbimSolid::XbimSolid(IIfcExtrudedAreaSolid^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
 		{
 			Init(repItem, overrideProfileDef, logger);
-
+			UpdateMemoryPressure();
 		}
 		XbimSolid::XbimSolid(IIfcSweptDiskSolid^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 
@@ -204,11 +215,13 @@ namespace Xbim
 		XbimSolid::XbimSolid(IIfcSectionedSpine^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcBoundingBox^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 
@@ -216,46 +229,55 @@ namespace Xbim
 		XbimSolid::XbimSolid(IIfcSurfaceCurveSweptAreaSolid^ repItem, ILogger^ logger)
 		{
 			Init(repItem, nullptr, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcSurfaceCurveSweptAreaSolid^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
 		{
 			Init(repItem, overrideProfileDef, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcHalfSpaceSolid^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcPolygonalBoundedHalfSpace^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcBoxedHalfSpace^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(XbimRect3D rect3D, double tolerance, ILogger^ logger)
 		{
 			Init(rect3D, tolerance, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcTriangulatedFaceSet^ IIfcSolid, ILogger^ logger)
 		{
 			Init(IIfcSolid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcFaceBasedSurfaceModel^ solid, ILogger^ logger)
 		{
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcShellBasedSurfaceModel^ solid, ILogger^ logger)
 		{
 			Init(solid, logger);
+			UpdateMemoryPressure();
 		}
 
 
@@ -263,6 +285,7 @@ namespace Xbim
 		XbimSolid::XbimSolid(IIfcCsgPrimitive3D^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 
@@ -270,36 +293,43 @@ namespace Xbim
 		XbimSolid::XbimSolid(IIfcSphere^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcBlock^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcRightCircularCylinder^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcRightCircularCone^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcRectangularPyramid^ repItem, ILogger^ logger)
 		{
 			Init(repItem, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcFixedReferenceSweptAreaSolid^ repItem, ILogger^ logger)
 		{
 			Init(repItem, nullptr, logger);
+			UpdateMemoryPressure();
 		}
 
 		XbimSolid::XbimSolid(IIfcFixedReferenceSweptAreaSolid^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
 		{
 			Init(repItem, overrideProfileDef, logger);
+			UpdateMemoryPressure();
 		}
 #pragma   endregion
 
@@ -586,6 +616,7 @@ namespace Xbim
 				pipeMaker1.Add(outerBound, TopExp::FirstVertex(edge), Standard_False, Standard_False);
 				try
 				{
+					XBIM_THROW_IF_CANCELLED();
 					pipeMaker1.Build();
 				}
 				catch (Standard_Failure sf)
@@ -624,6 +655,7 @@ namespace Xbim
 						pipeMaker2.SetTransitionMode(transitionMode);
 						pipeMaker1.SetMode(refSurface);
 						pipeMaker2.Add(innerBoundStart);
+						XBIM_THROW_IF_CANCELLED();
 						pipeMaker2.Build();
 						if (pipeMaker2.IsDone())
 						{
@@ -656,6 +688,7 @@ namespace Xbim
 
 					if (BRepCheck_Analyzer(solid, Standard_False).IsValid() == Standard_False)
 					{
+						XBIM_TRACE_SCOPE("ShapeFix");
 						ShapeFix_Shape shapeFixer(solid);
 						shapeFixer.SetPrecision(precision);
 						shapeFixer.SetMinTolerance(precision);
@@ -663,7 +696,8 @@ namespace Xbim
 						shapeFixer.FixFaceTool()->FixOrientationMode() = Standard_True;
 						shapeFixer.FixFaceTool()->FixWireTool()->FixAddCurve3dMode() = Standard_True;
 						shapeFixer.FixFaceTool()->FixWireTool()->FixIntersectingEdgesMode() = Standard_True;
-						if (shapeFixer.Perform())
+						Handle(XbimProgressMonitor) pi = new XbimProgressMonitor();
+						if (shapeFixer.Perform(pi))
 						{
 							TopoDS_Shell sshell;
 							b.MakeShell(sshell);
@@ -762,6 +796,7 @@ namespace Xbim
 					pipeMaker1.SetTransitionMode(BRepBuilderAPI_Transformed);
 					pipeMaker1.Add(outerBoundStart);
 					pipeMaker1.Add(outerBoundEnd);
+					XBIM_THROW_IF_CANCELLED();
 					pipeMaker1.Build();
 					if (pipeMaker1.IsDone())
 					{
@@ -780,6 +815,7 @@ namespace Xbim
 							pipeMaker2.SetTransitionMode(BRepBuilderAPI_Transformed);
 							pipeMaker2.Add(innerBoundStart);
 							pipeMaker2.Add(innerBoundEnd);
+							XBIM_THROW_IF_CANCELLED();
 							pipeMaker2.Build();
 							if (pipeMaker2.IsDone())
 							{
@@ -872,6 +908,7 @@ namespace Xbim
 						pipeMaker.AddWire(innerBoundStart);
 						pipeMaker.AddWire(innerBoundEnd);
 					}
+					XBIM_THROW_IF_CANCELLED();
 					pipeMaker.Build();
 					if (pipeMaker.IsDone() && pipeMaker.Shape().ShapeType() == TopAbs_ShapeEnum::TopAbs_SOLID)
 					{
@@ -905,22 +942,8 @@ namespace Xbim
 			XbimGeometryCreator::LogWarning(logger, repItem, "Invalid tapered extrusion, depth must be >0 and faces must be correctly defined");
 		}
 
-		void XbimSolid::Init(IIfcFixedReferenceSweptAreaSolid^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
+		XbimWire^ XbimSolid::BuildFixedReferenceDirectrix(IIfcFixedReferenceSweptAreaSolid^ repItem, ILogger^ logger)
 		{
-			BRepPrim_Builder b;
-			TopoDS_Shell shell;
-			b.MakeShell(shell);
-			XbimFace^ faceStart;
-			if (overrideProfileDef == nullptr)
-				faceStart = gcnew XbimFace(repItem->SweptArea, logger);
-			else
-				faceStart = gcnew XbimFace(overrideProfileDef, logger);
-			if (!faceStart->IsValid)
-			{
-				XbimGeometryCreator::LogWarning(logger, repItem, "Could not build swept area");
-				return;
-			}
-
 			IModelFactors^ mf = repItem->Model->ModelFactors;
 			XbimWire^ sweep = gcnew XbimWire(repItem->Directrix, logger, XbimConstraints::None);
 
@@ -944,7 +967,35 @@ namespace Xbim
 				else if (!repItem->StartParam.HasValue && repItem->EndParam.HasValue)
 					sweep = (XbimWire^)sweep->Trim(0, repItem->EndParam.Value, mf->Precision, logger);
 			}
-			if (!sweep->IsValid)
+			return sweep;
+		}
+
+		void XbimSolid::Init(IIfcFixedReferenceSweptAreaSolid^ repItem, IIfcProfileDef^ overrideProfileDef, ILogger^ logger)
+		{
+			BRepPrim_Builder b;
+			TopoDS_Shell shell;
+			b.MakeShell(shell);
+			XbimFace^ faceStart;
+			if (overrideProfileDef == nullptr)
+				faceStart = gcnew XbimFace(repItem->SweptArea, logger);
+			else
+				faceStart = gcnew XbimFace(overrideProfileDef, logger);
+			if (!faceStart->IsValid)
+			{
+				XbimGeometryCreator::LogWarning(logger, repItem, "Could not build swept area");
+				return;
+			}
+
+			XbimWire^ sweep;
+			bool useCache = XbimGeometryCreator::UseCurveCache;
+			if (!useCache || !XbimCurveCache::TryGet(repItem->Directrix, XbimCurveCache::FixedReferenceDirectrix, repItem->StartParam, repItem->EndParam, sweep))
+			{
+				Int64 started = System::Diagnostics::Stopwatch::GetTimestamp();
+				sweep = BuildFixedReferenceDirectrix(repItem, logger);
+				if (useCache)
+					XbimCurveCache::Add(repItem->Directrix, XbimCurveCache::FixedReferenceDirectrix, repItem->StartParam, repItem->EndParam, sweep, System::Diagnostics::Stopwatch::GetTimestamp() - started);
+			}
+			if (sweep == nullptr || !sweep->IsValid)
 			{
 				XbimGeometryCreator::LogWarning(logger, repItem, "Could not build directrix");
 				return;
@@ -977,6 +1028,7 @@ namespace Xbim
 				//pipeMaker1.SetMode(Standard_True);
 				pipeMaker1.SetTransitionMode(BRepBuilderAPI_Transformed);
 				pipeMaker1.Add(outerBound);
+				XBIM_THROW_IF_CANCELLED();
 				pipeMaker1.Build();
 				if (pipeMaker1.IsDone())
 				{
@@ -994,6 +1046,7 @@ namespace Xbim
 						//pipeMaker2.SetMode(Standard_True);
 						pipeMaker2.SetTransitionMode(BRepBuilderAPI_Transformed);
 						pipeMaker2.Add(innerBoundStart);
+						XBIM_THROW_IF_CANCELLED();
 						pipeMaker2.Build();
 						if (pipeMaker2.IsDone())
 						{
@@ -1080,6 +1133,7 @@ namespace Xbim
 				bool ok = false;
 				try
 				{
+					XBIM_THROW_IF_CANCELLED();
 					pipeMaker1.Build();
 					ok = true;
 				}
@@ -1114,6 +1168,7 @@ namespace Xbim
 						ok = false;
 						try
 						{
+							XBIM_THROW_IF_CANCELLED();
 							pipeMaker2.Build();
 							ok = true;
 						}
@@ -1557,6 +1612,7 @@ namespace Xbim
 				oSweepMaker.SetTransitionMode(transitionMode);
 				oSweepMaker.Add(outerWire);
 
+				XBIM_THROW_IF_CANCELLED();
 				oSweepMaker.Build();
 				if (oSweepMaker.IsDone())
 				{
@@ -1571,6 +1627,7 @@ namespace Xbim
 						iSweepMaker.SetTransitionMode(transitionMode);
 						TopoDS_Shape holeWire = iWireMaker.Wire().Reversed();
 						iSweepMaker.Add(holeWire);
+						XBIM_THROW_IF_CANCELLED();
 						iSweepMaker.Build();
 						if (iSweepMaker.IsDone())
 						{
@@ -1641,6 +1698,19 @@ namespace Xbim
 			//   for each arc add the angle
 			//
 		XbimWire^ XbimSolid::CreateDirectrix(IIfcCurve^ directrix, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, Microsoft::Extensions::Logging::ILogger^ logger)
+		{
+			XbimWire^ wire;
+			bool useCache = XbimGeometryCreator::UseCurveCache;
+			if (useCache && XbimCurveCache::TryGet(directrix, XbimCurveCache::Directrix, startParam, endParam, wire))
+				return wire;
+			Int64 started = System::Diagnostics::Stopwatch::GetTimestamp();
+			wire = BuildDirectrix(directrix, startParam, endParam, logger);
+			if (useCache)
+				XbimCurveCache::Add(directrix, XbimCurveCache::Directrix, startParam, endParam, wire, System::Diagnostics::Stopwatch::GetTimestamp() - started);
+			return wire;
+		}
+
+		XbimWire^ XbimSolid::BuildDirectrix(IIfcCurve^ directrix, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, Microsoft::Extensions::Logging::ILogger^ logger)
 		{
 			XbimWire^ wire = gcnew XbimWire(directrix, logger, XbimConstraints::None);
 
@@ -49,7 +49,10 @@ namespace Xbim
 
 			void Init(IIfcSweptDiskSolid^ solid, ILogger^ logger);
 			String^ BuildSweptDiskSolid(const TopoDS_Wire& directrixWire, double radius, double innerRadius, BRepBuilderAPI_TransitionMode transitionMode);
+			//the directrix comes from the curve cache if the same curve was built with the same trims before
 			XbimWire^ CreateDirectrix(IIfcCurve^ directrix, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, ILogger^ logger);
+			XbimWire^ BuildDirectrix(IIfcCurve^ directrix, Nullable<IfcParameterValue> startParam, Nullable<IfcParameterValue> endParam, ILogger^ logger);
+			XbimWire^ BuildFixedReferenceDirectrix(IIfcFixedReferenceSweptAreaSolid^ repItem, ILogger^ logger);
 			// this is case handled by IIfcSweptDiskSolid 
 			// void Init(IIfcSweptDiskSolidPolygonal^ solid, ILogger^ logger);
 			void Init(IIfcBoundingBox^ solid, ILogger^ logger);
@@ -119,6 +122,7 @@ namespace Xbim
 
 #pragma region constructors
 			XbimSolid() {};
+			//wraps an existing solid, often a temporary member of a set or compound, so it does not report memory pressure
 			XbimSolid(const TopoDS_Solid& solid);
 			XbimSolid(const TopoDS_Solid& solid, Object^ tag);
 			XbimSolid(IIfcSolidModel^ solid, ILogger^ logger);
@@ -0,0 +1,111 @@
+#include "XbimSolidBatch.h"
+#include "XbimCancellation.h"
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepPrimAPI_MakePrism.hxx>
+#include <Geom_Line.hxx>
+#include <Geom_Plane.hxx>
+#include <Geom_TrimmedCurve.hxx>
+#include <OSD_Parallel.hxx>
+#include <ShapeFix_ShapeTolerance.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace
+{
+	class PrismFunctor
+	{
+	public:
+		PrismFunctor(XbimSolidBatch::Extrusion* extrusions, double linearDeflection, double angularDeflection, XbimCancellationContext* context) :
+			extrusions(extrusions), linearDeflection(linearDeflection), angularDeflection(angularDeflection), context(context) {}
+
+		void operator()(int index) const
+		{
+			//the context belongs to the calling thread, its flag and deadline may be read from any thread while it is entered
+			if (context != nullptr && (context->IsCancelled() || context->IsExpired()))
+				return;
+			XbimSolidBatch::Extrusion& extrusion = extrusions[index];
+			try
+			{
+				//each prism is made from its own copy of the profile, extrusions that share a profile share its edges
+				BRepPrimAPI_MakePrism prism(extrusion.profile, extrusion.direction, Standard_True);
+				if (!prism.IsDone())
+					return;
+				TopoDS_Solid solid = TopoDS::Solid(prism.Shape());
+				if (!extrusion.location.IsIdentity())
+					solid.Move(extrusion.location);
+				ShapeFix_ShapeTolerance tolFixer;
+				tolFixer.LimitTolerance(solid, extrusion.precision);
+				if (linearDeflection > 0)
+					XbimSolidBatch::MeshCurvedFaces(solid, linearDeflection, angularDeflection);
+				extrusion.solid = solid;
+			}
+			catch (const Standard_Failure&)
+			{
+				extrusion.solid.Nullify();
+			}
+		}
+
+	private:
+		XbimSolidBatch::Extrusion* extrusions;
+		double linearDeflection;
+		double angularDeflection;
+		XbimCancellationContext* context;
+	};
+}
+
+bool XbimSolidBatch::IsCurved(const TopoDS_Face& face)
+{
+	if (Handle(Geom_Plane)::DownCast(BRep_Tool::Surface(face)).IsNull())
+		return true;
+	for (TopExp_Explorer edgeExplorer(face, TopAbs_EDGE); edgeExplorer.More(); edgeExplorer.Next())
+	{
+		Standard_Real start, end;
+		Handle(Geom_Curve) c3d = BRep_Tool::Curve(TopoDS::Edge(edgeExplorer.Current()), start, end);
+		if (c3d.IsNull())
+			continue;
+		Handle(Geom_TrimmedCurve) tc = Handle(Geom_TrimmedCurve)::DownCast(c3d);
+		while (!tc.IsNull())
+		{
+			c3d = tc->BasisCurve();
+			tc = Handle(Geom_TrimmedCurve)::DownCast(c3d);
+		}
+		if (c3d->DynamicType() != STANDARD_TYPE(Geom_Line))
+			return true;
+	}
+	return false;
+}
+
+void XbimSolidBatch::MeshCurvedFaces(const TopoDS_Shape& shape, double linearDeflection, double angularDeflection)
+{
+	BRep_Builder builder;
+	TopoDS_Compound curvedFaces;
+	builder.MakeCompound(curvedFaces);
+	bool hasCurvedFaces = false;
+	for (TopExp_Explorer faceExplorer(shape, TopAbs_FACE); faceExplorer.More(); faceExplorer.Next())
+	{
+		const TopoDS_Face& face = TopoDS::Face(faceExplorer.Current());
+		if (IsCurved(face))
+		{
+			builder.Add(curvedFaces, face);
+			hasCurvedFaces = true;
+		}
+	}
+	if (hasCurvedFaces)
+		BRepMesh_IncrementalMesh incrementalMesh(curvedFaces, linearDeflection, Standard_False, angularDeflection);
+}
+
+int XbimSolidBatch::MakePrisms(Extrusion* extrusions, int count, double linearDeflection, double angularDeflection, bool runParallel)
+{
+	if (count <= 0)
+		return 0;
+	PrismFunctor functor(extrusions, linearDeflection, angularDeflection, XbimCancellation::Current());
+	OSD_Parallel::For(0, count, functor, !runParallel || count < 2);
+	int made = 0;
+	for (int i = 0; i < count; i++)
+		if (!extrusions[i].solid.IsNull())
+			made++;
+	return made;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <gp_Vec.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Solid.hxx>
+
+//The native part of XbimGeometryCreator::CreateSolids. The profiles and placements of the extrusions are read through the model
+//first, on the calling thread, then every prism is made, placed, has its tolerances limited and its curved faces meshed on OCC's
+//thread pool, which only needs the native shapes. The header is included by /clr code, the implementation is compiled natively
+class XbimSolidBatch
+{
+public:
+	struct Extrusion
+	{
+		TopoDS_Face profile;
+		gp_Vec direction;
+		TopLoc_Location location;
+		double precision;
+		//null if the prism could not be made
+		TopoDS_Solid solid;
+	};
+
+	//makes the solid of each extrusion as XbimSolid::Init would. If linearDeflection > 0 the faces WriteTriangulation would give to
+	//BRepMesh are meshed as well, so writing the shape geometry finds them done. Stops if the cancellation context of the calling
+	//thread is cancelled or expires, the solids not made are left null. Returns the number of solids made
+	static int MakePrisms(Extrusion* extrusions, int count, double linearDeflection, double angularDeflection, bool runParallel);
+	//true unless the face is a plane bounded by lines, the test WriteTriangulation makes before it calls BRepMesh
+	static bool IsCurved(const TopoDS_Face& face);
+	//meshes the faces of the shape that WriteTriangulation gives to BRepMesh, all but the planes bounded by lines
+	static void MeshCurvedFaces(const TopoDS_Shape& shape, double linearDeflection, double angularDeflection);
+};
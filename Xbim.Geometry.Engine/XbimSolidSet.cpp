@@ -4,6 +4,10 @@
 #include "XbimGeometryCreator.h"
 #include "XbimOccWriter.h"
 #include "XbimProgressMonitor.h"
+#include "XbimTraceRecorder.h"
+#include "XbimNativeLog.h"
+#include "XbimGeometrySession.h"
+#include "XbimShapeBounds.h"
 #include <TopTools_IndexedMapOfShape.hxx>
 #include <TopExp.hxx>
 #include <BRepTools.hxx>
@@ -316,6 +320,61 @@ namespace Xbim
 			return vol;
 		}
 
+		TopoDS_Compound XbimSolidSet::BoundsShape(int% stamp)
+		{
+			TopoDS_Compound compound;
+			BRep_Builder builder;
+			builder.MakeCompound(compound);
+			unsigned int hash = 17;
+			for each (IXbimSolid ^ solid in solids)
+			{
+				XbimSolid^ occSolid = dynamic_cast<XbimSolid^>(solid);
+				if (occSolid == nullptr || !occSolid->IsValid) continue;
+				const TopoDS_Shape& shape = occSolid;
+				builder.Add(compound, shape);
+				hash = hash * 31 + (unsigned int)XbimShapeBounds::Stamp(shape);
+			}
+			stamp = (int)hash;
+			return compound;
+		}
+
+		array<double>^ XbimSolidSet::OrientedBox()
+		{
+			if (!IsValid) return nullptr;
+			if (bounds == nullptr) bounds = gcnew XbimShapeBounds();
+			int stamp;
+			TopoDS_Compound compound = BoundsShape(stamp);
+			return bounds->OrientedBox(compound, stamp);
+		}
+
+		XbimShapeGeometry^ XbimSolidSet::ConvexHull(double deflection, double angle)
+		{
+			if (!IsValid) return nullptr;
+			if (bounds == nullptr) bounds = gcnew XbimShapeBounds();
+			int stamp;
+			TopoDS_Compound compound = BoundsShape(stamp);
+			return bounds->ConvexHull(compound, stamp, deflection, angle);
+		}
+
+		const XbimShapeTree* XbimSolidSet::ShapeTree(double deflection, double angle)
+		{
+			if (!IsValid) return nullptr;
+			if (bounds == nullptr) bounds = gcnew XbimShapeBounds();
+			int stamp;
+			TopoDS_Compound compound = BoundsShape(stamp);
+			return bounds->Tree(compound, stamp, deflection, angle);
+		}
+
+		bool XbimSolidSet::Equals(IXbimGeometryObject^ geometryObject, double tolerance)
+		{
+			return XbimGeometryCreator::GeometricallyEquals(this, geometryObject, tolerance, 0, 0.5);
+		}
+
+		bool XbimSolidSet::Intersects(IXbimGeometryObject^ geometryObject, double tolerance)
+		{
+			return XbimGeometryCreator::Intersects(this, geometryObject, tolerance, 0, 0.5);
+		}
+
 		IXbimGeometryObject^ XbimSolidSet::Transform(XbimMatrix3D matrix3D)
 		{
 			if (!IsValid) return gcnew XbimSolidSet();
@@ -486,7 +545,8 @@ namespace Xbim
 				aBOP.AddArgument(body);
 				aBOP.SetTools(shapeTools);
 				aBOP.SetOperation(op);
-				aBOP.SetRunParallel(false);
+				//the scheduler lets the largest products spread the intersection of their tools over the idle cores
+				aBOP.SetRunParallel(XbimCancellation::RunParallel());
 				//aBOP.SetCheckInverted(true);
 				aBOP.SetNonDestructive(true);
 				aBOP.SetFuzzyValue(fuzzyTol);
@@ -496,7 +556,10 @@ namespace Xbim
 				TopoDS_Shape aR;
 
 
-				aBOP.Perform();
+				{
+					XBIM_TRACE_SCOPE("BOPAlgo_BOP");
+					aBOP.Perform();
+				}
 				aR = aBOP.Shape();
 
 				if (pi->TimedOut())
@@ -504,6 +567,8 @@ namespace Xbim
 					return BOOLEAN_TIMEDOUT;
 
 				}
+				if (pi->Cancelled())
+					return BOOLEAN_CANCELLED;
 				bool bopErr = aBOP.HasErrors();
 #ifdef _DEBUG
 
@@ -518,6 +583,7 @@ namespace Xbim
 #endif // DEBUG
 				if (bopErr) // a sign of failure do them individually
 				{
+					XBIM_NATIVE_WARNING("Boolean operation reported errors, the tools are applied one at a time");
 
 					//check if the shape is empty
 
@@ -534,6 +600,10 @@ namespace Xbim
 							toCut.Append(itl.Value());
 							TopoDS_Shape cutResult;
 							int success = DoBoolean(cutBody, toCut, op, tolerance, fuzzyFactor, cutResult, timeout);
+							if (success == BOOLEAN_CANCELLED)
+								return BOOLEAN_CANCELLED;
+							if (XbimCancellation::Cancelled()) //the deadline of the product has passed, do not try the remaining tools
+								return BOOLEAN_TIMEDOUT;
 							if (success > 0)
 							{
 								cutBody = cutResult;
@@ -554,6 +624,7 @@ namespace Xbim
 				//have one go at fixing if it is not right
 				if (BRepCheck_Analyzer(aR, Standard_True).IsValid() == Standard_False)
 				{
+					XBIM_NATIVE_WARNING("Boolean result is not a valid shape and has been fixed");
 					//try and fix if we can
 					ShapeFix_Shape fixer(aR);
 					fixer.SetMaxTolerance(tolerance);
@@ -594,12 +665,14 @@ namespace Xbim
 				try
 				{
 					//sometimes unifier crashes
+					XBIM_TRACE_SCOPE("UnifySameDomain");
 					unifier.Build();
 					result =unifier.Shape();
 				}
 				catch (...) //any failure
 				{
 					//default to what we had					
+					XBIM_NATIVE_WARNING("Faces of the boolean result could not be unified");
 				}
 				return retVal;
 			}
@@ -609,6 +682,7 @@ namespace Xbim
 			}
 			catch (Standard_Failure sf)
 			{
+				XBIM_NATIVE_WARNING("Boolean operation raised an OCC exception");
 				return BOOLEAN_FAIL;
 			}
 			catch (...)
@@ -625,6 +699,8 @@ namespace Xbim
 
 
 			XbimSolidSet^ solidResults = gcnew XbimSolidSet();
+			//the solids carry no entity, the messages are logged against the product whose session is open
+			Object^ entity = XbimGeometrySession::CurrentEntity;
 			for (int i = 0; i < this->Count; i++)
 			{
 				TopTools_ListOfShape tools;
@@ -643,6 +719,7 @@ namespace Xbim
 				{
 					success = BOOLEAN_FAIL;
 				}
+				XbimGeometryCreator::ReportNativeLog(logger, entity);
 
 				if (success > 0)
 				{
@@ -662,6 +739,9 @@ namespace Xbim
 				case BOOLEAN_TIMEDOUT:
 					msg = "Boolean operation timed out. No result whas been generated";
 					break;
+				case BOOLEAN_CANCELLED:
+					msg = "Boolean operation was cancelled. No result has been generated";
+					break;
 				case BOOLEAN_FAIL:
 					msg = "Boolean result could not be computed. Error undetermined";
 					break;
@@ -669,7 +749,7 @@ namespace Xbim
 					break;
 				}
 				if (!String::IsNullOrWhiteSpace(msg))
-					XbimGeometryCreator::LogWarning(logger, nullptr, msg);
+					XbimGeometryCreator::LogWarning(logger, entity, msg);
 				if (success <= 0)
 					throw gcnew XbimGeometryException(msg);
 
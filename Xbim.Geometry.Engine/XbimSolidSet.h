@@ -18,6 +18,7 @@ namespace Xbim
 		const int BOOLEAN_SUCCESS = 1; //first attempt with all  tools worked
 		const int BOOLEAN_FAIL = 0;
 		const int BOOLEAN_TIMEDOUT = -1;
+		const int BOOLEAN_CANCELLED = -2;
 		
 	
 	    int DoBoolean(const TopoDS_Shape& body, const TopTools_ListOfShape& tools, BOPAlgo_Operation op, double tolerance, double fuzzTolerance, TopoDS_Shape& result, int timeout);
@@ -57,9 +58,14 @@ namespace Xbim
 			static double _maxOpeningVolumePercentage = 0.0002;
 			bool _isSimplified = false;
 			int _ifcEntityLabel = 0;
+			XbimShapeBounds^ bounds;
+			//the valid solids as one compound and a stamp over the shapes of all of them
+			TopoDS_Compound BoundsShape(int% stamp);
 			void InstanceCleanup()
 			{
 				solids = nullptr;
+				delete bounds;
+				bounds = nullptr;
 			};
 		    IXbimSolidSet^ DoBoolean(IXbimSolidSet^ arguments, BOPAlgo_Operation operation, double tolerance, ILogger^ logger);
 			
@@ -137,6 +143,13 @@ namespace Xbim
 			virtual IXbimSolidSet^ Range(int start, int count);
 			//moves the solid set to the new position
 			void Move(IIfcAxis2Placement3D^ position);
+			//the oriented box and convex hull of all the solids, see XbimOccShape
+			array<double>^ OrientedBox();
+			XbimShapeGeometry^ ConvexHull(double deflection, double angle);
+			const XbimShapeTree* ShapeTree(double deflection, double angle);
+			//geometric comparison and clash test of all the solids, see XbimGeometryCreator
+			bool Equals(IXbimGeometryObject^ geometryObject, double tolerance);
+			bool Intersects(IXbimGeometryObject^ geometryObject, double tolerance);
 			
 
 			// Inherited via XbimSetObject
@@ -0,0 +1,224 @@
+#include "XbimTraceRecorder.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+volatile bool XbimTraceRecorder::enabled = false;
+
+namespace
+{
+	struct Span
+	{
+		const char* name;
+		long long begin;
+		long long end;
+	};
+
+	struct OpenSpan
+	{
+		const char* name;
+		long long begin;
+	};
+
+	//written only by its own thread, read by Write once recording has stopped
+	struct ThreadBuffer
+	{
+		unsigned long threadId;
+		int generation;
+		std::vector<Span> spans;
+		std::atomic<size_t> written;
+		std::vector<OpenSpan> open;
+		//the thread has ended, the buffer is kept until its spans are cleared
+		bool exited;
+		ThreadBuffer() : threadId(0), generation(-1), written(0), exited(false) {}
+	};
+
+	std::mutex registryLock;
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+	std::set<std::string> names;
+	std::atomic<int> generation(0);
+	int spansPerThread = 1 << 16;
+	long long startTicks = 0;
+
+	//frees the buffers of threads that have ended, registryLock must be held
+	void ReclaimExited()
+	{
+		buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const std::unique_ptr<ThreadBuffer>& buffer) { return buffer->exited; }), buffers.end());
+	}
+
+	//hands the buffer of a thread back when the thread ends, the spans of the current recording are kept for Write
+	struct ThreadSlot
+	{
+		ThreadBuffer* buffer = nullptr;
+		~ThreadSlot()
+		{
+			if (buffer == nullptr) return;
+			std::lock_guard<std::mutex> lock(registryLock);
+			buffer->exited = true;
+			if (buffer->generation != generation.load(std::memory_order_acquire) || buffer->written.load(std::memory_order_acquire) == 0)
+				ReclaimExited();
+		}
+	};
+	thread_local ThreadSlot threadSlot;
+
+	double TicksPerMicrosecond()
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return frequency.QuadPart / 1e6;
+	}
+
+	//the buffer of the calling thread, reset if recording has been restarted since it was last used
+	ThreadBuffer* CurrentBuffer()
+	{
+		ThreadBuffer* buffer = threadSlot.buffer;
+		if (buffer == nullptr)
+		{
+			std::unique_ptr<ThreadBuffer> created(new ThreadBuffer());
+			created->threadId = GetCurrentThreadId();
+			buffer = created.get();
+			std::lock_guard<std::mutex> lock(registryLock);
+			buffers.push_back(std::move(created));
+			threadSlot.buffer = buffer;
+		}
+		int current = generation.load(std::memory_order_acquire);
+		if (buffer->generation != current)
+		{
+			buffer->spans.assign(spansPerThread, Span());
+			buffer->written.store(0, std::memory_order_relaxed);
+			buffer->open.clear();
+			buffer->generation = current;
+		}
+		return buffer;
+	}
+
+	void WriteEscaped(FILE* file, const char* text)
+	{
+		for (const char* c = text; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				fputc('\\', file);
+			if ((unsigned char)*c < 0x20)
+				fputc(' ', file);
+			else
+				fputc(*c, file);
+		}
+	}
+}
+
+void XbimTraceRecorder::Start(int spansPerThreadRequested)
+{
+	enabled = false;
+	{
+		std::lock_guard<std::mutex> lock(registryLock);
+		spansPerThread = spansPerThreadRequested > 0 ? spansPerThreadRequested : 1 << 16;
+		startTicks = Now();
+		ReclaimExited();
+	}
+	generation.fetch_add(1, std::memory_order_release);
+	enabled = true;
+}
+
+void XbimTraceRecorder::Stop()
+{
+	enabled = false;
+}
+
+void XbimTraceRecorder::Clear()
+{
+	std::lock_guard<std::mutex> lock(registryLock);
+	ReclaimExited();
+	generation.fetch_add(1, std::memory_order_release);
+}
+
+int XbimTraceRecorder::SpanCount()
+{
+	std::lock_guard<std::mutex> lock(registryLock);
+	int current = generation.load(std::memory_order_acquire);
+	size_t count = 0;
+	for (auto& buffer : buffers)
+	{
+		if (buffer->generation != current) continue;
+		size_t written = buffer->written.load(std::memory_order_acquire);
+		count += written < buffer->spans.size() ? written : buffer->spans.size();
+	}
+	return (int)count;
+}
+
+long long XbimTraceRecorder::Now()
+{
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return ticks.QuadPart;
+}
+
+void XbimTraceRecorder::Record(const char* name, long long begin, long long end)
+{
+	if (!enabled) return;
+	ThreadBuffer* buffer = CurrentBuffer();
+	size_t written = buffer->written.load(std::memory_order_relaxed);
+	Span& span = buffer->spans[written % buffer->spans.size()];
+	span.name = name;
+	span.begin = begin;
+	span.end = end;
+	buffer->written.store(written + 1, std::memory_order_release);
+}
+
+void XbimTraceRecorder::Begin(const char* name)
+{
+	ThreadBuffer* buffer = CurrentBuffer();
+	buffer->open.push_back({ name, Now() });
+}
+
+void XbimTraceRecorder::End()
+{
+	ThreadBuffer* buffer = CurrentBuffer();
+	if (buffer->open.empty()) return; //recording was started inside the span
+	OpenSpan span = buffer->open.back();
+	buffer->open.pop_back();
+	Record(span.name, span.begin, Now());
+}
+
+const char* XbimTraceRecorder::RegisterName(const char* name)
+{
+	std::lock_guard<std::mutex> lock(registryLock);
+	return names.insert(name == nullptr ? "" : name).first->c_str();
+}
+
+bool XbimTraceRecorder::Write(const wchar_t* fileName)
+{
+	FILE* file = nullptr;
+	if (_wfopen_s(&file, fileName, L"w") != 0 || file == nullptr)
+		return false;
+	double ticksPerMicrosecond = TicksPerMicrosecond();
+	unsigned long processId = GetCurrentProcessId();
+	std::lock_guard<std::mutex> lock(registryLock);
+	int current = generation.load(std::memory_order_acquire);
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%lu,\"tid\":0,\"args\":{\"name\":\"Xbim Geometry\"}}", processId);
+	for (auto& buffer : buffers)
+	{
+		if (buffer->generation != current) continue;
+		size_t written = buffer->written.load(std::memory_order_acquire);
+		size_t capacity = buffer->spans.size();
+		size_t first = written > capacity ? written - capacity : 0;
+		for (size_t i = first; i < written; i++)
+		{
+			const Span& span = buffer->spans[i % capacity];
+			fprintf(file, ",\n{\"name\":\"");
+			WriteEscaped(file, span.name == nullptr ? "" : span.name);
+			fprintf(file, "\",\"ph\":\"X\",\"pid\":%lu,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+				processId, buffer->threadId, (span.begin - startTicks) / ticksPerMicrosecond, (span.end - span.begin) / ticksPerMicrosecond);
+		}
+	}
+	fprintf(file, "\n]}\n");
+	bool ok = ferror(file) == 0;
+	fclose(file);
+	return ok;
+}
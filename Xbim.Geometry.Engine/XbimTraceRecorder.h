@@ -0,0 +1,53 @@
+#pragma once
+
+//Records timed spans of the geometry pipeline into a ring buffer per thread and writes them as a Chrome trace event file
+//that can be opened in chrome://tracing or Perfetto. Recording is off by default, when off a span costs a single flag test.
+//The header is included by /clr code so it must not pull in <atomic>, <mutex> or <thread>, the implementation is compiled natively
+class XbimTraceRecorder
+{
+public:
+	//span names are held by pointer and must outlive the recording, use string literals or names returned by RegisterName
+	static volatile bool enabled;
+
+	//clears any previous spans and starts recording, each thread keeps the last spansPerThread spans. The buffer of a thread that has
+	//exited is freed when its spans are cleared, by Start or Clear, or at once if it holds none
+	static void Start(int spansPerThread);
+	static void Stop();
+	static void Clear();
+	static int SpanCount();
+
+	//QueryPerformanceCounter ticks
+	static long long Now();
+	static void Record(const char* name, long long begin, long long end);
+	//opens and closes a span on the calling thread, spans must be closed on the thread that opened them in reverse order
+	static void Begin(const char* name);
+	static void End();
+	//returns a copy of the name that lives until the process ends, the same pointer is returned for equal names
+	static const char* RegisterName(const char* name);
+
+	//writes all recorded spans as trace event JSON, recording should be stopped first. Returns false if the file cannot be written
+	static bool Write(const wchar_t* fileName);
+};
+
+//records the lifetime of the scope as a span
+class XbimTraceScope
+{
+private:
+	const char* name;
+	long long begin;
+public:
+	XbimTraceScope(const char* spanName) : name(spanName), begin(0)
+	{
+		if (XbimTraceRecorder::enabled) begin = XbimTraceRecorder::Now();
+	}
+	~XbimTraceScope()
+	{
+		if (begin != 0) XbimTraceRecorder::Record(name, begin, XbimTraceRecorder::Now());
+	}
+};
+
+#define XBIM_TRACE_CONCAT_IMPL(a, b) a##b
+#define XBIM_TRACE_CONCAT(a, b) XBIM_TRACE_CONCAT_IMPL(a, b)
+#define XBIM_TRACE_SCOPE(name) XbimTraceScope XBIM_TRACE_CONCAT(xbimTraceScope, __LINE__)(name)
+#define XBIM_TRACE_BEGIN(name) do { if (XbimTraceRecorder::enabled) XbimTraceRecorder::Begin(name); } while (0)
+#define XBIM_TRACE_END() do { if (XbimTraceRecorder::enabled) XbimTraceRecorder::End(); } while (0)
@@ -16,6 +16,7 @@ namespace Xbim
 			IntPtr temp = System::Threading::Interlocked::Exchange(ptrContainer, IntPtr::Zero);
 			if (temp != IntPtr::Zero)
 				delete (TopoDS_Vertex*)(temp.ToPointer());
+			ReleaseBounds();
 			System::GC::SuppressFinalize(this);
 		}
 
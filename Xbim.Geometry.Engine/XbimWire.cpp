@@ -6,6 +6,8 @@
 #include "XbimEdgeSet.h"
 #include "XbimVertexSet.h"
 #include "XbimCompound.h"
+#include "XbimEdgeChain.h"
+#include "XbimCoordinates.h"
 #include <BRepBuilderAPI_Transform.hxx>
 #include <BRepBuilderAPI_GTransform.hxx>
 #include <TopExp_Explorer.hxx>
@@ -64,7 +66,7 @@
 #include <GProp_GProps.hxx>
 #include <GC_MakeSegment.hxx>
 #include <ShapeAnalysis_Wire.hxx>
-#include <msclr\lock.h>
+#include "XbimTraceRecorder.h"
 #include <ShapeAnalysis_WireOrder.hxx>
 #include <GProp_PGProps.hxx>
 #include <ShapeFix_Edge.hxx>
@@ -90,6 +92,7 @@ namespace Xbim
 			IntPtr temp = System::Threading::Interlocked::Exchange(ptrContainer, IntPtr::Zero);
 			if (temp != IntPtr::Zero)
 				delete (TopoDS_Wire*)(temp.ToPointer());
+			ReleaseBounds();
 			System::GC::SuppressFinalize(this);
 		}
 #pragma endregion
@@ -307,19 +310,18 @@ namespace Xbim
 			gp_Pnt wStart = cc.Value(cc.FirstParameter());
 			gp_Pnt wEnd = cc.Value(cc.LastParameter());
 
-			BRepOffsetAPI_MakeOffset offseter(spineFace);
 			Standard_Real offset = profile->Thickness / 2;
-			// Pyatkov 15.06.2017. (Artoymyp on Github)
-			// Somewhere in the BRepOffsetAPI_MakeOffset.Perform() a static variable is used:
-			// static BRepMAT2d_Explorer Exp;
-			// That is why calls to this function in a multi-threaded mode 
-			// lead to an unpredictable behavior.
-			// SRL it was probably the xbimwire going out of scope and causing a memory access violation, I am leaving the lock code in at present just in case
-			{
-				msclr::lock l(_makeOffsetLock);
+			// Perform adds pcurves to the edges of the face it is given, so it works on a private copy in case the curves of the wire
+			// are shared with another call. The explorer in BRepFill_OffsetWire::Init is local in our build of OCC, offsets run in parallel
+			BRepBuilderAPI_Copy copier(spineFace);
+			BRepOffsetAPI_MakeOffset offseter(TopoDS::Face(copier.Shape()));
+			{
+				XBIM_TRACE_SCOPE("MakeOffset");
 				offseter.Perform(offset);
-			} // local scope ends, destructor of lock is called (lock is released).
-
+			}
+			// the wrappers own the shapes the offset was built from, they must not be finalized before it is done
+			GC::KeepAlive(centreWire);
+			GC::KeepAlive(xFace);
 
 			bool done = offseter.IsDone();
 
@@ -409,8 +411,8 @@ namespace Xbim
 		// In this case the pline may or ma not be closed it may or may not lie on a surface, it may be self intersecting
 		void XbimWire::Init(IIfcPolyline^ pline, ILogger^ logger, XbimConstraints constraints)
 		{
-			List<IIfcCartesianPoint^>^ polygon = Enumerable::ToList(pline->Points);
-			int originalCount = polygon->Count;
+			array<double>^ polygon = XbimCoordinates::Points(pline->Points, logger, pline);
+			int originalCount = polygon->Length / 3;
 			double tolerance = pline->Model->ModelFactors->Precision;
 			if (originalCount < 2)
 			{
@@ -429,10 +431,7 @@ namespace Xbim
 				BRepBuilderAPI_MakeWire wireMaker;
 
 
-				for (int i = 0; i < originalCount; i++)
-				{
-					pointSeq.Append(XbimConvert::GetPoint3d(polygon[i]));
-				}
+				XbimCoordinates::Append(polygon, pointSeq);
 				bool close = (constraints & XbimConstraints::Closed) == XbimConstraints::Closed;
 				bool notSelfIntersecting = (constraints & XbimConstraints::NotSelfIntersecting) == XbimConstraints::NotSelfIntersecting;
 				bool isClosed = XbimFace::RemoveDuplicatePoints(pointSeq, close, tolerance);
@@ -525,48 +524,26 @@ namespace Xbim
 			double tolerance = polyCurve->Model->ModelFactors->Precision;
 			ShapeFix_ShapeTolerance tFixer;
 
-			IItemSet<IItemSet<Ifc4::MeasureResource::IfcLengthMeasure>^>^ coordList;
-			IIfcCartesianPointList3D^ points3D = dynamic_cast<IIfcCartesianPointList3D^>(polyCurve->Points);
-			IIfcCartesianPointList2D^ points2D = dynamic_cast<IIfcCartesianPointList2D^>(polyCurve->Points);
-			int dim;
-			if (points3D != nullptr)
-			{
-				coordList = points3D->CoordList;
-				dim = 3;
-			}
-			else if (points2D != nullptr)
-			{
-				coordList = points2D->CoordList;
-				dim = 2;
-			}
-			else
+			array<double>^ coords = XbimCoordinates::Points(polyCurve->Points, logger);
+			if (coords == nullptr)
 			{
 				XbimGeometryCreator::LogError(logger, polyCurve, "Unsupported type of Coordinate List");
 				return;
 			}
 
 			//get a index of all the points
-			int pointCount = coordList->Count;
+			int pointCount = coords->Length / 3;
+			if (pointCount == 0)
+			{
+				XbimGeometryCreator::LogWarning(logger, polyCurve, "IfcIndexedPolyCurve has no points. It has been ignored");
+				return;
+			}
 			TColgp_Array1OfPnt poles(1, pointCount);
-			int n = 1;
-			for each (IItemSet<Ifc4::MeasureResource::IfcLengthMeasure> ^ coll in coordList)
-			{
-				IEnumerator<Ifc4::MeasureResource::IfcLengthMeasure>^ enumer = coll->GetEnumerator();
-				enumer->MoveNext();
-				gp_Pnt p;
-				p.SetX((double)enumer->Current);
-				enumer->MoveNext();
-				p.SetY((double)enumer->Current);
-				if (dim == 3)
-				{
-					enumer->MoveNext();
-					p.SetZ((double)enumer->Current);
-
-				}
-				else
-					p.SetZ(0);
-				poles.SetValue(n, p);
-				n++;
+			{
+				pin_ptr<double> pinned = &coords[0];
+				const double* c = pinned;
+				for (int n = 1; n <= pointCount; n++, c += 3)
+					poles.SetValue(n, gp_Pnt(c[0], c[1], c[2]));
 			}
 
 			if (Enumerable::Any(polyCurve->Segments))
@@ -590,6 +567,11 @@ namespace Xbim
 						gp_Pnt start = poles.Value((int)indices[0]);
 						gp_Pnt mid = poles.Value((int)indices[1]);
 						gp_Pnt end = poles.Value((int)indices[2]);
+						if (XbimCoordinates::IsMissing(start) || XbimCoordinates::IsMissing(mid) || XbimCoordinates::IsMissing(end))
+						{
+							XbimGeometryCreator::LogWarning(logger, segment, "Arc segment refers to a point that has been ignored. It has been ignored");
+							continue;
+						}
 						GC_MakeCircle circleMaker(start, mid, end);
 						if (circleMaker.IsDone()) //it is a valid arc
 						{
@@ -683,7 +665,9 @@ namespace Xbim
 
 						for (Standard_Integer p = 1; p <= originalCount; p++)
 						{
-							pointSeq.Append(poles.Value((int)indices[p - 1]));
+							const gp_Pnt& pole = poles.Value((int)indices[p - 1]);
+							if (!XbimCoordinates::IsMissing(pole))
+								pointSeq.Append(pole);
 						}
 
 
@@ -770,7 +754,8 @@ namespace Xbim
 
 				for (Standard_Integer p = 1; p <= originalCount; p++)
 				{
-					pointSeq.Append(poles.Value(p));
+					if (!XbimCoordinates::IsMissing(poles.Value(p)))
+						pointSeq.Append(poles.Value(p));
 				}
 
 
@@ -1038,8 +1023,8 @@ namespace Xbim
 
 		void XbimWire::Init(IIfcPolyLoop^ polyloop, ILogger^ logger, XbimConstraints /*constraints*/)
 		{
-			List<IIfcCartesianPoint^>^ polygon = Enumerable::ToList(polyloop->Polygon);
-			int originalCount = polygon->Count;
+			array<double>^ polygon = XbimCoordinates::Points(polyloop->Polygon, logger, polyloop);
+			int originalCount = polygon->Length / 3;
 			double tolerance = polyloop->Model->ModelFactors->Precision;
 			if (originalCount < 3)
 			{
@@ -1049,10 +1034,7 @@ namespace Xbim
 
 			TColgp_SequenceOfPnt pointSeq;
 			BRepBuilderAPI_MakeWire wireMaker;
-			for (int i = 0; i < originalCount; i++)
-			{
-				pointSeq.Append(XbimConvert::GetPoint3d(polygon[i]));
-			}
+			XbimCoordinates::Append(polygon, pointSeq);
 
 			XbimFace::RemoveDuplicatePoints(pointSeq, true, tolerance); //must be closed
 
@@ -3023,21 +3005,11 @@ namespace Xbim
 			XbimPoint3DWithTolerance^ startOriginalPnt = gcnew XbimPoint3DWithTolerance(startOriginal->X, startOriginal->Y, startOriginal->Z, pline->Model->ModelFactors->Precision);
 			return startLookupPnt == startOriginalPnt;
 		}
-#pragma warning( push )
-#pragma warning( disable : 4701)
-		bool XbimWire::SortEdgesForWire(const NCollection_Vector<TopoDS_Edge>& oldedges, NCollection_Vector<TopoDS_Edge>& newedges, NCollection_Vector<TopoDS_Edge>& notTaken, double tol, bool* pClosed, double* pMaxGap)
+		bool XbimWire::SortEdgesForWire(const NCollection_Vector<TopoDS_Edge>& oldedges, NCollection_Vector<TopoDS_Edge>& newedges, NCollection_Vector<TopoDS_Edge>& notTaken, double tol, bool* pClosed, double* pMaxGap, bool linearScan)
 		{
-			int i, n, minID, id, id2;
-			NCollection_Vector<int> bTaken;
+			int i, n;
 			NCollection_Vector<gp_Pnt> pnts;
-			TopExp_Explorer ex;
-			std::vector<TopoDS_Edge> edges;
-			gp_Pnt pnt, endPnts[2];
-			bool bSucc;
-			double minDis, otherDis, minminDis;
-
 			TopoDS_Vertex v1, v2;
-			TopoDS_Edge degEdge;
 			notTaken.Clear();
 			newedges.Clear();
 			if (pMaxGap)
@@ -3046,75 +3018,37 @@ namespace Xbim
 			if (n == 0)
 				return false;
 
+			std::vector<double> coords(6 * n);
 			for (i = 0; i < n; ++i)
 			{
 				TopExp::Vertices(oldedges(i), v1, v2);
 				pnts.Append(BRep_Tool::Pnt(v1));
 				pnts.Append(BRep_Tool::Pnt(v2));
-				bTaken.Append(0);
-			}
-
-			endPnts[0] = pnts(0);
-			endPnts[1] = pnts(1);
-			bTaken(0) = 1;
-			edges.push_back(oldedges(0));
-
-			while (1)
-			{
-				bSucc = false;
-				minID = -1;
-				minminDis = DBL_MAX;
-				for (i = 0; i < n; ++i)
+				for (int j = 0; j < 2; ++j)
 				{
-					if (bTaken(i) != 0)
-						continue;
-					id = GetMatchTwoPntsPair(pnts(2 * i), pnts(2 * i + 1), endPnts[0], endPnts[1], minDis, otherDis);
-					if (minDis < minminDis)
-					{
-						id2 = id;
-						minID = i;
-						minminDis = minDis;
-					}
+					const gp_Pnt& p = pnts(2 * i + j);
+					coords[6 * i + 3 * j] = p.X();
+					coords[6 * i + 3 * j + 1] = p.Y();
+					coords[6 * i + 3 * j + 2] = p.Z();
 				}
-				if (minID != -1 && minminDis < tol)
-				{
-					bTaken(minID) = 1;
-					bSucc = true;
-					if (id2 == 0)
-					{
-						edges.insert(edges.begin(), oldedges(minID));
-						endPnts[0] = pnts(2 * minID + 1);
-					}
-					else if (id2 == 1)
-					{
-						edges.push_back(oldedges(minID));
-						endPnts[1] = pnts(2 * minID + 1);
-					}
-					else if (id2 == 2)
-					{
-						edges.insert(edges.begin(), oldedges(minID));
-						endPnts[0] = pnts(2 * minID);
-					}
-					else if (id2 == 3)
-					{
-						edges.push_back(oldedges(minID));
-						endPnts[1] = pnts(2 * minID);
-					}
-					if (pMaxGap)
-					{
-						if (*pMaxGap < minminDis)
-							*pMaxGap = minminDis;
-					}
-				}
-				if (!bSucc)
-					break;
 			}
 
-			if (edges.size() != (size_t)oldedges.Length())
+			//the edges are chained from edge 0 taking the nearest free end point at each step, found in a grid of the end points
+			std::vector<int> order(n);
+			int chainEnds[2];
+			double maxGap;
+			int chained = XbimEdgeChain::Build(coords.data(), n, tol, order.data(), chainEnds, &maxGap, linearScan);
+			if (pMaxGap)
+				*pMaxGap = maxGap;
+
+			if (chained != n)
 			{
+				std::vector<char> bTaken(n, 0);
+				for (i = 0; i < chained; ++i)
+					bTaken[order[i]] = 1;
 				for (int x = 0; x < n; x++)
 				{
-					if (bTaken(x) == 0)
+					if (bTaken[x] == 0)
 						notTaken.Append(oldedges(x));
 					else
 						newedges.Append(oldedges(x));
@@ -3122,14 +3056,14 @@ namespace Xbim
 				return false;
 			}
 
-			if (endPnts[1].Distance(endPnts[0]) < tol) //close
+			if (pnts(chainEnds[1]).Distance(pnts(chainEnds[0])) < tol) //close
 			{
 				if (pClosed)
 					*pClosed = true;
 				int startID = -1;
-				for (i = 0; i < (int)(edges.size()); ++i)
+				for (i = 0; i < n; ++i)
 				{
-					if (oldedges(0).IsSame(edges[i]))
+					if (oldedges(0).IsSame(oldedges(order[i])))
 					{
 						startID = i;
 						break;
@@ -3137,15 +3071,15 @@ namespace Xbim
 				}
 				if (startID == -1)
 				{
-					for (i = 0; i < (int)(edges.size()); ++i)
-						newedges.Append(edges[i]);
+					for (i = 0; i < n; ++i)
+						newedges.Append(oldedges(order[i]));
 				}
 				else
 				{
-					for (i = startID; i < (int)(edges.size()); ++i)
-						newedges.Append(edges[i]);
+					for (i = startID; i < n; ++i)
+						newedges.Append(oldedges(order[i]));
 					for (i = 0; i < startID; ++i)
-						newedges.Append(edges[i]);
+						newedges.Append(oldedges(order[i]));
 				}
 			}
 			else
@@ -3153,40 +3087,11 @@ namespace Xbim
 				if (pClosed)
 					*pClosed = false;
 
-				for (i = 0; i < (int)(edges.size()); ++i)
-					newedges.Append(edges[i]);
+				for (i = 0; i < n; ++i)
+					newedges.Append(oldedges(order[i]));
 			}
 
 			return true;
 		}
-
-#pragma warning( pop )
-
-
-		int XbimWire::GetMatchTwoPntsPair(const gp_Pnt& b1, const gp_Pnt& e1, const gp_Pnt& b2, const gp_Pnt& e2,
-			double& minDis, double& otherDis)
-		{
-			double distance[4];
-			int index = -1, i;
-
-			distance[0] = b1.SquareDistance(b2);
-			distance[1] = b1.SquareDistance(e2);
-			distance[2] = e1.SquareDistance(b2);
-			distance[3] = e1.SquareDistance(e2);
-			minDis = DBL_MAX;
-			for (i = 0; i < 4; ++i)
-			{
-				if (distance[i] < minDis)
-				{
-					minDis = distance[i];
-					index = i;
-				}
-			}
-			otherDis = distance[3 - index];
-
-			minDis = sqrt(minDis);
-			otherDis = sqrt(otherDis);
-			return index;
-		}
 	}
 }
\ No newline at end of file
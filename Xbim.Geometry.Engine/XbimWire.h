@@ -23,9 +23,6 @@ namespace Xbim
 		{
 		private:
 
-			// Lock for preventing a usage of BRepOffsetAPI_MakeOffset.Perform(...) in a multi-threaded mode.
-			static Object^ _makeOffsetLock = gcnew Object();
-
 			IntPtr ptrContainer;
 			virtual property TopoDS_Wire* pWire
 			{
@@ -73,12 +70,13 @@ namespace Xbim
 			//helpers
 			static void AddNewellPoint(const gp_Pnt& previous, const gp_Pnt& current, double & x, double & y, double & z);
 			bool AreEdgesC1(const TopoDS_Edge& e1, const TopoDS_Edge& e2, double precision, double angularTolerance);
-			bool SortEdgesForWire(const NCollection_Vector<TopoDS_Edge>& oldedges, NCollection_Vector<TopoDS_Edge>& newedges, NCollection_Vector<TopoDS_Edge>& notTaken, double tol, bool *pClosed, double* pMaxGap);
-			int  GetMatchTwoPntsPair(const gp_Pnt& b1, const gp_Pnt& e1, const gp_Pnt& b2, const gp_Pnt& e2, double& minDis, double& otherDis);
 			
 			
 		public:
 			static gp_Dir NormalDir(const TopoDS_Wire& wire);
+			//orders the edges end to end from the first one, edges that cannot be chained within tol go to notTaken and newedges keeps the rest in their old order
+			//linearScan matches the end points without the grid of XbimEdgeChain, the results are the same
+			static bool SortEdgesForWire(const NCollection_Vector<TopoDS_Edge>& oldedges, NCollection_Vector<TopoDS_Edge>& newedges, NCollection_Vector<TopoDS_Edge>& notTaken, double tol, bool *pClosed, double* pMaxGap, bool linearScan = false);
 #pragma region destructors
 
 			~XbimWire() { InstanceCleanup(); }
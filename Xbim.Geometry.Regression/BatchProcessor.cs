@@ -5,7 +5,9 @@ using System.Collections.Generic;
 using System.Diagnostics;
 using System.IO;
 using System.Linq;
+using System.Threading;
 using Xbim.Common;
+using Xbim.Common.Geometry;
 using Xbim.Geometry.Engine.Interop;
 using Xbim.Ifc;
 using Xbim.Ifc4.Interfaces;
@@ -35,12 +37,21 @@ namespace XbimRegression
         public void Run()
         {
             var resultsFile = Path.Combine(Params.TestFileRoot, string.Format("XbimRegression_{0:yyyyMMdd-hhmmss}.csv", DateTime.Now));
+            var slowestFile = Path.ChangeExtension(resultsFile, ".slowest.csv");
 
             var di = new DirectoryInfo(Params.TestFileRoot);
+            // compare the geometry duration of warning heavy files with and without /loglimit to measure the cost of logging every repeat
+            if (Params.LogRepeatLimit >= 0)
+                new XbimGeometryEngine().LogRepeatLimit = Params.LogRepeatLimit;
+            // compare the geometry duration of MEP files with /nocurvecache to measure the time the shared directrices save
+            if (Params.NoCurveCache)
+                new XbimGeometryEngine().UseCurveCache = false;
 
             using (var writer = new StreamWriter(resultsFile))
+            using (var slowestWriter = new StreamWriter(slowestFile))
             {
                 writer.WriteLine(ProcessResult.CsvHeader);
+                slowestWriter.WriteLine("IFC File, " + XbimGeometryTelemetryRecord.CsvHeader);
                 // ParallelOptions opts = new ParallelOptions() { MaxDegreeOfParallelism = 12 };
                 var toProcess = di.GetFiles("*.IFC", SearchOption.AllDirectories);
                 // Parallel.ForEach<FileInfo>(toProcess, opts, file =>
@@ -49,6 +60,7 @@ namespace XbimRegression
                     //set up a  log file for this file run                 
                     var logFile = Path.ChangeExtension(file.FullName, "log");
                     ProcessResult result;
+                    var telemetry = new XbimGeometryTelemetry();
                     using (var loggerFactory = new LoggerFactory())
                     {
                         XbimLogging.LoggerFactory = loggerFactory;
@@ -72,7 +84,7 @@ namespace XbimRegression
                         });
                         var logger = loggerFactory.CreateLogger<BatchProcessor>();
                         Console.WriteLine($"Processing {file}");
-                        result = ProcessFile(file.FullName, writer, logger);
+                        result = ProcessFile(file.FullName, writer, logger, telemetry);
 
                     }
                     XbimLogging.LoggerFactory = null; // uses a default loggerFactory
@@ -104,6 +116,14 @@ namespace XbimRegression
                     result.FileName = file.Name;
                     writer.WriteLine(result.ToCsv());
                     writer.Flush();
+                    foreach (var record in telemetry.Slowest(Params.SlowestEntities))
+                        slowestWriter.WriteLine($"\"{file.Name}\",{record.ToCsv()}");
+                    slowestWriter.Flush();
+                    if (Params.WriteTelemetry)
+                    {
+                        using (var telemetryWriter = new StreamWriter(BuildFileName(file.FullName, ".telemetry.json")))
+                            telemetry.WriteJson(telemetryWriter);
+                    }
                 }
 
                 writer.Close();
@@ -113,7 +133,7 @@ namespace XbimRegression
             Console.ReadLine();
         }
 
-        private ProcessResult ProcessFile(string ifcFile, StreamWriter writer, ILogger<BatchProcessor> logger)
+        private ProcessResult ProcessFile(string ifcFile, StreamWriter writer, ILogger<BatchProcessor> logger, XbimGeometryTelemetry telemetry)
         {
             RemoveFiles(ifcFile);
             // using (var eventTrace = LoggerFactory.CreateEventTrace())
@@ -131,9 +151,43 @@ namespace XbimRegression
                         if (_params.MaxThreads > 0)
                             context.MaxThreads = _params.MaxThreads;
                         // context.CustomMeshingBehaviour = CustomMeshingBehaviour;
-                        context.CreateContext();
+                        context.DeflectionPolicy = CreateDeflectionPolicy();
+                        context.Telemetry = telemetry;
+                        context.ProductTimeBudget = TimeSpan.FromSeconds(_params.ProductBudgetSeconds);
+                        context.GeometryCacheBudget = _params.CacheBudgetMegabytes * 1024 * 1024;
+                        context.BooleanScheduling = _params.BooleanScheduling == "operands" ? XbimBooleanScheduling.OperandCount : XbimBooleanScheduling.CostModel;
+                        if (_params.ShardWorkers > 1)
+                        {
+                            // this executable is also the worker, see Program
+                            context.ShardWorkers = _params.ShardWorkers;
+                            context.ShardWorkerPath = Process.GetCurrentProcess().MainModule.FileName;
+                            context.ShardWorkerArguments = new[] { Program.ShardWorkerMode };
+                            context.ShardSourceFile = ifcFile;
+                        }
+                        if (Params.WriteTrace)
+                            XbimGeometryTrace.Start();
+                        var geometryEngine = new XbimGeometryEngine();
+                        geometryEngine.ResetCurveCacheStatistics();
+                        // the geometry of a file that takes longer than the timeout is abandoned
+                        var timeout = _params.Timeout > 0 ? new CancellationTokenSource(_params.Timeout) : new CancellationTokenSource();
+                        try
+                        {
+                            context.CancellationToken = timeout.Token;
+                            context.CreateContext();
+                        }
+                        finally
+                        {
+                            timeout.Dispose();
+                            if (Params.WriteTrace)
+                            {
+                                XbimGeometryTrace.Stop();
+                                XbimGeometryTrace.Write(BuildFileName(ifcFile, ".trace.json"));
+                            }
+                        }
                         //}
                         var geomTime = watch.ElapsedMilliseconds - parseTime;
+                        var curveCache = geometryEngine.CurveCacheStatistics();
+                        geometryEngine.ClearCurveCache(model);
                         //XbimSceneBuilder sb = new XbimSceneBuilder();
                         //string xbimSceneName = BuildFileName(ifcFile, ".xbimScene");
                         //sb.BuildGlobalScene(model, xbimSceneName);
@@ -165,7 +219,22 @@ namespace XbimRegression
                                 BReps = model.Instances.OfType<IIfcFaceBasedSurfaceModel>().Count() +
                                         model.Instances.OfType<IIfcShellBasedSurfaceModel>().Count() + model.Instances
                                             .OfType<IIfcManifoldSolidBrep>().Count(),
-                                Application = ohs == null ? "Unknown" : ohs.OwningApplication?.ApplicationFullName.ToString()
+                                Application = ohs == null ? "Unknown" : ohs.OwningApplication?.ApplicationFullName.ToString(),
+                                DeflectionPolicy = _params.DeflectionPolicy,
+                                Triangles = CountTriangles(geomReader),
+                                CacheBudget = _params.CacheBudgetMegabytes,
+                                CachePeakMegabytes = context.GeometryCacheStatistics.PeakResidentBytes / (1024 * 1024),
+                                CacheSpilledShapes = context.GeometryCacheStatistics.SpilledShapes,
+                                PeakWorkingSet = Process.GetCurrentProcess().PeakWorkingSet64 / (1024 * 1024),
+                                BooleanScheduling = _params.BooleanScheduling,
+                                BooleanMakespan = (long)(context.BooleanScheduleStatistics?.MakespanMs ?? 0),
+                                BooleanIdealMakespan = (long)(context.BooleanScheduleStatistics?.IdealMakespanMs ?? 0),
+                                ShardWorkers = _params.ShardWorkers,
+                                FailedShards = context.FailedShards?.Count ?? 0,
+                                SuppressedLogs = context.SuppressedLogMessages,
+                                CurveCacheHits = curveCache.Hits,
+                                CurveCacheHitRate = (int)Math.Round(curveCache.HitRate * 100),
+                                CurveCacheSaved = (long)curveCache.SavedTime.TotalMilliseconds
                             };
 
                         }
@@ -274,6 +343,35 @@ namespace XbimRegression
             return Xbim3DModelContext.MeshingBehaviourResult.Default;
         }
 
+        private XbimDeflectionPolicy CreateDeflectionPolicy()
+        {
+            switch (_params.DeflectionPolicy)
+            {
+                case "size":
+                    return new XbimSizeDeflectionPolicy();
+                case "budget":
+                    return new XbimTriangleBudgetDeflectionPolicy();
+                default:
+                    return null; // the deflection in the model factors
+            }
+        }
+
+        /// <summary>
+        /// Total number of triangles in the shape geometries, instances of the same geometry are only counted once
+        /// </summary>
+        private static long CountTriangles(IGeometryStoreReader geomReader)
+        {
+            long triangles = 0;
+            foreach (var shapeGeometry in geomReader.ShapeGeometries)
+            {
+                // the binary format starts with a version byte followed by the vertex and triangle counts
+                var data = shapeGeometry.ShapeData;
+                if (shapeGeometry.Format == XbimGeometryType.PolyhedronBinary && data != null && data.Length >= 9)
+                    triangles += BitConverter.ToInt32(data, 5);
+            }
+            return triangles;
+        }
+
         private IModel ParseModelFile(string ifcFileName, bool caching, ILogger<BatchProcessor> logger)
         {
             IModel ret = null;
@@ -309,6 +407,8 @@ namespace XbimRegression
             DeleteFile(BuildFileName(ifcFile, ".xbim"));
             DeleteFile(BuildFileName(ifcFile, ".xbimScene"));
             DeleteFile(BuildFileName(ifcFile, ".log"));
+            DeleteFile(BuildFileName(ifcFile, ".telemetry.json"));
+            DeleteFile(BuildFileName(ifcFile, ".trace.json"));
         }
 
         private void DeleteFile(string file)
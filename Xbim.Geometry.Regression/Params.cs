@@ -17,6 +17,16 @@ namespace XbimRegression
         public bool Caching;
         public bool WriteBreps = false;
         public bool GeometryV1;
+        public string DeflectionPolicy = "fixed";
+        public int SlowestEntities = 10;
+        public bool WriteTelemetry;
+        public bool WriteTrace;
+        public double ProductBudgetSeconds;
+        public long CacheBudgetMegabytes;
+        public string BooleanScheduling = "cost";
+        public int ShardWorkers;
+        public int LogRepeatLimit = -1;
+        public bool NoCurveCache;
 
         public Params(string[] args)
         {
@@ -63,6 +73,36 @@ namespace XbimRegression
                             case "/geometryv1":
                                 GeometryV1 = true;
                                 break;
+                            case "/deflection":
+                                paramType = CompoundParameter.DeflectionPolicy;
+                                break;
+                            case "/slowest":
+                                paramType = CompoundParameter.SlowestEntities;
+                                break;
+                            case "/budget":
+                                paramType = CompoundParameter.ProductBudget;
+                                break;
+                            case "/cachebudget":
+                                paramType = CompoundParameter.CacheBudget;
+                                break;
+                            case "/scheduler":
+                                paramType = CompoundParameter.BooleanScheduling;
+                                break;
+                            case "/shards":
+                                paramType = CompoundParameter.ShardWorkers;
+                                break;
+                            case "/loglimit":
+                                paramType = CompoundParameter.LogRepeatLimit;
+                                break;
+                            case "/nocurvecache":
+                                NoCurveCache = true;
+                                break;
+                            case "/telemetry":
+                                WriteTelemetry = true;
+                                break;
+                            case "/trace":
+                                WriteTrace = true;
+                                break;
                             default:
                                 Console.WriteLine("Skipping un-expected argument '{0}'", arg);
                                 break;
@@ -84,6 +124,73 @@ namespace XbimRegression
                         }
                         paramType = CompoundParameter.None;
                         break;
+                    case CompoundParameter.SlowestEntities:
+                        int slowest;
+                        if (int.TryParse(arg, out slowest))
+                        {
+                            SlowestEntities = slowest;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.ProductBudget:
+                        double budget;
+                        if (double.TryParse(arg, out budget))
+                        {
+                            ProductBudgetSeconds = budget;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.CacheBudget:
+                        long cacheBudget;
+                        if (long.TryParse(arg, out cacheBudget))
+                        {
+                            CacheBudgetMegabytes = cacheBudget;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.LogRepeatLimit:
+                        int logLimit;
+                        if (int.TryParse(arg, out logLimit))
+                        {
+                            LogRepeatLimit = logLimit;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.ShardWorkers:
+                        int shards;
+                        if (int.TryParse(arg, out shards))
+                        {
+                            ShardWorkers = shards;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.BooleanScheduling:
+                        switch (arg.ToLowerInvariant())
+                        {
+                            case "cost":
+                            case "operands":
+                                BooleanScheduling = arg.ToLowerInvariant();
+                                break;
+                            default:
+                                Console.WriteLine("Unknown boolean scheduler '{0}', using cost", arg);
+                                break;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
+                    case CompoundParameter.DeflectionPolicy:
+                        switch (arg.ToLowerInvariant())
+                        {
+                            case "fixed":
+                            case "size":
+                            case "budget":
+                                DeflectionPolicy = arg.ToLowerInvariant();
+                                break;
+                            default:
+                                Console.WriteLine("Unknown deflection policy '{0}', using fixed", arg);
+                                break;
+                        }
+                        paramType = CompoundParameter.None;
+                        break;
                 }
             }
             IsValid = true;
@@ -91,7 +198,7 @@ namespace XbimRegression
 
         private static void WriteSyntax()
         {
-            Console.WriteLine("Syntax: XbimRegression <modelfolder> [/timeout <seconds>] [/maxthreads <number>] [/singlethread] /writebreps");
+            Console.WriteLine("Syntax: XbimRegression <modelfolder> [/timeout <seconds>] [/maxthreads <number>] [/singlethread] [/deflection <fixed|size|budget>] [/slowest <number>] [/budget <seconds>] [/cachebudget <MB>] [/scheduler <cost|operands>] [/shards <number>] [/loglimit <number>] [/nocurvecache] [/telemetry] [/trace] /writebreps");
         }
 
         /// <summary>
@@ -115,7 +222,14 @@ namespace XbimRegression
             None,
             Timeout,
             MaxThreads,
-            CachingOn
+            CachingOn,
+            DeflectionPolicy,
+            SlowestEntities,
+            ProductBudget,
+            CacheBudget,
+            BooleanScheduling,
+            ShardWorkers,
+            LogRepeatLimit
         };
     }
 }
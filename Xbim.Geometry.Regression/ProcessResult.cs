@@ -36,13 +36,28 @@ namespace XbimRegression
         public long BReps { get; set; }
         public String Application { get; set; }
         public long BooleanGeometries { get; set; }
+        public String DeflectionPolicy { get; set; }
+        public long Triangles { get; set; }
+        public long CacheBudget { get; set; }
+        public long CachePeakMegabytes { get; set; }
+        public int CacheSpilledShapes { get; set; }
+        public long PeakWorkingSet { get; set; }
+        public String BooleanScheduling { get; set; }
+        public long BooleanMakespan { get; set; }
+        public long BooleanIdealMakespan { get; set; }
+        public int ShardWorkers { get; set; }
+        public int FailedShards { get; set; }
+        public int SuppressedLogs { get; set; }
+        public long CurveCacheHits { get; set; }
+        public int CurveCacheHitRate { get; set; }
+        public long CurveCacheSaved { get; set; }
         public const String CsvHeader = @"IFC File, Errors, Warnings, Information, Parse Duration (ms), Geometry Conversion (ms), Total Duration (ms), IFC Size,  IFC Entities, Geometry Nodes, " +
            
-            "FILE_SCHEMA, FILE_NAME, FILE_DESCRIPTION, Application, Products, Solid Models, Maps, Booleans, BReps";
+            "FILE_SCHEMA, FILE_NAME, FILE_DESCRIPTION, Application, Products, Solid Models, Maps, Booleans, BReps, Deflection Policy, Triangles, Cache Budget (MB), Cache Peak (MB), Cache Spills, Peak Working Set (MB), Boolean Scheduler, Boolean Makespan (ms), Ideal Boolean Makespan (ms), Shards, Failed Shards, Suppressed Logs, Curve Cache Hits, Curve Cache Hit Rate (%), Curve Cache Saved (ms)";
 
         public String ToCsv()
         {
-            return String.Format($"\"{FileName}\",{Errors},{Warnings},{Information},{ParseDuration},{GeometryDuration},{TotalTime},{IfcLength},{Entities},{GeometryEntries},\"{IfcSchema}\",\"{IfcName}\",\"{IfcDescription}\",\"{Application}\",{IfcProductEntries},{IfcSolidGeometries},{IfcMappedGeometries},{BooleanGeometries},{BReps}");
+            return String.Format($"\"{FileName}\",{Errors},{Warnings},{Information},{ParseDuration},{GeometryDuration},{TotalTime},{IfcLength},{Entities},{GeometryEntries},\"{IfcSchema}\",\"{IfcName}\",\"{IfcDescription}\",\"{Application}\",{IfcProductEntries},{IfcSolidGeometries},{IfcMappedGeometries},{BooleanGeometries},{BReps},{DeflectionPolicy},{Triangles},{CacheBudget},{CachePeakMegabytes},{CacheSpilledShapes},{PeakWorkingSet},{BooleanScheduling},{BooleanMakespan},{BooleanIdealMakespan},{ShardWorkers},{FailedShards},{SuppressedLogs},{CurveCacheHits},{CurveCacheHitRate},{CurveCacheSaved}");
         }
 
         public long TotalTime 
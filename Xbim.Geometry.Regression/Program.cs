@@ -1,15 +1,26 @@
-﻿using Xbim.Ifc;
+﻿using System;
+using System.Linq;
+using Xbim.Ifc;
+using Xbim.ModelGeometry.Scene;
 
 namespace XbimRegression
 {
     class Program
     {
+        internal const string ShardWorkerMode = "shardworker";
+
         private static void Main(string[] args)
         {
             // ContextTesting is a class that has been temporarily created to test multiple files
             // ContextTesting.Run();
             // return;
             IfcStore.ModelProviderFactory.UseHeuristicModelProvider();
+            // started by a sharded CreateContext to convert one shard of a model
+            if (args.Length > 0 && args[0] == ShardWorkerMode)
+            {
+                Environment.ExitCode = XbimShardWorker.Run(args.Skip(1).ToArray());
+                return;
+            }
             var arguments = new Params(args);
             if (!arguments.IsValid)
                 return;
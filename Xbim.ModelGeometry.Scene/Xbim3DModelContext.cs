@@ -6,14 +6,17 @@ using System.Collections.Concurrent;
 using System.Collections.Generic;
 using System.Collections.ObjectModel;
 using System.Diagnostics;
+using System.Globalization;
 using System.IO;
 using System.Linq;
+using System.Text;
 using System.Threading;
 using System.Threading.Tasks;
 using Xbim.Common;
 using Xbim.Common.Exceptions;
 using Xbim.Common.Geometry;
 using Xbim.Geometry.Engine.Interop;
+using Xbim.Ifc;
 using Xbim.Ifc4.Interfaces;
 using Xbim.ModelGeometry.Scene.Clustering;
 using Xbim.ModelGeometry.Scene.Extensions;
@@ -44,6 +47,13 @@ namespace Xbim.ModelGeometry.Scene
             private readonly int _styleId;
             private readonly int _productLabel;
             private readonly int _productType;
+            private readonly XbimCreateContextHelper _contextHelper;
+            private readonly XbimGeometryEngine _engine;
+            private readonly IModel _model;
+            private readonly ConcurrentDictionary<int, bool> _shapeIdsUsedMoreThanOnce;
+            private readonly IList<XbimShapeInstance> _productShapes;
+            private readonly IList<XbimShapeInstance> _cutToolIds;
+            private readonly IList<XbimShapeInstance> _projectToolIds;
             private IXbimGeometryObjectSet _productGeometries;
             private IXbimSolidSet _cutGeometries;
             private IXbimSolidSet _projectGeometries;
@@ -57,14 +67,96 @@ namespace Xbim.ModelGeometry.Scene
                 XbimShapeInstance shape = productShapes.FirstOrDefault();
                 _productLabel = shape != null ? shape.IfcProductLabel : 0;
                 _productType = shape != null ? shape.IfcTypeId : 0;
-                AddGeometries(contextHelper, engine, model, shapeIdsUsedMoreThanOnce, productShapes, cutToolIds, projectToolIds);
+                _contextHelper = contextHelper;
+                _engine = engine;
+                _model = model;
+                _shapeIdsUsedMoreThanOnce = shapeIdsUsedMoreThanOnce;
+                _productShapes = productShapes;
+                _cutToolIds = cutToolIds;
+                _projectToolIds = projectToolIds;
+                foreach (var cacheKey in CacheKeys)
+                    contextHelper.AddCacheUse(cacheKey);
             }
 
-            private void AddGeometries(XbimCreateContextHelper contextHelper, XbimGeometryEngine engine, IModel model, ConcurrentDictionary<int, bool> shapeIdsUsedMoreThanOnce, IList<XbimShapeInstance> productShapes, IList<XbimShapeInstance> cutToolIds, IList<XbimShapeInstance> projectToolIds)
+            /// <summary>
+            /// The number of cut and projection operands, known before the geometries are loaded
+            /// </summary>
+            public int OperationCount
+            {
+                get { return _cutToolIds.Count + _projectToolIds.Count; }
+            }
+
+            /// <summary>
+            /// The estimate of the cost model, in milliseconds
+            /// </summary>
+            public double EstimatedCost { get; set; }
+
+            /// <summary>
+            /// The booleans of the product spread their work over several threads
+            /// </summary>
+            public bool RunParallel { get; set; }
+
+            /// <summary>
+            /// Gathers the inputs of the cost model from the face counts of the cached geometries and the bounds of the shape instances
+            /// </summary>
+            public XbimBooleanCostFactors GetCostFactors()
+            {
+                var factors = new XbimBooleanCostFactors { ProductLabel = _productLabel, Tools = OperationCount };
+                var productBounds = XbimRect3D.Empty;
+                foreach (var productShape in _productShapes)
+                {
+                    var faceCounts = _contextHelper.GetFaceCounts(productShape);
+                    factors.ProductFaces += faceCounts.Faces;
+                    factors.ProductCurvedFaces += faceCounts.CurvedFaces;
+                    productBounds.Union(productShape.BoundingBox.Transform(productShape.Transformation));
+                }
+                // the boolean screens out the openings that do not touch the product, projections are always joined
+                foreach (var tool in _cutToolIds.Where(t => productBounds.Intersects(t.BoundingBox.Transform(t.Transformation))).Concat(_projectToolIds))
+                {
+                    var faceCounts = _contextHelper.GetFaceCounts(tool);
+                    factors.OverlappingTools++;
+                    factors.ToolFaces += faceCounts.Faces;
+                    factors.ToolCurvedFaces += faceCounts.CurvedFaces;
+                }
+                return factors;
+            }
+
+            /// <summary>
+            /// The keys of the cached geometries the operation uses
+            /// </summary>
+            public IEnumerable<int> CacheKeys
+            {
+                get
+                {
+                    return _productShapes.Concat(_cutToolIds).Concat(_projectToolIds)
+                        .Select(s => _contextHelper.GetCacheKey(s)).Where(k => k != 0);
+                }
+            }
+
+            /// <summary>
+            /// Gets the geometries of the operation from the cache, they are only held while the product is processed so that
+            /// the cache can keep within its memory budget
+            /// </summary>
+            public void LoadGeometries()
             {
-                // todo: memory: I suppose that the memory footprint grows during meshing because all the shapes are retained in the XbimBooleanDefinition fields
-                // this should be investigated and moved.
+                if (_productGeometries != null) return;
+                AddGeometries(_contextHelper, _engine, _model, _shapeIdsUsedMoreThanOnce, _productShapes, _cutToolIds, _projectToolIds);
+            }
 
+            /// <summary>
+            /// Drops the geometries and releases the cached operands no other operation needs
+            /// </summary>
+            public void ReleaseGeometries()
+            {
+                _productGeometries = null;
+                _cutGeometries = null;
+                _projectGeometries = null;
+                foreach (var cacheKey in CacheKeys)
+                    _contextHelper.ReleaseCacheUse(cacheKey);
+            }
+
+            private void AddGeometries(XbimCreateContextHelper contextHelper, XbimGeometryEngine engine, IModel model, ConcurrentDictionary<int, bool> shapeIdsUsedMoreThanOnce, IList<XbimShapeInstance> productShapes, IList<XbimShapeInstance> cutToolIds, IList<XbimShapeInstance> projectToolIds)
+            {
                 bool placebo;
                 _productGeometries = engine.CreateGeometryObjectSet();
                 foreach (var argument in productShapes)
@@ -194,7 +286,20 @@ namespace Xbim.ModelGeometry.Scene
             private HashSet<int> VoidedProductIds { get; set; }
             internal HashSet<int> VoidedShapeIds { get; set; }
             internal HashSet<int> ProductShapeIds { get; private set; }
-            internal ConcurrentDictionary<int, IXbimGeometryObject> CachedGeometries { get; private set; }
+            /// <summary>
+            /// The key is the label of the shape, the value is the first product found that uses it
+            /// </summary>
+            internal Dictionary<int, IIfcProduct> ShapeProducts { get; private set; }
+            internal XbimGeometryCache CachedGeometries { get; private set; }
+            private ConcurrentDictionary<int, int> CacheUses { get; set; }
+            private ConcurrentDictionary<int, (int Faces, int CurvedFaces)> CachedFaceCounts { get; set; }
+            /// <summary>
+            /// When greater than one only the products of shard ShardIndex are converted
+            /// </summary>
+            internal int ShardCount { get; set; }
+            internal int ShardIndex { get; set; }
+            private HashSet<int> FeatureIds { get; set; }
+            private HashSet<int> ShardFeatureIds { get; set; }
             internal int Total { get; private set; }
             internal int PercentageParsed { get; set; }
             internal int Tally { get; set; }
@@ -216,28 +321,65 @@ namespace Xbim.ModelGeometry.Scene
 
             internal IXbimGeometryObject GetGeometryFromCache(XbimShapeInstance shapeInstance, bool makeCopy)
             {
+                var cacheKey = GetCacheKey(shapeInstance);
+                IXbimGeometryObject obj;
+                if (cacheKey != 0 && CachedGeometries.TryGetValue(cacheKey, out obj))
+                    return makeCopy ? obj.Transform(shapeInstance.Transformation) : obj.TransformShallow(shapeInstance.Transformation);
+                return null;
+            }
 
+            /// <summary>
+            /// The key of the geometry of the shape instance in CachedGeometries, 0 if it has none
+            /// </summary>
+            internal int GetCacheKey(XbimShapeInstance shapeInstance)
+            {
                 int ifcShapeId;
                 if (GeometryShapeLookup.TryGetValue(shapeInstance.ShapeGeometryLabel, out ifcShapeId))
-                {
-                    IXbimGeometryObject obj;
-                    if (CachedGeometries.TryGetValue(ifcShapeId, out obj))
-                        return makeCopy ? obj.Transform(shapeInstance.Transformation) : obj.TransformShallow(shapeInstance.Transformation);
-                } //it might be a map
-                else
-                {
-                    GeometryReference geomRef;
-                    if (ShapeLookup.TryGetValue(shapeInstance.InstanceLabel, out geomRef))
-                    {
-                        IXbimGeometryObject obj;
-                        if (CachedGeometries.TryGetValue(geomRef.GeometryId, out obj))
-                            return makeCopy ? obj.Transform(shapeInstance.Transformation) : obj.TransformShallow(shapeInstance.Transformation);
-                    }
-                }
-                return null;
+                    return ifcShapeId;
+                //it might be a map
+                GeometryReference geomRef;
+                if (ShapeLookup.TryGetValue(shapeInstance.InstanceLabel, out geomRef))
+                    return geomRef.GeometryId;
+                return 0;
             }
 
-            internal bool Initialise(bool adjustWcs)
+            /// <summary>
+            /// Keeps the geometry for the booleans, its faces are counted for the cost model
+            /// </summary>
+            internal void CacheGeometry(int shapeId, IXbimGeometryObject geometry, XbimGeometryEngine engine)
+            {
+                var faces = engine.CountFaces(geometry, out int curvedFaces);
+                if (CachedGeometries.TryAdd(shapeId, geometry))
+                    CachedFaceCounts.TryAdd(shapeId, (faces, curvedFaces));
+            }
+
+            /// <summary>
+            /// The faces of the cached geometry of the shape instance, zero if it has none
+            /// </summary>
+            internal (int Faces, int CurvedFaces) GetFaceCounts(XbimShapeInstance shapeInstance)
+            {
+                CachedFaceCounts.TryGetValue(GetCacheKey(shapeInstance), out var faceCounts);
+                return faceCounts;
+            }
+
+            /// <summary>
+            /// Counts an operation that will use the cached geometry
+            /// </summary>
+            internal void AddCacheUse(int cacheKey)
+            {
+                CacheUses.AddOrUpdate(cacheKey, 1, (key, uses) => uses + 1);
+            }
+
+            /// <summary>
+            /// Called when an operation has finished with the cached geometry, the geometry is released after its last use
+            /// </summary>
+            internal void ReleaseCacheUse(int cacheKey)
+            {
+                if (CacheUses.AddOrUpdate(cacheKey, 0, (key, uses) => uses - 1) <= 0)
+                    CachedGeometries.Release(cacheKey);
+            }
+
+            internal bool Initialise(bool adjustWcs, XbimGeometryCache geometryCache)
             {
                 try
                 {
@@ -247,12 +389,15 @@ namespace Xbim.ModelGeometry.Scene
                     MapGeometryReferences = new ConcurrentDictionary<int, List<GeometryReference>>();
                     MapTransforms = new ConcurrentDictionary<int, XbimMatrix3D>();
                     GetOpeningsAndProjections();
+                    GetShard();
                     VoidedProductIds = new HashSet<int>();
                     VoidedShapeIds = new HashSet<int>();
                     ParallelOptions = new ParallelOptions();
                    // ParallelOptions.MaxDegreeOfParallelism = 16;
 
-                    CachedGeometries = new ConcurrentDictionary<int, IXbimGeometryObject>();
+                    CachedGeometries = geometryCache;
+                    CacheUses = new ConcurrentDictionary<int, int>();
+                    CachedFaceCounts = new ConcurrentDictionary<int, (int Faces, int CurvedFaces)>();
                     foreach (var voidedShapeId in OpeningsAndProjections.Select(op => op.Key.EntityLabel))
                         VoidedProductIds.Add(voidedShapeId);
                     GetProductShapeIds();
@@ -274,6 +419,37 @@ namespace Xbim.ModelGeometry.Scene
                 }
             }
 
+            /// <summary>
+            /// True if the product is converted in this shard. Products are divided by label, openings and projections go with the
+            /// elements they belong to
+            /// </summary>
+            internal bool InShard(IIfcProduct product)
+            {
+                if (ShardCount <= 1)
+                    return true;
+                if (FeatureIds.Contains(product.EntityLabel))
+                    return ShardFeatureIds.Contains(product.EntityLabel);
+                return product.EntityLabel % ShardCount == ShardIndex;
+            }
+
+            private void GetShard()
+            {
+                if (ShardCount <= 1)
+                    return;
+                FeatureIds = new HashSet<int>();
+                ShardFeatureIds = new HashSet<int>();
+                foreach (var elementToFeatures in OpeningsAndProjections)
+                {
+                    var elementInShard = elementToFeatures.Key.EntityLabel % ShardCount == ShardIndex;
+                    foreach (var feature in elementToFeatures)
+                    {
+                        FeatureIds.Add(feature.EntityLabel);
+                        if (elementInShard) ShardFeatureIds.Add(feature.EntityLabel);
+                    }
+                }
+                OpeningsAndProjections = OpeningsAndProjections.Where(g => g.Key.EntityLabel % ShardCount == ShardIndex).ToList();
+            }
+
             private void GetClusters()
             {
                 Clusters = new Dictionary<IIfcRepresentationContext, ConcurrentQueue<XbimBBoxClusterElement>>();
@@ -397,8 +573,9 @@ namespace Xbim.ModelGeometry.Scene
                 MappedShapeIds = new HashSet<int>();
                 FeatureElementShapeIds = new HashSet<int>();
                 ProductShapeIds = new HashSet<int>();
+                ShapeProducts = new Dictionary<int, IIfcProduct>();
 
-                foreach (var product in Model.Instances.OfType<IIfcProduct>(true).Where(p => p.Representation != null))
+                foreach (var product in Model.Instances.OfType<IIfcProduct>(true).Where(p => p.Representation != null && InShard(p)))
                 {
 
                     if (customMeshBehaviour != null)
@@ -426,12 +603,13 @@ namespace Xbim.ModelGeometry.Scene
                             {
                                 if (shape is IIfcMappedItem mappedItem)
                                 {
-                                    ProcessMappedItem(isFeatureElementShape, isVoidedProductShape, mappedItem);
+                                    ProcessMappedItem(product, isFeatureElementShape, isVoidedProductShape, mappedItem);
                                 }
                                 else
                                 {
                                     //if not already processed add it
                                     ProductShapeIds.Add(shape.EntityLabel);
+                                    if (!ShapeProducts.ContainsKey(shape.EntityLabel)) ShapeProducts.Add(shape.EntityLabel, product);
                                     if (isFeatureElementShape) FeatureElementShapeIds.Add(shape.EntityLabel);
                                     if (isVoidedProductShape) VoidedShapeIds.Add(shape.EntityLabel);
                                 }
@@ -441,20 +619,21 @@ namespace Xbim.ModelGeometry.Scene
                 }
             }
 
-            private void ProcessMappedItem(bool isFeatureElementShape, bool isVoidedProductShape, IIfcMappedItem mappedItem)
+            private void ProcessMappedItem(IIfcProduct product, bool isFeatureElementShape, bool isVoidedProductShape, IIfcMappedItem mappedItem)
             {
                 MappedShapeIds.Add(mappedItem.EntityLabel);
                 //make sure any shapes mapped are in the set to process as well
                 foreach (var item in mappedItem.MappingSource.MappedRepresentation.Items)
                 {
                     if (item is IIfcMappedItem)
-                        ProcessMappedItem(isFeatureElementShape, isVoidedProductShape, item as IIfcMappedItem);
+                        ProcessMappedItem(product, isFeatureElementShape, isVoidedProductShape, item as IIfcMappedItem);
                     else if (item != null && !(item is IIfcGeometricSet))
                     {
                         var mappedItemLabel = item.EntityLabel;
                         //if not already processed add it
 
                         ProductShapeIds.Add(mappedItemLabel);
+                        if (!ShapeProducts.ContainsKey(mappedItemLabel)) ShapeProducts.Add(mappedItemLabel, product);
                         if (isFeatureElementShape) FeatureElementShapeIds.Add(mappedItemLabel);
                         if (isVoidedProductShape) VoidedShapeIds.Add(mappedItemLabel);
                     }
@@ -466,13 +645,7 @@ namespace Xbim.ModelGeometry.Scene
                 if (_disposed) return;
                 _disposed = true;
                 if (CachedGeometries != null)
-                {
-                    foreach (var cachedGeom in CachedGeometries)
-                    {
-                        if (cachedGeom.Value != null)
-                            cachedGeom.Value.Dispose();
-                    }
-                }
+                    CachedGeometries.Dispose();
                 GC.SuppressFinalize(this);
             }
         }
@@ -506,6 +679,8 @@ namespace Xbim.ModelGeometry.Scene
             BooleanTimeOutMilliSeconds = BooleanTimeOutSeconds * 1000;
         }
         private readonly IModel _model;
+        private readonly string _contextType;
+        private readonly string _requiredContextIdentifier;
 
         internal static void LogWarning(object entity, string format, params object[] args)
         {
@@ -577,6 +752,8 @@ namespace Xbim.ModelGeometry.Scene
             ILogger logger = null)
         {
             _model = model;
+            _contextType = contextType;
+            _requiredContextIdentifier = requiredContextIdentifier;
             _logger = logger ?? XbimLogging.CreateLogger<Xbim3DModelContext>();
             model.AddRevitWorkArounds();
             var wr2 = model.AddWorkAroundTrimForPolylinesIncorrectlySetToOneForEntireCurve();
@@ -697,6 +874,10 @@ namespace Xbim.ModelGeometry.Scene
                 return false;
             }
 
+            HullProxies.Clear();
+            if (ShardWorkers > 1 && ShardCount <= 1 && CanShard(out string sourceFile))
+                return CreateContextSharded(progDelegate, adjustWcs, sourceFile);
+
             using (var geometryTransaction = geometryStore.BeginInit())
             {
                 if (geometryTransaction == null)
@@ -707,8 +888,12 @@ namespace Xbim.ModelGeometry.Scene
                 using (var contextHelper = new XbimCreateContextHelper(_model, _contexts))
                 {
                     contextHelper.customMeshBehaviour = CustomMeshingBehaviour;
+                    contextHelper.ShardCount = ShardCount;
+                    contextHelper.ShardIndex = ShardIndex;
                     if (progDelegate != null) progDelegate(-1, "Initialise");
-                    if (!contextHelper.Initialise(adjustWcs))
+                    var geometryCache = new XbimGeometryCache(Engine, GeometryCacheBudget, GeometryCacheDirectory);
+                    GeometryCacheStatistics = geometryCache.Statistics;
+                    if (!contextHelper.Initialise(adjustWcs, geometryCache))
                         throw new Exception("Failed to initialise geometric context, " + contextHelper.InitialiseError);
                     progDelegate?.Invoke(101, "Initialise");
 
@@ -716,22 +901,34 @@ namespace Xbim.ModelGeometry.Scene
                     {
                         contextHelper.ParallelOptions.MaxDegreeOfParallelism = MaxThreads;
                     }
+                    contextHelper.ParallelOptions.CancellationToken = CancellationToken;
 
-                    WriteShapeGeometries(contextHelper, progDelegate, geometryTransaction, geomStorageType);
+                    using (XbimGeometryTrace.Span("WriteShapeGeometries"))
+                    {
+                        WriteShapeGeometries(contextHelper, progDelegate, geometryTransaction, geomStorageType);
+                    }
                     PrepareMapGeometryReferences(contextHelper, progDelegate);
 
                     // process features
-                    var processed = WriteProductsWithFeatures(contextHelper, progDelegate, geomStorageType, geometryTransaction);
+                    HashSet<int> processed;
+                    using (XbimGeometryTrace.Span("WriteProductsWithFeatures"))
+                    {
+                        processed = WriteProductsWithFeatures(contextHelper, progDelegate, geomStorageType, geometryTransaction);
+                    }
 
                     progDelegate?.Invoke(-1, "WriteProductShapes");
                     var productsRemaining = _model.Instances.OfType<IIfcProduct>()
                         .Where(p =>
                             p.Representation != null
                             && !processed.Contains(p.EntityLabel)
+                            && contextHelper.InShard(p)
                         ).ToList();
 
 
-                    WriteProductShapes(contextHelper, productsRemaining, geometryTransaction);
+                    using (XbimGeometryTrace.Span("WriteProductShapes"))
+                    {
+                        WriteProductShapes(contextHelper, productsRemaining, geometryTransaction);
+                    }
                     if (progDelegate != null) progDelegate(101, "WriteProductShapes");
                     //Write out the actual representation item reference count
 
@@ -743,14 +940,174 @@ namespace Xbim.ModelGeometry.Scene
                         WriteRegionsToStore(cluster.Key, cluster.Value, geometryTransaction, contextHelper.PlacementTree.WorldCoordinateSystem);
                     }
                     if (progDelegate != null) progDelegate(101, "WriteRegionsToDb");
-
+                    // a shard worker passes the bounds of its elements to the parent, which builds the regions of the whole model
+                    if (ShardCount > 1)
+                        ShardClusters = contextHelper.Clusters.ToDictionary(c => c.Key.EntityLabel, c => c.Value.ToList());
                 }
                 geometryTransaction.Commit();
             }
+            SuppressedLogMessages = Engine.ReportSuppressedLogs(_logger);
             _logger.LogInformation("Finished creation of model scene");
             return true;
         }
 
+        private bool CanShard(out string sourceFile)
+        {
+            sourceFile = ShardSourceFile ?? (_model as IfcStore)?.FileName;
+            if (string.IsNullOrEmpty(ShardWorkerPath) || !File.Exists(ShardWorkerPath) || string.IsNullOrEmpty(sourceFile) || !File.Exists(sourceFile))
+            {
+                _logger.LogWarning("The shard worker '{0}' or the model file '{1}' cannot be found, creating the context in this process", ShardWorkerPath, sourceFile);
+                return false;
+            }
+            // every worker opens the file, an xbim database would be opened by all of them and by this process at once
+            if (!ShardSourceExtensions.Contains(Path.GetExtension(sourceFile)))
+            {
+                _logger.LogWarning("The model file '{0}' is not an IFC file the workers can each read, creating the context in this process", sourceFile);
+                return false;
+            }
+            return true;
+        }
+
+        private static readonly HashSet<string> ShardSourceExtensions = new HashSet<string>(StringComparer.OrdinalIgnoreCase) { ".ifc", ".ifczip", ".ifcxml" };
+
+        /// <summary>
+        /// Converts the products in ShardWorkers processes, each one opening the model file, and merges the geometry they write into the geometry store
+        /// </summary>
+        private bool CreateContextSharded(ReportProgressDelegate progDelegate, bool adjustWcs, string sourceFile)
+        {
+            var shardCount = ShardWorkers;
+            var directory = Path.Combine(string.IsNullOrEmpty(ShardDirectory) ? Path.GetTempPath() : ShardDirectory, "xbim-shards-" + Guid.NewGuid().ToString("N"));
+            Directory.CreateDirectory(directory);
+            var failedShards = new List<int>();
+            FailedShards = failedShards;
+            // the workers keep their own caches and schedules
+            GeometryCacheStatistics = new XbimGeometryCacheStatistics { MemoryBudget = GeometryCacheBudget };
+            BooleanScheduleStatistics = null;
+            try
+            {
+                var threadsPerShard = Math.Max(1, (MaxThreads > 0 ? MaxThreads : Environment.ProcessorCount) / shardCount);
+                var outputFiles = Enumerable.Range(0, shardCount).Select(i => Path.Combine(directory, "shard" + i + ".xbsh")).ToArray();
+                var completed = 0;
+                progDelegate?.Invoke(0, "CreateShards");
+                var workers = Enumerable.Range(0, shardCount).Select(shard => Task.Run(() =>
+                {
+                    var succeeded = RunShardWorker(sourceFile, shard, shardCount, threadsPerShard, adjustWcs, outputFiles[shard]);
+                    progDelegate?.Invoke(Interlocked.Increment(ref completed) * 100 / shardCount, "CreateShards");
+                    return succeeded;
+                })).ToArray();
+                Task.WaitAll(workers);
+                CancellationToken.ThrowIfCancellationRequested();
+                for (var shard = 0; shard < shardCount; shard++)
+                    if (!workers[shard].Result) failedShards.Add(shard);
+                progDelegate?.Invoke(101, "CreateShards");
+                if (failedShards.Any())
+                {
+                    _logger.LogError("Shards {0} of {1} failed, the geometry of their products is missing", string.Join(",", failedShards), shardCount);
+                    if (failedShards.Count == shardCount)
+                        return false;
+                }
+
+                using (var geometryTransaction = _model.GeometryStore.BeginInit())
+                {
+                    if (geometryTransaction == null)
+                    {
+                        _logger.LogWarning("No Transaction created. Finishing...");
+                        return false;
+                    }
+                    progDelegate?.Invoke(-1, "MergeShards");
+                    var merger = new XbimShardMerger(_model, geometryTransaction);
+                    for (var shard = 0; shard < shardCount; shard++)
+                    {
+                        if (failedShards.Contains(shard))
+                            continue;
+                        merger.Merge(XbimShardFile.Read(outputFiles[shard]));
+                        progDelegate?.Invoke((shard + 1) * 100 / shardCount, "MergeShards");
+                    }
+                    progDelegate?.Invoke(101, "MergeShards");
+
+                    progDelegate?.Invoke(-1, "WriteRegionsToDb");
+                    var worldCoordinateSystem = new XbimPlacementTree(_model, adjustWcs).WorldCoordinateSystem;
+                    foreach (var cluster in merger.Clusters)
+                    {
+                        if (_model.Instances[cluster.Key] is IIfcRepresentationContext context)
+                            WriteRegionsToStore(context, cluster.Value, geometryTransaction, worldCoordinateSystem);
+                    }
+                    progDelegate?.Invoke(101, "WriteRegionsToDb");
+                    geometryTransaction.Commit();
+                }
+                _logger.LogInformation("Finished creation of model scene in {0} shards", shardCount);
+                return true;
+            }
+            finally
+            {
+                try
+                {
+                    Directory.Delete(directory, true);
+                }
+                catch (IOException e)
+                {
+                    _logger.LogWarning("Failed to delete the shard folder {0}, {1}", directory, e.Message);
+                }
+            }
+        }
+
+        //runs the worker of one shard, again after a failure up to ShardRetries times, the worker is killed if CreateContext is cancelled
+        private bool RunShardWorker(string sourceFile, int shard, int shardCount, int maxThreads, bool adjustWcs, string outputFile)
+        {
+            var arguments = new List<string>
+            {
+                "-model", sourceFile, "-shard", shard.ToString(), "-shards", shardCount.ToString(), "-output", outputFile,
+                "-maxthreads", maxThreads.ToString(), "-context", _contextType ?? "model", "-adjustwcs", adjustWcs.ToString(),
+                "-primitives", MeshPrimitivesDirectly.ToString(), "-lofts", MeshLoftsDirectly.ToString(), "-cachebudget", (GeometryCacheBudget / shardCount).ToString()
+            };
+            if (_requiredContextIdentifier != null)
+                arguments.AddRange(new[] { "-contextid", _requiredContextIdentifier });
+            if (ProductTimeBudget > TimeSpan.Zero)
+                arguments.AddRange(new[] { "-budget", ProductTimeBudget.TotalSeconds.ToString(CultureInfo.InvariantCulture) });
+            arguments.InsertRange(0, ShardWorkerArguments ?? Enumerable.Empty<string>());
+
+            for (var attempt = 0; attempt <= ShardRetries; attempt++)
+            {
+                CancellationToken.ThrowIfCancellationRequested();
+                var exitCode = (ShardProcess ?? RunShardProcess)(arguments, out string errors);
+                CancellationToken.ThrowIfCancellationRequested();
+                if (exitCode == XbimShardWorker.Succeeded && File.Exists(outputFile))
+                    return true;
+                _logger.LogWarning("Shard {0} of {1} failed with exit code {2} on attempt {3}: {4}", shard, shardCount, exitCode, attempt + 1, errors);
+                if (exitCode == XbimShardWorker.InvalidArguments)
+                    return false;
+            }
+            return false;
+        }
+
+        internal delegate int ShardProcessRunner(IList<string> arguments, out string errors);
+
+        /// <summary>
+        /// Runs a worker with its arguments and returns its exit code, by default in a process of ShardWorkerPath
+        /// </summary>
+        internal ShardProcessRunner ShardProcess { get; set; }
+
+        private int RunShardProcess(IList<string> arguments, out string errors)
+        {
+            var startInfo = new ProcessStartInfo(ShardWorkerPath, string.Join(" ", arguments.Select(a => "\"" + a + "\"")))
+            {
+                UseShellExecute = false,
+                CreateNoWindow = true,
+                RedirectStandardError = true
+            };
+            using (var process = new Process { StartInfo = startInfo })
+            {
+                var errorText = new StringBuilder();
+                process.ErrorDataReceived += (s, e) => { if (e.Data != null) lock (errorText) errorText.AppendLine(e.Data); };
+                process.Start();
+                process.BeginErrorReadLine();
+                using (CancellationToken.Register(() => { try { process.Kill(); } catch (InvalidOperationException) { } }))
+                    process.WaitForExit();
+                errors = errorText.ToString().Trim();
+                return process.ExitCode;
+            }
+        }
+
         [Flags]
         public enum MeshingBehaviourResult
         {
@@ -770,6 +1127,12 @@ namespace Xbim.ModelGeometry.Scene
         /// </summary>
         public MeshingBehaviourSetter CustomMeshingBehaviour;
 
+        /// <summary>
+        /// Determines the deflection of each shape from its size or type before it is meshed, if null the deflection in the Model.ModelFactors is applied to all shapes.
+        /// Any deflection set by the CustomMeshingBehaviour for elements with openings and projections takes precedence over the policy
+        /// </summary>
+        public XbimDeflectionPolicy DeflectionPolicy { get; set; }
+
         /// <summary>
         /// Computes and writes to the DB all shapes of products considering their features (openings and extensions).
         /// The process starts from listing all OpeningsAndProjections (from the context) then performs the solid operations.
@@ -850,12 +1213,25 @@ namespace Xbim.ModelGeometry.Scene
                 }
             });
 
-            // process all the openings and projections starting with the most operations first
+            // process all the openings and projections starting with the most expensive first
             //contextHelper.ParallelOptions.MaxDegreeOfParallelism = 1;
-            Parallel.ForEach(openingAndProjectionOps.OrderByDescending(b => b.CutGeometries.Count + b.ProjectGeometries.Count), contextHelper.ParallelOptions, openingAndProjectionOp =>
+            var statistics = new XbimBooleanScheduleStatistics();
+            BooleanScheduleStatistics = statistics;
+            var schedule = ScheduleBooleans(contextHelper, openingAndProjectionOps, statistics);
+            // without buffering each idle thread takes the next product in the order of the schedule
+            var partitioner = BooleanScheduling == XbimBooleanScheduling.CostModel
+                ? Partitioner.Create(schedule, EnumerablePartitionerOptions.NoBuffering)
+                : Partitioner.Create(schedule);
+            var makespan = Stopwatch.StartNew();
+            Parallel.ForEach(partitioner, contextHelper.ParallelOptions, openingAndProjectionOp =>
             {
                 Interlocked.Increment(ref localTally);
                 var elementLabel = 0;
+                var productTime = Stopwatch.StartNew();
+                IDisposable cancellationScope = null;
+                IDisposable parallelScope = null;
+                // the results of the booleans are released once the product is written, the cached operands are not tracked
+                var session = new XbimGeometrySession(_model.Instances[openingAndProjectionOp.ProductLabel]);
                 try
                 {
                     if (progDelegate != null)
@@ -867,6 +1243,7 @@ namespace Xbim.ModelGeometry.Scene
                             progDelegate(localPercentageParsed, "Building Elements");
                         }
                     }
+                    openingAndProjectionOp.LoadGeometries();
                     if (!openingAndProjectionOp.ProductGeometries.Any())
                         return;
 
@@ -880,6 +1257,9 @@ namespace Xbim.ModelGeometry.Scene
                     var thisDeflectionAngle = mf.DeflectionAngle;
                     var behaviour = MeshingBehaviourResult.Default;
 
+                    DeflectionPolicy?.GetDeflection(_model.Instances[elementLabel] as IIfcProduct, openingAndProjectionOp.ProductGeometries.BoundingBox,
+                        mf, ref thisDeflectionDistance, ref thisDeflectionAngle);
+
                     if (CustomMeshingBehaviour != null)
                     {
                         behaviour = CustomMeshingBehaviour(elementLabel, typeId, ref thisDeflectionDistance, ref thisDeflectionAngle);
@@ -887,12 +1267,23 @@ namespace Xbim.ModelGeometry.Scene
                             return; // we are in a parallel loop, this continues to the next
                     }
 
+                    // the budget covers all the booleans of the product
+                    cancellationScope = XbimGeometryCancellation.Enter(CancellationToken, ProductTimeBudget);
+                    if (openingAndProjectionOp.RunParallel)
+                        parallelScope = XbimGeometryCancellation.EnterParallel();
                     // Get all the parts of this element into a set of solid geometries
                     var elementGeom = openingAndProjectionOp.ProductGeometries;
+                    var telemetry = Telemetry;
+                    var telemetryMark = telemetry != null ? XbimGeometryTelemetry.Mark() : default(XbimTelemetryMark);
+                    var booleanOutcome = XbimGeometryOutcome.Success;
                     // make the finished shape
                     if (behaviour.HasFlag(MeshingBehaviourResult.PerformAdditions) && openingAndProjectionOp.ProjectGeometries.Any())
                     {
-                        var nextGeom = elementGeom.Union(openingAndProjectionOp.ProjectGeometries, precision);
+                        IXbimGeometryObjectSet nextGeom;
+                        using (XbimGeometryTrace.Span("Union"))
+                        {
+                            nextGeom = elementGeom.Union(openingAndProjectionOp.ProjectGeometries, precision);
+                        }
                         if (nextGeom.IsValid)
                         {
                             if (nextGeom.First != null && nextGeom.First.IsValid)
@@ -901,7 +1292,10 @@ namespace Xbim.ModelGeometry.Scene
                                 LogWarning(_model.Instances[elementLabel], "Projections are an empty shape");
                         }
                         else
+                        {
                             LogWarning(_model.Instances[elementLabel], "Joining of projections has failed. Projections have been ignored");
+                            booleanOutcome = XbimGeometryOutcome.Failed;
+                        }
                     }
 
 
@@ -911,7 +1305,10 @@ namespace Xbim.ModelGeometry.Scene
                         try
                         {
                             //nextGeom = CutWithTimeOut(elementGeom, openingAndProjectionOp.CutGeometries, precision, BooleanTimeOutMilliSeconds);
-                            nextGeom = elementGeom.Cut(openingAndProjectionOp.CutGeometries, precision);
+                            using (XbimGeometryTrace.Span("Cut"))
+                            {
+                                nextGeom = elementGeom.Cut(openingAndProjectionOp.CutGeometries, precision);
+                            }
                             if (nextGeom.IsValid)
                             {
                                 if (nextGeom.First != null && nextGeom.First.IsValid)
@@ -921,11 +1318,15 @@ namespace Xbim.ModelGeometry.Scene
                                         "Cutting openings has resulted in an empty shape");
                             }
                             else
+                            {
                                 LogWarning(_model.Instances[elementLabel],
                                     "Cutting openings has failed. Openings have been ignored");
+                                booleanOutcome = XbimGeometryOutcome.Failed;
+                            }
                         }
                         catch (TimeoutException)
                         {
+                            booleanOutcome = XbimGeometryOutcome.TimedOut;
                             LogWarning(_model.Instances[elementLabel], "Cutting openings has failed. Openings have been ignored. Operation timed out after {0} seconds", BooleanTimeOutMilliSeconds / 1000);
 
                         }
@@ -933,6 +1334,14 @@ namespace Xbim.ModelGeometry.Scene
 
                     }
 
+                    if (telemetry != null)
+                        telemetryMark = telemetry.RecordBoolean(_model.Instances[elementLabel], telemetryMark, booleanOutcome);
+                    // the product is meshed even if its booleans ran out of time
+                    parallelScope?.Dispose();
+                    parallelScope = null;
+                    cancellationScope?.Dispose();
+                    cancellationScope = null;
+
                     // now add to the DB     
                     //
                     foreach (var geom in elementGeom)
@@ -949,6 +1358,7 @@ namespace Xbim.ModelGeometry.Scene
 
                         if (geomType == XbimGeometryType.PolyhedronBinary)
                         {
+                            using (XbimGeometryTrace.Span("WriteTriangulation"))
                             using (var bw = new BinaryWriter(memStream))
                             {
                                 Engine.WriteTriangulation(bw, geom, mf.Precision,
@@ -957,6 +1367,7 @@ namespace Xbim.ModelGeometry.Scene
                         }
                         else
                         {
+                            using (XbimGeometryTrace.Span("WriteTriangulation"))
                             using (var tw = new StreamWriter(memStream))
                             {
                                 Engine.WriteTriangulation(tw, geom, mf.Precision,
@@ -964,6 +1375,8 @@ namespace Xbim.ModelGeometry.Scene
                             }
                         }
                         ((IXbimShapeGeometryData)shapeGeometry).ShapeData = memStream.ToArray();
+                        if (telemetry != null)
+                            telemetryMark = telemetry.RecordMesh(_model.Instances[elementLabel], telemetryMark, shapeGeometry.ShapeData);
                         if (shapeGeometry.ShapeData.Length > 0)
                         {
                             var shapeInstance = new XbimShapeInstance
@@ -989,8 +1402,22 @@ namespace Xbim.ModelGeometry.Scene
                     LogWarning(_model.Instances[elementLabel],
                         "Contains openings but  its basic geometry can not be built, {0}", e.Message);
                 }
+                finally
+                {
+                    parallelScope?.Dispose();
+                    cancellationScope?.Dispose();
+                    session.Dispose();
+                    openingAndProjectionOp.ReleaseGeometries();
+                    var elapsed = productTime.Elapsed.TotalMilliseconds;
+                    lock (statistics)
+                    {
+                        statistics.TotalMs += elapsed;
+                        statistics.LongestProductMs = Math.Max(statistics.LongestProductMs, elapsed);
+                    }
+                }
                 //if (progDelegate != null) progDelegate(101, "FeatureElement, (#" + element.EntityLabel + " ended)");
             });
+            statistics.MakespanMs = makespan.Elapsed.TotalMilliseconds;
             contextHelper.PercentageParsed = localPercentageParsed;
             contextHelper.Tally = localTally;
             if (progDelegate != null) progDelegate(101, "WriteFeatureElements, (" + localTally + " written)");
@@ -999,6 +1426,38 @@ namespace Xbim.ModelGeometry.Scene
             return new HashSet<int>(processed.Keys);
         }
 
+        /// <summary>
+        /// Orders the boolean operations, longest first when scheduled by the cost model, and marks the ones estimated to take
+        /// longer than the share of one thread to spread their booleans over several threads
+        /// </summary>
+        private List<XbimProductBooleanInfo> ScheduleBooleans(XbimCreateContextHelper contextHelper, IEnumerable<XbimProductBooleanInfo> ops, XbimBooleanScheduleStatistics statistics)
+        {
+            var workers = contextHelper.ParallelOptions.MaxDegreeOfParallelism > 0 ? contextHelper.ParallelOptions.MaxDegreeOfParallelism : Environment.ProcessorCount;
+            var costModel = BooleanCostModel ?? new XbimBooleanCostModel();
+            var schedule = ops.ToList();
+            foreach (var op in schedule)
+                op.EstimatedCost = costModel.Estimate(op.GetCostFactors());
+            var estimatedTotal = schedule.Sum(op => op.EstimatedCost);
+            if (BooleanScheduling == XbimBooleanScheduling.CostModel)
+            {
+                schedule = schedule.OrderByDescending(op => op.EstimatedCost).ToList();
+                foreach (var op in schedule.TakeWhile(op => op.EstimatedCost > estimatedTotal / workers))
+                {
+                    if (op.OperationCount < 2) continue;
+                    op.RunParallel = true;
+                    statistics.SplitProducts++;
+                }
+            }
+            else
+                schedule = schedule.OrderByDescending(op => op.OperationCount).ToList();
+            statistics.Scheduling = BooleanScheduling;
+            statistics.Workers = workers;
+            statistics.Products = schedule.Count;
+            statistics.EstimatedTotalMs = estimatedTotal;
+            statistics.EstimatedMakespanMs = XbimBooleanScheduleStatistics.SimulateMakespan(schedule.Select(op => op.EstimatedCost), workers);
+            return schedule;
+        }
+
         private XbimMatrix3D ApplyShapeDisplacement(GeometryReference shape, XbimMatrix3D transformation)
         {
             if (!shape.LocalShapeDisplacement.HasValue)
@@ -1017,7 +1476,7 @@ namespace Xbim.ModelGeometry.Scene
             // grids are written here, they are products (parallel loop  below) 
             // but they are not processed there because their representation is (likely) not body (IsBodyRepresentation())
             //
-            foreach (var grid in Model.Instances.OfType<IIfcGrid>())
+            foreach (var grid in Model.Instances.OfType<IIfcGrid>().Where(contextHelper.InShard))
             {
                 if (contextHelper.ShapeLookup.TryGetValue(grid.EntityLabel, out GeometryReference instance) &&
                     grid.Representation != null &&
@@ -1292,12 +1751,140 @@ namespace Xbim.ModelGeometry.Scene
         /// </summary>
         public int MaxThreads { get; set; }
 
+        /// <summary>
+        /// Cancels CreateContext, running OCC algorithms are stopped and an OperationCanceledException is thrown
+        /// </summary>
+        public CancellationToken CancellationToken { get; set; }
+
+        /// <summary>
+        /// The time allowed to build and mesh each representation item, and to cut the openings and add the projections of each product,
+        /// TimeSpan.Zero for no limit. Items over budget are written as empty shapes, products over budget are written without their openings.
+        /// This is in addition to the BooleanTimeOut of the engine
+        /// </summary>
+        public TimeSpan ProductTimeBudget { get; set; }
+
+        /// <summary>
+        /// If true, spheres, cylinders, cones and swept disks along polylines that are not cut or extended by features are meshed directly
+        /// from their parameters by the XbimPrimitiveTessellator, otherwise, the default, they are built as solids by the geometry engine and then meshed.
+        /// The direct meshes are close to but not the same as those of the solids
+        /// </summary>
+        public bool MeshPrimitivesDirectly { get; set; }
+
+        /// <summary>
+        /// If true, tapered extrusions, tapered revolutions and sectioned spines that are not cut or extended by features are meshed straight
+        /// from their cross sections by the geometry engine, otherwise, the default, they are built as solids by lofting their sections and then
+        /// meshed. Only used when the geometry is stored as PolyhedronBinary
+        /// </summary>
+        public bool MeshLoftsDirectly { get; set; }
+
+        /// <summary>
+        /// If true, the convex hull of each shape built as a solid, solid set or compound is kept in HullProxies as a light proxy for its mesh.
+        /// Shapes meshed directly from their primitives or sections get the hull of their mesh, shapes meshed by shard workers have none. False by default
+        /// </summary>
+        public bool CreateHullProxies { get; set; }
+
+        /// <summary>
+        /// The convex hulls made when CreateHullProxies is set, keyed by the IfcShapeLabel of the shape geometry they stand in for. They are
+        /// not written to the geometry store and are cleared when a context is next created
+        /// </summary>
+        public ConcurrentDictionary<int, XbimShapeGeometry> HullProxies { get; } = new ConcurrentDictionary<int, XbimShapeGeometry>();
+
+        /// <summary>
+        /// If set, the time, memory, triangle count and outcome of every representation item and every boolean operation on a product is recorded here
+        /// </summary>
+        public XbimGeometryTelemetry Telemetry { get; set; }
+
+        /// <summary>
+        /// The estimated native bytes the shapes kept for the openings and projections may use, 0, the default, for no limit.
+        /// Over the budget the least recently used shapes are written to a scratch file and read back when they are needed
+        /// </summary>
+        public long GeometryCacheBudget { get; set; }
+
+        /// <summary>
+        /// The folder of the scratch file of the geometry cache, null for the temp folder
+        /// </summary>
+        public string GeometryCacheDirectory { get; set; }
+
+        /// <summary>
+        /// How the geometry cache of the last CreateContext used its budget
+        /// </summary>
+        public XbimGeometryCacheStatistics GeometryCacheStatistics { get; private set; }
+
+        /// <summary>
+        /// The order in which the products with openings and projections are cut, by default the most expensive first
+        /// </summary>
+        public XbimBooleanScheduling BooleanScheduling { get; set; } = XbimBooleanScheduling.CostModel;
+
+        /// <summary>
+        /// Estimates the cost of the booleans of each product for the schedule
+        /// </summary>
+        public XbimBooleanCostModel BooleanCostModel { get; set; } = new XbimBooleanCostModel();
+
+        /// <summary>
+        /// The estimated and measured times of the booleans of the last CreateContext
+        /// </summary>
+        public XbimBooleanScheduleStatistics BooleanScheduleStatistics { get; private set; }
+
+        /// <summary>
+        /// The engine messages of the last CreateContext suppressed as repeats, see XbimGeometryEngine.LogRepeatLimit. They are summarised in the log
+        /// at the end of CreateContext. The counts are process wide, so they include those of any context created at the same time
+        /// </summary>
+        public int SuppressedLogMessages { get; private set; }
+
+        /// <summary>
+        /// If greater than one CreateContext runs this many worker processes, each converting a share of the products, and merges their geometry.
+        /// A crash or leak in the geometry engine then costs only its shard. Needs ShardWorkerPath and the model file. The DeflectionPolicy,
+        /// CustomMeshingBehaviour and Telemetry are not passed to the workers
+        /// </summary>
+        public int ShardWorkers { get; set; }
+
+        /// <summary>
+        /// The executable that runs XbimShardWorker.Run with its command line
+        /// </summary>
+        public string ShardWorkerPath { get; set; }
+
+        /// <summary>
+        /// Arguments put before those of the shard, e.g. to select the worker mode of an executable that does other things
+        /// </summary>
+        public IEnumerable<string> ShardWorkerArguments { get; set; }
+
+        /// <summary>
+        /// The IFC file the workers open, by default the file the IfcStore was opened from. An xbim database is not sharded, the context is
+        /// then created in this process
+        /// </summary>
+        public string ShardSourceFile { get; set; }
+
+        /// <summary>
+        /// The number of times a failed worker is run again
+        /// </summary>
+        public int ShardRetries { get; set; } = 2;
+
+        /// <summary>
+        /// The folder of the files the workers write, null for the temp folder
+        /// </summary>
+        public string ShardDirectory { get; set; }
+
+        /// <summary>
+        /// The shards of the last sharded CreateContext that failed after all retries, their products have no geometry
+        /// </summary>
+        public IReadOnlyList<int> FailedShards { get; private set; }
+
+        /// <summary>
+        /// Set in a worker to convert only the products of shard ShardIndex of ShardCount
+        /// </summary>
+        public int ShardIndex { get; set; }
+
+        public int ShardCount { get; set; }
+
+        internal Dictionary<int, List<XbimBBoxClusterElement>> ShardClusters { get; private set; }
+
         private void WriteShapeGeometries(XbimCreateContextHelper contextHelper, ReportProgressDelegate progDelegate, IGeometryStoreInitialiser geometryStore, XbimGeometryType geomStorageType)
         {
             var localPercentageParsed = contextHelper.PercentageParsed;
             var localTally = contextHelper.Tally;
             // var dedupCount = 0;
             var xbimTessellator = new XbimTessellator(Model, geomStorageType);
+            var primitiveTessellator = new XbimPrimitiveTessellator(Model, geomStorageType);
             //var geomHash = new ConcurrentDictionary<RepresentationItemGeometricHashKey, int>();
 
             //var mapLookup = new ConcurrentDictionary<int, int>();
@@ -1307,7 +1894,7 @@ namespace Xbim.ModelGeometry.Scene
             var deflection = Model.ModelFactors.DeflectionTolerance;
             var deflectionAngle = Model.ModelFactors.DeflectionAngle;
             //if we have any grids turn them in to geometry
-            foreach (var grid in Model.Instances.OfType<IIfcGrid>())
+            foreach (var grid in Model.Instances.OfType<IIfcGrid>().Where(contextHelper.InShard))
             {
                 using (var geomModel = Engine.CreateGrid(grid, _logger))
                 {
@@ -1363,6 +1950,8 @@ namespace Xbim.ModelGeometry.Scene
                     }
                     var isFeatureElementShape = contextHelper.FeatureElementShapeIds.Contains(shapeId);
                     var isVoidedProductShape = contextHelper.VoidedShapeIds.Contains(shapeId);
+                    var telemetry = Telemetry;
+                    var telemetryMark = telemetry != null ? XbimGeometryTelemetry.Mark() : default(XbimTelemetryMark);
 
 
                     // Console.WriteLine(shape.GetType().Name);
@@ -1370,44 +1959,127 @@ namespace Xbim.ModelGeometry.Scene
                     IXbimGeometryObject geomModel = null;
                     if (!isFeatureElementShape && !isVoidedProductShape && xbimTessellator.CanMesh(shape)) // if we can mesh the shape directly just do it
                     {
-                        shapeGeom = xbimTessellator.Mesh(shape);
+                        using (XbimGeometryTrace.Span("Tessellate"))
+                        {
+                            shapeGeom = xbimTessellator.Mesh(shape);
+                        }
                     }
-                    else //we need to create a geometry object
+                    else
                     {
-                        try
+                        if (!isFeatureElementShape && !isVoidedProductShape && MeshPrimitivesDirectly && primitiveTessellator.CanMesh(shape))
                         {
-                            geomModel = Engine.Create(shape, _logger);
+                            //spheres, cylinders, cones and swept disks that take no part in booleans are meshed without a B-rep, null if the shape is degenerate
+                            var shapeDeflection = deflection;
+                            var shapeDeflectionAngle = deflectionAngle;
+                            if (DeflectionPolicy != null)
+                            {
+                                contextHelper.ShapeProducts.TryGetValue(shapeId, out IIfcProduct shapeProduct);
+                                DeflectionPolicy.GetDeflection(shapeProduct, primitiveTessellator.GetBounds(shape), Model.ModelFactors, ref shapeDeflection, ref shapeDeflectionAngle);
+                            }
+                            using (XbimGeometryTrace.Span("MeshPrimitive"))
+                            {
+                                shapeGeom = primitiveTessellator.Mesh(shape, shapeDeflection, shapeDeflectionAngle);
+                            }
                         }
-                        catch (XbimGeometryFaceSetTooLargeException fse)
+                        if (shapeGeom == null && !isFeatureElementShape && !isVoidedProductShape && MeshLoftsDirectly && geomStorageType == XbimGeometryType.PolyhedronBinary &&
+                            (shape is IIfcExtrudedAreaSolidTapered || shape is IIfcRevolvedAreaSolidTapered || shape is IIfcSectionedSpine))
                         {
-                            int faceSetEntityLabel = (int)fse.Data["LargeFaceSetLabel"];
-                            string faceSetEntityType = (string)fse.Data["LargeFaceSetType"];
-                            _logger.LogWarning("Large Face Set #{0} {1} detected and handled as Mesh", faceSetEntityLabel, faceSetEntityType);
-
-                            //just mesh the big shape as we have no idea what we shoudl have               
-                            shapeGeom = xbimTessellator.Mesh((IIfcRepresentationItem)Model.Instances[faceSetEntityLabel]);
+                            //lofts that take no part in booleans are meshed from their sections, null if they cannot be and the B-rep is built instead
+                            var shapeDeflection = deflection;
+                            var shapeDeflectionAngle = deflectionAngle;
+                            if (DeflectionPolicy != null)
+                            {
+                                //the bounds come from the placed sections, so the loft is only meshed once
+                                contextHelper.ShapeProducts.TryGetValue(shapeId, out IIfcProduct shapeProduct);
+                                DeflectionPolicy.GetDeflection(shapeProduct, Engine.LoftBounds(shape, _logger), Model.ModelFactors, ref shapeDeflection, ref shapeDeflectionAngle);
+                            }
+                            using (XbimGeometryTrace.Span("MeshLoft"))
+                            {
+                                shapeGeom = Engine.CreateLoftShapeGeometry(shape, shapeDeflection, shapeDeflectionAngle, _logger);
+                            }
                         }
-                        if (geomModel != null && geomModel.IsValid)
+                        if (shapeGeom != null && CreateHullProxies)
                         {
-
-                            shapeGeom = Engine.CreateShapeGeometry(geomModel, precision, deflection, deflectionAngle, geomStorageType, _logger);
-                            if (isFeatureElementShape)
+                            //the shape was meshed directly and has no B-rep, the hull is taken from its mesh
+                            using (XbimGeometryTrace.Span("Hull"))
                             {
-                                var geomSet = geomModel as IXbimGeometryObjectSet;
-                                if (geomSet != null)
+                                var hull = Engine.CreateHullShapeGeometry(shapeGeom);
+                                if (hull != null)
+                                {
+                                    hull.IfcShapeLabel = shapeId;
+                                    HullProxies[shapeId] = hull;
+                                }
+                            }
+                        }
+                        if (shapeGeom == null) //we need to create a geometry object
+                        {
+                            // the intermediate shapes of the conversion are released as soon as the item is written, only cached shapes are kept
+                            using (var session = new XbimGeometrySession(shape))
+                            using (XbimGeometryCancellation.Enter(CancellationToken, ProductTimeBudget))
+                            {
+                                try
+                                {
+                                    using (XbimGeometryTrace.Span("Create"))
+                                    {
+                                        geomModel = Engine.Create(shape, _logger);
+                                    }
+                                }
+                                catch (XbimGeometryFaceSetTooLargeException fse)
+                                {
+                                    int faceSetEntityLabel = (int)fse.Data["LargeFaceSetLabel"];
+                                    string faceSetEntityType = (string)fse.Data["LargeFaceSetType"];
+                                    _logger.LogWarning("Large Face Set #{0} {1} detected and handled as Mesh", faceSetEntityLabel, faceSetEntityType);
+
+                                    //just mesh the big shape as we have no idea what we shoudl have               
+                                    shapeGeom = xbimTessellator.Mesh((IIfcRepresentationItem)Model.Instances[faceSetEntityLabel]);
+                                }
+                                if (telemetry != null)
+                                    telemetryMark = telemetry.RecordCreate(shape, telemetryMark, shapeGeom != null || (geomModel != null && geomModel.IsValid));
+                                if (geomModel != null && geomModel.IsValid)
                                 {
-                                    var solidSet = Engine.CreateSolidSet();
-                                    solidSet.Add(geomSet);
-                                    contextHelper.CachedGeometries.TryAdd(shapeId, solidSet);
+                                    var shapeDeflection = deflection;
+                                    var shapeDeflectionAngle = deflectionAngle;
+                                    if (DeflectionPolicy != null)
+                                    {
+                                        contextHelper.ShapeProducts.TryGetValue(shapeId, out IIfcProduct shapeProduct);
+                                        DeflectionPolicy.GetDeflection(shapeProduct, geomModel.BoundingBox, Model.ModelFactors, ref shapeDeflection, ref shapeDeflectionAngle);
+                                    }
+                                    using (XbimGeometryTrace.Span("CreateShapeGeometry"))
+                                    {
+                                        shapeGeom = Engine.CreateShapeGeometry(geomModel, precision, shapeDeflection, shapeDeflectionAngle, geomStorageType, _logger);
+                                    }
+                                    if (CreateHullProxies)
+                                    {
+                                        using (XbimGeometryTrace.Span("Hull"))
+                                        {
+                                            var hull = Engine.CreateHullShapeGeometry(geomModel, shapeDeflection, shapeDeflectionAngle);
+                                            if (hull != null)
+                                            {
+                                                hull.IfcShapeLabel = shapeId;
+                                                HullProxies[shapeId] = hull;
+                                            }
+                                        }
+                                    }
+                                    if (isFeatureElementShape)
+                                    {
+                                        var geomSet = geomModel as IXbimGeometryObjectSet;
+                                        if (geomSet != null)
+                                        {
+                                            var solidSet = Engine.CreateSolidSet();
+                                            solidSet.Add(geomSet);
+                                            contextHelper.CacheGeometry(shapeId, solidSet, Engine);
+                                        }
+                                        //we need for boolean operations later, add the polyhedron if the face is planar
+                                        else contextHelper.CacheGeometry(shapeId, geomModel, Engine);
+                                    }
+                                    else if (isVoidedProductShape)
+                                        contextHelper.CacheGeometry(shapeId, geomModel, Engine);
                                 }
-                                //we need for boolean operations later, add the polyhedron if the face is planar
-                                else contextHelper.CachedGeometries.TryAdd(shapeId, geomModel);
                             }
-                            else if (isVoidedProductShape)
-                                contextHelper.CachedGeometries.TryAdd(shapeId, geomModel);
                         }
                     }
 
+                    telemetry?.RecordMesh(shape, telemetryMark, shapeGeom?.ShapeData);
                     if (shapeGeom == null || shapeGeom.ShapeData == null || shapeGeom.ShapeData.Length == 0)
                         LogInfo(_model.Instances[shapeId], "Is an empty shape");
                     else
@@ -0,0 +1,160 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Linq;
+using Xbim.Geometry.Engine.Interop;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// The order in which the products with openings and projections are cut
+    /// </summary>
+    public enum XbimBooleanScheduling
+    {
+        /// <summary>
+        /// Products with the most openings and projections first
+        /// </summary>
+        OperandCount,
+        /// <summary>
+        /// Products with the highest estimated cost first, each idle thread takes the next product. The products estimated to take
+        /// longer than the share of one thread spread their booleans over several threads
+        /// </summary>
+        CostModel
+    }
+
+    /// <summary>
+    /// What is known about the booleans of a product before its geometry is loaded
+    /// </summary>
+    public struct XbimBooleanCostFactors
+    {
+        public int ProductLabel;
+        public int ProductFaces;
+        public int ProductCurvedFaces;
+        /// <summary>
+        /// The openings and projections
+        /// </summary>
+        public int Tools;
+        /// <summary>
+        /// The tools whose bounding box intersects the bounding box of the product, the others are screened out by the boolean
+        /// </summary>
+        public int OverlappingTools;
+        /// <summary>
+        /// The faces of the overlapping tools
+        /// </summary>
+        public int ToolFaces;
+        public int ToolCurvedFaces;
+    }
+
+    /// <summary>
+    /// Estimates the time in milliseconds the booleans of a product take. Override Estimate to calibrate it for a particular kind of model
+    /// </summary>
+    public class XbimBooleanCostModel
+    {
+        /// <summary>
+        /// The cost of a curved face relative to a planar one, the intersection of curved faces is approximated and far slower
+        /// </summary>
+        public double CurvedFaceWeight { get; set; } = 8;
+
+        /// <summary>
+        /// Milliseconds per pair of faces that may intersect
+        /// </summary>
+        public double MillisecondsPerFacePair { get; set; } = 0.02;
+
+        /// <summary>
+        /// Milliseconds for a boolean whatever its size
+        /// </summary>
+        public double MillisecondsPerProduct { get; set; } = 1;
+
+        /// <summary>
+        /// If set, the boolean time recorded for a product by an earlier run is used in place of the estimate, e.g. the
+        /// Xbim3DModelContext.Telemetry of the previous conversion of the same model
+        /// </summary>
+        public XbimGeometryTelemetry History { get; set; }
+
+        private Dictionary<int, double> _history;
+        private XbimGeometryTelemetry _historySource;
+
+        public virtual double Estimate(XbimBooleanCostFactors factors)
+        {
+            if (TryGetHistory(factors.ProductLabel, out double booleanMs))
+                return booleanMs;
+            var productFaces = factors.ProductFaces + CurvedFaceWeight * factors.ProductCurvedFaces;
+            var toolFaces = factors.ToolFaces + CurvedFaceWeight * factors.ToolCurvedFaces;
+            // every face of the product is intersected with the faces of the tools that overlap it, the tools are also intersected with each other
+            var toolPairs = factors.OverlappingTools > 1 ? toolFaces * toolFaces / factors.OverlappingTools : 0;
+            return MillisecondsPerProduct + MillisecondsPerFacePair * (productFaces * toolFaces + toolPairs);
+        }
+
+        private bool TryGetHistory(int productLabel, out double booleanMs)
+        {
+            booleanMs = 0;
+            var history = History;
+            if (history == null)
+                return false;
+            if (!ReferenceEquals(history, _historySource))
+            {
+                _history = history.Records.Where(r => r.BooleanMs > 0).ToDictionary(r => r.EntityLabel, r => r.BooleanMs);
+                _historySource = history;
+            }
+            return _history.TryGetValue(productLabel, out booleanMs);
+        }
+    }
+
+    /// <summary>
+    /// How the booleans of the last CreateContext were scheduled
+    /// </summary>
+    public class XbimBooleanScheduleStatistics
+    {
+        public XbimBooleanScheduling Scheduling { get; internal set; }
+        public int Workers { get; internal set; }
+        public int Products { get; internal set; }
+        /// <summary>
+        /// The products whose booleans were spread over several threads
+        /// </summary>
+        public int SplitProducts { get; internal set; }
+        /// <summary>
+        /// The sum of the estimated costs in milliseconds
+        /// </summary>
+        public double EstimatedTotalMs { get; internal set; }
+        /// <summary>
+        /// The time the products would take on the workers in the scheduled order if the estimates were exact
+        /// </summary>
+        public double EstimatedMakespanMs { get; internal set; }
+        /// <summary>
+        /// The sum of the times taken by the products
+        /// </summary>
+        public double TotalMs { get; internal set; }
+        /// <summary>
+        /// The elapsed time from the start of the first product to the end of the last
+        /// </summary>
+        public double MakespanMs { get; internal set; }
+        /// <summary>
+        /// The longest time taken by a single product, no schedule finishes sooner
+        /// </summary>
+        public double LongestProductMs { get; internal set; }
+
+        /// <summary>
+        /// The time the products would take on the workers with a perfect division of the work, TotalMs / Workers
+        /// </summary>
+        public double IdealMakespanMs
+        {
+            get { return Workers > 0 ? Math.Max(TotalMs / Workers, LongestProductMs) : 0; }
+        }
+
+        /// <summary>
+        /// Assigns each cost in turn to the least loaded worker, as the threads of the parallel loop take the next product when idle,
+        /// and returns the largest load
+        /// </summary>
+        public static double SimulateMakespan(IEnumerable<double> costsInOrder, int workers)
+        {
+            var loads = new double[Math.Max(1, workers)];
+            foreach (var cost in costsInOrder)
+            {
+                var least = 0;
+                for (var i = 1; i < loads.Length; i++)
+                    if (loads[i] < loads[least]) least = i;
+                loads[least] += cost;
+            }
+            return loads.Max();
+        }
+    }
+}
@@ -0,0 +1,238 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Threading.Tasks;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// A bounding volume hierarchy over axis aligned boxes, held in flat arrays. Each node splits its boxes at the median of their centres
+    /// along the axis the centres spread furthest, so the layout of the nodes depends only on the number of boxes and the two halves of a
+    /// large node are built in parallel. The first child of a node follows it. A built tree is only read, it may be queried from many threads
+    /// </summary>
+    internal sealed class XbimBoxTree
+    {
+        public const int LeafSize = 4;
+        private const int ParallelSize = 8192;
+
+        // the boxes of the items and of the nodes as min x, y, z then max x, y, z
+        private readonly double[] _boxes;
+        private readonly double[] _nodeBoxes;
+        // the second child of an inner node, -1 for a leaf
+        private readonly int[] _secondChild;
+        // the positions in _items of the items of each leaf
+        private readonly int[] _first;
+        private readonly int[] _count;
+        // the items in the order of the leaves
+        private readonly int[] _items;
+
+        /// <param name="boxes">Six values for each item, the tree keeps the array</param>
+        /// <param name="count">The number of items</param>
+        /// <param name="runParallel">Builds the halves of large nodes on other threads</param>
+        public XbimBoxTree(double[] boxes, int count, bool runParallel)
+        {
+            _boxes = boxes;
+            _items = new int[count];
+            for (int i = 0; i < count; i++)
+                _items[i] = i;
+            var nodeCount = count == 0 ? 0 : 2 * Leaves(count) - 1;
+            _nodeBoxes = new double[6 * nodeCount];
+            _secondChild = new int[nodeCount];
+            _first = new int[nodeCount];
+            _count = new int[nodeCount];
+            if (count > 0)
+                Build(0, 0, count, runParallel);
+        }
+
+        public int Count
+        {
+            get { return _items.Length; }
+        }
+
+        public int NodeCount
+        {
+            get { return _secondChild.Length; }
+        }
+
+        /// <summary>
+        /// The boxes of the nodes, six values for each
+        /// </summary>
+        public double[] NodeBoxes
+        {
+            get { return _nodeBoxes; }
+        }
+
+        public bool IsLeaf(int node)
+        {
+            return _secondChild[node] < 0;
+        }
+
+        public int SecondChild(int node)
+        {
+            return _secondChild[node];
+        }
+
+        /// <summary>
+        /// The position of the first item of a leaf, the items of a leaf are at consecutive positions
+        /// </summary>
+        public int First(int node)
+        {
+            return _first[node];
+        }
+
+        public int ItemCount(int node)
+        {
+            return _count[node];
+        }
+
+        /// <summary>
+        /// The item at a position in the order of the leaves, neighbouring positions hold nearby boxes
+        /// </summary>
+        public int Item(int position)
+        {
+            return _items[position];
+        }
+
+        /// <summary>
+        /// Adds the items whose boxes come within the margin of the box to the list. The stack is grown as needed and may be reused
+        /// </summary>
+        public void Overlapping(double minX, double minY, double minZ, double maxX, double maxY, double maxZ, double margin, List<int> items, ref int[] stack)
+        {
+            if (NodeCount == 0)
+                return;
+            minX -= margin; minY -= margin; minZ -= margin;
+            maxX += margin; maxY += margin; maxZ += margin;
+            var top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                var node = stack[--top];
+                var b = 6 * node;
+                if (_nodeBoxes[b] > maxX || _nodeBoxes[b + 1] > maxY || _nodeBoxes[b + 2] > maxZ ||
+                    _nodeBoxes[b + 3] < minX || _nodeBoxes[b + 4] < minY || _nodeBoxes[b + 5] < minZ)
+                    continue;
+                if (_secondChild[node] < 0)
+                {
+                    for (int p = _first[node], end = p + _count[node]; p < end; p++)
+                    {
+                        var item = _items[p];
+                        var i = 6 * item;
+                        if (_boxes[i] <= maxX && _boxes[i + 1] <= maxY && _boxes[i + 2] <= maxZ &&
+                            _boxes[i + 3] >= minX && _boxes[i + 4] >= minY && _boxes[i + 5] >= minZ)
+                            items.Add(item);
+                    }
+                    continue;
+                }
+                if (top + 2 > stack.Length)
+                    Array.Resize(ref stack, 2 * stack.Length);
+                stack[top++] = _secondChild[node];
+                stack[top++] = node + 1;
+            }
+        }
+
+        // the leaves of a node of count items, a node of 2 * Leaves - 1 nodes
+        private static int Leaves(int count)
+        {
+            return count <= LeafSize ? 1 : Leaves(count / 2) + Leaves(count - count / 2);
+        }
+
+        private void Build(int node, int first, int count, bool runParallel)
+        {
+            if (count <= LeafSize)
+            {
+                _secondChild[node] = -1;
+                _first[node] = first;
+                _count[node] = count;
+                var n = 6 * node;
+                var i = 6 * _items[first];
+                for (int k = 0; k < 6; k++)
+                    _nodeBoxes[n + k] = _boxes[i + k];
+                for (int p = first + 1; p < first + count; p++)
+                    Union(n, _boxes, 6 * _items[p]);
+                return;
+            }
+
+            // the axis along which the centres spread furthest
+            double minX = double.MaxValue, minY = double.MaxValue, minZ = double.MaxValue;
+            double maxX = double.MinValue, maxY = double.MinValue, maxZ = double.MinValue;
+            for (int p = first; p < first + count; p++)
+            {
+                var i = 6 * _items[p];
+                var x = _boxes[i] + _boxes[i + 3];
+                var y = _boxes[i + 1] + _boxes[i + 4];
+                var z = _boxes[i + 2] + _boxes[i + 5];
+                if (x < minX) minX = x;
+                if (x > maxX) maxX = x;
+                if (y < minY) minY = y;
+                if (y > maxY) maxY = y;
+                if (z < minZ) minZ = z;
+                if (z > maxZ) maxZ = z;
+            }
+            var axis = 0;
+            if (maxY - minY > maxX - minX)
+                axis = 1;
+            if (maxZ - minZ > Math.Max(maxX - minX, maxY - minY))
+                axis = 2;
+
+            var half = count / 2;
+            Select(first, first + count - 1, first + half, axis);
+            var left = node + 1;
+            var right = node + 2 * Leaves(half);
+            _secondChild[node] = right;
+            if (runParallel && count >= ParallelSize)
+                Parallel.Invoke(() => Build(left, first, half, true), () => Build(right, first + half, count - half, true));
+            else
+            {
+                Build(left, first, half, runParallel);
+                Build(right, first + half, count - half, runParallel);
+            }
+            for (int k = 0; k < 6; k++)
+                _nodeBoxes[6 * node + k] = _nodeBoxes[6 * left + k];
+            Union(6 * node, _nodeBoxes, 6 * right);
+        }
+
+        private void Union(int n, double[] boxes, int i)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                _nodeBoxes[n + k] = Math.Min(_nodeBoxes[n + k], boxes[i + k]);
+                _nodeBoxes[n + k + 3] = Math.Max(_nodeBoxes[n + k + 3], boxes[i + k + 3]);
+            }
+        }
+
+        private double Centre(int item, int axis)
+        {
+            return _boxes[6 * item + axis] + _boxes[6 * item + axis + 3];
+        }
+
+        // moves the items between lo and hi so that the one at k has no centre further along the axis before it and none nearer after it
+        private void Select(int lo, int hi, int k, int axis)
+        {
+            while (hi > lo)
+            {
+                var pivot = Centre(_items[(lo + hi) >> 1], axis);
+                int i = lo, j = hi;
+                while (i <= j)
+                {
+                    while (Centre(_items[i], axis) < pivot)
+                        i++;
+                    while (Centre(_items[j], axis) > pivot)
+                        j--;
+                    if (i <= j)
+                    {
+                        var swap = _items[i];
+                        _items[i] = _items[j];
+                        _items[j] = swap;
+                        i++;
+                        j--;
+                    }
+                }
+                if (k <= j)
+                    hi = j;
+                else if (k >= i)
+                    lo = i;
+                else
+                    return;
+            }
+        }
+    }
+}
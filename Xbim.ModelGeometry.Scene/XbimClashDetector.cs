@@ -0,0 +1,1095 @@
+﻿using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Linq;
+using System.Threading;
+using System.Threading.Tasks;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+using Xbim.Geometry.Engine.Interop;
+using Xbim.Ifc4.Interfaces;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    public enum XbimClashType
+    {
+        /// <summary>
+        /// The meshes pass into each other by more than the tolerance, or one holds the other
+        /// </summary>
+        Hard,
+        /// <summary>
+        /// The meshes do not pass into each other but come within the clearance
+        /// </summary>
+        Clearance
+    }
+
+    /// <summary>
+    /// Two shape instances that clash, A is the one read first
+    /// </summary>
+    public struct XbimClash
+    {
+        public int InstanceLabelA;
+        public int InstanceLabelB;
+        public int ProductLabelA;
+        public int ProductLabelB;
+        public XbimClashType Type;
+        /// <summary>
+        /// The shortest distance between the meshes of a clearance clash, 0 for a hard clash
+        /// </summary>
+        public double Distance;
+    }
+
+    /// <summary>
+    /// What the last FindClashes did, complete once its clashes have all been read
+    /// </summary>
+    public class XbimClashStatistics
+    {
+        /// <summary>
+        /// The shape instances that passed the filter
+        /// </summary>
+        public int Instances { get; internal set; }
+        /// <summary>
+        /// The time taken to read the instances and build the tree of their boxes
+        /// </summary>
+        public long BuildMilliseconds { get; internal set; }
+        /// <summary>
+        /// The pairs of instances whose boxes come within the clearance of each other
+        /// </summary>
+        public long CandidatePairs { get; internal set; }
+        /// <summary>
+        /// The candidate pairs whose meshes were tested
+        /// </summary>
+        public long TestedPairs { get; internal set; }
+        /// <summary>
+        /// The candidate pairs not tested because a shape geometry is not stored as PolyhedronBinary or has no triangles
+        /// </summary>
+        public long SkippedPairs { get; internal set; }
+        public long HardClashes { get; internal set; }
+        public long ClearanceClashes { get; internal set; }
+        /// <summary>
+        /// The number of times a shape geometry was read and indexed, a geometry dropped from the cache is read again when next needed
+        /// </summary>
+        public int MeshesRead { get; internal set; }
+        public int MeshesEvicted { get; internal set; }
+        /// <summary>
+        /// The largest estimated size of the meshes held by the cache at any one time
+        /// </summary>
+        public long PeakMeshBytes { get; internal set; }
+        public long ElapsedMilliseconds { get; internal set; }
+    }
+
+    /// <summary>
+    /// Finds the shape instances whose meshes pass into each other or come within a clearance. The world boxes of the instances are put in
+    /// a bounding volume hierarchy, each instance looks for the boxes near its own and the triangles of each pair found are tested against
+    /// each other through the bounding volume hierarchies of their meshes. A mesh is read once for all the instances that share its shape
+    /// geometry and is tested in place, the transform of the instance is applied to the nodes and triangles as they are reached. The meshes
+    /// are kept in a cache limited to MeshCacheBudget, the instances are visited in the order of the tree so that neighbours share it.
+    /// Apart from the meshes each instance takes around 200 bytes, clashes are handed to the caller as they are found.
+    /// The meshes are expected to be closed and outward facing, as CreateContext writes them
+    /// </summary>
+    public class XbimClashDetector
+    {
+        private readonly Func<int, XbimShapeGeometry> _shapeGeometry;
+        private readonly Func<IEnumerable<XbimShapeInstance>> _shapeInstances;
+        private readonly object _statisticsLock = new object();
+
+        /// <summary>
+        /// Finds the clashes between the instances of a context. By default only the shapes of products with their openings and
+        /// projections applied are used, features and spatial elements are left out, and the tolerance is the precision of the model
+        /// </summary>
+        public XbimClashDetector(Xbim3DModelContext context)
+        {
+            var model = context.Model;
+            var readLock = new object();
+            _shapeGeometry = label =>
+            {
+                lock (readLock) return context.ShapeGeometry(label);
+            };
+            _shapeInstances = context.ShapeInstances;
+            InstanceFilter = instance => instance.RepresentationType == XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded &&
+                !IsFeatureOrSpatialElement(model, instance.IfcTypeId);
+            Tolerance = model.ModelFactors.Precision;
+        }
+
+        /// <param name="shapeGeometry">Gets a shape geometry by its label, it may be called from several threads at once</param>
+        public XbimClashDetector(Func<int, XbimShapeGeometry> shapeGeometry)
+        {
+            _shapeGeometry = shapeGeometry;
+            InstanceFilter = instance => instance.RepresentationType == XbimGeometryRepresentationType.OpeningsAndAdditionsIncluded;
+        }
+
+        /// <summary>
+        /// How far one mesh must pass into another for a hard clash
+        /// </summary>
+        public double Tolerance { get; set; }
+
+        /// <summary>
+        /// Meshes that do not pass into each other but come this close are clearance clashes, 0 or less, the default, finds hard clashes only
+        /// </summary>
+        public double Clearance { get; set; }
+
+        /// <summary>
+        /// The instances to test, null for all
+        /// </summary>
+        public Func<XbimShapeInstance, bool> InstanceFilter { get; set; }
+
+        /// <summary>
+        /// If true, instances of the same product are tested against each other, false by default
+        /// </summary>
+        public bool IncludeSameProduct { get; set; }
+
+        /// <summary>
+        /// Defines the maximum number of threads to use, any value less than 1 is not used
+        /// </summary>
+        public int MaxThreads { get; set; }
+
+        /// <summary>
+        /// The estimated bytes the meshes kept between pairs may use, 0 for no limit. Over the budget the least recently used are dropped.
+        /// Each thread holds the two meshes it is testing on top of this
+        /// </summary>
+        public long MeshCacheBudget { get; set; } = 256L << 20;
+
+        /// <summary>
+        /// The number of clashes found ahead of the caller, the search waits while this many are unread
+        /// </summary>
+        public int ResultBufferSize { get; set; } = 4096;
+
+        public XbimClashStatistics Statistics { get; private set; }
+
+        /// <summary>
+        /// Finds the clashes between the instances of the context the detector was made for
+        /// </summary>
+        public IEnumerable<XbimClash> FindClashes(CancellationToken cancellationToken = default(CancellationToken))
+        {
+            if (_shapeInstances == null)
+                throw new InvalidOperationException("The detector was not made for a context, pass the shape instances to test");
+            return FindClashes(_shapeInstances(), cancellationToken);
+        }
+
+        /// <summary>
+        /// Finds the clashes between the instances. The search runs on other threads as the clashes are read, the order in which they are
+        /// returned varies from run to run. Stopping early stops the search
+        /// </summary>
+        public IEnumerable<XbimClash> FindClashes(IEnumerable<XbimShapeInstance> shapeInstances, CancellationToken cancellationToken = default(CancellationToken))
+        {
+            var statistics = new XbimClashStatistics();
+            Statistics = statistics;
+            var watch = Stopwatch.StartNew();
+            var count = 0;
+            var instances = new Instance[1024];
+            var boxes = new double[6 * instances.Length];
+            var filter = InstanceFilter;
+            foreach (var shapeInstance in shapeInstances)
+            {
+                if (filter != null && !filter(shapeInstance))
+                    continue;
+                var bounds = shapeInstance.BoundingBox;
+                if (bounds.IsEmpty)
+                    continue;
+                if (count == instances.Length)
+                {
+                    Array.Resize(ref instances, 2 * count);
+                    Array.Resize(ref boxes, 12 * count);
+                }
+                var frame = new Frame(shapeInstance.Transformation);
+                instances[count] = new Instance
+                {
+                    InstanceLabel = shapeInstance.InstanceLabel,
+                    ProductLabel = shapeInstance.IfcProductLabel,
+                    GeometryLabel = shapeInstance.ShapeGeometryLabel,
+                    Frame = frame
+                };
+                var local = new[] { bounds.X, bounds.Y, bounds.Z, bounds.X + bounds.SizeX, bounds.Y + bounds.SizeY, bounds.Z + bounds.SizeZ };
+                frame.ApplyBox(local, 0, boxes, 6 * count);
+                count++;
+            }
+            statistics.Instances = count;
+            XbimBoxTree tree;
+            using (XbimGeometryTrace.Span("ClashTree"))
+                tree = new XbimBoxTree(boxes, count, MaxThreads != 1);
+            statistics.BuildMilliseconds = watch.ElapsedMilliseconds;
+
+            var cache = new MeshCache(_shapeGeometry, MeshCacheBudget);
+            var results = new BlockingCollection<XbimClash>(Math.Max(1, ResultBufferSize));
+            var cancellation = CancellationTokenSource.CreateLinkedTokenSource(cancellationToken);
+            var options = new ParallelOptions { CancellationToken = cancellation.Token };
+            if (MaxThreads > 0)
+                options.MaxDegreeOfParallelism = MaxThreads;
+            var search = new Search
+            {
+                Tolerance = Math.Max(0, Tolerance),
+                Clearance = Math.Max(0, Clearance),
+                IncludeSameProduct = IncludeSameProduct,
+                Instances = instances,
+                Boxes = boxes,
+                Tree = tree,
+                Cache = cache
+            };
+            // in the order of the leaves, so the instances a thread takes in turn are near each other
+            var task = Task.Run(() =>
+            {
+                try
+                {
+                    Parallel.For(0, count, options, () => new Worker(), (position, loop, worker) =>
+                    {
+                        search.Run(tree.Item(position), worker, results, cancellation.Token);
+                        return worker;
+                    }, worker =>
+                    {
+                        lock (_statisticsLock)
+                        {
+                            statistics.CandidatePairs += worker.CandidatePairs;
+                            statistics.TestedPairs += worker.TestedPairs;
+                            statistics.SkippedPairs += worker.SkippedPairs;
+                            statistics.HardClashes += worker.HardClashes;
+                            statistics.ClearanceClashes += worker.ClearanceClashes;
+                        }
+                    });
+                }
+                finally
+                {
+                    results.CompleteAdding();
+                }
+            });
+            try
+            {
+                foreach (var clash in results.GetConsumingEnumerable(cancellationToken))
+                    yield return clash;
+                task.GetAwaiter().GetResult();
+            }
+            finally
+            {
+                // stops the search if the caller stopped reading, the error of a failed search has been thrown above
+                cancellation.Cancel();
+                try
+                {
+                    task.Wait();
+                }
+                catch (AggregateException)
+                {
+                }
+                cancellation.Dispose();
+                results.Dispose();
+                lock (_statisticsLock)
+                {
+                    statistics.MeshesRead = cache.Read;
+                    statistics.MeshesEvicted = cache.Evicted;
+                    statistics.PeakMeshBytes = cache.PeakBytes;
+                    statistics.ElapsedMilliseconds = watch.ElapsedMilliseconds;
+                }
+            }
+        }
+
+        private static bool IsFeatureOrSpatialElement(IModel model, short typeId)
+        {
+            var type = model.Metadata.GetType(typeId);
+            return type != null && (typeof(IIfcFeatureElement).IsAssignableFrom(type) || typeof(IIfcSpatialElement).IsAssignableFrom(type));
+        }
+
+        private struct Instance
+        {
+            public int InstanceLabel;
+            public int ProductLabel;
+            public int GeometryLabel;
+            public Frame Frame;
+        }
+
+        // the state of one thread of the search
+        private class Worker
+        {
+            public readonly List<int> Hits = new List<int>();
+            public int[] Stack = new int[64];
+            public int[] Pairs = new int[128];
+            public readonly double[] BoxA = new double[6];
+            public readonly double[] BoxB = new double[6];
+            public readonly Vec[] TrianglesA = new Vec[3 * XbimBoxTree.LeafSize];
+            public readonly Vec[] TrianglesB = new Vec[3 * XbimBoxTree.LeafSize];
+            public readonly double[] TriangleBoxesA = new double[6 * XbimBoxTree.LeafSize];
+            public readonly double[] TriangleBoxesB = new double[6 * XbimBoxTree.LeafSize];
+            public long CandidatePairs;
+            public long TestedPairs;
+            public long SkippedPairs;
+            public long HardClashes;
+            public long ClearanceClashes;
+        }
+
+        private class Search
+        {
+            // rays that run along no edge or face of the usual axis aligned or mitred shapes, the next is tried when one grazes an edge
+            private static readonly Vec[] Rays = { new Vec(0.3129, 0.5281, 0.7893), new Vec(-0.6712, 0.2234, 0.7068), new Vec(0.4471, -0.8363, 0.3172) };
+            // how close to an edge of a triangle, in its barycentric coordinates, a crossing is too close to call
+            private const double EdgeMargin = 1e-6;
+
+            public double Tolerance;
+            public double Clearance;
+            public bool IncludeSameProduct;
+            public Instance[] Instances;
+            public double[] Boxes;
+            public XbimBoxTree Tree;
+            public MeshCache Cache;
+
+            public void Run(int a, Worker worker, BlockingCollection<XbimClash> results, CancellationToken cancellationToken)
+            {
+                var i = 6 * a;
+                worker.Hits.Clear();
+                Tree.Overlapping(Boxes[i], Boxes[i + 1], Boxes[i + 2], Boxes[i + 3], Boxes[i + 4], Boxes[i + 5], Clearance, worker.Hits, ref worker.Stack);
+                foreach (var b in worker.Hits)
+                {
+                    // each pair once, from the instance read first
+                    if (b <= a || (!IncludeSameProduct && Instances[a].ProductLabel == Instances[b].ProductLabel))
+                        continue;
+                    worker.CandidatePairs++;
+                    XbimClash clash;
+                    if (Test(Instances[a], Instances[b], a, b, worker, out clash))
+                    {
+                        if (clash.Type == XbimClashType.Hard)
+                            worker.HardClashes++;
+                        else
+                            worker.ClearanceClashes++;
+                        results.Add(clash, cancellationToken);
+                    }
+                }
+            }
+
+            private bool Test(Instance instanceA, Instance instanceB, int a, int b, Worker worker, out XbimClash clash)
+            {
+                clash = new XbimClash
+                {
+                    InstanceLabelA = instanceA.InstanceLabel,
+                    InstanceLabelB = instanceB.InstanceLabel,
+                    ProductLabelA = instanceA.ProductLabel,
+                    ProductLabelB = instanceB.ProductLabel
+                };
+                var meshA = Cache.Get(instanceA.GeometryLabel);
+                var meshB = Cache.Get(instanceB.GeometryLabel);
+                if (meshA == null || meshB == null)
+                {
+                    worker.SkippedPairs++;
+                    return false;
+                }
+                worker.TestedPairs++;
+                var frameA = instanceA.Frame;
+                var frameB = instanceB.Frame;
+                // the meshes are stored as floats, planes closer than their rounding are the same plane
+                var numeric = 1e-6 * Math.Max(meshA.Size * frameA.Scale, meshB.Size * frameB.Scale);
+                var depth = Math.Max(Tolerance, numeric);
+                var signA = frameA.Mirrored ? -1 : 1;
+                var signB = frameB.Mirrored ? -1 : 1;
+                var best = double.MaxValue;
+
+                var treeA = meshA.Tree;
+                var treeB = meshB.Tree;
+                var pairs = worker.Pairs;
+                var top = 0;
+                pairs[top++] = 0;
+                pairs[top++] = 0;
+                while (top > 0)
+                {
+                    var nodeB = pairs[--top];
+                    var nodeA = pairs[--top];
+                    frameA.ApplyBox(treeA.NodeBoxes, 6 * nodeA, worker.BoxA, 0);
+                    frameB.ApplyBox(treeB.NodeBoxes, 6 * nodeB, worker.BoxB, 0);
+                    var gap = Gap(worker.BoxA, 0, worker.BoxB, 0);
+                    // only boxes that overlap can hold triangles that pass through each other
+                    if (gap > Clearance + numeric || (gap > numeric && gap >= best))
+                        continue;
+                    var leafA = treeA.IsLeaf(nodeA);
+                    var leafB = treeB.IsLeaf(nodeB);
+                    if (leafA && leafB)
+                    {
+                        var countA = Place(meshA, frameA, nodeA, worker.TrianglesA, worker.TriangleBoxesA);
+                        var countB = Place(meshB, frameB, nodeB, worker.TrianglesB, worker.TriangleBoxesB);
+                        for (int i = 0; i < countA; i++)
+                        {
+                            for (int j = 0; j < countB; j++)
+                            {
+                                // the box of a leaf may span a whole face, those of its triangles screen most pairs
+                                gap = Gap(worker.TriangleBoxesA, 6 * i, worker.TriangleBoxesB, 6 * j);
+                                if (gap <= numeric && Penetrates(worker.TrianglesA, 3 * i, signA, worker.TrianglesB, 3 * j, signB, depth, numeric))
+                                {
+                                    clash.Type = XbimClashType.Hard;
+                                    return true;
+                                }
+                                if (Clearance > 0 && gap <= Clearance && gap < best)
+                                    best = Math.Min(best, Distance(worker.TrianglesA, 3 * i, worker.TrianglesB, 3 * j));
+                            }
+                        }
+                        continue;
+                    }
+                    if (top + 4 > pairs.Length)
+                    {
+                        Array.Resize(ref pairs, 2 * pairs.Length);
+                        worker.Pairs = pairs;
+                    }
+                    // splits the larger box
+                    if (!leafA && (leafB || Volume(worker.BoxA) >= Volume(worker.BoxB)))
+                    {
+                        pairs[top++] = treeA.SecondChild(nodeA);
+                        pairs[top++] = nodeB;
+                        pairs[top++] = nodeA + 1;
+                        pairs[top++] = nodeB;
+                    }
+                    else
+                    {
+                        pairs[top++] = nodeA;
+                        pairs[top++] = treeB.SecondChild(nodeB);
+                        pairs[top++] = nodeA;
+                        pairs[top++] = nodeB + 1;
+                    }
+                }
+
+                // no surfaces pass through each other, so a mesh inside the box of the other is either wholly inside it or wholly outside
+                if ((Within(b, a, numeric) && Holds(meshA, frameA, meshB, frameB)) || (Within(a, b, numeric) && Holds(meshB, frameB, meshA, frameA)))
+                {
+                    clash.Type = XbimClashType.Hard;
+                    return true;
+                }
+                if (Clearance > 0 && best <= Clearance)
+                {
+                    clash.Type = XbimClashType.Clearance;
+                    clash.Distance = best;
+                    return true;
+                }
+                return false;
+            }
+
+            // true if the world box of instance a lies within that of instance b
+            private bool Within(int a, int b, double margin)
+            {
+                int i = 6 * a, j = 6 * b;
+                for (int k = 0; k < 3; k++)
+                {
+                    if (Boxes[i + k] < Boxes[j + k] - margin || Boxes[i + k + 3] > Boxes[j + k + 3] + margin)
+                        return false;
+                }
+                return true;
+            }
+
+            // true if a point of the inner mesh is inside the outer one, counting the crossings of a ray from it in the frame of the outer mesh.
+            // A ray through an edge or vertex would be counted once for each triangle that shares it, so another ray is tried
+            private static bool Holds(ClashMesh outer, Frame outerFrame, ClashMesh inner, Frame innerFrame)
+            {
+                var points = inner.Points;
+                var triangle = inner.Triangles;
+                var centre = new Vec(0, 0, 0);
+                for (int k = 0; k < 3; k++)
+                    centre = centre + new Vec(points[3 * triangle[k]], points[3 * triangle[k] + 1], points[3 * triangle[k] + 2]);
+                centre = centre * (1.0 / 3);
+                var world = innerFrame.Apply(centre.X, centre.Y, centre.Z);
+                var origin = outerFrame.Inverse().Apply(world.X, world.Y, world.Z);
+
+                var crossings = 0;
+                foreach (var ray in Rays)
+                {
+                    crossings = CountCrossings(outer, origin, ray, out bool grazed);
+                    if (!grazed)
+                        break;
+                }
+                return (crossings & 1) == 1;
+            }
+
+            // the number of triangles of the mesh the ray crosses, grazed is true if it passes too close to an edge of one of them
+            private static int CountCrossings(ClashMesh mesh, Vec origin, Vec ray, out bool grazed)
+            {
+                var tree = mesh.Tree;
+                var boxes = tree.NodeBoxes;
+                var stack = new int[64];
+                var top = 0;
+                var crossings = 0;
+                grazed = false;
+                stack[top++] = 0;
+                while (top > 0)
+                {
+                    var node = stack[--top];
+                    if (!RayHitsBox(origin, ray, boxes, 6 * node))
+                        continue;
+                    if (tree.IsLeaf(node))
+                    {
+                        for (int p = tree.First(node), end = p + tree.ItemCount(node); p < end; p++)
+                        {
+                            var t = 3 * tree.Item(p);
+                            if (RayCrosses(origin, ray, mesh.Point(mesh.Triangles[t]), mesh.Point(mesh.Triangles[t + 1]), mesh.Point(mesh.Triangles[t + 2]), ref grazed))
+                                crossings++;
+                        }
+                        continue;
+                    }
+                    if (top + 2 > stack.Length)
+                        Array.Resize(ref stack, 2 * stack.Length);
+                    stack[top++] = tree.SecondChild(node);
+                    stack[top++] = node + 1;
+                }
+                return crossings;
+            }
+
+            private static bool RayHitsBox(Vec origin, Vec ray, double[] boxes, int i)
+            {
+                double near = 0, far = double.MaxValue;
+                for (int k = 0; k < 3; k++)
+                {
+                    var o = k == 0 ? origin.X : k == 1 ? origin.Y : origin.Z;
+                    var d = k == 0 ? ray.X : k == 1 ? ray.Y : ray.Z;
+                    var t0 = (boxes[i + k] - o) / d;
+                    var t1 = (boxes[i + k + 3] - o) / d;
+                    near = Math.Max(near, Math.Min(t0, t1));
+                    far = Math.Min(far, Math.Max(t0, t1));
+                }
+                return near <= far;
+            }
+
+            // Moller and Trumbore, crossings behind the origin are not counted. A crossing within the margin of an edge sets grazed
+            private static bool RayCrosses(Vec origin, Vec ray, Vec v0, Vec v1, Vec v2, ref bool grazed)
+            {
+                var e1 = v1 - v0;
+                var e2 = v2 - v0;
+                var p = Vec.Cross(ray, e2);
+                var det = Vec.Dot(e1, p);
+                if (det == 0)
+                    return false;
+                var s = origin - v0;
+                var u = Vec.Dot(s, p) / det;
+                if (u < -EdgeMargin || u > 1 + EdgeMargin)
+                    return false;
+                var q = Vec.Cross(s, e1);
+                var v = Vec.Dot(ray, q) / det;
+                if (v < -EdgeMargin || u + v > 1 + EdgeMargin)
+                    return false;
+                if (Vec.Dot(e2, q) / det <= 0)
+                    return false;
+                if (u <= EdgeMargin || v <= EdgeMargin || u + v >= 1 - EdgeMargin)
+                    grazed = true;
+                return true;
+            }
+
+            // puts the triangles of a leaf and their boxes in the world
+            private static int Place(ClashMesh mesh, Frame frame, int node, Vec[] triangles, double[] boxes)
+            {
+                var tree = mesh.Tree;
+                var count = tree.ItemCount(node);
+                for (int n = 0, p = tree.First(node); n < count; n++, p++)
+                {
+                    var t = 3 * tree.Item(p);
+                    for (int k = 0; k < 3; k++)
+                    {
+                        var v = 3 * mesh.Triangles[t + k];
+                        triangles[3 * n + k] = frame.Apply(mesh.Points[v], mesh.Points[v + 1], mesh.Points[v + 2]);
+                    }
+                    Vec a = triangles[3 * n], b = triangles[3 * n + 1], c = triangles[3 * n + 2];
+                    boxes[6 * n] = Math.Min(a.X, Math.Min(b.X, c.X));
+                    boxes[6 * n + 1] = Math.Min(a.Y, Math.Min(b.Y, c.Y));
+                    boxes[6 * n + 2] = Math.Min(a.Z, Math.Min(b.Z, c.Z));
+                    boxes[6 * n + 3] = Math.Max(a.X, Math.Max(b.X, c.X));
+                    boxes[6 * n + 4] = Math.Max(a.Y, Math.Max(b.Y, c.Y));
+                    boxes[6 * n + 5] = Math.Max(a.Z, Math.Max(b.Z, c.Z));
+                }
+                return count;
+            }
+
+            private static double Gap(double[] a, int i, double[] b, int j)
+            {
+                var sum = 0.0;
+                for (int k = 0; k < 3; k++)
+                {
+                    var d = Math.Max(a[i + k] - b[j + k + 3], b[j + k] - a[i + k + 3]);
+                    if (d > 0)
+                        sum += d * d;
+                }
+                return Math.Sqrt(sum);
+            }
+
+            private static double Volume(double[] box)
+            {
+                return (box[3] - box[0]) * (box[4] - box[1]) * (box[5] - box[2]);
+            }
+        }
+
+        // true if an edge of either triangle passes through the other with both ends more than the depth from its plane, or the triangles lie
+        // in the same plane, face the same way and overlap by more than the depth. The sign turns a triangle of a mirrored instance outwards
+        private static bool Penetrates(Vec[] a, int i, int signA, Vec[] b, int j, int signB, double depth, double numeric)
+        {
+            var normalA = Vec.Cross(a[i + 1] - a[i], a[i + 2] - a[i]);
+            var normalB = Vec.Cross(b[j + 1] - b[j], b[j + 2] - b[j]);
+            var lengthA = normalA.Length;
+            var lengthB = normalB.Length;
+            if (lengthA == 0 || lengthB == 0)
+                return false;
+            normalA = normalA * (1 / lengthA);
+            normalB = normalB * (1 / lengthB);
+            if (Vec.Cross(normalA, normalB).Length < 1e-6 &&
+                Math.Abs(Vec.Dot(b[j] - a[i], normalA)) <= numeric && Math.Abs(Vec.Dot(b[j + 1] - a[i], normalA)) <= numeric &&
+                Math.Abs(Vec.Dot(b[j + 2] - a[i], normalA)) <= numeric)
+                return Vec.Dot(normalA, normalB) * signA * signB > 0 && Overlap(a, i, normalA, b, j, normalB, depth);
+            for (int k = 0; k < 3; k++)
+            {
+                if (Pierces(a[i + k], a[i + (k + 1) % 3], b, j, normalB, depth) || Pierces(b[j + k], b[j + (k + 1) % 3], a, i, normalA, depth))
+                    return true;
+            }
+            return false;
+        }
+
+        // true if the segment crosses the plane of the triangle with both ends more than the depth from it, at a point inside the triangle
+        // and more than the depth from its edges
+        private static bool Pierces(Vec p, Vec q, Vec[] t, int i, Vec normal, double depth)
+        {
+            var dp = Vec.Dot(p - t[i], normal);
+            var dq = Vec.Dot(q - t[i], normal);
+            if (!((dp > depth && dq < -depth) || (dp < -depth && dq > depth)))
+                return false;
+            var x = p + (q - p) * (dp / (dp - dq));
+            return Inside(x, t, i, normal, depth);
+        }
+
+        // true if the point in the plane of the triangle is more than the margin inside each of its edges, the normal follows the winding
+        private static bool Inside(Vec x, Vec[] t, int i, Vec normal, double margin)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                var edge = t[i + (k + 1) % 3] - t[i + k];
+                var length = edge.Length;
+                if (length == 0 || Vec.Dot(Vec.Cross(edge, x - t[i + k]), normal) <= margin * length)
+                    return false;
+            }
+            return true;
+        }
+
+        // true if two triangles in the same plane overlap, an edge of one crossing an edge of the other or the centre of one inside the other
+        private static bool Overlap(Vec[] a, int i, Vec normalA, Vec[] b, int j, Vec normalB, double margin)
+        {
+            if (Inside((a[i] + a[i + 1] + a[i + 2]) * (1.0 / 3), b, j, normalB, margin) || Inside((b[j] + b[j + 1] + b[j + 2]) * (1.0 / 3), a, i, normalA, margin))
+                return true;
+            for (int k = 0; k < 3; k++)
+            {
+                var p = a[i + k];
+                var q = a[i + (k + 1) % 3];
+                for (int l = 0; l < 3; l++)
+                {
+                    var r = b[j + l];
+                    var s = b[j + (l + 1) % 3];
+                    // the ends of each edge on either side of the other, by more than the margin
+                    var pq = q - p;
+                    var rs = s - r;
+                    var lengthPq = pq.Length;
+                    var lengthRs = rs.Length;
+                    if (lengthPq == 0 || lengthRs == 0)
+                        continue;
+                    var sideR = Vec.Dot(Vec.Cross(pq, r - p), normalA) / lengthPq;
+                    var sideS = Vec.Dot(Vec.Cross(pq, s - p), normalA) / lengthPq;
+                    var sideP = Vec.Dot(Vec.Cross(rs, p - r), normalA) / lengthRs;
+                    var sideQ = Vec.Dot(Vec.Cross(rs, q - r), normalA) / lengthRs;
+                    if (((sideR > margin && sideS < -margin) || (sideR < -margin && sideS > margin)) &&
+                        ((sideP > margin && sideQ < -margin) || (sideP < -margin && sideQ > margin)))
+                        return true;
+                }
+            }
+            return false;
+        }
+
+        // the shortest distance between two triangles, 0 if they touch or cross
+        private static double Distance(Vec[] a, int i, Vec[] b, int j)
+        {
+            if (Touches(a, i, b, j) || Touches(b, j, a, i))
+                return 0;
+            var best = double.MaxValue;
+            for (int k = 0; k < 3; k++)
+            {
+                best = Math.Min(best, (a[i + k] - ClosestOnTriangle(a[i + k], b[j], b[j + 1], b[j + 2])).LengthSquared);
+                best = Math.Min(best, (b[j + k] - ClosestOnTriangle(b[j + k], a[i], a[i + 1], a[i + 2])).LengthSquared);
+                for (int l = 0; l < 3; l++)
+                    best = Math.Min(best, SegmentDistanceSquared(a[i + k], a[i + (k + 1) % 3], b[j + l], b[j + (l + 1) % 3]));
+            }
+            return Math.Sqrt(best);
+        }
+
+        // true if an edge of a meets the triangle b
+        private static bool Touches(Vec[] a, int i, Vec[] b, int j)
+        {
+            var normal = Vec.Cross(b[j + 1] - b[j], b[j + 2] - b[j]);
+            if (normal.LengthSquared == 0)
+                return false;
+            for (int k = 0; k < 3; k++)
+            {
+                var p = a[i + k];
+                var q = a[i + (k + 1) % 3];
+                var dp = Vec.Dot(p - b[j], normal);
+                var dq = Vec.Dot(q - b[j], normal);
+                if ((dp > 0 && dq > 0) || (dp < 0 && dq < 0) || dp == dq)
+                    continue;
+                var x = p + (q - p) * (dp / (dp - dq));
+                var inside = true;
+                for (int l = 0; l < 3 && inside; l++)
+                    inside = Vec.Dot(Vec.Cross(b[j + (l + 1) % 3] - b[j + l], x - b[j + l]), normal) >= 0;
+                if (inside)
+                    return true;
+            }
+            return false;
+        }
+
+        // Ericson, Real-Time Collision Detection 5.1.5
+        private static Vec ClosestOnTriangle(Vec p, Vec a, Vec b, Vec c)
+        {
+            var ab = b - a;
+            var ac = c - a;
+            var ap = p - a;
+            var d1 = Vec.Dot(ab, ap);
+            var d2 = Vec.Dot(ac, ap);
+            if (d1 <= 0 && d2 <= 0)
+                return a;
+            var bp = p - b;
+            var d3 = Vec.Dot(ab, bp);
+            var d4 = Vec.Dot(ac, bp);
+            if (d3 >= 0 && d4 <= d3)
+                return b;
+            var vc = d1 * d4 - d3 * d2;
+            if (vc <= 0 && d1 >= 0 && d3 <= 0)
+                return a + ab * (d1 / (d1 - d3));
+            var cp = p - c;
+            var d5 = Vec.Dot(ab, cp);
+            var d6 = Vec.Dot(ac, cp);
+            if (d6 >= 0 && d5 <= d6)
+                return c;
+            var vb = d5 * d2 - d1 * d6;
+            if (vb <= 0 && d2 >= 0 && d6 <= 0)
+                return a + ac * (d2 / (d2 - d6));
+            var va = d3 * d6 - d5 * d4;
+            if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0)
+                return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+            var denominator = 1 / (va + vb + vc);
+            return a + ab * (vb * denominator) + ac * (vc * denominator);
+        }
+
+        // Ericson, Real-Time Collision Detection 5.1.9
+        private static double SegmentDistanceSquared(Vec p1, Vec q1, Vec p2, Vec q2)
+        {
+            var d1 = q1 - p1;
+            var d2 = q2 - p2;
+            var r = p1 - p2;
+            var a = d1.LengthSquared;
+            var e = d2.LengthSquared;
+            var f = Vec.Dot(d2, r);
+            double s, t;
+            if (a == 0 && e == 0)
+                return r.LengthSquared;
+            if (a == 0)
+            {
+                s = 0;
+                t = Clamp(f / e);
+            }
+            else
+            {
+                var c = Vec.Dot(d1, r);
+                if (e == 0)
+                {
+                    t = 0;
+                    s = Clamp(-c / a);
+                }
+                else
+                {
+                    var b = Vec.Dot(d1, d2);
+                    var denominator = a * e - b * b;
+                    s = denominator != 0 ? Clamp((b * f - c * e) / denominator) : 0;
+                    t = (b * s + f) / e;
+                    if (t < 0)
+                    {
+                        t = 0;
+                        s = Clamp(-c / a);
+                    }
+                    else if (t > 1)
+                    {
+                        t = 1;
+                        s = Clamp((b - c) / a);
+                    }
+                }
+            }
+            return ((p1 + d1 * s) - (p2 + d2 * t)).LengthSquared;
+        }
+
+        private static double Clamp(double value)
+        {
+            return value < 0 ? 0 : value > 1 ? 1 : value;
+        }
+
+        private struct Vec
+        {
+            public readonly double X;
+            public readonly double Y;
+            public readonly double Z;
+
+            public Vec(double x, double y, double z)
+            {
+                X = x;
+                Y = y;
+                Z = z;
+            }
+
+            public double LengthSquared
+            {
+                get { return X * X + Y * Y + Z * Z; }
+            }
+
+            public double Length
+            {
+                get { return Math.Sqrt(LengthSquared); }
+            }
+
+            public static Vec operator +(Vec a, Vec b)
+            {
+                return new Vec(a.X + b.X, a.Y + b.Y, a.Z + b.Z);
+            }
+
+            public static Vec operator -(Vec a, Vec b)
+            {
+                return new Vec(a.X - b.X, a.Y - b.Y, a.Z - b.Z);
+            }
+
+            public static Vec operator *(Vec a, double s)
+            {
+                return new Vec(a.X * s, a.Y * s, a.Z * s);
+            }
+
+            public static double Dot(Vec a, Vec b)
+            {
+                return a.X * b.X + a.Y * b.Y + a.Z * b.Z;
+            }
+
+            public static Vec Cross(Vec a, Vec b)
+            {
+                return new Vec(a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X);
+            }
+        }
+
+        // the affine part of a shape instance transformation, points are row vectors as in XbimMatrix3D
+        private struct Frame
+        {
+            public double M11, M12, M13, M21, M22, M23, M31, M32, M33, X, Y, Z;
+
+            public Frame(XbimMatrix3D m)
+            {
+                M11 = m.M11; M12 = m.M12; M13 = m.M13;
+                M21 = m.M21; M22 = m.M22; M23 = m.M23;
+                M31 = m.M31; M32 = m.M32; M33 = m.M33;
+                X = m.OffsetX; Y = m.OffsetY; Z = m.OffsetZ;
+            }
+
+            public double Determinant
+            {
+                get { return M11 * (M22 * M33 - M23 * M32) - M12 * (M21 * M33 - M23 * M31) + M13 * (M21 * M32 - M22 * M31); }
+            }
+
+            public bool Mirrored
+            {
+                get { return Determinant < 0; }
+            }
+
+            // the largest factor by which a length grows
+            public double Scale
+            {
+                get
+                {
+                    return Math.Sqrt(Math.Max(M11 * M11 + M12 * M12 + M13 * M13, Math.Max(M21 * M21 + M22 * M22 + M23 * M23, M31 * M31 + M32 * M32 + M33 * M33)));
+                }
+            }
+
+            public Vec Apply(double x, double y, double z)
+            {
+                return new Vec(x * M11 + y * M21 + z * M31 + X, x * M12 + y * M22 + z * M32 + Y, x * M13 + y * M23 + z * M33 + Z);
+            }
+
+            // the box holding a transformed box, from its centre and half sizes
+            public void ApplyBox(double[] box, int i, double[] result, int r)
+            {
+                var centre = Apply((box[i] + box[i + 3]) * 0.5, (box[i + 1] + box[i + 4]) * 0.5, (box[i + 2] + box[i + 5]) * 0.5);
+                var ex = (box[i + 3] - box[i]) * 0.5;
+                var ey = (box[i + 4] - box[i + 1]) * 0.5;
+                var ez = (box[i + 5] - box[i + 2]) * 0.5;
+                var wx = Math.Abs(M11) * ex + Math.Abs(M21) * ey + Math.Abs(M31) * ez;
+                var wy = Math.Abs(M12) * ex + Math.Abs(M22) * ey + Math.Abs(M32) * ez;
+                var wz = Math.Abs(M13) * ex + Math.Abs(M23) * ey + Math.Abs(M33) * ez;
+                result[r] = centre.X - wx;
+                result[r + 1] = centre.Y - wy;
+                result[r + 2] = centre.Z - wz;
+                result[r + 3] = centre.X + wx;
+                result[r + 4] = centre.Y + wy;
+                result[r + 5] = centre.Z + wz;
+            }
+
+            public Frame Inverse()
+            {
+                var d = 1 / Determinant;
+                var inverse = new Frame
+                {
+                    M11 = (M22 * M33 - M23 * M32) * d,
+                    M12 = (M13 * M32 - M12 * M33) * d,
+                    M13 = (M12 * M23 - M13 * M22) * d,
+                    M21 = (M23 * M31 - M21 * M33) * d,
+                    M22 = (M11 * M33 - M13 * M31) * d,
+                    M23 = (M13 * M21 - M11 * M23) * d,
+                    M31 = (M21 * M32 - M22 * M31) * d,
+                    M32 = (M12 * M31 - M11 * M32) * d,
+                    M33 = (M11 * M22 - M12 * M21) * d
+                };
+                inverse.X = -(X * inverse.M11 + Y * inverse.M21 + Z * inverse.M31);
+                inverse.Y = -(X * inverse.M12 + Y * inverse.M22 + Z * inverse.M32);
+                inverse.Z = -(X * inverse.M13 + Y * inverse.M23 + Z * inverse.M33);
+                return inverse;
+            }
+        }
+
+        // the triangles of a shape geometry in its own coordinates, with a tree over their boxes
+        private sealed class ClashMesh
+        {
+            public double[] Points;
+            public int[] Triangles;
+            public XbimBoxTree Tree;
+            // the largest coordinate, for the rounding of the stored floats
+            public double Size;
+            public long Bytes;
+
+            public Vec Point(int index)
+            {
+                return new Vec(Points[3 * index], Points[3 * index + 1], Points[3 * index + 2]);
+            }
+
+            public static ClashMesh Read(XbimShapeGeometry geometry)
+            {
+                if (geometry == null || geometry.Format != XbimGeometryType.PolyhedronBinary || geometry.ShapeData == null || geometry.ShapeData.Length == 0)
+                    return null;
+                List<XbimPoint3D> vertices;
+                var indices = new List<int>();
+                using (var ms = new MemoryStream(geometry.ShapeData))
+                using (var br = new BinaryReader(ms))
+                {
+                    var triangulation = br.ReadShapeTriangulation();
+                    vertices = triangulation.Vertices.ToList();
+                    foreach (var face in triangulation.Faces)
+                    {
+                        for (int i = 0; i + 2 < face.Indices.Count; i += 3)
+                        {
+                            indices.Add(face.Indices[i]);
+                            indices.Add(face.Indices[i + 1]);
+                            indices.Add(face.Indices[i + 2]);
+                        }
+                    }
+                }
+                var triangleCount = indices.Count / 3;
+                if (triangleCount == 0)
+                    return null;
+                var mesh = new ClashMesh { Points = new double[3 * vertices.Count], Triangles = indices.ToArray() };
+                for (int i = 0; i < vertices.Count; i++)
+                {
+                    mesh.Points[3 * i] = vertices[i].X;
+                    mesh.Points[3 * i + 1] = vertices[i].Y;
+                    mesh.Points[3 * i + 2] = vertices[i].Z;
+                    mesh.Size = Math.Max(mesh.Size, Math.Max(Math.Abs(vertices[i].X), Math.Max(Math.Abs(vertices[i].Y), Math.Abs(vertices[i].Z))));
+                }
+                var boxes = new double[6 * triangleCount];
+                for (int t = 0; t < triangleCount; t++)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        boxes[6 * t + k] = double.MaxValue;
+                        boxes[6 * t + k + 3] = double.MinValue;
+                    }
+                    for (int c = 0; c < 3; c++)
+                    {
+                        var v = 3 * mesh.Triangles[3 * t + c];
+                        for (int k = 0; k < 3; k++)
+                        {
+                            boxes[6 * t + k] = Math.Min(boxes[6 * t + k], mesh.Points[v + k]);
+                            boxes[6 * t + k + 3] = Math.Max(boxes[6 * t + k + 3], mesh.Points[v + k]);
+                        }
+                    }
+                }
+                mesh.Tree = new XbimBoxTree(boxes, triangleCount, false);
+                mesh.Bytes = 8L * mesh.Points.Length + 4L * mesh.Triangles.Length + 8L * boxes.Length + 64L * mesh.Tree.NodeCount;
+                return mesh;
+            }
+        }
+
+        // the meshes read, the least recently used are dropped over the budget. A mesh is read by one thread, the others wait for it
+        private sealed class MeshCache
+        {
+            private class Entry
+            {
+                public Lazy<ClashMesh> Mesh;
+                public LinkedListNode<int> Use;
+                public long Bytes;
+            }
+
+            private readonly Func<int, XbimShapeGeometry> _shapeGeometry;
+            private readonly long _budget;
+            private readonly Dictionary<int, Entry> _entries = new Dictionary<int, Entry>();
+            private readonly LinkedList<int> _uses = new LinkedList<int>();
+            private readonly object _lock = new object();
+            private long _bytes;
+            private int _read;
+
+            public MeshCache(Func<int, XbimShapeGeometry> shapeGeometry, long budget)
+            {
+                _shapeGeometry = shapeGeometry;
+                _budget = budget;
+            }
+
+            public int Read
+            {
+                get { return _read; }
+            }
+
+            public int Evicted { get; private set; }
+
+            public long PeakBytes { get; private set; }
+
+            public ClashMesh Get(int label)
+            {
+                Entry entry;
+                lock (_lock)
+                {
+                    if (_entries.TryGetValue(label, out entry))
+                    {
+                        _uses.Remove(entry.Use);
+                        _uses.AddLast(entry.Use);
+                    }
+                    else
+                    {
+                        entry = new Entry
+                        {
+                            Mesh = new Lazy<ClashMesh>(() => Load(label), LazyThreadSafetyMode.ExecutionAndPublication),
+                            Use = new LinkedListNode<int>(label)
+                        };
+                        _entries.Add(label, entry);
+                        _uses.AddLast(entry.Use);
+                    }
+                }
+                var mesh = entry.Mesh.Value;
+                if (mesh == null)
+                    return null;
+                lock (_lock)
+                {
+                    // counted once, by the first thread back, unless it has already been dropped
+                    Entry current;
+                    if (entry.Bytes == 0 && _entries.TryGetValue(label, out current) && current == entry)
+                    {
+                        entry.Bytes = mesh.Bytes;
+                        _bytes += mesh.Bytes;
+                        PeakBytes = Math.Max(PeakBytes, _bytes);
+                        while (_budget > 0 && _bytes > _budget && _uses.First != entry.Use)
+                        {
+                            var oldest = _uses.First;
+                            _uses.RemoveFirst();
+                            _bytes -= _entries[oldest.Value].Bytes;
+                            _entries.Remove(oldest.Value);
+                            Evicted++;
+                        }
+                    }
+                }
+                return mesh;
+            }
+
+            private ClashMesh Load(int label)
+            {
+                Interlocked.Increment(ref _read);
+                return ClashMesh.Read(_shapeGeometry(label));
+            }
+        }
+    }
+}
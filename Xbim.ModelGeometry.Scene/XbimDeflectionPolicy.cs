@@ -0,0 +1,124 @@
+﻿using System;
+using System.Collections.Generic;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.Interfaces;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Determines the linear and angular deflection used to mesh an individual shape, the policy is consulted before the shape is meshed.
+    /// When no policy is set on the Xbim3DModelContext the DeflectionTolerance and DeflectionAngle of the ModelFactors are applied to every shape
+    /// </summary>
+    public abstract class XbimDeflectionPolicy
+    {
+        /// <summary>
+        /// Adjusts the deflection for a shape. On entry linearDeflection and angularDeflection hold the model defaults
+        /// </summary>
+        /// <param name="product">The product the shape belongs to, this may be null and if the shape is shared by several products it is the first one found</param>
+        /// <param name="bounds">The bounding box of the shape before meshing, in model units</param>
+        /// <param name="modelFactors">The factors of the model being meshed</param>
+        /// <param name="linearDeflection">The maximum chordal deviation in model units</param>
+        /// <param name="angularDeflection">The maximum angular deviation in radians</param>
+        public abstract void GetDeflection(IIfcProduct product, XbimRect3D bounds, IModelFactors modelFactors,
+            ref double linearDeflection, ref double angularDeflection);
+
+        /// <summary>
+        /// Length of the diagonal of the bounds, 0 if the bounds are empty
+        /// </summary>
+        protected static double Diagonal(XbimRect3D bounds)
+        {
+            if (bounds.IsEmpty) return 0;
+            return Math.Sqrt(bounds.SizeX * bounds.SizeX + bounds.SizeY * bounds.SizeY + bounds.SizeZ * bounds.SizeZ);
+        }
+    }
+
+    /// <summary>
+    /// Scales the linear deflection with the size of the shape, small parts such as bolts are meshed finely and large parts such as tunnel linings coarsely
+    /// </summary>
+    public class XbimSizeDeflectionPolicy : XbimDeflectionPolicy
+    {
+        /// <summary>
+        /// The linear deflection as a proportion of the bounding box diagonal, defaults to 0.005
+        /// </summary>
+        public double DiagonalRatio { get; set; } = 0.005;
+        public double MinLinearDeflectionInMM { get; set; } = 0.5;
+        public double MaxLinearDeflectionInMM { get; set; } = 100;
+
+        public override void GetDeflection(IIfcProduct product, XbimRect3D bounds, IModelFactors modelFactors,
+            ref double linearDeflection, ref double angularDeflection)
+        {
+            var diagonal = Diagonal(bounds);
+            if (diagonal <= 0) return;
+            var min = MinLinearDeflectionInMM * modelFactors.OneMilliMeter;
+            var max = MaxLinearDeflectionInMM * modelFactors.OneMilliMeter;
+            linearDeflection = Math.Min(max, Math.Max(min, diagonal * DiagonalRatio));
+        }
+    }
+
+    /// <summary>
+    /// Chooses the deflection so that a cylinder the size of the shape is meshed with about TriangleBudget triangles
+    /// </summary>
+    public class XbimTriangleBudgetDeflectionPolicy : XbimDeflectionPolicy
+    {
+        public int TriangleBudget { get; set; } = 2000;
+        public double MinLinearDeflectionInMM { get; set; } = 0.5;
+        /// <summary>
+        /// The coarsest angular deflection in radians that will be used, defaults to 0.5
+        /// </summary>
+        public double MaxAngularDeflection { get; set; } = 0.5;
+
+        public override void GetDeflection(IIfcProduct product, XbimRect3D bounds, IModelFactors modelFactors,
+            ref double linearDeflection, ref double angularDeflection)
+        {
+            var diagonal = Diagonal(bounds);
+            if (diagonal <= 0 || TriangleBudget <= 0) return;
+            // a closed cylinder divided into n segments has 2n side and 2n cap triangles
+            var segments = Math.Max(8, TriangleBudget / 4);
+            var radius = diagonal / 2;
+            angularDeflection = Math.Min(MaxAngularDeflection, 2 * Math.PI / segments);
+            linearDeflection = Math.Max(MinLinearDeflectionInMM * modelFactors.OneMilliMeter,
+                radius * (1 - Math.Cos(Math.PI / segments)));
+        }
+    }
+
+    /// <summary>
+    /// Applies a fixed deflection to products of specific IFC types, all other products use the Fallback policy or the model defaults
+    /// </summary>
+    public class XbimTypeDeflectionPolicy : XbimDeflectionPolicy
+    {
+        private readonly List<Tuple<Type, double, double>> _deflections = new List<Tuple<Type, double, double>>();
+
+        /// <summary>
+        /// The policy applied to products that do not match any type, if null the model defaults are used
+        /// </summary>
+        public XbimDeflectionPolicy Fallback { get; set; }
+
+        /// <summary>
+        /// Sets the deflection for products of type T, types are matched in the order they are added
+        /// </summary>
+        public XbimTypeDeflectionPolicy Add<T>(double linearDeflectionInMM, double angularDeflection) where T : IIfcProduct
+        {
+            _deflections.Add(Tuple.Create(typeof(T), linearDeflectionInMM, angularDeflection));
+            return this;
+        }
+
+        public override void GetDeflection(IIfcProduct product, XbimRect3D bounds, IModelFactors modelFactors,
+            ref double linearDeflection, ref double angularDeflection)
+        {
+            if (product != null)
+            {
+                foreach (var deflection in _deflections)
+                {
+                    if (deflection.Item1.IsInstanceOfType(product))
+                    {
+                        linearDeflection = deflection.Item2 * modelFactors.OneMilliMeter;
+                        angularDeflection = deflection.Item3;
+                        return;
+                    }
+                }
+            }
+            Fallback?.GetDeflection(product, bounds, modelFactors, ref linearDeflection, ref angularDeflection);
+        }
+    }
+}
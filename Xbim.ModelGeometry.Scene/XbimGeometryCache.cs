@@ -0,0 +1,312 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Xbim.Common.Geometry;
+using Xbim.Geometry.Engine.Interop;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// How the geometry cache of the last CreateContext used its memory budget
+    /// </summary>
+    public class XbimGeometryCacheStatistics
+    {
+        /// <summary>
+        /// The budget in bytes, 0 if the cache was not limited
+        /// </summary>
+        public long MemoryBudget { get; internal set; }
+        /// <summary>
+        /// The largest estimated native size of the shapes held in memory at any one time
+        /// </summary>
+        public long PeakResidentBytes { get; internal set; }
+        /// <summary>
+        /// The number of times a shape was dropped from memory to keep within the budget
+        /// </summary>
+        public int SpilledShapes { get; internal set; }
+        /// <summary>
+        /// The size of the scratch file, each shape is written once however often it is spilled
+        /// </summary>
+        public long SpilledBytes { get; internal set; }
+        /// <summary>
+        /// The number of times a spilled shape was read back from the scratch file
+        /// </summary>
+        public int ReloadedShapes { get; internal set; }
+        /// <summary>
+        /// The number of shapes released once no remaining boolean operation needed them
+        /// </summary>
+        public int ReleasedShapes { get; internal set; }
+    }
+
+    /// <summary>
+    /// Holds the shapes used as operands of the boolean operations of CreateContext. When the estimated native size of the shapes in memory
+    /// exceeds the budget the least recently used ones are written to a scratch file in binary BRep and read back when they are next needed.
+    /// The methods may be called from any thread
+    /// </summary>
+    public sealed class XbimGeometryCache : IDisposable
+    {
+        private class Entry
+        {
+            public IXbimGeometryObject Geometry;
+            public long Bytes;
+            public long LastUse;
+            public long Offset = -1;
+            public int Length;
+            // being written to the scratch file outside the lock, it is disposed by the writer if it is released meanwhile
+            public bool Writing;
+            public bool Released;
+        }
+
+        private readonly XbimGeometryEngine _engine;
+        private readonly string _scratchDirectory;
+        private readonly Dictionary<int, Entry> _entries = new Dictionary<int, Entry>();
+        private readonly object _lock = new object();
+        private FileStream _scratchFile;
+        private long _residentBytes;
+        private long _writingBytes;
+        private long _useCount;
+        private bool _disposed;
+
+        /// <param name="engine">The engine used to measure, write and read the shapes</param>
+        /// <param name="memoryBudget">The estimated native bytes the shapes in memory may use, 0 for no limit</param>
+        /// <param name="scratchDirectory">Where the scratch file is created, null for the temp folder. The file is deleted when the cache is disposed</param>
+        public XbimGeometryCache(XbimGeometryEngine engine, long memoryBudget, string scratchDirectory = null)
+        {
+            _engine = engine;
+            _scratchDirectory = scratchDirectory;
+            Statistics = new XbimGeometryCacheStatistics { MemoryBudget = Math.Max(0, memoryBudget) };
+        }
+
+        public XbimGeometryCacheStatistics Statistics { get; private set; }
+
+        public int Count
+        {
+            get { lock (_lock) return _entries.Count; }
+        }
+
+        /// <summary>
+        /// The estimated native size of the shapes currently in memory
+        /// </summary>
+        public long ResidentBytes
+        {
+            get { lock (_lock) return _residentBytes; }
+        }
+
+        /// <summary>
+        /// Adds the shape, the cache owns it from now on and it is not released by any geometry session open on the calling thread
+        /// </summary>
+        public bool TryAdd(int key, IXbimGeometryObject geometry)
+        {
+            if (geometry == null)
+                return false;
+            var bytes = _engine.EstimateNativeBytes(geometry);
+            List<Entry> spilled;
+            lock (_lock)
+            {
+                if (_entries.ContainsKey(key))
+                    return false;
+                XbimGeometrySession.Detach(geometry);
+                _entries.Add(key, new Entry { Geometry = geometry, Bytes = bytes, LastUse = ++_useCount });
+                _residentBytes += bytes;
+                spilled = Spill(key);
+            }
+            WriteSpilled(spilled);
+            return true;
+        }
+
+        public bool ContainsKey(int key)
+        {
+            lock (_lock) return _entries.ContainsKey(key);
+        }
+
+        /// <summary>
+        /// Gets the shape, reading it back from the scratch file if it has been spilled. The shape returned stays valid if it is spilled again
+        /// </summary>
+        public bool TryGetValue(int key, out IXbimGeometryObject geometry)
+        {
+            Entry entry;
+            byte[] data;
+            lock (_lock)
+            {
+                geometry = null;
+                if (!_entries.TryGetValue(key, out entry))
+                    return false;
+                entry.LastUse = ++_useCount;
+                if (entry.Geometry != null)
+                {
+                    geometry = entry.Geometry;
+                    return true;
+                }
+                data = ReadScratch(entry);
+            }
+            // reading the BRep is the slow part, other threads may use the cache meanwhile
+            var reloaded = _engine.FromBinaryBrep(data);
+            if (reloaded == null)
+                return false;
+            XbimGeometrySession.Detach(reloaded);
+            List<Entry> spilled;
+            lock (_lock)
+            {
+                if (entry.Geometry != null)
+                {
+                    // another thread reloaded it first
+                    reloaded.Dispose();
+                    geometry = entry.Geometry;
+                    return true;
+                }
+                if (!_entries.ContainsKey(key))
+                {
+                    // released meanwhile, the finalizer releases the copy
+                    geometry = reloaded;
+                    return true;
+                }
+                entry.Geometry = reloaded;
+                _residentBytes += entry.Bytes;
+                Statistics.ReloadedShapes++;
+                spilled = Spill(key);
+                geometry = reloaded;
+            }
+            WriteSpilled(spilled);
+            return true;
+        }
+
+        /// <summary>
+        /// Removes the shape from the cache and releases it, the caller guarantees it will not be asked for again
+        /// </summary>
+        public void Release(int key)
+        {
+            IXbimGeometryObject geometry;
+            lock (_lock)
+            {
+                if (!_entries.TryGetValue(key, out Entry entry))
+                    return;
+                _entries.Remove(key);
+                geometry = entry.Geometry;
+                if (geometry != null)
+                    _residentBytes -= entry.Bytes;
+                Statistics.ReleasedShapes++;
+                if (entry.Writing)
+                {
+                    entry.Released = true;
+                    return;
+                }
+            }
+            geometry?.Dispose();
+        }
+
+        //picks the least recently used shapes until the resident size is a quarter below the budget, the shape being added or reloaded stays.
+        //Shapes already in the scratch file are dropped now, the others are returned to be written by WriteSpilled once the lock is released
+        private List<Entry> Spill(int keep)
+        {
+            if (_residentBytes > Statistics.PeakResidentBytes)
+                Statistics.PeakResidentBytes = _residentBytes;
+            var budget = Statistics.MemoryBudget;
+            if (budget <= 0 || _residentBytes - _writingBytes <= budget)
+                return null;
+            var target = budget - budget / 4;
+            List<Entry> spilled = null;
+            foreach (var pair in _entries.Where(e => e.Value.Geometry != null && !e.Value.Writing && e.Key != keep).OrderBy(e => e.Value.LastUse).ToList())
+            {
+                if (_residentBytes - _writingBytes <= target)
+                    break;
+                var entry = pair.Value;
+                if (entry.Offset >= 0)
+                {
+                    Drop(entry);
+                    continue;
+                }
+                entry.Writing = true;
+                _writingBytes += entry.Bytes;
+                (spilled ?? (spilled = new List<Entry>())).Add(entry);
+            }
+            return spilled;
+        }
+
+        //serialising a shape is slow, so it is done without the lock and the entry is only updated under it
+        private void WriteSpilled(List<Entry> spilled)
+        {
+            if (spilled == null)
+                return;
+            foreach (var entry in spilled)
+            {
+                var data = _engine.ToBinaryBrep(entry.Geometry);
+                lock (_lock)
+                {
+                    entry.Writing = false;
+                    _writingBytes -= entry.Bytes;
+                    if (!entry.Released)
+                    {
+                        if (data != null && !_disposed) // otherwise it cannot be written so it must stay in memory
+                        {
+                            WriteScratch(entry, data);
+                            Drop(entry);
+                        }
+                        continue;
+                    }
+                }
+                entry.Geometry.Dispose();
+                entry.Geometry = null;
+            }
+        }
+
+        private void Drop(Entry entry)
+        {
+            // the shape is not disposed, a thread may still be using it, the finalizer releases it
+            entry.Geometry = null;
+            _residentBytes -= entry.Bytes;
+            Statistics.SpilledShapes++;
+        }
+
+        private void WriteScratch(Entry entry, byte[] data)
+        {
+            if (_scratchFile == null)
+            {
+                var directory = string.IsNullOrEmpty(_scratchDirectory) ? Path.GetTempPath() : _scratchDirectory;
+                Directory.CreateDirectory(directory);
+                _scratchFile = new FileStream(Path.Combine(directory, "xbim-geometry-" + Guid.NewGuid().ToString("N") + ".cache"),
+                    FileMode.CreateNew, FileAccess.ReadWrite, FileShare.None, 0x10000, FileOptions.DeleteOnClose);
+            }
+            entry.Offset = _scratchFile.Length;
+            entry.Length = data.Length;
+            _scratchFile.Seek(entry.Offset, SeekOrigin.Begin);
+            _scratchFile.Write(data, 0, data.Length);
+            Statistics.SpilledBytes += data.Length;
+        }
+
+        private byte[] ReadScratch(Entry entry)
+        {
+            var data = new byte[entry.Length];
+            _scratchFile.Seek(entry.Offset, SeekOrigin.Begin);
+            var read = 0;
+            while (read < data.Length)
+            {
+                var count = _scratchFile.Read(data, read, data.Length - read);
+                if (count == 0)
+                    throw new EndOfStreamException("The geometry cache scratch file is truncated");
+                read += count;
+            }
+            return data;
+        }
+
+        public void Dispose()
+        {
+            if (_disposed)
+                return;
+            _disposed = true;
+            lock (_lock)
+            {
+                foreach (var entry in _entries.Values)
+                {
+                    if (entry.Writing)
+                        entry.Released = true;
+                    else
+                        entry.Geometry?.Dispose();
+                }
+                _entries.Clear();
+                _residentBytes = 0;
+                _scratchFile?.Dispose();
+                _scratchFile = null;
+            }
+        }
+    }
+}
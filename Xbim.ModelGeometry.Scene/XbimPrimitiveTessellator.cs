@@ -0,0 +1,512 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+using Xbim.Ifc4.Interfaces;
+using Xbim.ModelGeometry.Scene.Extensions;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// Meshes spheres, cylinders, cones and swept disks along polylines directly from their parametric definition, without building a B-rep solid.
+    /// Use only for shapes that take no part in boolean operations. The meshes are closed and the chordal deviation of the circular sections
+    /// is kept within the linear and angular deflection
+    /// </summary>
+    public class XbimPrimitiveTessellator
+    {
+        private const int MinSegments = 8;
+        private const int MaxSegments = 512;
+
+        private readonly IModel _model;
+        private readonly XbimGeometryType _geometryType;
+
+        private class Face
+        {
+            internal readonly List<int> Indices = new List<int>();
+            //one normal for planar faces, otherwise a normal for every index
+            internal readonly List<XbimVector3D> Normals = new List<XbimVector3D>();
+            internal bool IsPlanar;
+        }
+
+        private class PrimitiveMesh
+        {
+            internal readonly List<XbimPoint3D> Points = new List<XbimPoint3D>();
+            internal readonly List<Face> Faces = new List<Face>();
+
+            internal int AddPoint(XbimPoint3D p)
+            {
+                Points.Add(p);
+                return Points.Count - 1;
+            }
+        }
+
+        public XbimPrimitiveTessellator(IModel model, XbimGeometryType geometryType)
+        {
+            _model = model;
+            _geometryType = geometryType;
+        }
+
+        /// <summary>
+        /// Returns true if the item is a primitive this tessellator supports, Mesh may still return null if the item is degenerate
+        /// </summary>
+        public bool CanMesh(IIfcRepresentationItem item)
+        {
+            if (_geometryType != XbimGeometryType.PolyhedronBinary) return false;
+            if (item is IIfcCsgSolid csg) item = csg.TreeRootExpression as IIfcRepresentationItem;
+            if (item is IIfcSphere || item is IIfcRightCircularCylinder || item is IIfcRightCircularCone)
+                return true;
+            if (item is IIfcSweptDiskSolid sweptDisk)
+            {
+                //trimmed directrices and filleted polygonal sweeps are left to the geometry engine
+                if (sweptDisk.StartParam.HasValue || sweptDisk.EndParam.HasValue) return false;
+                if (sweptDisk is IIfcSweptDiskSolidPolygonal polygonal && polygonal.FilletRadius.HasValue) return false;
+                if (sweptDisk.Directrix is IIfcPolyline) return true;
+                if (sweptDisk.Directrix is IIfcIndexedPolyCurve polyCurve)
+                    return polyCurve.Segments == null || !polyCurve.Segments.Any();
+            }
+            return false;
+        }
+
+        /// <summary>
+        /// The bounds of the item before it is meshed, for swept disks the mitres at the joints are not included
+        /// </summary>
+        public XbimRect3D GetBounds(IIfcRepresentationItem item)
+        {
+            if (item is IIfcCsgSolid csg) item = csg.TreeRootExpression as IIfcRepresentationItem;
+            var bounds = XbimRect3D.Empty;
+            if (item is IIfcSweptDiskSolid sweptDisk)
+            {
+                var radius = (double)sweptDisk.Radius;
+                foreach (var p in GetDirectrixPoints(sweptDisk.Directrix))
+                {
+                    bounds.Union(new XbimPoint3D(p.X - radius, p.Y - radius, p.Z - radius));
+                    bounds.Union(new XbimPoint3D(p.X + radius, p.Y + radius, p.Z + radius));
+                }
+                return bounds;
+            }
+            double r, zMin, zMax;
+            IIfcAxis2Placement3D position;
+            if (item is IIfcSphere sphere)
+            {
+                r = sphere.Radius;
+                zMin = -r;
+                zMax = r;
+                position = sphere.Position;
+            }
+            else if (item is IIfcRightCircularCylinder cylinder)
+            {
+                r = cylinder.Radius;
+                zMin = 0;
+                zMax = cylinder.Height;
+                position = cylinder.Position;
+            }
+            else if (item is IIfcRightCircularCone cone)
+            {
+                r = cone.BottomRadius;
+                zMin = 0;
+                zMax = cone.Height;
+                position = cone.Position;
+            }
+            else
+                return bounds;
+            var matrix = position != null ? position.ToMatrix3D() : XbimMatrix3D.Identity;
+            foreach (var x in new[] { -r, r })
+                foreach (var y in new[] { -r, r })
+                    foreach (var z in new[] { zMin, zMax })
+                        bounds.Union(matrix.Transform(new XbimPoint3D(x, y, z)));
+            return bounds;
+        }
+
+        /// <summary>
+        /// Meshes the item, returns null if the item is not supported or is degenerate, the shape should then be built by the geometry engine
+        /// </summary>
+        /// <param name="item">The item to mesh</param>
+        /// <param name="linearDeflection">The maximum chordal deviation in model units</param>
+        /// <param name="angularDeflection">The maximum angle in radians between adjacent segments of a circle</param>
+        public XbimShapeGeometry Mesh(IIfcRepresentationItem item, double linearDeflection, double angularDeflection)
+        {
+            if (!CanMesh(item)) return null;
+            if (item is IIfcCsgSolid csg) item = (IIfcRepresentationItem)csg.TreeRootExpression;
+            PrimitiveMesh mesh;
+            XbimMatrix3D matrix = XbimMatrix3D.Identity;
+            if (item is IIfcSphere sphere)
+            {
+                mesh = MeshSphere(sphere.Radius, Segments(sphere.Radius, linearDeflection, angularDeflection));
+                if (sphere.Position != null) matrix = sphere.Position.ToMatrix3D();
+            }
+            else if (item is IIfcRightCircularCylinder cylinder)
+            {
+                var path = new List<XbimPoint3D> { new XbimPoint3D(0, 0, 0), new XbimPoint3D(0, 0, cylinder.Height) };
+                mesh = MeshSweptDisk(path, cylinder.Radius, 0, Segments(cylinder.Radius, linearDeflection, angularDeflection));
+                if (cylinder.Position != null) matrix = cylinder.Position.ToMatrix3D();
+            }
+            else if (item is IIfcRightCircularCone cone)
+            {
+                mesh = MeshCone(cone.BottomRadius, cone.Height, Segments(cone.BottomRadius, linearDeflection, angularDeflection));
+                if (cone.Position != null) matrix = cone.Position.ToMatrix3D();
+            }
+            else
+            {
+                var sweptDisk = (IIfcSweptDiskSolid)item;
+                var radius = (double)sweptDisk.Radius;
+                var innerRadius = sweptDisk.InnerRadius.HasValue ? (double)sweptDisk.InnerRadius.Value : 0;
+                if (innerRadius >= radius) innerRadius = 0;
+                mesh = MeshSweptDisk(GetDirectrixPoints(sweptDisk.Directrix), radius, innerRadius,
+                    Segments(radius, linearDeflection, angularDeflection));
+            }
+            if (mesh == null) return null;
+            if (!matrix.IsIdentity) Transform(mesh, matrix);
+            return ToShapeGeometry(mesh);
+        }
+
+        private static int Segments(double radius, double linearDeflection, double angularDeflection)
+        {
+            var segments = MinSegments;
+            if (angularDeflection > 0)
+                segments = Math.Max(segments, (int)Math.Ceiling(2 * Math.PI / angularDeflection));
+            if (linearDeflection > 0 && linearDeflection < radius)
+                segments = Math.Max(segments, (int)Math.Ceiling(Math.PI / Math.Acos(1 - linearDeflection / radius)));
+            return Math.Min(segments, MaxSegments);
+        }
+
+        private List<XbimPoint3D> GetDirectrixPoints(IIfcCurve directrix)
+        {
+            var points = new List<XbimPoint3D>();
+            if (directrix is IIfcPolyline polyline)
+            {
+                foreach (var p in polyline.Points)
+                    points.Add(new XbimPoint3D(p.Coordinates[0], p.Coordinates[1], p.Coordinates.Count > 2 ? (double)p.Coordinates[2] : 0));
+            }
+            else if (directrix is IIfcIndexedPolyCurve polyCurve)
+            {
+                if (polyCurve.Points is IIfcCartesianPointList3D pointList3D)
+                {
+                    foreach (var c in pointList3D.CoordList)
+                        points.Add(new XbimPoint3D(c[0], c[1], c[2]));
+                }
+                else if (polyCurve.Points is IIfcCartesianPointList2D pointList2D)
+                {
+                    foreach (var c in pointList2D.CoordList)
+                        points.Add(new XbimPoint3D(c[0], c[1], 0));
+                }
+            }
+            //remove coincident points, they have no direction
+            var precision = _model.ModelFactors.Precision;
+            var distinct = new List<XbimPoint3D>(points.Count);
+            foreach (var p in points)
+            {
+                if (distinct.Count == 0 || (p - distinct[distinct.Count - 1]).Length > precision)
+                    distinct.Add(p);
+            }
+            return distinct;
+        }
+
+        private static PrimitiveMesh MeshSphere(double radius, int segments)
+        {
+            if (radius <= 0) return null;
+            var mesh = new PrimitiveMesh();
+            var face = new Face();
+            var rings = Math.Max(4, (segments + 1) / 2);
+            var north = mesh.AddPoint(new XbimPoint3D(0, 0, radius));
+            for (int k = 1; k < rings; k++)
+            {
+                var phi = Math.PI * k / rings;
+                for (int j = 0; j < segments; j++)
+                {
+                    var theta = 2 * Math.PI * j / segments;
+                    mesh.AddPoint(new XbimPoint3D(radius * Math.Sin(phi) * Math.Cos(theta), radius * Math.Sin(phi) * Math.Sin(theta), radius * Math.Cos(phi)));
+                }
+            }
+            var south = mesh.AddPoint(new XbimPoint3D(0, 0, -radius));
+            Func<int, int, int> ringPoint = (k, j) => 1 + (k - 1) * segments + j % segments;
+            Action<int> add = i =>
+            {
+                face.Indices.Add(i);
+                face.Normals.Add((mesh.Points[i] - new XbimPoint3D(0, 0, 0)).Normalized());
+            };
+            for (int j = 0; j < segments; j++)
+            {
+                add(north); add(ringPoint(1, j)); add(ringPoint(1, j + 1));
+                for (int k = 1; k < rings - 1; k++)
+                {
+                    add(ringPoint(k, j)); add(ringPoint(k + 1, j)); add(ringPoint(k + 1, j + 1));
+                    add(ringPoint(k, j)); add(ringPoint(k + 1, j + 1)); add(ringPoint(k, j + 1));
+                }
+                add(south); add(ringPoint(rings - 1, j + 1)); add(ringPoint(rings - 1, j));
+            }
+            mesh.Faces.Add(face);
+            return mesh;
+        }
+
+        private static PrimitiveMesh MeshCone(double radius, double height, int segments)
+        {
+            if (radius <= 0 || height <= 0) return null;
+            var mesh = new PrimitiveMesh();
+            for (int j = 0; j < segments; j++)
+            {
+                var theta = 2 * Math.PI * j / segments;
+                mesh.AddPoint(new XbimPoint3D(radius * Math.Cos(theta), radius * Math.Sin(theta), 0));
+            }
+            var apex = mesh.AddPoint(new XbimPoint3D(0, 0, height));
+            Func<double, XbimVector3D> sideNormal = theta => new XbimVector3D(height * Math.Cos(theta), height * Math.Sin(theta), radius).Normalized();
+            var side = new Face();
+            for (int j = 0; j < segments; j++)
+            {
+                var theta = 2 * Math.PI * j / segments;
+                var nextTheta = 2 * Math.PI * (j + 1) / segments;
+                side.Indices.Add(j);
+                side.Normals.Add(sideNormal(theta));
+                side.Indices.Add((j + 1) % segments);
+                side.Normals.Add(sideNormal(nextTheta));
+                side.Indices.Add(apex);
+                side.Normals.Add(sideNormal((theta + nextTheta) / 2));
+            }
+            mesh.Faces.Add(side);
+            var bottom = new Face { IsPlanar = true };
+            bottom.Normals.Add(new XbimVector3D(0, 0, -1));
+            for (int j = 1; j < segments - 1; j++)
+            {
+                bottom.Indices.Add(0);
+                bottom.Indices.Add(j + 1);
+                bottom.Indices.Add(j);
+            }
+            mesh.Faces.Add(bottom);
+            return mesh;
+        }
+
+        /// <summary>
+        /// Sweeps a circle, or an annulus if innerRadius is greater than 0, along the path. At each vertex the section is mitred on the plane
+        /// that bisects the adjacent segments, the section of each segment is found by projecting the previous section along the segment on to this plane
+        /// </summary>
+        private static PrimitiveMesh MeshSweptDisk(List<XbimPoint3D> path, double radius, double innerRadius, int segments)
+        {
+            if (path.Count < 2 || radius <= 0) return null;
+            var directions = new List<XbimVector3D>(path.Count - 1);
+            for (int i = 0; i < path.Count - 1; i++)
+            {
+                //a segment of no length has no direction, nor has a cylinder of no height
+                var segment = path[i + 1] - path[i];
+                if (segment.Length <= 0) return null;
+                directions.Add(segment.Normalized());
+            }
+            for (int i = 1; i < directions.Count; i++)
+            {
+                //a segment that doubles back on itself cannot be mitred
+                if (XbimVector3D.DotProduct(directions[i - 1], directions[i]) < -0.99) return null;
+            }
+
+            //the section at the start, u and v are perpendicular to the first segment
+            var d0 = directions[0];
+            var reference = Math.Abs(d0.X) < 0.9 ? new XbimVector3D(1, 0, 0) : new XbimVector3D(0, 1, 0);
+            var u = XbimVector3D.CrossProduct(reference, d0).Normalized();
+            var v = XbimVector3D.CrossProduct(d0, u);
+            if (path.Count == 2 && Math.Abs(d0.Z - 1) < 1e-9)
+            {
+                //a cylinder along its z axis, keep the seam on the x axis of the position
+                u = new XbimVector3D(1, 0, 0);
+                v = new XbimVector3D(0, 1, 0);
+            }
+            var hollow = innerRadius > 0;
+            var outer = new List<XbimPoint3D>(segments);
+            var inner = new List<XbimPoint3D>(segments);
+            for (int j = 0; j < segments; j++)
+            {
+                var theta = 2 * Math.PI * j / segments;
+                var radial = u * Math.Cos(theta) + v * Math.Sin(theta);
+                outer.Add(path[0] + radial * radius);
+                if (hollow) inner.Add(path[0] + radial * innerRadius);
+            }
+
+            var mesh = new PrimitiveMesh();
+            var outerRings = new List<int>(path.Count);
+            var innerRings = new List<int>(path.Count);
+            outerRings.Add(AddRing(mesh, outer));
+            if (hollow) innerRings.Add(AddRing(mesh, inner));
+            for (int i = 1; i < path.Count; i++)
+            {
+                var direction = directions[i - 1];
+                var mitre = i < directions.Count ? (direction + directions[i]).Normalized() : direction;
+                var denominator = XbimVector3D.DotProduct(direction, mitre);
+                for (int j = 0; j < segments; j++)
+                {
+                    outer[j] = outer[j] + direction * (XbimVector3D.DotProduct(path[i] - outer[j], mitre) / denominator);
+                    if (hollow) inner[j] = inner[j] + direction * (XbimVector3D.DotProduct(path[i] - inner[j], mitre) / denominator);
+                }
+                outerRings.Add(AddRing(mesh, outer));
+                if (hollow) innerRings.Add(AddRing(mesh, inner));
+            }
+
+            for (int i = 0; i < directions.Count; i++)
+            {
+                mesh.Faces.Add(SweepFace(mesh, outerRings[i], outerRings[i + 1], path[i], directions[i], segments, false));
+                if (hollow)
+                    mesh.Faces.Add(SweepFace(mesh, innerRings[i], innerRings[i + 1], path[i], directions[i], segments, true));
+            }
+            mesh.Faces.Add(CapFace(outerRings[0], hollow ? innerRings[0] : -1, directions[0] * -1, segments, true));
+            mesh.Faces.Add(CapFace(outerRings[path.Count - 1], hollow ? innerRings[path.Count - 1] : -1, directions[directions.Count - 1], segments, false));
+            return mesh;
+        }
+
+        private static int AddRing(PrimitiveMesh mesh, List<XbimPoint3D> ring)
+        {
+            var first = mesh.Points.Count;
+            mesh.Points.AddRange(ring);
+            return first;
+        }
+
+        //the side of one segment, the normals are radial to the axis of the segment and point away from it, or towards it for the inner wall
+        private static Face SweepFace(PrimitiveMesh mesh, int startRing, int endRing, XbimPoint3D origin, XbimVector3D direction, int segments, bool inward)
+        {
+            var face = new Face();
+            Action<int> add = i =>
+            {
+                var offset = mesh.Points[i] - origin;
+                var normal = (offset - direction * XbimVector3D.DotProduct(offset, direction)).Normalized();
+                face.Indices.Add(i);
+                face.Normals.Add(inward ? normal * -1 : normal);
+            };
+            for (int j = 0; j < segments; j++)
+            {
+                var a = startRing + j;
+                var b = startRing + (j + 1) % segments;
+                var c = endRing + (j + 1) % segments;
+                var d = endRing + j;
+                if (inward)
+                {
+                    add(a); add(c); add(b);
+                    add(a); add(d); add(c);
+                }
+                else
+                {
+                    add(a); add(b); add(c);
+                    add(a); add(c); add(d);
+                }
+            }
+            return face;
+        }
+
+        //the planar end of a sweep, a fan for a disk or a strip for an annulus
+        private static Face CapFace(int outerRing, int innerRing, XbimVector3D normal, int segments, bool isStart)
+        {
+            var face = new Face { IsPlanar = true };
+            face.Normals.Add(normal);
+            Action<int, int, int> add = (a, b, c) =>
+            {
+                face.Indices.Add(a);
+                if (isStart)
+                {
+                    face.Indices.Add(c);
+                    face.Indices.Add(b);
+                }
+                else
+                {
+                    face.Indices.Add(b);
+                    face.Indices.Add(c);
+                }
+            };
+            if (innerRing < 0)
+            {
+                for (int j = 1; j < segments - 1; j++)
+                    add(outerRing, outerRing + j, outerRing + j + 1);
+            }
+            else
+            {
+                for (int j = 0; j < segments; j++)
+                {
+                    var next = (j + 1) % segments;
+                    add(outerRing + j, outerRing + next, innerRing + next);
+                    add(outerRing + j, innerRing + next, innerRing + j);
+                }
+            }
+            return face;
+        }
+
+        private static void Transform(PrimitiveMesh mesh, XbimMatrix3D matrix)
+        {
+            for (int i = 0; i < mesh.Points.Count; i++)
+                mesh.Points[i] = matrix.Transform(mesh.Points[i]);
+            foreach (var face in mesh.Faces)
+            {
+                for (int i = 0; i < face.Normals.Count; i++)
+                {
+                    var n = face.Normals[i];
+                    face.Normals[i] = new XbimVector3D(
+                        n.X * matrix.M11 + n.Y * matrix.M21 + n.Z * matrix.M31,
+                        n.X * matrix.M12 + n.Y * matrix.M22 + n.Z * matrix.M32,
+                        n.X * matrix.M13 + n.Y * matrix.M23 + n.Z * matrix.M33).Normalized();
+                }
+            }
+        }
+
+        //writes the mesh in the same binary layout as the geometry engine
+        private static XbimShapeGeometry ToShapeGeometry(PrimitiveMesh mesh)
+        {
+            var bounds = XbimRect3D.Empty;
+            foreach (var p in mesh.Points)
+                bounds.Union(p);
+            var shapeGeometry = new XbimShapeGeometry
+            {
+                GeometryHash = 0,
+                LOD = XbimLOD.LOD_Unspecified,
+                Format = XbimGeometryType.PolyhedronBinary,
+                BoundingBox = bounds
+            };
+            var vertexCount = mesh.Points.Count;
+            var triangleCount = mesh.Faces.Sum(f => f.Indices.Count / 3);
+            using (var memStream = new MemoryStream(0x4000))
+            {
+                using (var bw = new BinaryWriter(memStream))
+                {
+                    bw.Write((byte)1); //stream format version
+                    bw.Write((uint)vertexCount);
+                    bw.Write((uint)triangleCount);
+                    foreach (var p in mesh.Points)
+                    {
+                        bw.Write((float)p.X);
+                        bw.Write((float)p.Y);
+                        bw.Write((float)p.Z);
+                    }
+                    bw.Write(mesh.Faces.Count);
+                    foreach (var face in mesh.Faces)
+                    {
+                        if (face.IsPlanar)
+                        {
+                            bw.Write(face.Indices.Count / 3);
+                            WriteNormal(bw, face.Normals[0]);
+                            foreach (var index in face.Indices)
+                                WriteIndex(bw, index, vertexCount);
+                        }
+                        else
+                        {
+                            bw.Write(-face.Indices.Count / 3); //a negative count indicates that every index has a normal
+                            for (int i = 0; i < face.Indices.Count; i++)
+                            {
+                                WriteIndex(bw, face.Indices[i], vertexCount);
+                                WriteNormal(bw, face.Normals[i]);
+                            }
+                        }
+                    }
+                }
+                ((IXbimShapeGeometryData)shapeGeometry).ShapeData = memStream.ToArray();
+            }
+            return shapeGeometry;
+        }
+
+        private static void WriteNormal(BinaryWriter bw, XbimVector3D normal)
+        {
+            new XbimPackedNormal(normal.X, normal.Y, normal.Z).Write(bw);
+        }
+
+        private static void WriteIndex(BinaryWriter bw, int index, int vertexCount)
+        {
+            if (vertexCount <= 0xFF)
+                bw.Write((byte)index);
+            else if (vertexCount <= 0xFFFF)
+                bw.Write((ushort)index);
+            else
+                bw.Write((uint)index);
+        }
+    }
+}
@@ -0,0 +1,308 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Linq;
+using Microsoft.Extensions.Logging;
+using Xbim.Common;
+using Xbim.Common.Geometry;
+using Xbim.Ifc;
+using Xbim.Ifc4.Interfaces;
+
+namespace Xbim.ModelGeometry.Scene
+{
+    /// <summary>
+    /// The worker process of a sharded CreateContext. An executable that hosts the worker calls Run with its command line and returns
+    /// the result as its exit code, the path of the executable is given to the parent in Xbim3DModelContext.ShardWorkerPath
+    /// </summary>
+    public static class XbimShardWorker
+    {
+        public const int Succeeded = 0;
+        public const int Failed = 1;
+        public const int InvalidArguments = 2;
+
+        /// <summary>
+        /// Opens the model, converts the products of one shard and writes their geometry to the output file.
+        /// Arguments: -model &lt;file&gt; -shard &lt;index&gt; -shards &lt;count&gt; -output &lt;file&gt; [-maxthreads &lt;n&gt;] [-context &lt;type&gt;]
+        /// [-contextid &lt;identifier&gt;] [-adjustwcs &lt;true|false&gt;] [-budget &lt;seconds&gt;] [-cachebudget &lt;bytes&gt;] [-primitives &lt;true|false&gt;]
+        /// [-lofts &lt;true|false&gt;]
+        /// </summary>
+        public static int Run(string[] args, ILogger logger = null)
+        {
+            logger = logger ?? XbimLogging.CreateLogger<Xbim3DModelContext>();
+            var options = new Dictionary<string, string>(StringComparer.OrdinalIgnoreCase);
+            for (var i = 0; i + 1 < args.Length; i += 2)
+                options[args[i].TrimStart('-', '/')] = args[i + 1];
+            if (!options.TryGetValue("model", out string modelFile) || !options.TryGetValue("output", out string outputFile) ||
+                !TryGetInt(options, "shard", out int shardIndex) || !TryGetInt(options, "shards", out int shardCount) ||
+                shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount)
+            {
+                logger.LogError("Invalid shard worker arguments '{0}'", string.Join(" ", args));
+                return InvalidArguments;
+            }
+            try
+            {
+                using (var model = IfcStore.Open(modelFile))
+                {
+                    options.TryGetValue("context", out string contextType);
+                    options.TryGetValue("contextid", out string contextIdentifier);
+                    var context = new Xbim3DModelContext(model, contextType ?? "model", contextIdentifier, logger)
+                    {
+                        ShardIndex = shardIndex,
+                        ShardCount = shardCount
+                    };
+                    if (TryGetInt(options, "maxthreads", out int maxThreads))
+                        context.MaxThreads = maxThreads;
+                    if (options.TryGetValue("budget", out string budget))
+                        context.ProductTimeBudget = TimeSpan.FromSeconds(double.Parse(budget, CultureInfo.InvariantCulture));
+                    if (options.TryGetValue("cachebudget", out string cacheBudget))
+                        context.GeometryCacheBudget = long.Parse(cacheBudget, CultureInfo.InvariantCulture);
+                    if (options.TryGetValue("primitives", out string primitives))
+                        context.MeshPrimitivesDirectly = bool.Parse(primitives);
+                    if (options.TryGetValue("lofts", out string lofts))
+                        context.MeshLoftsDirectly = bool.Parse(lofts);
+                    var adjustWcs = !options.TryGetValue("adjustwcs", out string adjust) || bool.Parse(adjust);
+                    if (!context.CreateContext(null, adjustWcs))
+                        return Failed;
+                    // written to a temporary name so that a worker killed while writing leaves no output the parent would read
+                    var partialFile = outputFile + ".partial";
+                    using (var reader = model.GeometryStore.BeginRead())
+                        XbimShardFile.Write(partialFile, reader, context.ShardClusters);
+                    if (File.Exists(outputFile))
+                        File.Delete(outputFile);
+                    File.Move(partialFile, outputFile);
+                }
+                return Succeeded;
+            }
+            catch (Exception e)
+            {
+                logger.LogError(e, "Shard {0} of {1} of {2} failed", shardIndex, shardCount, modelFile);
+                return Failed;
+            }
+        }
+
+        private static bool TryGetInt(Dictionary<string, string> options, string name, out int value)
+        {
+            value = 0;
+            return options.TryGetValue(name, out string text) && int.TryParse(text, NumberStyles.Integer, CultureInfo.InvariantCulture, out value);
+        }
+    }
+
+    /// <summary>
+    /// The geometry a shard worker passes back to the parent, the shape geometries and instances of its geometry store and the
+    /// bounds of its elements for the regions
+    /// </summary>
+    internal class XbimShardFile
+    {
+        private const int Magic = 0x48534258; // XBSH
+        private const int Version = 1;
+
+        public List<XbimShapeGeometry> ShapeGeometries { get; } = new List<XbimShapeGeometry>();
+        public List<XbimShapeInstance> ShapeInstances { get; } = new List<XbimShapeInstance>();
+        /// <summary>
+        /// The key is the label of the representation context
+        /// </summary>
+        public Dictionary<int, List<XbimBBoxClusterElement>> Clusters { get; } = new Dictionary<int, List<XbimBBoxClusterElement>>();
+
+        public static void Write(string fileName, IGeometryStoreReader reader, IDictionary<int, List<XbimBBoxClusterElement>> clusters)
+        {
+            using (var writer = new BinaryWriter(new FileStream(fileName, FileMode.Create, FileAccess.Write, FileShare.None, 0x10000)))
+            {
+                writer.Write(Magic);
+                writer.Write(Version);
+                var geometries = reader.ShapeGeometries.ToList();
+                writer.Write(geometries.Count);
+                foreach (var geometry in geometries)
+                {
+                    writer.Write(geometry.ShapeLabel);
+                    writer.Write(geometry.IfcShapeLabel);
+                    writer.Write(geometry.GeometryHash);
+                    writer.Write(geometry.ReferenceCount);
+                    writer.Write((byte)geometry.LOD);
+                    writer.Write((byte)geometry.Format);
+                    Write(writer, geometry.BoundingBox);
+                    writer.Write(geometry.LocalShapeDisplacement.HasValue);
+                    if (geometry.LocalShapeDisplacement.HasValue)
+                    {
+                        var displacement = geometry.LocalShapeDisplacement.Value;
+                        writer.Write(displacement.X);
+                        writer.Write(displacement.Y);
+                        writer.Write(displacement.Z);
+                    }
+                    var data = geometry.ShapeData ?? new byte[0];
+                    writer.Write(data.Length);
+                    writer.Write(data);
+                }
+                var instances = reader.ShapeInstances.ToList();
+                writer.Write(instances.Count);
+                foreach (var instance in instances)
+                {
+                    writer.Write(instance.InstanceLabel);
+                    writer.Write(instance.IfcTypeId);
+                    writer.Write(instance.IfcProductLabel);
+                    writer.Write(instance.StyleLabel);
+                    writer.Write(instance.ShapeGeometryLabel);
+                    writer.Write((byte)instance.RepresentationType);
+                    writer.Write(instance.RepresentationContext);
+                    Write(writer, instance.Transformation);
+                    Write(writer, instance.BoundingBox);
+                }
+                writer.Write(clusters.Count);
+                foreach (var cluster in clusters)
+                {
+                    writer.Write(cluster.Key);
+                    writer.Write(cluster.Value.Count);
+                    foreach (var element in cluster.Value)
+                    {
+                        writer.Write(element.GeometryIds.FirstOrDefault());
+                        Write(writer, element.Bound);
+                    }
+                }
+            }
+        }
+
+        public static XbimShardFile Read(string fileName)
+        {
+            var shard = new XbimShardFile();
+            using (var reader = new BinaryReader(new FileStream(fileName, FileMode.Open, FileAccess.Read, FileShare.Read, 0x10000)))
+            {
+                if (reader.ReadInt32() != Magic || reader.ReadInt32() != Version)
+                    throw new InvalidDataException("Not a shard file of this version: " + fileName);
+                var geometries = reader.ReadInt32();
+                for (var i = 0; i < geometries; i++)
+                {
+                    var geometry = new XbimShapeGeometry
+                    {
+                        ShapeLabel = reader.ReadInt32(),
+                        IfcShapeLabel = reader.ReadInt32(),
+                        GeometryHash = reader.ReadInt32(),
+                        ReferenceCount = reader.ReadInt32(),
+                        LOD = (XbimLOD)reader.ReadByte(),
+                        Format = (XbimGeometryType)reader.ReadByte(),
+                        BoundingBox = ReadRect(reader)
+                    };
+                    if (reader.ReadBoolean())
+                        geometry.LocalShapeDisplacement = new XbimVector3D(reader.ReadDouble(), reader.ReadDouble(), reader.ReadDouble());
+                    geometry.ShapeData = reader.ReadBytes(reader.ReadInt32());
+                    shard.ShapeGeometries.Add(geometry);
+                }
+                var instances = reader.ReadInt32();
+                for (var i = 0; i < instances; i++)
+                {
+                    shard.ShapeInstances.Add(new XbimShapeInstance
+                    {
+                        InstanceLabel = reader.ReadInt32(),
+                        IfcTypeId = reader.ReadInt16(),
+                        IfcProductLabel = reader.ReadInt32(),
+                        StyleLabel = reader.ReadInt32(),
+                        ShapeGeometryLabel = reader.ReadInt32(),
+                        RepresentationType = (XbimGeometryRepresentationType)reader.ReadByte(),
+                        RepresentationContext = reader.ReadInt32(),
+                        Transformation = ReadMatrix(reader),
+                        BoundingBox = ReadRect(reader)
+                    });
+                }
+                var contexts = reader.ReadInt32();
+                for (var i = 0; i < contexts; i++)
+                {
+                    var elements = new List<XbimBBoxClusterElement>();
+                    shard.Clusters.Add(reader.ReadInt32(), elements);
+                    var count = reader.ReadInt32();
+                    for (var j = 0; j < count; j++)
+                        elements.Add(new XbimBBoxClusterElement(reader.ReadInt32(), ReadRect(reader)));
+                }
+            }
+            return shard;
+        }
+
+        private static void Write(BinaryWriter writer, XbimRect3D rect)
+        {
+            writer.Write(rect.X);
+            writer.Write(rect.Y);
+            writer.Write(rect.Z);
+            writer.Write(rect.SizeX);
+            writer.Write(rect.SizeY);
+            writer.Write(rect.SizeZ);
+        }
+
+        private static XbimRect3D ReadRect(BinaryReader reader)
+        {
+            return new XbimRect3D(reader.ReadDouble(), reader.ReadDouble(), reader.ReadDouble(), reader.ReadDouble(), reader.ReadDouble(), reader.ReadDouble());
+        }
+
+        private static void Write(BinaryWriter writer, XbimMatrix3D matrix)
+        {
+            foreach (var value in new[] { matrix.M11, matrix.M12, matrix.M13, matrix.M14, matrix.M21, matrix.M22, matrix.M23, matrix.M24,
+                matrix.M31, matrix.M32, matrix.M33, matrix.M34, matrix.OffsetX, matrix.OffsetY, matrix.OffsetZ, matrix.M44 })
+                writer.Write(value);
+        }
+
+        private static XbimMatrix3D ReadMatrix(BinaryReader reader)
+        {
+            var m = new double[16];
+            for (var i = 0; i < m.Length; i++)
+                m[i] = reader.ReadDouble();
+            return new XbimMatrix3D(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+        }
+    }
+
+    /// <summary>
+    /// Adds the shard files to the geometry store of the parent in shard order. The geometry of a representation item mapped by products
+    /// of several shards is written by each of them, and an opening or projection of elements in several shards is converted by each
+    /// of them, only the first copy is kept and the instances are remapped to it
+    /// </summary>
+    internal class XbimShardMerger
+    {
+        private readonly IModel _model;
+        private readonly IGeometryStoreInitialiser _store;
+        private readonly Dictionary<int, int> _representationItemShapes = new Dictionary<int, int>();
+        private readonly HashSet<int> _mergedProducts = new HashSet<int>();
+
+        /// <summary>
+        /// The bounds of the elements of all shards merged, the key is the label of the representation context
+        /// </summary>
+        public Dictionary<int, List<XbimBBoxClusterElement>> Clusters { get; } = new Dictionary<int, List<XbimBBoxClusterElement>>();
+
+        public XbimShardMerger(IModel model, IGeometryStoreInitialiser store)
+        {
+            _model = model;
+            _store = store;
+        }
+
+        public void Merge(XbimShardFile shard)
+        {
+            // the instances of products merged from an earlier shard are dropped, and the geometries only they use with them
+            var instances = shard.ShapeInstances.Where(i => !_mergedProducts.Contains(i.IfcProductLabel)).ToList();
+            var usedShapes = new HashSet<int>(instances.Select(i => i.ShapeGeometryLabel));
+            var shapeLabels = new Dictionary<int, int>();
+            foreach (var shapeGeometry in shard.ShapeGeometries)
+            {
+                if (!usedShapes.Contains(shapeGeometry.ShapeLabel))
+                    continue;
+                var isRepresentationItem = _model.Instances[shapeGeometry.IfcShapeLabel] is IIfcRepresentationItem;
+                if (isRepresentationItem && _representationItemShapes.TryGetValue(shapeGeometry.IfcShapeLabel, out int merged))
+                {
+                    shapeLabels[shapeGeometry.ShapeLabel] = merged;
+                    continue;
+                }
+                var shapeLabel = _store.AddShapeGeometry(shapeGeometry);
+                shapeLabels[shapeGeometry.ShapeLabel] = shapeLabel;
+                if (isRepresentationItem)
+                    _representationItemShapes[shapeGeometry.IfcShapeLabel] = shapeLabel;
+            }
+            foreach (var shapeInstance in instances)
+            {
+                if (shapeLabels.TryGetValue(shapeInstance.ShapeGeometryLabel, out int shapeLabel))
+                    shapeInstance.ShapeGeometryLabel = shapeLabel;
+                _store.AddShapeInstance(shapeInstance, shapeInstance.ShapeGeometryLabel);
+            }
+            _mergedProducts.UnionWith(instances.Select(i => i.IfcProductLabel));
+            foreach (var cluster in shard.Clusters)
+            {
+                if (!Clusters.TryGetValue(cluster.Key, out List<XbimBBoxClusterElement> elements))
+                    Clusters.Add(cluster.Key, elements = new List<XbimBBoxClusterElement>());
+                elements.AddRange(cluster.Value);
+            }
+        }
+    }
+}